@@ -185,10 +185,14 @@ SET(WEECHAT_SOURCES
 ./src/plugins/logger/logger-config.c
 ./src/plugins/logger/logger-config.h
 ./src/plugins/logger/logger.h
+./src/plugins/logger/logger-index.c
+./src/plugins/logger/logger-index.h
 ./src/plugins/logger/logger-info.c
 ./src/plugins/logger/logger-info.h
 ./src/plugins/logger/logger-tail.c
 ./src/plugins/logger/logger-tail.h
+./src/plugins/logger/logger-writer.c
+./src/plugins/logger/logger-writer.h
 ./src/plugins/lua/weechat-lua-api.c
 ./src/plugins/lua/weechat-lua-api.h
 ./src/plugins/lua/weechat-lua.c
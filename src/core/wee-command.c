@@ -1767,6 +1767,7 @@ COMMAND_CALLBACK(debug)
     if (string_strcasecmp (argv[1], "tags") == 0)
     {
         gui_chat_display_tags ^= 1;
+        gui_chat_rows_invalidate ();
         gui_window_ask_refresh (2);
         return WEECHAT_RC_OK;
     }
@@ -5141,6 +5142,45 @@ COMMAND_CALLBACK(save)
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Callback for command "/search": searches text in buffer.
+ */
+
+COMMAND_CALLBACK(search)
+{
+    int i, exact, regex, where;
+
+    /* make C compiler happy */
+    (void) data;
+
+    exact = -1;
+    regex = -1;
+    where = -1;
+
+    for (i = 1; i < argc; i++)
+    {
+        if (string_strcasecmp (argv[i], "-exact") == 0)
+            exact = 1;
+        else if (string_strcasecmp (argv[i], "-regex") == 0)
+            regex = 1;
+        else if (string_strcasecmp (argv[i], "-prefix") == 0)
+            where = GUI_TEXT_SEARCH_IN_PREFIX;
+        else if (string_strcasecmp (argv[i], "-message") == 0)
+            where = GUI_TEXT_SEARCH_IN_MESSAGE;
+        else if (string_strcasecmp (argv[i], "-prefix_message") == 0)
+            where = GUI_TEXT_SEARCH_IN_PREFIX | GUI_TEXT_SEARCH_IN_MESSAGE;
+        else
+            break;
+    }
+
+    if (i >= argc)
+        return WEECHAT_RC_ERROR;
+
+    gui_input_search_text_string (buffer, argv_eol[i], exact, regex, where);
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Displays a secured data.
  */
@@ -7710,6 +7750,35 @@ command_init ()
            "Without argument, all files (WeeChat and plugins) are saved."),
         "%(config_files)|%*",
         &command_save, NULL);
+    hook_command (
+        NULL, "search",
+        N_("search text in buffer"),
+        N_("[-exact] [-regex] [-prefix|-message|-prefix_message] <text>"),
+        N_("          -exact: case sensitive search\n"
+           "          -regex: search a regular expression\n"
+           "         -prefix: search in prefixes\n"
+           "        -message: search in messages\n"
+           " -prefix_message: search in prefixes and messages\n"
+           "            text: text to search\n"
+           "\n"
+           "The search is started in current buffer (like with key ctrl-R), "
+           "and the buffer is scrolled to the last line found. Then the keys "
+           "used during search can be used as usual (up/down to search "
+           "previous/next line, enter to stop search).\n"
+           "\n"
+           "Options that are not given have default values (see options "
+           "weechat.look.buffer_search_*).\n"
+           "\n"
+           "When the text searched grows (without regex), only the lines "
+           "found by the previous search are checked again.\n"
+           "\n"
+           "Examples:\n"
+           "  search \"weechat\" in messages:\n"
+           "    /search -message weechat\n"
+           "  search lines from nick \"FlashCode\" (case sensitive):\n"
+           "    /search -exact -prefix FlashCode"),
+        "-exact|-regex|-prefix|-message|-prefix_message|%*",
+        &command_search, NULL);
     hook_command (
         NULL, "secure",
         N_("manage secured data (passwords or private data encrypted in file "
@@ -80,6 +80,7 @@ struct t_config_option *config_startup_sys_rlimit;
 /* config, look & feel section */
 
 struct t_config_option *config_look_align_end_of_lines;
+struct t_config_option *config_look_bar_item_update_delay;
 struct t_config_option *config_look_bar_more_left;
 struct t_config_option *config_look_bar_more_right;
 struct t_config_option *config_look_bar_more_up;
@@ -138,6 +139,7 @@ struct t_config_option *config_look_jump_current_to_previous_buffer;
 struct t_config_option *config_look_jump_previous_buffer_when_closing;
 struct t_config_option *config_look_jump_smart_back_to_buffer;
 struct t_config_option *config_look_key_bind_safe;
+struct t_config_option *config_look_max_fps;
 struct t_config_option *config_look_nick_prefix;
 struct t_config_option *config_look_nick_suffix;
 struct t_config_option *config_look_mouse;
@@ -2061,6 +2063,16 @@ config_weechat_init_options ()
            "are starting under this data (time, buffer, prefix, suffix, "
            "message (default))"),
         "time|buffer|prefix|suffix|message", 0, 0, "message", NULL, 0, NULL, NULL, &config_change_buffers, NULL, NULL, NULL);
+    config_look_bar_item_update_delay = config_file_new_option (
+        weechat_config_file, ptr_section,
+        "bar_item_update_delay", "integer",
+        N_("minimum delay between two updates of a bar item (in "
+           "milliseconds); when a bar item is updated more often (for "
+           "example nicklist or hotlist during a flood), updates are "
+           "grouped and the item is rebuilt only once at the end of delay "
+           "(0 = update bar items immediately); items input_text and "
+           "input_search are always updated immediately"),
+        NULL, 0, 10000, "50", NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL);
     config_look_bar_more_left = config_file_new_option (
         weechat_config_file, ptr_section,
         "bar_more_left", "string",
@@ -2199,9 +2211,12 @@ config_weechat_init_options ()
         weechat_config_file, ptr_section,
         "color_pairs_auto_reset", "integer",
         N_("automatically reset table of color pairs when number of available "
-           "pairs is lower or equal to this number (-1 = disable automatic "
+           "pairs is lower or equal to this number; available pairs are the "
+           "pairs not yet used and the pairs that can be reused because they "
+           "are not displayed on screen (when table is full, the least "
+           "recently used of these pairs is reused) (-1 = disable automatic "
            "reset, and then a manual \"/color reset\" is needed when table "
-            "is full)"),
+           "is full)"),
         NULL, -1, 256, "5", NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL);
     config_look_color_real_white = config_file_new_option (
         weechat_config_file, ptr_section,
@@ -2454,6 +2469,14 @@ config_weechat_init_options ()
         N_("allow only binding of \"safe\" keys (beginning with a ctrl or meta "
            "code)"),
         NULL, 0, 0, "on", NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL);
+    config_look_max_fps = config_file_new_option (
+        weechat_config_file, ptr_section,
+        "max_fps", "integer",
+        N_("maximum number of refreshs of screen per second: during a flood, "
+           "all messages received are displayed with a single refresh at "
+           "the end of the frame; keys pressed are always displayed "
+           "immediately (0 = no limit, refresh screen after each event)"),
+        NULL, 0, 1000, "60", NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL);
     config_look_nick_prefix = config_file_new_option (
         weechat_config_file, ptr_section,
         "nick_prefix", "string",
@@ -118,6 +118,7 @@ extern struct t_config_option *config_startup_display_version;
 extern struct t_config_option *config_startup_sys_rlimit;
 
 extern struct t_config_option *config_look_align_end_of_lines;
+extern struct t_config_option *config_look_bar_item_update_delay;
 extern struct t_config_option *config_look_bar_more_left;
 extern struct t_config_option *config_look_bar_more_right;
 extern struct t_config_option *config_look_bar_more_up;
@@ -175,6 +176,7 @@ extern struct t_config_option *config_look_jump_current_to_previous_buffer;
 extern struct t_config_option *config_look_jump_previous_buffer_when_closing;
 extern struct t_config_option *config_look_jump_smart_back_to_buffer;
 extern struct t_config_option *config_look_key_bind_safe;
+extern struct t_config_option *config_look_max_fps;
 extern struct t_config_option *config_look_nick_prefix;
 extern struct t_config_option *config_look_nick_suffix;
 extern struct t_config_option *config_look_mouse;
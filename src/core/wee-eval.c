@@ -49,6 +49,10 @@ char *comparisons[EVAL_NUM_COMPARISONS] =
 
 struct t_hashtable *eval_hashtable_pointers = NULL;
 
+struct t_eval_node *eval_compile_condition (const char *expr,
+                                            const char *prefix,
+                                            const char *suffix);
+
 
 /*
  * Checks if a value is true: a value is true if string is non-NULL, non-empty
@@ -66,236 +70,450 @@ eval_is_true (const char *value)
 }
 
 /*
- * Gets value of hdata using "path" to a variable.
+ * Splits a path in hdata (for example "buffer.local_variables.type" in
+ * "${window.buffer.local_variables.type}") into elements.
  *
- * Note: result must be freed after use.
+ * The elements are split like eval_hdata_get_value() reads them: the name
+ * of variable is before the first ".", and the rest of path is used to go on
+ * with a pointer, or as key for a hashtable.
  */
 
-char *
-eval_hdata_get_value (struct t_hdata *hdata, void *pointer, const char *path)
+void
+eval_var_split_path (struct t_eval_var *var, const char *path)
 {
-    char *value, *old_value, *var_name, str_value[128], *pos;
-    const char *ptr_value, *hdata_name;
-    int type;
-    struct t_hashtable *hashtable;
+    char *ptr_path, *pos;
+    int num_path;
 
-    value = NULL;
-    var_name = NULL;
+    var->path = NULL;
+    var->num_path = 0;
+    var->path_vars = NULL;
 
-    /* NULL pointer? return empty string */
-    if (!pointer)
-        return strdup ("");
+    if (!path)
+        return;
 
-    /* no path? just return current pointer as string */
-    if (!path || !path[0])
+    var->path = strdup (path);
+    if (!var->path)
+        return;
+
+    /* count elements in path */
+    num_path = 0;
+    ptr_path = var->path;
+    while (ptr_path)
     {
-        snprintf (str_value, sizeof (str_value),
-                  "0x%lx", (long unsigned int)pointer);
-        return strdup (str_value);
+        num_path++;
+        if (!ptr_path[0])
+            break;
+        pos = strchr (ptr_path, '.');
+        ptr_path = (pos) ? pos + 1 : NULL;
     }
 
-    /*
-     * look for name of hdata, for example in "window.buffer.full_name", the
-     * hdata name is "window"
-     */
-    pos = strchr (path, '.');
-    if (pos > path)
-        var_name = string_strndup (path, pos - path);
-    else
-        var_name = strdup (path);
+    var->path_vars = malloc (num_path * sizeof (var->path_vars[0]));
+    if (!var->path_vars)
+        return;
 
-    if (!var_name)
-        goto end;
+    /* split elements */
+    ptr_path = var->path;
+    while (ptr_path && (var->num_path < num_path))
+    {
+        if (ptr_path[0])
+        {
+            pos = strchr (ptr_path, '.');
+            var->path_vars[var->num_path].name = (pos > ptr_path) ?
+                string_strndup (ptr_path, pos - ptr_path) : strdup (ptr_path);
+            var->path_vars[var->num_path].key = (pos) ? pos + 1 : NULL;
+        }
+        else
+        {
+            pos = NULL;
+            var->path_vars[var->num_path].name = NULL;
+            var->path_vars[var->num_path].key = NULL;
+        }
+        var->num_path++;
+        ptr_path = (pos) ? pos + 1 : NULL;
+    }
+}
 
-    /* search type of variable in hdata */
-    type = hdata_get_var_type (hdata, var_name);
-    if (type < 0)
-        goto end;
+/*
+ * Creates a variable with the text between prefix and suffix: the type of
+ * variable is found and names are split, so that the variable can be
+ * evaluated quickly many times.
+ *
+ * Returns pointer to new variable, NULL if error.
+ */
 
-    /* build a string with the value or variable */
-    switch (type)
+struct t_eval_var *
+eval_var_new (const char *text)
+{
+    struct t_eval_var *new_var;
+    const char *pos, *pos2;
+    char *pos_list, *pos_list_end, *tmp;
+
+    if (!text)
+        return NULL;
+
+    new_var = malloc (sizeof (*new_var));
+    if (!new_var)
+        return NULL;
+
+    new_var->type = EVAL_VAR_OTHER;
+    new_var->text = strdup (text);
+    new_var->value = NULL;
+    new_var->name = NULL;
+    new_var->arguments = NULL;
+    new_var->option_file = NULL;
+    new_var->option_section = NULL;
+    new_var->option_name = NULL;
+    new_var->hdata_name = NULL;
+    new_var->hdata_list = NULL;
+    new_var->path = NULL;
+    new_var->num_path = 0;
+    new_var->path_vars = NULL;
+
+    if (strncmp (text, "esc:", 4) == 0)
     {
-        case WEECHAT_HDATA_CHAR:
-            snprintf (str_value, sizeof (str_value),
-                      "%c", hdata_char (hdata, pointer, var_name));
-            value = strdup (str_value);
-            break;
-        case WEECHAT_HDATA_INTEGER:
-            snprintf (str_value, sizeof (str_value),
-                      "%d", hdata_integer (hdata, pointer, var_name));
-            value = strdup (str_value);
-            break;
-        case WEECHAT_HDATA_LONG:
-            snprintf (str_value, sizeof (str_value),
-                      "%ld", hdata_long (hdata, pointer, var_name));
-            value = strdup (str_value);
-            break;
-        case WEECHAT_HDATA_STRING:
-        case WEECHAT_HDATA_SHARED_STRING:
-            ptr_value = hdata_string (hdata, pointer, var_name);
-            value = (ptr_value) ? strdup (ptr_value) : NULL;
-            break;
-        case WEECHAT_HDATA_POINTER:
-            pointer = hdata_pointer (hdata, pointer, var_name);
-            snprintf (str_value, sizeof (str_value),
-                      "0x%lx", (long unsigned int)pointer);
-            value = strdup (str_value);
-            break;
-        case WEECHAT_HDATA_TIME:
-            snprintf (str_value, sizeof (str_value),
-                      "%ld", (long)hdata_time (hdata, pointer, var_name));
-            value = strdup (str_value);
-            break;
-        case WEECHAT_HDATA_HASHTABLE:
-            pointer = hdata_hashtable (hdata, pointer, var_name);
-            if (pos)
+        /* escaped chars */
+        new_var->type = EVAL_VAR_STRING;
+        new_var->value = string_convert_escaped_chars (text + 4);
+    }
+    else if ((text[0] == '\\') && text[1] && (text[1] != '\\'))
+    {
+        /* escaped chars */
+        new_var->type = EVAL_VAR_STRING;
+        new_var->value = string_convert_escaped_chars (text);
+    }
+    else if (strncmp (text, "color:", 6) == 0)
+    {
+        /* color */
+        new_var->type = EVAL_VAR_COLOR;
+        new_var->name = strdup (text + 6);
+    }
+    else if (strncmp (text, "info:", 5) == 0)
+    {
+        /* info (with optional arguments) */
+        new_var->type = EVAL_VAR_INFO;
+        pos = strchr (text + 5, ',');
+        if (pos)
+        {
+            new_var->name = string_strndup (text + 5, pos - text - 5);
+            new_var->arguments = strdup (pos + 1);
+        }
+        else
+            new_var->name = strdup (text + 5);
+    }
+    else if (strncmp (text, "sec.data.", 9) == 0)
+    {
+        /* secured data */
+        new_var->type = EVAL_VAR_SECURE_DATA;
+        new_var->name = strdup (text + 9);
+    }
+    else
+    {
+        /* option (only if there are at least two dots in text) */
+        pos = strchr (text, '.');
+        pos2 = (pos) ? strchr (pos + 1, '.') : NULL;
+        if (pos && pos2)
+        {
+            new_var->option_file = string_strndup (text, pos - text);
+            new_var->option_section = string_strndup (pos + 1,
+                                                      pos2 - pos - 1);
+            new_var->option_name = strdup (pos2 + 1);
+        }
+
+        /* hdata name (with optional list name) and path */
+        new_var->hdata_name = (pos > text) ?
+            string_strndup (text, pos - text) : strdup (text);
+        if (new_var->hdata_name)
+        {
+            pos_list = strchr (new_var->hdata_name, '[');
+            if (pos_list > new_var->hdata_name)
             {
-                /*
-                 * for a hashtable, if there is a "." after name of hdata,
-                 * get the value for this key in hashtable
-                 */
-                hashtable = pointer;
-                ptr_value = hashtable_get (hashtable, pos + 1);
-                if (ptr_value)
+                pos_list_end = strchr (pos_list + 1, ']');
+                if (pos_list_end > pos_list + 1)
                 {
-                    switch (hashtable->type_values)
-                    {
-                        case HASHTABLE_INTEGER:
-                            snprintf (str_value, sizeof (str_value),
-                                      "%d", *((int *)ptr_value));
-                            value = strdup (str_value);
-                            break;
-                        case HASHTABLE_STRING:
-                            value = strdup (ptr_value);
-                            break;
-                        case HASHTABLE_POINTER:
-                        case HASHTABLE_BUFFER:
-                            snprintf (str_value, sizeof (str_value),
-                                      "0x%lx", (long unsigned int)ptr_value);
-                            value = strdup (str_value);
-                            break;
-                        case HASHTABLE_TIME:
-                            snprintf (str_value, sizeof (str_value),
-                                      "%ld", (long)(*((time_t *)ptr_value)));
-                            value = strdup (str_value);
-                            break;
-                        case HASHTABLE_NUM_TYPES:
-                            break;
-                    }
+                    new_var->hdata_list = string_strndup (
+                        pos_list + 1, pos_list_end - pos_list - 1);
+                }
+                tmp = string_strndup (new_var->hdata_name,
+                                      pos_list - new_var->hdata_name);
+                if (tmp)
+                {
+                    free (new_var->hdata_name);
+                    new_var->hdata_name = tmp;
                 }
             }
-            else
-            {
+        }
+        eval_var_split_path (new_var, (pos) ? pos + 1 : NULL);
+    }
+
+    return new_var;
+}
+
+/*
+ * Frees a variable.
+ */
+
+void
+eval_var_free (struct t_eval_var *var)
+{
+    int i;
+
+    if (!var)
+        return;
+
+    if (var->text)
+        free (var->text);
+    if (var->value)
+        free (var->value);
+    if (var->name)
+        free (var->name);
+    if (var->arguments)
+        free (var->arguments);
+    if (var->option_file)
+        free (var->option_file);
+    if (var->option_section)
+        free (var->option_section);
+    if (var->option_name)
+        free (var->option_name);
+    if (var->hdata_name)
+        free (var->hdata_name);
+    if (var->hdata_list)
+        free (var->hdata_list);
+    if (var->path_vars)
+    {
+        for (i = 0; i < var->num_path; i++)
+        {
+            if (var->path_vars[i].name)
+                free (var->path_vars[i].name);
+        }
+        free (var->path_vars);
+    }
+    if (var->path)
+        free (var->path);
+
+    free (var);
+}
+
+/*
+ * Gets value of hdata using the path of a variable (starting at element
+ * "index" of path).
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+eval_hdata_get_value (struct t_hdata *hdata, void *pointer,
+                      struct t_eval_var *var, int index)
+{
+    char *value, str_value[128];
+    const char *ptr_value, *hdata_name, *var_name, *key;
+    int type;
+    struct t_hashtable *hashtable;
+
+    while (1)
+    {
+        /* NULL pointer? return empty string */
+        if (!pointer)
+            return strdup ("");
+
+        /* no path? just return current pointer as string */
+        if ((index >= var->num_path) || !var->path_vars[index].name)
+        {
+            snprintf (str_value, sizeof (str_value),
+                      "0x%lx", (long unsigned int)pointer);
+            return strdup (str_value);
+        }
+
+        var_name = var->path_vars[index].name;
+        key = var->path_vars[index].key;
+
+        /* search type of variable in hdata */
+        type = hdata_get_var_type (hdata, var_name);
+        if (type < 0)
+            return NULL;
+
+        value = NULL;
+
+        /* build a string with the value or variable */
+        switch (type)
+        {
+            case WEECHAT_HDATA_CHAR:
+                snprintf (str_value, sizeof (str_value),
+                          "%c", hdata_char (hdata, pointer, var_name));
+                value = strdup (str_value);
+                break;
+            case WEECHAT_HDATA_INTEGER:
+                snprintf (str_value, sizeof (str_value),
+                          "%d", hdata_integer (hdata, pointer, var_name));
+                value = strdup (str_value);
+                break;
+            case WEECHAT_HDATA_LONG:
+                snprintf (str_value, sizeof (str_value),
+                          "%ld", hdata_long (hdata, pointer, var_name));
+                value = strdup (str_value);
+                break;
+            case WEECHAT_HDATA_STRING:
+            case WEECHAT_HDATA_SHARED_STRING:
+                ptr_value = hdata_string (hdata, pointer, var_name);
+                value = (ptr_value) ? strdup (ptr_value) : NULL;
+                break;
+            case WEECHAT_HDATA_POINTER:
+                pointer = hdata_pointer (hdata, pointer, var_name);
                 snprintf (str_value, sizeof (str_value),
                           "0x%lx", (long unsigned int)pointer);
                 value = strdup (str_value);
-            }
-            break;
-    }
+                break;
+            case WEECHAT_HDATA_TIME:
+                snprintf (str_value, sizeof (str_value),
+                          "%ld", (long)hdata_time (hdata, pointer, var_name));
+                value = strdup (str_value);
+                break;
+            case WEECHAT_HDATA_HASHTABLE:
+                pointer = hdata_hashtable (hdata, pointer, var_name);
+                if (key)
+                {
+                    /*
+                     * for a hashtable, if there is a "." after name of hdata,
+                     * get the value for this key in hashtable
+                     */
+                    hashtable = pointer;
+                    ptr_value = hashtable_get (hashtable, key);
+                    if (ptr_value)
+                    {
+                        switch (hashtable->type_values)
+                        {
+                            case HASHTABLE_INTEGER:
+                                snprintf (str_value, sizeof (str_value),
+                                          "%d", *((int *)ptr_value));
+                                value = strdup (str_value);
+                                break;
+                            case HASHTABLE_STRING:
+                                value = strdup (ptr_value);
+                                break;
+                            case HASHTABLE_POINTER:
+                            case HASHTABLE_BUFFER:
+                                snprintf (str_value, sizeof (str_value),
+                                          "0x%lx",
+                                          (long unsigned int)ptr_value);
+                                value = strdup (str_value);
+                                break;
+                            case HASHTABLE_TIME:
+                                snprintf (str_value, sizeof (str_value),
+                                          "%ld",
+                                          (long)(*((time_t *)ptr_value)));
+                                value = strdup (str_value);
+                                break;
+                            case HASHTABLE_NUM_TYPES:
+                                break;
+                        }
+                    }
+                }
+                else
+                {
+                    snprintf (str_value, sizeof (str_value),
+                              "0x%lx", (long unsigned int)pointer);
+                    value = strdup (str_value);
+                }
+                break;
+        }
+
+        /*
+         * if we are on a pointer and that something else is in path (after
+         * "."), go on with this pointer and remaining path
+         */
+        if ((type != WEECHAT_HDATA_POINTER) || !key)
+            return value;
 
-    /*
-     * if we are on a pointer and that something else is in path (after "."),
-     * go on with this pointer and remaining path
-     */
-    if ((type == WEECHAT_HDATA_POINTER) && pos)
-    {
         hdata_name = hdata_get_var_hdata (hdata, var_name);
         if (!hdata_name)
-            goto end;
+            return value;
 
         hdata = hook_hdata_get (NULL, hdata_name);
-        old_value = value;
-        value = eval_hdata_get_value (hdata, pointer, (pos) ? pos + 1 : NULL);
-        if (old_value)
-            free (old_value);
+        if (value)
+            free (value);
+        index++;
     }
-
-end:
-    if (var_name)
-        free (var_name);
-
-    return value;
 }
 
 /*
- * Replaces variables, which can be, by order of priority:
+ * Gets value of a variable, which can be, by order of priority:
  *   1. an extra variable (from hashtable "extra_vars")
- *   2. a color (format: color:xxx)
- *   3. an option (format: file.section.option)
- *   4. a buffer local variable
- *   5. a hdata name/variable
+ *   2. a string with escaped chars (format: esc:xxx or \xxx)
+ *   3. a color (format: color:xxx)
+ *   4. an info (format: info:name,arguments)
+ *   5. a secured data (format: sec.data.xxx)
+ *   6. an option (format: file.section.option)
+ *   7. a buffer local variable
+ *   8. a hdata name/variable
  *
  * Examples:
  *   option: ${weechat.look.scroll_amount}
  *   hdata : ${window.buffer.full_name}
  *           ${window.buffer.local_variables.type}
+ *
+ * Note: result must be freed after use.
  */
 
 char *
-eval_replace_vars_cb (void *data, const char *text)
+eval_var_get_value (struct t_eval_var *var, struct t_hashtable *pointers,
+                    struct t_hashtable *extra_vars)
 {
-    struct t_hashtable *pointers, *extra_vars;
+    struct t_config_file *ptr_config;
+    struct t_config_section *ptr_section;
     struct t_config_option *ptr_option;
     struct t_gui_buffer *ptr_buffer;
-    char str_value[64], *value, *pos, *pos1, *pos2, *hdata_name, *list_name;
-    char *tmp, *info_name;
-    const char *ptr_value, *ptr_arguments;
+    char str_value[64], *value;
+    const char *ptr_value;
     struct t_hdata *hdata;
     void *pointer;
 
-    pointers = (struct t_hashtable *)(((void **)data)[0]);
-    extra_vars = (struct t_hashtable *)(((void **)data)[1]);
-
     /* 1. look for var in hashtable "extra_vars" */
-    if (extra_vars)
+    if (extra_vars && var->text)
     {
-        ptr_value = hashtable_get (extra_vars, text);
+        ptr_value = hashtable_get (extra_vars, var->text);
         if (ptr_value)
             return strdup (ptr_value);
     }
 
-    /* 2. convert escaped chars */
-    if (strncmp (text, "esc:", 4) == 0)
-        return string_convert_escaped_chars (text + 4);
-    if ((text[0] == '\\') && text[1] && (text[1] != '\\'))
-        return string_convert_escaped_chars (text);
-
-    /* 3. look for a color */
-    if (strncmp (text, "color:", 6) == 0)
+    switch (var->type)
     {
-        ptr_value = gui_color_get_custom (text + 6);
-        return strdup ((ptr_value) ? ptr_value : "");
+        case EVAL_VAR_STRING:
+            /* 2. escaped chars (converted when variable was created) */
+            return strdup ((var->value) ? var->value : "");
+        case EVAL_VAR_COLOR:
+            /* 3. color */
+            ptr_value = (var->name) ? gui_color_get_custom (var->name) : NULL;
+            return strdup ((ptr_value) ? ptr_value : "");
+        case EVAL_VAR_INFO:
+            /* 4. info */
+            ptr_value = (var->name) ?
+                hook_info_get (NULL, var->name, var->arguments) : NULL;
+            return strdup ((ptr_value) ? ptr_value : "");
+        case EVAL_VAR_SECURE_DATA:
+            /* 5. secured data */
+            ptr_value = (var->name) ?
+                hashtable_get (secure_hashtable_data, var->name) : NULL;
+            return strdup ((ptr_value) ? ptr_value : "");
+        case EVAL_VAR_OTHER:
+        case EVAL_NUM_VAR_TYPES:
+            break;
     }
 
-    /* 4. look for an info */
-    if (strncmp (text, "info:", 5) == 0)
+    /* 6. look for name of option: if found, return this value */
+    if (var->option_file && var->option_section && var->option_name)
     {
-        ptr_value = NULL;
-        ptr_arguments = strchr (text + 5, ',');
-        if (ptr_arguments)
+        ptr_option = NULL;
+        ptr_config = config_file_search (var->option_file);
+        if (ptr_config)
         {
-            info_name = string_strndup (text + 5, ptr_arguments - text - 5);
-            ptr_arguments++;
-        }
-        else
-            info_name = strdup (text + 5);
-        if (info_name)
-        {
-            ptr_value = hook_info_get (NULL, info_name, ptr_arguments);
-            free (info_name);
+            ptr_section = config_file_search_section (ptr_config,
+                                                      var->option_section);
+            if (ptr_section)
+            {
+                ptr_option = config_file_search_option (ptr_config,
+                                                        ptr_section,
+                                                        var->option_name);
+            }
         }
-        return strdup ((ptr_value) ? ptr_value : "");
-    }
-
-    /* 5. look for name of option: if found, return this value */
-    if (strncmp (text, "sec.data.", 9) == 0)
-    {
-        ptr_value = hashtable_get (secure_hashtable_data, text + 9);
-        return strdup ((ptr_value) ? ptr_value : "");
-    }
-    else
-    {
-        config_file_search_with_string (text, NULL, NULL, &ptr_option, NULL);
         if (ptr_option)
         {
             if (!ptr_option->value)
@@ -320,93 +538,34 @@ eval_replace_vars_cb (void *data, const char *text)
         }
     }
 
-    /* 6. look for local variable in buffer */
+    /* 7. look for local variable in buffer */
     ptr_buffer = hashtable_get (pointers, "buffer");
-    if (ptr_buffer)
+    if (ptr_buffer && var->text)
     {
-        ptr_value = hashtable_get (ptr_buffer->local_variables, text);
+        ptr_value = hashtable_get (ptr_buffer->local_variables, var->text);
         if (ptr_value)
             return strdup (ptr_value);
     }
 
-    /* 7. look for hdata */
+    /* 8. look for hdata */
     value = NULL;
-    hdata_name = NULL;
-    list_name = NULL;
-    pointer = NULL;
-
-    pos = strchr (text, '.');
-    if (pos > text)
-        hdata_name = string_strndup (text, pos - text);
-    else
-        hdata_name = strdup (text);
-
-    if (!hdata_name)
-        goto end;
-
-    pos1 = strchr (hdata_name, '[');
-    if (pos1 > hdata_name)
+    if (var->hdata_name)
     {
-        pos2 = strchr (pos1 + 1, ']');
-        if (pos2 > pos1 + 1)
+        hdata = hook_hdata_get (NULL, var->hdata_name);
+        if (hdata)
         {
-            list_name = string_strndup (pos1 + 1, pos2 - pos1 - 1);
+            pointer = (var->hdata_list) ?
+                hdata_get_list (hdata, var->hdata_list) : NULL;
+            if (!pointer)
+                pointer = hashtable_get (pointers, var->hdata_name);
+            if (pointer)
+                value = eval_hdata_get_value (hdata, pointer, var, 0);
         }
-        tmp = string_strndup (hdata_name, pos1 - hdata_name);
-        if (tmp)
-        {
-            free (hdata_name);
-            hdata_name = tmp;
-        }
-    }
-
-    hdata = hook_hdata_get (NULL, hdata_name);
-    if (!hdata)
-        goto end;
-
-    if (list_name)
-        pointer = hdata_get_list (hdata, list_name);
-    if (!pointer)
-    {
-        pointer = hashtable_get (pointers, hdata_name);
-        if (!pointer)
-            goto end;
     }
 
-    value = eval_hdata_get_value (hdata, pointer, (pos) ? pos + 1 : NULL);
-
-end:
-    if (hdata_name)
-        free (hdata_name);
-    if (list_name)
-        free (list_name);
-
     return (value) ? value : strdup ("");
 }
 
-/*
- * Replaces variables in a string.
- *
- * Note: result must be freed after use.
- */
-
-char *
-eval_replace_vars (const char *expr, struct t_hashtable *pointers,
-                   struct t_hashtable *extra_vars,
-                   const char *prefix, const char *suffix)
-{
-    int errors;
-    void *ptr[2];
-
-    ptr[0] = pointers;
-    ptr[1] = extra_vars;
-
-    return string_replace_with_callback (expr, prefix, suffix,
-                                         &eval_replace_vars_cb,
-                                         ptr,
-                                         &errors);
-}
-
 /*
  * Compares two expressions.
  *
@@ -555,109 +714,394 @@ eval_strstr_level (const char *string, const char *search)
 }
 
 /*
- * Evaluates a condition (this function must not be called directly).
- *
- * For return value, see function eval_expression().
+ * Creates a new node in a compiled expression.
  *
- * Note: result must be freed after use (if not NULL).
+ * Returns pointer to new node, NULL if error.
  */
 
-char *
-eval_expression_condition (const char *expr,
-                           struct t_hashtable *pointers,
-                           struct t_hashtable *extra_vars,
-                           const char *prefix,
-                           const char *suffix)
+struct t_eval_node *
+eval_node_new (enum t_eval_node_type type)
 {
-    int logic, comp, length, level, rc;
-    const char *pos, *pos_end;
-    char *expr2, *sub_expr, *value, *tmp_value, *tmp_value2;
+    struct t_eval_node *new_node;
 
-    value = NULL;
-
-    if (!expr)
+    new_node = malloc (sizeof (*new_node));
+    if (!new_node)
         return NULL;
 
-    if (!expr[0])
-        return strdup (expr);
+    new_node->type = type;
+    new_node->op = 0;
+    new_node->value = NULL;
+    new_node->num_parts = 0;
+    new_node->parts = NULL;
+    new_node->left = NULL;
+    new_node->right = NULL;
+    new_node->regex_constant = 0;
+    new_node->regex = NULL;
+
+    return new_node;
+}
 
-    /* skip spaces at beginning of string */
-    while (expr[0] == ' ')
+/*
+ * Frees a node (and its sub-nodes) in a compiled expression.
+ */
+
+void
+eval_node_free (struct t_eval_node *node)
+{
+    int i;
+
+    if (!node)
+        return;
+
+    if (node->value)
+        free (node->value);
+    if (node->parts)
     {
-        expr++;
+        for (i = 0; i < node->num_parts; i++)
+        {
+            if (node->parts[i].string)
+                free (node->parts[i].string);
+            eval_var_free (node->parts[i].var);
+            eval_node_free (node->parts[i].var_name);
+        }
+        free (node->parts);
     }
-    if (!expr[0])
-        return strdup (expr);
-
-    /* skip spaces at end of string */
-    pos_end = expr + strlen (expr) - 1;
-    while ((pos_end > expr) && (pos_end[0] == ' '))
+    eval_node_free (node->left);
+    eval_node_free (node->right);
+    if (node->regex)
     {
-        pos_end--;
+        regfree (node->regex);
+        free (node->regex);
     }
 
-    expr2 = string_strndup (expr, pos_end + 1 - expr);
-    if (!expr2)
+    free (node);
+}
+
+/*
+ * Adds a part (string or variable) in a node of type "text".
+ *
+ * Returns pointer to new part, NULL if error.
+ */
+
+struct t_eval_text_part *
+eval_node_add_part (struct t_eval_node *node)
+{
+    struct t_eval_text_part *new_parts;
+
+    new_parts = realloc (node->parts,
+                         (node->num_parts + 1) * sizeof (node->parts[0]));
+    if (!new_parts)
         return NULL;
 
-    /*
-     * search for a logical operator, and if one is found:
-     * - split expression into two sub-expressions
-     * - evaluate first sub-expression
-     * - if needed, evaluate second sub-expression
-     * - return result
-     */
-    for (logic = 0; logic < EVAL_NUM_LOGICAL_OPS; logic++)
+    node->parts = new_parts;
+    node->parts[node->num_parts].string = NULL;
+    node->parts[node->num_parts].var = NULL;
+    node->parts[node->num_parts].var_name = NULL;
+    node->num_parts++;
+
+    return &(node->parts[node->num_parts - 1]);
+}
+
+/*
+ * Compiles a text with variables: the text is split into strings and
+ * variables, like function string_replace_with_callback() does when it
+ * replaces variables.
+ *
+ * Returns pointer to node of type "text", NULL if error.
+ */
+
+struct t_eval_node *
+eval_compile_text (const char *string, const char *prefix, const char *suffix)
+{
+    struct t_eval_node *node;
+    struct t_eval_text_part *part;
+    int length_prefix, length_suffix, index_string, index_result;
+    int sub_count, sub_level;
+    char *result, *key;
+    const char *pos_end_name;
+
+    if (!string || !prefix || !prefix[0] || !suffix || !suffix[0])
+        return NULL;
+
+    node = eval_node_new (EVAL_NODE_TEXT);
+    if (!node)
+        return NULL;
+
+    result = malloc (strlen (string) + 1);
+    if (!result)
     {
-        pos = eval_strstr_level (expr2, logical_ops[logic]);
-        if (pos > expr2)
+        eval_node_free (node);
+        return NULL;
+    }
+
+    length_prefix = strlen (prefix);
+    length_suffix = strlen (suffix);
+
+    index_string = 0;
+    index_result = 0;
+    while (string[index_string])
+    {
+        if ((string[index_string] == '\\')
+            && (string[index_string + 1] == prefix[0]))
         {
-            pos_end = pos - 1;
-            while ((pos_end > expr2) && (pos_end[0] == ' '))
+            index_string++;
+            result[index_result++] = string[index_string++];
+        }
+        else if (strncmp (string + index_string, prefix, length_prefix) == 0)
+        {
+            sub_count = 0;
+            sub_level = 0;
+            pos_end_name = string + index_string + length_prefix;
+            while (pos_end_name[0])
             {
-                pos_end--;
+                if (strncmp (pos_end_name, suffix, length_suffix) == 0)
+                {
+                    if (sub_level == 0)
+                        break;
+                    sub_level--;
+                }
+                if ((pos_end_name[0] == '\\')
+                    && (pos_end_name[1] == prefix[0]))
+                {
+                    pos_end_name++;
+                }
+                else if (strncmp (pos_end_name, prefix, length_prefix) == 0)
+                {
+                    sub_count++;
+                    sub_level++;
+                }
+                pos_end_name++;
             }
-            sub_expr = string_strndup (expr2, pos_end + 1 - expr2);
-            if (!sub_expr)
-                goto end;
-            tmp_value = eval_expression_condition (sub_expr, pointers,
-                                                   extra_vars,
-                                                   prefix, suffix);
-            free (sub_expr);
-            rc = eval_is_true (tmp_value);
-            if (tmp_value)
-                free (tmp_value);
-            /*
-             * if rc == 0 with "&&" or rc == 1 with "||", no need to
-             * evaluate second sub-expression, just return the rc
-             */
-            if ((!rc && (logic == EVAL_LOGICAL_OP_AND))
-                || (rc && (logic == EVAL_LOGICAL_OP_OR)))
+            /* prefix without matching suffix: text is truncated here */
+            if (!pos_end_name[0])
+                break;
+            key = string_strndup (string + index_string + length_prefix,
+                                  pos_end_name - (string + index_string + length_prefix));
+            if (!key)
             {
-                value = strdup ((rc) ? EVAL_STR_TRUE : EVAL_STR_FALSE);
-                goto end;
+                result[index_result++] = string[index_string++];
+                continue;
             }
-            pos += strlen (logical_ops[logic]);
-            while (pos[0] == ' ')
+            /* add string before the variable */
+            if (index_result > 0)
             {
-                pos++;
+                part = eval_node_add_part (node);
+                result[index_result] = '\0';
+                if (part)
+                    part->string = strdup (result);
+                index_result = 0;
             }
-            tmp_value = eval_expression_condition (pos, pointers, extra_vars,
-                                                   prefix, suffix);
-            rc = eval_is_true (tmp_value);
-            if (tmp_value)
-                free (tmp_value);
-            value = strdup ((rc) ? EVAL_STR_TRUE : EVAL_STR_FALSE);
+            /* add the variable */
+            part = eval_node_add_part (node);
+            if (part)
+            {
+                if (sub_count > 0)
+                {
+                    part->var_name = eval_compile_text (key, prefix,
+                                                        suffix);
+                }
+                else
+                    part->var = eval_var_new (key);
+            }
+            free (key);
+            index_string = pos_end_name - string + length_suffix;
+        }
+        else
+            result[index_result++] = string[index_string++];
+    }
+
+    /* add string at the end */
+    if (index_result > 0)
+    {
+        result[index_result] = '\0';
+        part = eval_node_add_part (node);
+        if (part)
+            part->string = strdup (result);
+    }
+
+    free (result);
+
+    return node;
+}
+
+/*
+ * Checks if a node is a constant text (without variables).
+ *
+ * Returns:
+ *   1: node is a constant text
+ *   0: node has variables (or is not a text)
+ */
+
+int
+eval_node_is_constant_text (struct t_eval_node *node)
+{
+    int i;
+
+    if (!node || (node->type != EVAL_NODE_TEXT))
+        return 0;
+
+    for (i = 0; i < node->num_parts; i++)
+    {
+        if (!node->parts[i].string)
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Compiles sub-expressions between parentheses at beginning of a condition
+ * (which has no logical operator neither comparison).
+ *
+ * If there is something after the closing parenthesis, the value of
+ * sub-expression is concatenated to this text when the expression is
+ * evaluated, and the result is evaluated again (it can start with another
+ * parenthesis).
+ *
+ * Returns pointer to node, NULL if error.
+ */
+
+struct t_eval_node *
+eval_compile_parentheses (const char *expr, const char *prefix,
+                          const char *suffix)
+{
+    struct t_eval_node *node, *sub_node;
+    const char *pos;
+    char *sub_expr;
+    int level;
+
+    if (expr[0] != '(')
+        return eval_compile_text (expr, prefix, suffix);
+
+    level = 0;
+    pos = expr + 1;
+    while (pos[0])
+    {
+        if (pos[0] == '(')
+            level++;
+        else if (pos[0] == ')')
+        {
+            if (level == 0)
+                break;
+            level--;
+        }
+        pos++;
+    }
+
+    /* closing parenthesis not found: the value is NULL */
+    if (pos[0] != ')')
+        return eval_node_new (EVAL_NODE_VALUE);
+
+    sub_expr = string_strndup (expr + 1, pos - expr - 1);
+    if (!sub_expr)
+        return NULL;
+    sub_node = eval_compile_condition (sub_expr, prefix, suffix);
+    free (sub_expr);
+
+    /*
+     * nothing around parentheses, then return value of sub-expression as-is
+     */
+    if (!pos[1])
+        return sub_node;
+
+    node = eval_node_new (EVAL_NODE_PARENTHESES);
+    if (!node)
+    {
+        eval_node_free (sub_node);
+        return NULL;
+    }
+    node->left = sub_node;
+    node->value = strdup (pos + 1);
+
+    return node;
+}
+
+/*
+ * Compiles a condition.
+ *
+ * The condition is split like function eval_expression() did before
+ * compiled expressions: first with logical operators, then with comparisons,
+ * then parentheses; the remaining text has only variables to replace.
+ *
+ * Returns pointer to node, NULL if error.
+ */
+
+struct t_eval_node *
+eval_compile_condition (const char *expr, const char *prefix,
+                        const char *suffix)
+{
+    struct t_eval_node *node;
+    int logic, comp;
+    const char *pos, *pos_end;
+    char *expr2, *sub_expr;
+
+    if (!expr)
+        return eval_node_new (EVAL_NODE_VALUE);
+
+    /* skip spaces at beginning of string */
+    while (expr[0] == ' ')
+    {
+        expr++;
+    }
+    if (!expr[0])
+    {
+        node = eval_node_new (EVAL_NODE_VALUE);
+        if (node)
+            node->value = strdup (expr);
+        return node;
+    }
+
+    /* skip spaces at end of string */
+    pos_end = expr + strlen (expr) - 1;
+    while ((pos_end > expr) && (pos_end[0] == ' '))
+    {
+        pos_end--;
+    }
+
+    expr2 = string_strndup (expr, pos_end + 1 - expr);
+    if (!expr2)
+        return NULL;
+
+    node = NULL;
+
+    /*
+     * search for a logical operator, and if one is found, split expression
+     * into two sub-expressions
+     */
+    for (logic = 0; logic < EVAL_NUM_LOGICAL_OPS; logic++)
+    {
+        pos = eval_strstr_level (expr2, logical_ops[logic]);
+        if (pos > expr2)
+        {
+            pos_end = pos - 1;
+            while ((pos_end > expr2) && (pos_end[0] == ' '))
+            {
+                pos_end--;
+            }
+            sub_expr = string_strndup (expr2, pos_end + 1 - expr2);
+            if (!sub_expr)
+                goto end;
+            node = eval_node_new (EVAL_NODE_LOGICAL);
+            if (node)
+            {
+                node->op = logic;
+                node->left = eval_compile_condition (sub_expr, prefix,
+                                                     suffix);
+                pos += strlen (logical_ops[logic]);
+                while (pos[0] == ' ')
+                {
+                    pos++;
+                }
+                node->right = eval_compile_condition (pos, prefix, suffix);
+            }
+            free (sub_expr);
             goto end;
         }
     }
 
     /*
-     * search for a comparison, and if one is found:
-     * - split expression into two sub-expressions
-     * - evaluate the two sub-expressions
-     * - compare sub-expressions
-     * - return result
+     * search for a comparison, and if one is found, split expression into
+     * two sub-expressions
      */
     for (comp = 0; comp < EVAL_NUM_COMPARISONS; comp++)
     {
@@ -677,166 +1121,327 @@ eval_expression_condition (const char *expr,
             {
                 pos++;
             }
-            if ((comp == EVAL_COMPARE_REGEX_MATCHING)
-                || (comp == EVAL_COMPARE_REGEX_NOT_MATCHING))
+            node = eval_node_new (EVAL_NODE_COMPARE);
+            if (node)
             {
-                /* for regex: just replace vars in both expressions */
-                tmp_value = eval_replace_vars (sub_expr, pointers,
-                                               extra_vars,
-                                               prefix, suffix);
-                tmp_value2 = eval_replace_vars (pos, pointers,
-                                                extra_vars,
-                                                prefix, suffix);
-            }
-            else
-            {
-                /* other comparison: fully evaluate both expressions */
-                tmp_value = eval_expression_condition (sub_expr, pointers,
-                                                       extra_vars,
-                                                       prefix, suffix);
-                tmp_value2 = eval_expression_condition (pos, pointers,
-                                                        extra_vars,
-                                                        prefix, suffix);
+                node->op = comp;
+                if ((comp == EVAL_COMPARE_REGEX_MATCHING)
+                    || (comp == EVAL_COMPARE_REGEX_NOT_MATCHING))
+                {
+                    /* for regex: just replace vars in both expressions */
+                    node->left = eval_compile_text (sub_expr, prefix, suffix);
+                    node->right = eval_compile_text (pos, prefix, suffix);
+                    if (eval_node_is_constant_text (node->right))
+                    {
+                        /* regex without variables: compile it now */
+                        node->regex_constant = 1;
+                        node->regex = malloc (sizeof (*node->regex));
+                        if (node->regex
+                            && (string_regcomp (node->regex,
+                                                (node->right->num_parts > 0) ?
+                                                node->right->parts[0].string : "",
+                                                REG_EXTENDED | REG_ICASE | REG_NOSUB) != 0))
+                        {
+                            free (node->regex);
+                            node->regex = NULL;
+                        }
+                    }
+                }
+                else
+                {
+                    /* other comparison: fully evaluate both expressions */
+                    node->left = eval_compile_condition (sub_expr, prefix,
+                                                         suffix);
+                    node->right = eval_compile_condition (pos, prefix,
+                                                          suffix);
+                }
             }
             free (sub_expr);
-            value = eval_compare (tmp_value, comp, tmp_value2);
-            if (tmp_value)
-                free (tmp_value);
-            if (tmp_value2)
-                free (tmp_value2);
             goto end;
         }
     }
 
     /*
-     * evaluate sub-expressions between parentheses and replace them with their
-     * value
+     * evaluate sub-expressions between parentheses and replace variables in
+     * the result
      */
-    while (expr2[0] == '(')
+    node = eval_compile_parentheses (expr2, prefix, suffix);
+
+end:
+    free (expr2);
+
+    return node;
+}
+
+/*
+ * Evaluates a node of a compiled expression.
+ *
+ * Note: result must be freed after use (if not NULL).
+ */
+
+char *
+eval_node_exec (struct t_eval_node *node, struct t_eval_compiled *compiled,
+                struct t_hashtable *pointers, struct t_hashtable *extra_vars)
+{
+    struct t_eval_node *node2;
+    struct t_eval_var *var;
+    char *value, *value2, *result, *result2;
+    const char *ptr_value;
+    int i, rc, length, length_value;
+
+    if (!node)
+        return NULL;
+
+    value = NULL;
+
+    switch (node->type)
     {
-        level = 0;
-        pos = expr2 + 1;
-        while (pos[0])
-        {
-            if (pos[0] == '(')
-                level++;
-            else if (pos[0] == ')')
+        case EVAL_NODE_VALUE:
+            value = (node->value) ? strdup (node->value) : NULL;
+            break;
+        case EVAL_NODE_TEXT:
+            if (node->num_parts == 0)
+                return strdup ("");
+            if ((node->num_parts == 1) && node->parts[0].string)
+                return strdup (node->parts[0].string);
+            result = NULL;
+            length = 1;
+            for (i = 0; i < node->num_parts; i++)
             {
-                if (level == 0)
-                    break;
-                level--;
+                value = NULL;
+                ptr_value = node->parts[i].string;
+                if (node->parts[i].var)
+                {
+                    value = eval_var_get_value (node->parts[i].var,
+                                                pointers, extra_vars);
+                    ptr_value = value;
+                }
+                else if (node->parts[i].var_name)
+                {
+                    /* name of variable has variables: evaluate it first */
+                    value2 = eval_node_exec (node->parts[i].var_name,
+                                             compiled, pointers, extra_vars);
+                    var = eval_var_new ((value2) ? value2 : "");
+                    if (var)
+                    {
+                        value = eval_var_get_value (var, pointers,
+                                                    extra_vars);
+                        eval_var_free (var);
+                    }
+                    if (value2)
+                        free (value2);
+                    ptr_value = value;
+                }
+                length_value = (ptr_value) ? strlen (ptr_value) : 0;
+                result2 = realloc (result, length + length_value);
+                if (!result2)
+                {
+                    if (result)
+                        free (result);
+                    if (value)
+                        free (value);
+                    return NULL;
+                }
+                if (!result)
+                    result2[0] = '\0';
+                result = result2;
+                if (length_value > 0)
+                    memcpy (result + length - 1, ptr_value, length_value + 1);
+                length += length_value;
+                if (value)
+                    free (value);
             }
-            pos++;
-        }
-        /* closing parenthesis not found */
-        if (pos[0] != ')')
-            goto end;
-        sub_expr = string_strndup (expr2 + 1, pos - expr2 - 1);
-        if (!sub_expr)
-            goto end;
-        tmp_value = eval_expression_condition (sub_expr, pointers, extra_vars,
-                                               prefix, suffix);
-        free (sub_expr);
-        if (!pos[1])
-        {
+            value = result;
+            break;
+        case EVAL_NODE_LOGICAL:
+            value = eval_node_exec (node->left, compiled, pointers,
+                                    extra_vars);
+            rc = eval_is_true (value);
+            if (value)
+                free (value);
             /*
-             * nothing around parentheses, then return value of
-             * sub-expression as-is
+             * if rc == 0 with "&&" or rc == 1 with "||", no need to
+             * evaluate second sub-expression, just return the rc
              */
-            value = tmp_value;
-            goto end;
-        }
-        length = ((tmp_value) ? strlen (tmp_value) : 0) + 1 +
-            strlen (pos + 1) + 1;
-        tmp_value2 = malloc (length);
-        if (!tmp_value2)
-        {
-            if (tmp_value)
-                free (tmp_value);
-            goto end;
-        }
-        tmp_value2[0] = '\0';
-        if (tmp_value)
-            strcat (tmp_value2, tmp_value);
-        strcat (tmp_value2, " ");
-        strcat (tmp_value2, pos + 1);
-        free (expr2);
-        expr2 = tmp_value2;
-        if (tmp_value)
-            free (tmp_value);
+            if ((rc && (node->op == EVAL_LOGICAL_OP_AND))
+                || (!rc && (node->op == EVAL_LOGICAL_OP_OR)))
+            {
+                value = eval_node_exec (node->right, compiled, pointers,
+                                        extra_vars);
+                rc = eval_is_true (value);
+                if (value)
+                    free (value);
+            }
+            value = strdup ((rc) ? EVAL_STR_TRUE : EVAL_STR_FALSE);
+            break;
+        case EVAL_NODE_COMPARE:
+            if (node->regex_constant)
+            {
+                /* regex already compiled (NULL if invalid) */
+                rc = 0;
+                if (node->regex)
+                {
+                    value = eval_node_exec (node->left, compiled, pointers,
+                                            extra_vars);
+                    if (value)
+                    {
+                        rc = (regexec (node->regex, value,
+                                       0, NULL, 0) == 0) ? 1 : 0;
+                        if (node->op == EVAL_COMPARE_REGEX_NOT_MATCHING)
+                            rc ^= 1;
+                        free (value);
+                    }
+                }
+                value = strdup ((rc) ? EVAL_STR_TRUE : EVAL_STR_FALSE);
+            }
+            else
+            {
+                value = eval_node_exec (node->left, compiled, pointers,
+                                        extra_vars);
+                value2 = eval_node_exec (node->right, compiled, pointers,
+                                         extra_vars);
+                result = eval_compare (value, node->op, value2);
+                if (value)
+                    free (value);
+                if (value2)
+                    free (value2);
+                value = result;
+            }
+            break;
+        case EVAL_NODE_PARENTHESES:
+            /*
+             * concatenate the value of sub-expression and the text after
+             * parentheses, then evaluate the result (it can not be compiled
+             * before, since it depends on the value of sub-expression)
+             */
+            value = eval_node_exec (node->left, compiled, pointers,
+                                    extra_vars);
+            length = ((value) ? strlen (value) : 0) + 1 +
+                strlen (node->value) + 1;
+            result = malloc (length);
+            if (result)
+            {
+                snprintf (result, length, "%s %s",
+                          (value) ? value : "", node->value);
+                node2 = eval_compile_parentheses (result, compiled->prefix,
+                                                  compiled->suffix);
+                free (result);
+                result = eval_node_exec (node2, compiled, pointers,
+                                         extra_vars);
+                eval_node_free (node2);
+            }
+            if (value)
+                free (value);
+            value = result;
+            break;
+        case EVAL_NUM_NODE_TYPES:
+            break;
     }
 
-    /*
-     * at this point, there is no more logical operator neither comparison,
-     * so we just replace variables in string and return the result
-     */
-    value = eval_replace_vars (expr2, pointers, extra_vars, prefix, suffix);
-
-end:
-    if (expr2)
-        free (expr2);
-
     return value;
 }
 
 /*
- * Evaluates an expression.
+ * Compiles an expression, so that it can be evaluated many times with
+ * function eval_exec(), without parsing it again.
  *
- * The hashtable "pointers" must have string for keys, pointer for values.
- * The hashtable "extra_vars" must have string for keys and values.
- * The hashtable "options" must have string for keys and values.
+ * The hashtable "options" must have string for keys and values (see function
+ * eval_expression() for supported options).
  *
- * Supported options:
- *   - prefix: change the default prefix before variables to replace ("${")
- *   - suffix: change the default suffix after variables to replace ('}")
- *   - type:
- *       - condition: evaluate as a condition (use operators/parentheses,
- *         return a boolean)
+ * Returns pointer to compiled expression, NULL if error.
  *
- * If the expression is a condition, it can contain:
- *   - conditions:  ==  != <  <=  >  >=
- *   - logical operators:  &&  ||
- *   - parentheses for priority
+ * Note: result must be freed after use with function eval_compiled_free().
+ */
+
+struct t_eval_compiled *
+eval_compile (const char *expr, struct t_hashtable *options)
+{
+    struct t_eval_compiled *new_compiled;
+    const char *ptr_value;
+
+    if (!expr)
+        return NULL;
+
+    new_compiled = malloc (sizeof (*new_compiled));
+    if (!new_compiled)
+        return NULL;
+
+    new_compiled->condition = 0;
+    new_compiled->prefix = NULL;
+    new_compiled->suffix = NULL;
+    new_compiled->root = NULL;
+
+    /* read options */
+    if (options)
+    {
+        /* check the type of evaluation */
+        ptr_value = hashtable_get (options, "type");
+        if (ptr_value && (strcmp (ptr_value, "condition") == 0))
+            new_compiled->condition = 1;
+
+        /* check for custom prefix */
+        ptr_value = hashtable_get (options, "prefix");
+        if (ptr_value && ptr_value[0])
+            new_compiled->prefix = strdup (ptr_value);
+
+        /* check for custom suffix */
+        ptr_value = hashtable_get (options, "suffix");
+        if (ptr_value && ptr_value[0])
+            new_compiled->suffix = strdup (ptr_value);
+    }
+    if (!new_compiled->prefix)
+        new_compiled->prefix = strdup ("${");
+    if (!new_compiled->suffix)
+        new_compiled->suffix = strdup ("}");
+
+    if (!new_compiled->prefix || !new_compiled->suffix)
+    {
+        eval_compiled_free (new_compiled);
+        return NULL;
+    }
+
+    /* compile expression */
+    if (new_compiled->condition)
+    {
+        /* evaluate as condition (return a boolean: "0" or "1") */
+        new_compiled->root = eval_compile_condition (expr,
+                                                     new_compiled->prefix,
+                                                     new_compiled->suffix);
+    }
+    else
+    {
+        /* only replace variables in expression */
+        new_compiled->root = eval_compile_text (expr,
+                                                new_compiled->prefix,
+                                                new_compiled->suffix);
+    }
+
+    return new_compiled;
+}
+
+/*
+ * Evaluates a compiled expression (see function eval_compile()).
  *
- * Examples of simple expression without condition (the [ ] are NOT part of
- * result):
- *   >> ${window.buffer.number}
- *   == [2]
- *   >> buffer:${window.buffer.full_name}
- *   == [buffer:irc.freenode.#weechat]
- *   >> ${window.win_width}
- *   == [112]
- *   >> ${window.win_height}
- *   == [40]
+ * The hashtable "pointers" must have string for keys, pointer for values.
+ * The hashtable "extra_vars" must have string for keys and values.
  *
- * Examples of conditions:
- *   >> ${window.buffer.full_name} == irc.freenode.#weechat
- *   == [1]
- *   >> ${window.buffer.full_name} == irc.freenode.#test
- *   == [0]
- *   >> ${window.win_width} >= 30 && ${window.win_height} >= 20
- *   == [1]
+ * For return value, see function eval_expression().
  *
  * Note: result must be freed after use (if not NULL).
  */
 
 char *
-eval_expression (const char *expr, struct t_hashtable *pointers,
-                 struct t_hashtable *extra_vars, struct t_hashtable *options)
+eval_exec (struct t_eval_compiled *compiled, struct t_hashtable *pointers,
+           struct t_hashtable *extra_vars)
 {
-    int condition, rc, pointers_allocated;
+    int rc, pointers_allocated;
     char *value;
-    const char *prefix, *suffix, *default_prefix = "${", *default_suffix = "}";
-    const char *ptr_value;
     struct t_gui_window *window;
 
-    if (!expr)
+    if (!compiled)
         return NULL;
 
-    condition = 0;
     pointers_allocated = 0;
-    prefix = default_prefix;
-    suffix = default_suffix;
 
     /* create hashtable pointers if it's NULL */
     if (!pointers)
@@ -867,44 +1472,164 @@ eval_expression (const char *expr, struct t_hashtable *pointers,
         }
     }
 
-    /* read options */
-    if (options)
-    {
-        /* check the type of evaluation */
-        ptr_value = hashtable_get (options, "type");
-        if (ptr_value && (strcmp (ptr_value, "condition") == 0))
-            condition = 1;
-
-        /* check for custom prefix */
-        ptr_value = hashtable_get (options, "prefix");
-        if (ptr_value && ptr_value[0])
-            prefix = ptr_value;
-
-        /* check for custom suffix */
-        ptr_value = hashtable_get (options, "suffix");
-        if (ptr_value && ptr_value[0])
-            suffix = ptr_value;
-    }
-
     /* evaluate expression */
-    if (condition)
+    value = eval_node_exec (compiled->root, compiled, pointers, extra_vars);
+    if (compiled->condition)
     {
-        /* evaluate as condition (return a boolean: "0" or "1") */
-        value = eval_expression_condition (expr, pointers, extra_vars,
-                                           prefix, suffix);
         rc = eval_is_true (value);
         if (value)
             free (value);
         value = strdup ((rc) ? EVAL_STR_TRUE : EVAL_STR_FALSE);
     }
-    else
-    {
-        /* only replace variables in expression */
-        value = eval_replace_vars (expr, pointers, extra_vars, prefix, suffix);
-    }
 
     if (pointers_allocated)
         hashtable_free (pointers);
 
     return value;
 }
+
+/*
+ * Adds names of variables used in a node (and its sub-nodes) as keys in
+ * hashtable "vars".
+ *
+ * Returns:
+ *   1: all variables have been added
+ *   0: some variables are known only at runtime (name of variable with
+ *      variables, like "${${x}}", or text after parentheses)
+ */
+
+int
+eval_node_get_vars (struct t_eval_node *node, struct t_hashtable *vars)
+{
+    int i, rc;
+
+    if (!node)
+        return 1;
+
+    rc = 1;
+
+    for (i = 0; i < node->num_parts; i++)
+    {
+        if (node->parts[i].var && node->parts[i].var->text)
+            hashtable_set (vars, node->parts[i].var->text, NULL);
+        else if (node->parts[i].var_name)
+        {
+            eval_node_get_vars (node->parts[i].var_name, vars);
+            rc = 0;
+        }
+    }
+
+    if (!eval_node_get_vars (node->left, vars))
+        rc = 0;
+    if (!eval_node_get_vars (node->right, vars))
+        rc = 0;
+
+    if (node->type == EVAL_NODE_PARENTHESES)
+        rc = 0;
+
+    return rc;
+}
+
+/*
+ * Adds names of variables used in a compiled expression as keys in hashtable
+ * "vars" (with NULL values), so that a caller can build only these variables
+ * in hashtable "extra_vars" before calling eval_exec().
+ *
+ * The hashtable "vars" must have string for keys.
+ *
+ * Returns:
+ *   1: all variables used in expression have been added
+ *   0: the list is incomplete: some variables are known only when the
+ *      expression is evaluated (all variables must then be built)
+ */
+
+int
+eval_compiled_get_vars (struct t_eval_compiled *compiled,
+                        struct t_hashtable *vars)
+{
+    if (!compiled || !vars)
+        return 0;
+
+    return eval_node_get_vars (compiled->root, vars);
+}
+
+/*
+ * Frees a compiled expression.
+ */
+
+void
+eval_compiled_free (struct t_eval_compiled *compiled)
+{
+    if (!compiled)
+        return;
+
+    if (compiled->prefix)
+        free (compiled->prefix);
+    if (compiled->suffix)
+        free (compiled->suffix);
+    eval_node_free (compiled->root);
+
+    free (compiled);
+}
+
+/*
+ * Evaluates an expression.
+ *
+ * The hashtable "pointers" must have string for keys, pointer for values.
+ * The hashtable "extra_vars" must have string for keys and values.
+ * The hashtable "options" must have string for keys and values.
+ *
+ * Supported options:
+ *   - prefix: change the default prefix before variables to replace ("${")
+ *   - suffix: change the default suffix after variables to replace ('}")
+ *   - type:
+ *       - condition: evaluate as a condition (use operators/parentheses,
+ *         return a boolean)
+ *
+ * If the expression is a condition, it can contain:
+ *   - conditions:  ==  != <  <=  >  >=
+ *   - logical operators:  &&  ||
+ *   - parentheses for priority
+ *
+ * Examples of simple expression without condition (the [ ] are NOT part of
+ * result):
+ *   >> ${window.buffer.number}
+ *   == [2]
+ *   >> buffer:${window.buffer.full_name}
+ *   == [buffer:irc.freenode.#weechat]
+ *   >> ${window.win_width}
+ *   == [112]
+ *   >> ${window.win_height}
+ *   == [40]
+ *
+ * Examples of conditions:
+ *   >> ${window.buffer.full_name} == irc.freenode.#weechat
+ *   == [1]
+ *   >> ${window.buffer.full_name} == irc.freenode.#test
+ *   == [0]
+ *   >> ${window.win_width} >= 30 && ${window.win_height} >= 20
+ *   == [1]
+ *
+ * If the same expression is evaluated many times, it is faster to compile it
+ * once with eval_compile() and then evaluate it with eval_exec().
+ *
+ * Note: result must be freed after use (if not NULL).
+ */
+
+char *
+eval_expression (const char *expr, struct t_hashtable *pointers,
+                 struct t_hashtable *extra_vars, struct t_hashtable *options)
+{
+    struct t_eval_compiled *compiled;
+    char *value;
+
+    compiled = eval_compile (expr, options);
+    if (!compiled)
+        return NULL;
+
+    value = eval_exec (compiled, pointers, extra_vars);
+
+    eval_compiled_free (compiled);
+
+    return value;
+}
@@ -20,6 +20,8 @@
 #ifndef WEECHAT_EVAL_H
 #define WEECHAT_EVAL_H 1
 
+#include <regex.h>
+
 #define EVAL_STR_FALSE "0"
 #define EVAL_STR_TRUE  "1"
 
@@ -47,7 +49,104 @@ enum t_eval_comparison
     EVAL_NUM_COMPARISONS,
 };
 
+enum t_eval_node_type
+{
+    EVAL_NODE_VALUE = 0,               /* constant value (can be NULL)      */
+    EVAL_NODE_TEXT,                    /* text with variables to replace    */
+    EVAL_NODE_LOGICAL,                 /* logical operator (2 nodes)        */
+    EVAL_NODE_COMPARE,                 /* comparison (2 nodes)              */
+    EVAL_NODE_PARENTHESES,             /* "(...) text": value of sub-       */
+                                       /* expression + " " + text, which   */
+                                       /* is evaluated again at runtime    */
+    /* number of node types */
+    EVAL_NUM_NODE_TYPES,
+};
+
+enum t_eval_var_type
+{
+    EVAL_VAR_STRING = 0,               /* constant string (escaped chars)   */
+    EVAL_VAR_COLOR,                    /* color (color:xxx)                 */
+    EVAL_VAR_INFO,                     /* info (info:name,arguments)        */
+    EVAL_VAR_SECURE_DATA,              /* secured data (sec.data.xxx)       */
+    EVAL_VAR_OTHER,                    /* option, local variable or hdata   */
+    /* number of variable types */
+    EVAL_NUM_VAR_TYPES,
+};
+
+/* element of a path in hdata (for example "buffer" in "window.buffer.name") */
+
+struct t_eval_hdata_path
+{
+    char *name;                        /* name of variable in hdata (NULL   */
+                                       /* to return pointer as string)      */
+    const char *key;                   /* rest of path after name (key for  */
+                                       /* a hashtable), NULL if none        */
+};
+
+/* variable (text between prefix and suffix), split when compiled */
+
+struct t_eval_var
+{
+    enum t_eval_var_type type;         /* type of variable                  */
+    char *text;                        /* full text (key for extra vars)    */
+    char *value;                       /* value (for type "string")         */
+    char *name;                        /* name of color/info/secured data   */
+    char *arguments;                   /* arguments for info                */
+    char *option_file;                 /* option: file name                 */
+    char *option_section;              /* option: section name              */
+    char *option_name;                 /* option: option name               */
+    char *hdata_name;                  /* name of hdata                     */
+    char *hdata_list;                  /* name of list in hdata             */
+    char *path;                        /* path in hdata (after hdata name)  */
+    int num_path;                      /* number of elements in path        */
+    struct t_eval_hdata_path *path_vars; /* elements of path                */
+};
+
+/* part of a text: a string or a variable */
+
+struct t_eval_text_part
+{
+    char *string;                      /* string (if not a variable)        */
+    struct t_eval_var *var;            /* variable with static name         */
+    struct t_eval_node *var_name;      /* name of variable, which contains  */
+                                       /* other variables (like "${${x}}")  */
+};
+
+/* node of a compiled expression */
+
+struct t_eval_node
+{
+    enum t_eval_node_type type;        /* type of node                      */
+    int op;                            /* logical operator or comparison    */
+    char *value;                       /* constant value (type "value"),    */
+                                       /* text after ")" (parentheses)      */
+    int num_parts;                     /* number of parts (type "text")     */
+    struct t_eval_text_part *parts;    /* parts of text                     */
+    struct t_eval_node *left;          /* left node (or sub-expression)     */
+    struct t_eval_node *right;         /* right node                        */
+    int regex_constant;                /* 1 if regex has no variable        */
+    regex_t *regex;                    /* regex compiled (NULL if invalid)  */
+};
+
+/* compiled expression (see eval_compile) */
+
+struct t_eval_compiled
+{
+    int condition;                     /* 1 if evaluated as a condition     */
+    char *prefix;                      /* prefix before variables           */
+    char *suffix;                      /* suffix after variables            */
+    struct t_eval_node *root;          /* root node                         */
+};
+
 extern int eval_is_true (const char *value);
+extern struct t_eval_compiled *eval_compile (const char *expr,
+                                             struct t_hashtable *options);
+extern char *eval_exec (struct t_eval_compiled *compiled,
+                        struct t_hashtable *pointers,
+                        struct t_hashtable *extra_vars);
+extern int eval_compiled_get_vars (struct t_eval_compiled *compiled,
+                                   struct t_hashtable *vars);
+extern void eval_compiled_free (struct t_eval_compiled *compiled);
 extern char *eval_expression (const char *expr,
                               struct t_hashtable *pointers,
                               struct t_hashtable *extra_vars,
@@ -578,6 +578,7 @@ hdata_move (struct t_hdata *hdata, void *pointer, int count)
 void *
 hdata_search (struct t_hdata *hdata, void *pointer, const char *search, int move)
 {
+    struct t_eval_compiled *compiled;
     char *result;
     int rc;
 
@@ -600,8 +601,8 @@ hdata_search (struct t_hdata *hdata, void *pointer, const char *search, int move
 
     /*
      * create hashtable with extra vars (empty hashtable)
-     * (hashtable would be created in eval_expression(), but it's created here
-     * so it will not be created for each call to eval_expression())
+     * (hashtable would be created in eval_exec(), but it's created here
+     * so it will not be created for each call to eval_exec())
      */
     if (!hdata_search_extra_vars)
     {
@@ -623,25 +624,31 @@ hdata_search (struct t_hdata *hdata, void *pointer, const char *search, int move
             hashtable_set (hdata_search_options, "type", "condition");
     }
 
+    /* compile expression once, it is evaluated for each pointer */
+    compiled = eval_compile (search, hdata_search_options);
+    if (!compiled)
+        return NULL;
+
     while (pointer)
     {
         /* set pointer in hashtable (used for evaluating expression) */
         hashtable_set (hdata_search_pointers, hdata->name, pointer);
 
         /* evaluate expression */
-        result = eval_expression (search, hdata_search_pointers,
-                                  hdata_search_extra_vars,
-                                  hdata_search_options);
+        result = eval_exec (compiled, hdata_search_pointers,
+                            hdata_search_extra_vars);
         rc = eval_is_true (result);
         if (result)
             free (result);
         if (rc)
-            return pointer;
+            break;
 
         pointer = hdata_move (hdata, pointer, move);
     }
 
-    return NULL;
+    eval_compiled_free (compiled);
+
+    return pointer;
 }
 
 /*
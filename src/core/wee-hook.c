@@ -2159,14 +2159,22 @@ hook_print_exec (struct t_gui_buffer *buffer, struct t_gui_line *line)
 {
     struct t_hook *ptr_hook, *next_hook;
     char *prefix_no_color, *message_no_color;
+    const char *ptr_prefix_no_color, *ptr_message_no_color;
 
     if (!line->data->message || !line->data->message[0])
         return;
 
-    prefix_no_color = (line->data->prefix) ?
-        gui_color_decode (line->data->prefix, NULL) : NULL;
+    /*
+     * use a copy of prefix/message without colors (computed once for the
+     * line), because a callback can change the line
+     */
+    ptr_prefix_no_color = gui_line_get_prefix_no_color (line->data);
+    prefix_no_color = (ptr_prefix_no_color) ?
+        strdup (ptr_prefix_no_color) : NULL;
 
-    message_no_color = gui_color_decode (line->data->message, NULL);
+    ptr_message_no_color = gui_line_get_message_no_color (line->data);
+    message_no_color = (ptr_message_no_color) ?
+        strdup (ptr_message_no_color) : NULL;
     if (!message_no_color)
     {
         if (prefix_no_color)
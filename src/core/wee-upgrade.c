@@ -504,6 +504,16 @@ upgrade_weechat_read_buffer (struct t_infolist *infolist)
     ptr_buffer->time_for_each_line =
         infolist_integer (infolist, "time_for_each_line");
 
+    /* id of next line */
+    ptr_buffer->next_line_id = infolist_integer (infolist, "next_line_id");
+    str = infolist_string (infolist, "line_id_epoch");
+    if (str)
+    {
+        if (ptr_buffer->line_id_epoch)
+            free (ptr_buffer->line_id_epoch);
+        ptr_buffer->line_id_epoch = strdup (str);
+    }
+
     /* input */
     ptr_buffer->input = infolist_integer (infolist, "input");
     ptr_buffer->input_get_unknown_commands =
@@ -637,6 +647,19 @@ upgrade_weechat_read_buffer_line (struct t_infolist *infolist)
             {
                 new_line->data->highlight = infolist_integer (infolist,
                                                               "highlight");
+                /*
+                 * keep line id, so that relay clients can resume sync (the
+                 * id given by gui_line_add is not used, and the id of next
+                 * line saved with buffer is kept, because ids of lines
+                 * removed must not be reused)
+                 */
+                if (infolist_search_var (infolist, "id"))
+                {
+                    upgrade_current_buffer->next_line_id--;
+                    new_line->data->id = infolist_integer (infolist, "id");
+                    if (new_line->data->id >= upgrade_current_buffer->next_line_id)
+                        upgrade_current_buffer->next_line_id = new_line->data->id + 1;
+                }
                 if (infolist_integer (infolist, "last_read_line"))
                     upgrade_current_buffer->lines->last_read_line = new_line;
             }
@@ -103,6 +103,9 @@ struct t_rlimit_resource rlimit_resource[] =
 };
 #endif /* HAVE_SYS_RESOURCE_H */
 
+struct t_util_strftime_cache util_strftime_cache[UTIL_STRFTIME_CACHE_SIZE];
+unsigned long util_strftime_cache_counter = 0;
+
 struct t_util_signal util_signals[] =
 { { "hup", SIGHUP },
   { "int", SIGINT },
@@ -321,6 +324,224 @@ util_get_time_string (const time_t *date)
     return text_time;
 }
 
+/*
+ * Returns the precision of a time format for strftime (in seconds): the
+ * formatted string can change only after this delay (and at most at each
+ * local minute/hour/day boundary).
+ *
+ * Unknown conversion specifiers are considered as changing every second.
+ */
+
+int
+util_strftime_precision (const char *format)
+{
+    int precision;
+
+    precision = 86400;
+    while (format[0])
+    {
+        if (format[0] != '%')
+        {
+            format++;
+            continue;
+        }
+        format++;
+
+        /* skip flags, field width and modifiers (glibc extensions) */
+        while (format[0] && strchr ("_-0^#EO123456789", format[0]))
+        {
+            format++;
+        }
+        if (!format[0])
+            break;
+
+        switch (format[0])
+        {
+            case '%':
+            case 'n':
+            case 't':
+                break;
+            case 'a':
+            case 'A':
+            case 'b':
+            case 'B':
+            case 'C':
+            case 'd':
+            case 'D':
+            case 'e':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'h':
+            case 'j':
+            case 'm':
+            case 'u':
+            case 'U':
+            case 'V':
+            case 'w':
+            case 'W':
+            case 'x':
+            case 'y':
+            case 'Y':
+                break;
+            case 'H':
+            case 'I':
+            case 'k':
+            case 'l':
+            case 'p':
+            case 'P':
+            case 'z':
+            case 'Z':
+                if (precision > 3600)
+                    precision = 3600;
+                break;
+            case 'M':
+            case 'R':
+                if (precision > 60)
+                    precision = 60;
+                break;
+            default:
+                return 1;
+        }
+        format++;
+    }
+
+    return precision;
+}
+
+/*
+ * Formats a date with strftime, using a cache shared by all callers: dates
+ * in the same second (or minute/hour/day, according to the specifiers used
+ * in format) return the cached string without calling localtime and
+ * strftime.
+ *
+ * Boundaries of days are computed with mktime, so that a change of daylight
+ * saving time or a change of day invalidates the cached string.
+ *
+ * Note: this function is not thread-safe (it must be called only by the main
+ * thread).
+ *
+ * Returns the length of string, 0 if error (like strftime, the string is
+ * empty if it does not fit in "max" bytes).
+ */
+
+int
+util_strftime (char *string, int max, const char *format, time_t date)
+{
+    struct t_util_strftime_cache *ptr_cache;
+    struct tm *local_time, tm_day;
+    int i, oldest;
+
+    if (!string || (max <= 0))
+        return 0;
+
+    string[0] = '\0';
+
+    if (!format)
+        return 0;
+
+    /* search format in cache */
+    ptr_cache = NULL;
+    oldest = 0;
+    for (i = 0; i < UTIL_STRFTIME_CACHE_SIZE; i++)
+    {
+        if (util_strftime_cache[i].format
+            && (strcmp (util_strftime_cache[i].format, format) == 0))
+        {
+            ptr_cache = &util_strftime_cache[i];
+            break;
+        }
+        if (!util_strftime_cache[i].format
+            || (util_strftime_cache[oldest].format
+                && (util_strftime_cache[i].last_used
+                    < util_strftime_cache[oldest].last_used)))
+        {
+            oldest = i;
+        }
+    }
+
+    if (!ptr_cache)
+    {
+        /* format not found: use a free entry or replace the oldest one */
+        ptr_cache = &util_strftime_cache[oldest];
+        if (ptr_cache->format)
+            free (ptr_cache->format);
+        ptr_cache->format = strdup (format);
+        if (!ptr_cache->format)
+            return 0;
+        ptr_cache->precision = util_strftime_precision (format);
+        ptr_cache->date_start = 0;
+        ptr_cache->date_end = 0;
+        ptr_cache->string[0] = '\0';
+        ptr_cache->length = 0;
+    }
+
+    ptr_cache->last_used = ++util_strftime_cache_counter;
+
+    if ((date < ptr_cache->date_start) || (date >= ptr_cache->date_end))
+    {
+        /* date not in the range of cached string: format it now */
+        local_time = localtime (&date);
+        if (!local_time)
+        {
+            ptr_cache->date_start = 0;
+            ptr_cache->date_end = 0;
+            return 0;
+        }
+        ptr_cache->length = strftime (ptr_cache->string,
+                                      sizeof (ptr_cache->string),
+                                      format, local_time);
+        if (ptr_cache->length == 0)
+            ptr_cache->string[0] = '\0';
+        switch (ptr_cache->precision)
+        {
+            case 60:
+                ptr_cache->date_start = date - local_time->tm_sec;
+                ptr_cache->date_end = ptr_cache->date_start + 60;
+                break;
+            case 3600:
+                ptr_cache->date_start = date - local_time->tm_sec -
+                    (local_time->tm_min * 60);
+                ptr_cache->date_end = ptr_cache->date_start + 3600;
+                break;
+            case 86400:
+                memcpy (&tm_day, local_time, sizeof (tm_day));
+                tm_day.tm_sec = 0;
+                tm_day.tm_min = 0;
+                tm_day.tm_hour = 0;
+                tm_day.tm_isdst = -1;
+                ptr_cache->date_start = mktime (&tm_day);
+                memcpy (&tm_day, local_time, sizeof (tm_day));
+                tm_day.tm_sec = 0;
+                tm_day.tm_min = 0;
+                tm_day.tm_hour = 0;
+                tm_day.tm_mday++;
+                tm_day.tm_isdst = -1;
+                ptr_cache->date_end = mktime (&tm_day);
+                if ((ptr_cache->date_start == (time_t)-1)
+                    || (ptr_cache->date_end == (time_t)-1)
+                    || (date < ptr_cache->date_start)
+                    || (date >= ptr_cache->date_end))
+                {
+                    ptr_cache->date_start = date;
+                    ptr_cache->date_end = date + 1;
+                }
+                break;
+            default:
+                ptr_cache->date_start = date;
+                ptr_cache->date_end = date + 1;
+                break;
+        }
+    }
+
+    if (ptr_cache->length >= max)
+        return 0;
+
+    memcpy (string, ptr_cache->string, ptr_cache->length + 1);
+
+    return ptr_cache->length;
+}
+
 /*
  * Gets a signal number with a name; only some commonly used signal names are
  * supported here (see declaration of util_signals[]).
@@ -759,3 +980,22 @@ util_version_number (const char *version)
     return (version_int[0] << 24) | (version_int[1] << 16)
         | (version_int[2] << 8) | version_int[3];
 }
+
+/*
+ * Frees all allocated data.
+ */
+
+void
+util_end ()
+{
+    int i;
+
+    for (i = 0; i < UTIL_STRFTIME_CACHE_SIZE; i++)
+    {
+        if (util_strftime_cache[i].format)
+        {
+            free (util_strftime_cache[i].format);
+            util_strftime_cache[i].format = NULL;
+        }
+    }
+}
@@ -34,11 +34,29 @@ struct t_util_signal
     int signal;                        /* signal number                     */
 };
 
+/* cache for dates formatted with strftime */
+
+#define UTIL_STRFTIME_CACHE_SIZE 8
+
+struct t_util_strftime_cache
+{
+    char *format;                      /* time format (see man strftime)    */
+    int precision;                     /* precision of format (in seconds): */
+                                       /* 1, 60, 3600 or 86400              */
+    time_t date_start;                 /* formatted string is the same for  */
+    time_t date_end;                   /* any date in [date_start,date_end[ */
+    char string[256];                  /* date formatted with strftime      */
+    int length;                        /* length of string                  */
+    unsigned long last_used;           /* used to replace oldest entry      */
+};
+
 extern void util_setrlimit ();
 extern int util_timeval_cmp (struct timeval *tv1, struct timeval *tv2);
 extern long util_timeval_diff (struct timeval *tv1, struct timeval *tv2);
 extern void util_timeval_add (struct timeval *tv, long interval);
 extern char *util_get_time_string (const time_t *date);
+extern int util_strftime (char *string, int max, const char *format,
+                          time_t date);
 extern int util_signal_search (const char *name);
 extern void util_catch_signal (int signum, void (*handler)(int));
 extern int util_mkdir_home (const char *directory, int mode);
@@ -52,5 +70,6 @@ extern char *util_search_full_lib_name (const char *filename,
                                         const char *sys_directory);
 extern char *util_file_get_content (const char *filename);
 extern int util_version_number (const char *version);
+extern void util_end ();
 
 #endif /* WEECHAT_UTIL_H */
@@ -42,7 +42,10 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <limits.h>
 #include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <time.h>
@@ -99,6 +102,8 @@ int weechat_no_gnutls = 0;             /* remove init/deinit of gnutls      */
 int weechat_no_gcrypt = 0;             /* remove init/deinit of gcrypt      */
                                        /* (useful with valgrind)            */
 char *weechat_startup_commands = NULL; /* startup commands (-r flag)        */
+int weechat_headless = 0;              /* 1 if running headless (no GUI)    */
+int weechat_daemon = 0;                /* 1 if daemon (headless, no output) */
 
 
 /*
@@ -148,6 +153,14 @@ weechat_display_usage (char *exec_name)
                             "      --upgrade            upgrade WeeChat using session files (see /help upgrade in WeeChat)\n"
                             "  -v, --version            display WeeChat version\n"
                             "  plugin:option            option for plugin (see man weechat)\n"));
+    if (weechat_headless)
+    {
+        string_iconv_fprintf (stdout, "\n");
+        string_iconv_fprintf (stdout,
+                              _("Extra options in headless mode:\n"
+                                "      --daemon             run WeeChat as a daemon (fork, new process group, current directory \"/\",\n"
+                                "                           file descriptors closed, screen is never drawn)\n"));
+    }
     string_iconv_fprintf(stdout, "\n");
 }
 
@@ -177,6 +190,10 @@ weechat_parse_args (int argc, char *argv[])
             gui_color_display_terminal_colors ();
             weechat_shutdown (EXIT_SUCCESS, 0);
         }
+        else if (weechat_headless && (strcmp (argv[i], "--daemon") == 0))
+        {
+            weechat_daemon = 1;
+        }
         else if ((strcmp (argv[i], "-d") == 0)
             || (strcmp (argv[i], "--dir") == 0))
         {
@@ -268,6 +285,89 @@ weechat_parse_args (int argc, char *argv[])
     }
 }
 
+/*
+ * Runs WeeChat as a daemon: forks, creates a new session, changes current
+ * directory to "/" and closes file descriptors (stdin, stdout and stderr are
+ * redirected to /dev/null).
+ *
+ * The home directory is converted to an absolute path before the change of
+ * current directory, so it must exist when this function is called.
+ * The umask is inherited from the parent process.
+ *
+ * Any error in this function is fatal.
+ */
+
+void
+weechat_daemonize ()
+{
+    int i, num_fd;
+    pid_t pid;
+    char home_absolute_path[PATH_MAX];
+
+    pid = fork ();
+    if (pid < 0)
+    {
+        string_iconv_fprintf (stderr,
+                              _("Error: unable to fork (%s)\n"),
+                              strerror (errno));
+        weechat_shutdown (EXIT_FAILURE, 0);
+    }
+    if (pid > 0)
+    {
+        /* parent process: exit now, the child is the daemon */
+        exit (EXIT_SUCCESS);
+    }
+
+    /* child process: new session, without controlling terminal */
+    if (setsid () < 0)
+    {
+        string_iconv_fprintf (stderr,
+                              _("Error: unable to create a new session "
+                                "(%s)\n"),
+                              strerror (errno));
+        weechat_shutdown (EXIT_FAILURE, 0);
+    }
+
+    /*
+     * do not keep current directory busy: home must be an absolute path
+     * (relative paths used later are relative to "/")
+     */
+    if ((weechat_home[0] != '/')
+        && realpath (weechat_home, home_absolute_path))
+    {
+        free (weechat_home);
+        weechat_home = strdup (home_absolute_path);
+        if (!weechat_home)
+        {
+            string_iconv_fprintf (stderr,
+                                  _("Error: not enough memory for home "
+                                    "directory\n"));
+            weechat_shutdown (EXIT_FAILURE, 0);
+        }
+    }
+    if (chdir ("/") < 0)
+    {
+        string_iconv_fprintf (stderr,
+                              _("Error: unable to change directory to \"/\" "
+                                "(%s)\n"),
+                              strerror (errno));
+        weechat_shutdown (EXIT_FAILURE, 0);
+    }
+
+    /* close all file descriptors and redirect standard ones to /dev/null */
+    num_fd = getdtablesize ();
+    for (i = 0; i < num_fd; i++)
+    {
+        close (i);
+    }
+    i = open ("/dev/null", O_RDWR);
+    if (i >= 0)
+    {
+        (void) dup (i);
+        (void) dup (i);
+    }
+}
+
 /*
  * Creates WeeChat home directory (by default ~/.weechat).
  *
@@ -538,6 +638,8 @@ weechat_init (int argc, char *argv[], void (*gui_init_cb)())
         weechat_shutdown (EXIT_FAILURE, 0);
     weechat_parse_args (argc, argv);    /* parse command line args          */
     weechat_create_home_dir ();         /* create WeeChat home directory    */
+    if (weechat_daemon)
+        weechat_daemonize ();           /* run as daemon (headless mode)    */
     log_init ();                        /* init log file                    */
     plugin_api_init ();                 /* create some hooks (info,hdata,..)*/
     secure_read ();                     /* read secured data options        */
@@ -554,7 +656,8 @@ weechat_init (int argc, char *argv[], void (*gui_init_cb)())
     }
     weechat_welcome_message ();         /* display WeeChat welcome message  */
     gui_chat_print_lines_waiting_buffer (NULL); /* display lines waiting    */
-    weechat_term_check ();              /* warnings about $TERM (if wrong)  */
+    if (!weechat_headless)
+        weechat_term_check ();          /* warnings about $TERM (if wrong)  */
     command_startup (0);                /* command executed before plugins  */
     plugin_init (weechat_auto_load_plugins, /* init plugin interface(s)     */
                  argc, argv);
@@ -590,5 +693,6 @@ weechat_end (void (*gui_end_cb)(int clean_exit))
     hdata_end ();                       /* end hdata                        */
     secure_end ();                      /* end secured data                 */
     string_end ();                      /* end string                       */
+    util_end ();                        /* end util                         */
     weechat_shutdown (-1, 0);           /* end other things                 */
 }
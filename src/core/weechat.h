@@ -105,6 +105,8 @@ extern int weechat_plugin_no_dlclose;
 extern int weechat_no_gnutls;
 extern int weechat_no_gcrypt;
 extern char *weechat_startup_commands;
+extern int weechat_headless;
+extern int weechat_daemon;
 
 extern void weechat_term_check ();
 extern void weechat_shutdown (int return_code, int crash);
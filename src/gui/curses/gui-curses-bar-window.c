@@ -410,6 +410,7 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
     int diff, max_length, optimal_number_of_lines;
     int some_data_not_displayed;
     int index_item, index_subitem, index_line;
+    int first_line, total_lines;
 
     if (!gui_init_ok)
         return;
@@ -457,7 +458,36 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
 
     filling = gui_bar_get_filling (bar_window->bar);
 
+    /* build only lines displayed if possible (for example a big nicklist) */
+    if (gui_bar_window_content_virtual (bar_window))
+    {
+        gui_bar_window_content_set_virtual (bar_window,
+                                            bar_window->scroll_y,
+                                            bar_window->height);
+    }
+    else
+    {
+        gui_bar_window_content_set_virtual (bar_window, 0, 0);
+    }
+
     content = gui_bar_window_content_get_with_filling (bar_window, window);
+
+    if ((bar_window->virtual_lines >= 0)
+        && (bar_window->scroll_y > 0)
+        && (bar_window->scroll_y > bar_window->virtual_lines - bar_window->height))
+    {
+        /* scroll is after the end of item: build lines displayed again */
+        bar_window->scroll_y = bar_window->virtual_lines - bar_window->height;
+        if (bar_window->scroll_y < 0)
+            bar_window->scroll_y = 0;
+        gui_bar_window_content_set_virtual (bar_window,
+                                            bar_window->scroll_y,
+                                            bar_window->height);
+        if (content)
+            free (content);
+        content = gui_bar_window_content_get_with_filling (bar_window, window);
+    }
+
     if (content)
     {
         if ((filling == GUI_BAR_FILLING_HORIZONTAL)
@@ -473,6 +503,22 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
         }
 
         items = string_split (content, "\n", 0, 0, &items_count);
+
+        /*
+         * if content has only lines displayed, the first line of content is
+         * not the first line of item
+         */
+        if (bar_window->virtual_lines >= 0)
+        {
+            first_line = bar_window->virtual_first_line;
+            total_lines = bar_window->virtual_lines;
+        }
+        else
+        {
+            first_line = 0;
+            total_lines = items_count;
+        }
+
         if (items_count == 0)
         {
             if (CONFIG_INTEGER(bar_window->bar->options[GUI_BAR_OPTION_SIZE]) == 0)
@@ -508,6 +554,11 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
                         num_lines = 1;
                     optimal_number_of_lines += num_lines;
                 }
+                if ((bar_window->virtual_lines >= 0)
+                    && (bar_window->virtual_max_length > max_length))
+                {
+                    max_length = bar_window->virtual_max_length;
+                }
                 if (max_length == 0)
                     max_length = 1;
 
@@ -518,7 +569,7 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
                         if (filling == GUI_BAR_FILLING_HORIZONTAL)
                             num_lines = optimal_number_of_lines;
                         else
-                            num_lines = items_count;
+                            num_lines = total_lines;
                         gui_bar_window_set_current_size (bar_window, window,
                                                          num_lines);
                         break;
@@ -539,9 +590,9 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
             y = 0;
             some_data_not_displayed = 0;
             if ((bar_window->scroll_y > 0)
-                && (bar_window->scroll_y > items_count - bar_window->height))
+                && (bar_window->scroll_y > total_lines - bar_window->height))
             {
-                bar_window->scroll_y = items_count - bar_window->height;
+                bar_window->scroll_y = total_lines - bar_window->height;
                 if (bar_window->scroll_y < 0)
                     bar_window->scroll_y = 0;
             }
@@ -625,7 +676,7 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
                 }
 
                 if ((bar_window->scroll_y == 0)
-                    || (line >= bar_window->scroll_y))
+                    || (first_line + line >= bar_window->scroll_y))
                 {
                     if (!gui_bar_window_print_string (bar_window, filling,
                                                       &x, &y,
@@ -695,7 +746,8 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
                 }
             }
             if ((bar_window->cursor_x < 0) && (bar_window->cursor_y < 0)
-                && (some_data_not_displayed || (line < items_count)))
+                && (some_data_not_displayed
+                    || (first_line + line < total_lines)))
             {
                 ptr_string = (filling == GUI_BAR_FILLING_HORIZONTAL) ?
                     CONFIG_STRING(config_look_bar_more_right) :
@@ -740,7 +792,7 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
         if (x > bar_window->width - 2)
             x = bar_window->width - 2;
         wmove (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar, y, x);
-        wrefresh (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar);
+        wnoutrefresh (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_bar);
         if (!gui_cursor_mode)
         {
             gui_window_cursor_x = bar_window->cursor_x;
@@ -789,7 +841,7 @@ gui_bar_window_draw (struct t_gui_bar_window *bar_window,
         wnoutrefresh (GUI_BAR_WINDOW_OBJECTS(bar_window)->win_separator);
     }
 
-    refresh ();
+    gui_window_flush_needed = 1;
 }
 
 /*
@@ -1212,6 +1212,125 @@ gui_chat_display_time_to_prefix (struct t_gui_window *window,
         free (ptr_prefix);
 }
 
+/*
+ * Checks if the message "day changed" must be displayed before a line: only
+ * for the first displayed line with a date, if this date is not today.
+ *
+ * Returns:
+ *   1: message must be displayed (local date of line is set in "date_line")
+ *   0: no message before line
+ */
+
+int
+gui_chat_day_changed_before (struct t_gui_window *window,
+                             struct t_gui_line *line, struct tm *date_line)
+{
+    struct t_gui_line *ptr_prev_line;
+    struct timeval tv_time;
+    struct tm local_time;
+    time_t seconds;
+
+    if ((line->data->date == 0)
+        || !CONFIG_BOOLEAN(config_look_day_change)
+        || !window->buffer->day_change)
+        return 0;
+
+    ptr_prev_line = gui_line_get_prev_displayed (line);
+    while (ptr_prev_line && (ptr_prev_line->data->date == 0))
+    {
+        ptr_prev_line = gui_line_get_prev_displayed (ptr_prev_line);
+    }
+    if (ptr_prev_line)
+        return 0;
+
+    gettimeofday (&tv_time, NULL);
+    seconds = tv_time.tv_sec;
+    localtime_r (&seconds, &local_time);
+    localtime_r (&line->data->date, date_line);
+
+    return ((local_time.tm_mday != date_line->tm_mday)
+            || (local_time.tm_mon != date_line->tm_mon)
+            || (local_time.tm_year != date_line->tm_year)) ? 1 : 0;
+}
+
+/*
+ * Checks if the message "day changed" must be displayed after a line: if the
+ * day of next displayed line with a date (or current date for last line) is
+ * not the day of line.
+ *
+ * Returns:
+ *   1: message must be displayed (local dates of line and next line are set
+ *      in "date_line" and "date_next")
+ *   0: no message after line
+ */
+
+int
+gui_chat_day_changed_after (struct t_gui_window *window,
+                            struct t_gui_line *line, struct tm *date_line,
+                            struct tm *date_next)
+{
+    struct t_gui_line *ptr_next_line;
+    struct timeval tv_time;
+    time_t seconds, *ptr_time;
+
+    if ((line->data->date == 0)
+        || !CONFIG_BOOLEAN(config_look_day_change)
+        || !window->buffer->day_change)
+        return 0;
+
+    ptr_next_line = gui_line_get_next_displayed (line);
+    while (ptr_next_line && (ptr_next_line->data->date == 0))
+    {
+        ptr_next_line = gui_line_get_next_displayed (ptr_next_line);
+    }
+    if (ptr_next_line)
+    {
+        /* get time of next line */
+        ptr_time = &ptr_next_line->data->date;
+    }
+    else
+    {
+        /* it was the last line => compare with current system time */
+        gettimeofday (&tv_time, NULL);
+        seconds = tv_time.tv_sec;
+        ptr_time = &seconds;
+    }
+    if (*ptr_time == 0)
+        return 0;
+
+    localtime_r (&line->data->date, date_line);
+    localtime_r (ptr_time, date_next);
+
+    return ((date_line->tm_mday != date_next->tm_mday)
+            || (date_line->tm_mon != date_next->tm_mon)
+            || (date_line->tm_year != date_next->tm_year)) ? 1 : 0;
+}
+
+/*
+ * Returns number of rows displayed around a line, which can change without
+ * change of the line itself: messages "day changed" (before/after line) and
+ * read marker (after line).
+ */
+
+int
+gui_chat_get_line_extra_rows (struct t_gui_window *window,
+                              struct t_gui_line *line)
+{
+    struct tm date_line, date_next;
+    int rows;
+
+    rows = 0;
+
+    if (gui_chat_day_changed_before (window, line, &date_line))
+        rows++;
+    if (gui_chat_day_changed_after (window, line, &date_line, &date_next))
+        rows++;
+    if (gui_chat_marker_for_line (window->buffer, line))
+        rows++;
+
+    return rows;
+}
+
 /*
  * Displays a line in the chat window.
  *
@@ -1233,10 +1352,7 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
     int word_length_with_spaces, word_length;
     char *ptr_data, *ptr_end_offset, *next_char;
     char *ptr_style, *message_with_tags, *message_with_search;
-    struct t_gui_line *ptr_prev_line, *ptr_next_line;
     struct tm local_time, local_time2;
-    struct timeval tv_time;
-    time_t seconds, *ptr_time;
 
     if (!line)
         return 0;
@@ -1255,7 +1371,7 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
             return 0;
         x = window->win_chat_cursor_x;
         y = window->win_chat_cursor_y;
-        num_lines = gui_chat_display_line (window, line, 0, 1);
+        num_lines = gui_chat_get_line_rows (window, line);
         window->win_chat_cursor_x = x;
         window->win_chat_cursor_y = y;
         gui_window_current_emphasis = 0;
@@ -1265,36 +1381,12 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
     lines_displayed = 0;
 
     /* display message before first line of buffer if date is not today */
-    if ((line->data->date != 0)
-        && CONFIG_BOOLEAN(config_look_day_change)
-        && window->buffer->day_change)
+    if (gui_chat_day_changed_before (window, line, &local_time2))
     {
-        ptr_time = NULL;
-        ptr_prev_line = gui_line_get_prev_displayed (line);
-        if (ptr_prev_line)
-        {
-            while (ptr_prev_line && (ptr_prev_line->data->date == 0))
-            {
-                ptr_prev_line = gui_line_get_prev_displayed (ptr_prev_line);
-            }
-        }
-        if (!ptr_prev_line)
-        {
-            gettimeofday (&tv_time, NULL);
-            seconds = tv_time.tv_sec;
-            localtime_r (&seconds, &local_time);
-            localtime_r (&line->data->date, &local_time2);
-            if ((local_time.tm_mday != local_time2.tm_mday)
-                || (local_time.tm_mon != local_time2.tm_mon)
-                || (local_time.tm_year != local_time2.tm_year))
-            {
-                gui_chat_display_day_changed (window, NULL, &local_time2,
-                                              simulate);
-                gui_chat_display_new_line (window, num_lines, count,
-                                           &lines_displayed, simulate);
-                pre_lines_displayed++;
-            }
-        }
+        gui_chat_display_day_changed (window, NULL, &local_time2, simulate);
+        gui_chat_display_new_line (window, num_lines, count,
+                                   &lines_displayed, simulate);
+        pre_lines_displayed++;
     }
 
     /* calculate marker position (maybe not used for this line!) */
@@ -1456,45 +1548,12 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
     }
 
     /* display message if day has changed after this line */
-    if ((line->data->date != 0)
-        && CONFIG_BOOLEAN(config_look_day_change)
-        && window->buffer->day_change)
+    if (gui_chat_day_changed_after (window, line, &local_time, &local_time2))
     {
-        ptr_time = NULL;
-        ptr_next_line = gui_line_get_next_displayed (line);
-        if (ptr_next_line)
-        {
-            while (ptr_next_line && (ptr_next_line->data->date == 0))
-            {
-                ptr_next_line = gui_line_get_next_displayed (ptr_next_line);
-            }
-        }
-        if (ptr_next_line)
-        {
-            /* get time of next line */
-            ptr_time = &ptr_next_line->data->date;
-        }
-        else
-        {
-            /* it was the last line => compare with current system time */
-            gettimeofday (&tv_time, NULL);
-            seconds = tv_time.tv_sec;
-            ptr_time = &seconds;
-        }
-        if (ptr_time && (*ptr_time != 0))
-        {
-            localtime_r (&line->data->date, &local_time);
-            localtime_r (ptr_time, &local_time2);
-            if ((local_time.tm_mday != local_time2.tm_mday)
-                || (local_time.tm_mon != local_time2.tm_mon)
-                || (local_time.tm_year != local_time2.tm_year))
-            {
-                gui_chat_display_day_changed (window, &local_time, &local_time2,
-                                              simulate);
-                gui_chat_display_new_line (window, num_lines, count,
-                                           &lines_displayed, simulate);
-            }
-        }
+        gui_chat_display_day_changed (window, &local_time, &local_time2,
+                                      simulate);
+        gui_chat_display_new_line (window, num_lines, count,
+                                   &lines_displayed, simulate);
     }
 
     /* display read marker (after line) */
@@ -1543,6 +1602,58 @@ gui_chat_display_line (struct t_gui_window *window, struct t_gui_line *line,
     return lines_displayed;
 }
 
+/*
+ * Returns number of rows used by a line in a window (same result as
+ * gui_chat_display_line with simulate == 1).
+ *
+ * The rows of the line itself are cached in the line data, with the width of
+ * chat area, the alignment of line and the rows generation (changed when
+ * options are changed); only the rows around the line (day changed, read
+ * marker) are computed on each call.
+ *
+ * The cache is not used when the start of line does not have a fixed width:
+ * prefix not aligned with a prefix for same nick (it depends on previous
+ * line), or names of merged buffers not aligned (it depends on buffer of
+ * line).
+ */
+
+int
+gui_chat_get_line_rows (struct t_gui_window *window, struct t_gui_line *line)
+{
+    int width, align, rows;
+
+    if (!line)
+        return 0;
+
+    if (((CONFIG_INTEGER(config_look_prefix_align) == CONFIG_LOOK_PREFIX_ALIGN_NONE)
+         && CONFIG_STRING(config_look_prefix_same_nick)
+         && CONFIG_STRING(config_look_prefix_same_nick)[0])
+        || (window->buffer->mixed_lines && (window->buffer->active != 2)
+            && (CONFIG_INTEGER(config_look_prefix_buffer_align) == CONFIG_LOOK_PREFIX_BUFFER_ALIGN_NONE)))
+    {
+        return gui_chat_display_line (window, line, 0, 1);
+    }
+
+    width = gui_chat_get_real_width (window);
+    align = gui_line_get_align (window->buffer, line, 1, 1);
+
+    if ((line->data->rows_generation == gui_chat_rows_generation)
+        && (line->data->rows_width == width)
+        && (line->data->rows_align == align))
+    {
+        return line->data->rows + gui_chat_get_line_extra_rows (window, line);
+    }
+
+    rows = gui_chat_display_line (window, line, 0, 1);
+
+    line->data->rows = rows - gui_chat_get_line_extra_rows (window, line);
+    line->data->rows_width = width;
+    line->data->rows_align = align;
+    line->data->rows_generation = gui_chat_rows_generation;
+
+    return rows;
+}
+
 /*
  * Displays a line in the chat window (for a buffer with free content).
  */
@@ -1624,7 +1735,7 @@ gui_chat_calculate_line_diff (struct t_gui_window *window,
             *line = gui_line_get_last_displayed (window->buffer);
             if (!(*line))
                 return;
-            current_size = gui_chat_display_line (window, *line, 0, 1);
+            current_size = gui_chat_get_line_rows (window, *line);
             if (current_size == 0)
                 current_size = 1;
             *line_pos = current_size - 1;
@@ -1636,11 +1747,11 @@ gui_chat_calculate_line_diff (struct t_gui_window *window,
             if (!(*line))
                 return;
             *line_pos = 0;
-            current_size = gui_chat_display_line (window, *line, 0, 1);
+            current_size = gui_chat_get_line_rows (window, *line);
         }
     }
     else
-        current_size = gui_chat_display_line (window, *line, 0, 1);
+        current_size = gui_chat_get_line_rows (window, *line);
 
     while ((*line) && (difference != 0))
     {
@@ -1654,7 +1765,7 @@ gui_chat_calculate_line_diff (struct t_gui_window *window,
                 *line = gui_line_get_prev_displayed (*line);
                 if (*line)
                 {
-                    current_size = gui_chat_display_line (window, *line, 0, 1);
+                    current_size = gui_chat_get_line_rows (window, *line);
                     if (current_size == 0)
                         current_size = 1;
                     *line_pos = current_size - 1;
@@ -1672,7 +1783,7 @@ gui_chat_calculate_line_diff (struct t_gui_window *window,
                 *line = gui_line_get_next_displayed (*line);
                 if (*line)
                 {
-                    current_size = gui_chat_display_line (window, *line, 0, 1);
+                    current_size = gui_chat_get_line_rows (window, *line);
                     if (current_size == 0)
                         current_size = 1;
                     *line_pos = 0;
@@ -1699,6 +1810,142 @@ gui_chat_calculate_line_diff (struct t_gui_window *window,
     }
 }
 
+/*
+ * Saves info about the content of chat window after lines have been displayed.
+ *
+ * If last_line is not NULL, it is the last line of buffer and it is displayed
+ * on last row of chat window: on next refresh, if only lines have been added
+ * in buffer, the chat window can be scrolled to display only new lines.
+ */
+
+void
+gui_chat_save_content (struct t_gui_window *window,
+                       struct t_gui_line *last_line)
+{
+    struct t_gui_window_curses_objects *objects;
+
+    objects = GUI_WINDOW_OBJECTS(window);
+
+    objects->chat_lines = window->buffer->lines;
+    objects->chat_last_line = last_line;
+    objects->chat_last_line_rows = (last_line) ?
+        gui_chat_get_line_rows (window, last_line) : 0;
+    objects->chat_last_line_marker = (last_line) ?
+        gui_chat_marker_for_line (window->buffer, last_line) : 0;
+    objects->chat_width = window->win_chat_width;
+    objects->chat_height = window->win_chat_height;
+    objects->chat_prefix_max_length = window->buffer->lines->prefix_max_length;
+    objects->chat_buffer_max_length = window->buffer->lines->buffer_max_length;
+    objects->chat_rows_generation = gui_chat_rows_generation;
+}
+
+/*
+ * Removes a line from content saved for a window (called when a line is
+ * removed from a buffer, so that the pointer to this line is not used any
+ * more).
+ */
+
+void
+gui_chat_remove_line (struct t_gui_window *window, struct t_gui_line *line)
+{
+    if (GUI_WINDOW_OBJECTS(window)->chat_last_line == line)
+        GUI_WINDOW_OBJECTS(window)->chat_last_line = NULL;
+}
+
+/*
+ * Draws only new lines of a formatted buffer: the content of chat window is
+ * scrolled up and new lines are displayed on last rows.
+ *
+ * This is possible only if the last line of buffer was displayed on last row
+ * of chat window on previous refresh, and if nothing else has changed in chat
+ * window (size, alignment, options, rows around this line).
+ *
+ * Returns:
+ *   1: new lines displayed
+ *   0: chat window must be fully drawn
+ */
+
+int
+gui_chat_draw_formatted_buffer_new_lines (struct t_gui_window *window)
+{
+    struct t_gui_window_curses_objects *objects;
+    struct t_gui_line *ptr_line, *ptr_last_line;
+    int rows;
+
+    objects = GUI_WINDOW_OBJECTS(window);
+
+    if (!objects->chat_last_line
+        || window->scroll->start_line
+        || (window->buffer->type != GUI_BUFFER_TYPE_FORMATTED)
+        || (objects->chat_lines != window->buffer->lines)
+        || (objects->chat_width != window->win_chat_width)
+        || (objects->chat_height != window->win_chat_height)
+        || (objects->chat_prefix_max_length != window->buffer->lines->prefix_max_length)
+        || (objects->chat_buffer_max_length != window->buffer->lines->buffer_max_length)
+        || (objects->chat_rows_generation != gui_chat_rows_generation))
+    {
+        return 0;
+    }
+
+    /*
+     * count rows of new lines (starting from end of buffer), until the last
+     * line displayed on previous refresh is found
+     */
+    rows = 0;
+    ptr_line = gui_line_get_last_displayed (window->buffer);
+    while (ptr_line && (ptr_line != objects->chat_last_line))
+    {
+        rows += gui_chat_get_line_rows (window, ptr_line);
+        if (rows >= window->win_chat_height)
+            return 0;
+        ptr_line = gui_line_get_prev_displayed (ptr_line);
+    }
+    if (!ptr_line)
+        return 0;
+
+    /* rows around last line displayed must be the same (day change, marker) */
+    if ((gui_chat_get_line_rows (window, ptr_line) != objects->chat_last_line_rows)
+        || (gui_chat_marker_for_line (window->buffer, ptr_line) != objects->chat_last_line_marker))
+    {
+        return 0;
+    }
+
+    /* no new line displayed? */
+    if (rows == 0)
+        return 1;
+
+    /* scroll content of chat window (and coordinates of lines) */
+    scrollok (GUI_WINDOW_OBJECTS(window)->win_chat, TRUE);
+    wscrl (GUI_WINDOW_OBJECTS(window)->win_chat, rows);
+    scrollok (GUI_WINDOW_OBJECTS(window)->win_chat, FALSE);
+    gui_window_coords_scroll (window, rows);
+
+    /* display new lines on last rows */
+    window->win_chat_cursor_x = 0;
+    window->win_chat_cursor_y = window->win_chat_height - rows;
+    ptr_last_line = ptr_line;
+    ptr_line = gui_line_get_next_displayed (ptr_line);
+    while (ptr_line)
+    {
+        gui_chat_display_line (window, ptr_line, 0, 0);
+        ptr_last_line = ptr_line;
+        ptr_line = gui_line_get_next_displayed (ptr_line);
+    }
+
+    window->scroll->first_line_displayed = 0;
+
+    gui_chat_save_content (window, ptr_last_line);
+
+    /* cursor is below end line of chat window? */
+    if (window->win_chat_cursor_y > window->win_chat_height - 1)
+    {
+        window->win_chat_cursor_x = 0;
+        window->win_chat_cursor_y = window->win_chat_height - 1;
+    }
+
+    return 1;
+}
+
 /*
  * Draws chat window for a formatted buffer.
  */
@@ -1706,13 +1953,14 @@ gui_chat_calculate_line_diff (struct t_gui_window *window,
 void
 gui_chat_draw_formatted_buffer (struct t_gui_window *window)
 {
-    struct t_gui_line *ptr_line, *ptr_line2;
-    int auto_search_first_line, line_pos, line_pos2, count;
+    struct t_gui_line *ptr_line, *ptr_line2, *ptr_last_line;
+    int auto_search_first_line, line_pos, line_pos2, count, end_displayed;
     int old_scrolling, old_lines_after;
 
     /* display at position of scrolling */
     auto_search_first_line = 1;
     ptr_line = NULL;
+    ptr_last_line = NULL;
     line_pos = 0;
     if (window->scroll->start_line)
     {
@@ -1754,10 +2002,10 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
     {
         /* display end of first line at top of screen */
         count = gui_chat_display_line (window, ptr_line,
-                                       gui_chat_display_line (window,
-                                                              ptr_line,
-                                                              0, 1) -
+                                       gui_chat_get_line_rows (window,
+                                                               ptr_line) -
                                        line_pos, 0);
+        ptr_last_line = ptr_line;
         ptr_line = gui_line_get_next_displayed (ptr_line);
         window->scroll->first_line_displayed = 0;
     }
@@ -1769,9 +2017,15 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
     while (ptr_line && (window->win_chat_cursor_y <= window->win_chat_height - 1))
     {
         count = gui_chat_display_line (window, ptr_line, 0, 0);
+        ptr_last_line = ptr_line;
         ptr_line = gui_line_get_next_displayed (ptr_line);
     }
 
+    /* check if last line of buffer is displayed on last row of window */
+    end_displayed = (!ptr_line
+                     && (window->win_chat_cursor_y == window->win_chat_height)) ?
+        1 : 0;
+
     old_scrolling = window->scroll->scrolling;
     old_lines_after = window->scroll->lines_after;
 
@@ -1781,7 +2035,7 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
     /* if so, disable scroll indicator */
     if (!ptr_line && window->scroll->scrolling)
     {
-        if ((count == gui_chat_display_line (window, gui_line_get_last_displayed (window->buffer), 0, 1))
+        if ((count == gui_chat_get_line_rows (window, gui_line_get_last_displayed (window->buffer)))
             || (count == window->win_chat_height))
             window->scroll->scrolling = 0;
     }
@@ -1813,6 +2067,10 @@ gui_chat_draw_formatted_buffer (struct t_gui_window *window)
                                  WEECHAT_HOOK_SIGNAL_POINTER, window);
     }
 
+    gui_chat_save_content (window,
+                           (end_displayed && !window->scroll->start_line) ?
+                           ptr_last_line : NULL);
+
     /* cursor is below end line of chat window? */
     if (window->win_chat_cursor_y > window->win_chat_height - 1)
     {
@@ -1875,23 +2133,17 @@ gui_chat_draw_free_buffer (struct t_gui_window *window, int clear_chat)
 char *
 gui_chat_get_bare_line (struct t_gui_line *line)
 {
-    char *prefix, *message, str_time[256], *str_line;
-    const char *tag_prefix_nick;
+    char str_time[256], *str_line;
+    const char *prefix, *message, *tag_prefix_nick;
     struct tm *local_time;
     int length;
 
-    prefix = NULL;
-    message = NULL;
-    str_line = NULL;
-
-    prefix = (line->data->prefix) ?
-        gui_color_decode (line->data->prefix, NULL) : strdup ("");
+    prefix = gui_line_get_prefix_no_color (line->data);
     if (!prefix)
-        goto end;
-    message = (line->data->message) ?
-        gui_color_decode (line->data->message, NULL) : strdup ("");
+        prefix = "";
+    message = gui_line_get_message_no_color (line->data);
     if (!message)
-        goto end;
+        message = "";
 
     str_time[0] = '\0';
     if (line->data->buffer->time_for_each_line
@@ -1922,12 +2174,6 @@ gui_chat_get_bare_line (struct t_gui_line *line)
                   message);
     }
 
-end:
-    if (prefix)
-        free (prefix);
-    if (message)
-        free (message);
-
     return str_line;
 }
 
@@ -2017,7 +2263,7 @@ gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat)
     struct t_gui_window *ptr_win;
     struct t_gui_line *ptr_line;
     char format_empty[32];
-    int i;
+    int i, new_lines_displayed;
 
     if (!gui_init_ok)
         return;
@@ -2035,13 +2281,26 @@ gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat)
             && (ptr_win->win_chat_x >= 0) && (ptr_win->win_chat_y >= 0)
             && (GUI_WINDOW_OBJECTS(ptr_win)->win_chat))
         {
-            gui_window_coords_alloc (ptr_win);
-
             gui_chat_reset_style (ptr_win, NULL, 0, 1,
                                   GUI_COLOR_CHAT_INACTIVE_WINDOW,
                                   GUI_COLOR_CHAT_INACTIVE_BUFFER,
                                   GUI_COLOR_CHAT);
 
+            /* only lines added: try to display only new lines */
+            new_lines_displayed = (!clear_chat
+                                   && buffer->chat_refresh_new_lines
+                                   && (ptr_win->win_chat_height >= 2)) ?
+                gui_chat_draw_formatted_buffer_new_lines (ptr_win) : 0;
+            if (new_lines_displayed)
+            {
+                wnoutrefresh (GUI_WINDOW_OBJECTS(ptr_win)->win_chat);
+                gui_window_flush_needed = 1;
+                continue;
+            }
+
+            gui_window_coords_alloc (ptr_win);
+            GUI_WINDOW_OBJECTS(ptr_win)->chat_last_line = NULL;
+
             if (clear_chat)
             {
                 snprintf (format_empty, sizeof (format_empty),
@@ -2072,11 +2331,10 @@ gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat)
                     break;
             }
             wnoutrefresh (GUI_WINDOW_OBJECTS(ptr_win)->win_chat);
+            gui_window_flush_needed = 1;
         }
     }
 
-    refresh ();
-
     if (buffer->type == GUI_BUFFER_TYPE_FREE)
     {
         for (ptr_line = buffer->lines->first_line; ptr_line;
@@ -2088,4 +2346,5 @@ gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat)
 
 end:
     buffer->chat_refresh_needed = 0;
+    buffer->chat_refresh_new_lines = 0;
 }
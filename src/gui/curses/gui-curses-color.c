@@ -103,6 +103,14 @@ int gui_color_warning_pairs_full = 0;    /* warning displayed?              */
 int gui_color_pairs_auto_reset = 0;         /* auto reset of pairs needed   */
 int gui_color_pairs_auto_reset_pending = 0; /* auto reset is pending        */
 time_t gui_color_pairs_auto_reset_last = 0; /* time of last auto reset      */
+int *gui_color_pairs_index = NULL;       /* index in gui_color_pairs for    */
+                                         /* each pair (0 = pair not used)   */
+unsigned int *gui_color_pairs_last_used = NULL; /* frame of last use (LRU)  */
+unsigned int gui_color_pairs_frame = 1;  /* current frame (for pairs LRU)   */
+char *gui_color_pairs_displayed = NULL;  /* pairs displayed on screen       */
+unsigned int gui_color_pairs_displayed_frame = 0; /* frame of last scan of  */
+                                         /* pairs displayed on screen       */
+int gui_color_pairs_recycled = 0;        /* number of pairs reused          */
 
 /* color buffer */
 struct t_gui_buffer *gui_color_buffer = NULL; /* buffer with colors         */
@@ -365,10 +373,119 @@ gui_color_timer_warning_pairs_full (void *data, int remaining_calls)
     return WEECHAT_RC_OK;
 }
 
+/*
+ * Scans the screen to find pairs currently displayed (result is kept until the
+ * end of current frame).
+ */
+
+void
+gui_color_pairs_scan_displayed ()
+{
+    int x, y, pair;
+
+    if (!gui_color_pairs_displayed
+        || (gui_color_pairs_displayed_frame == gui_color_pairs_frame))
+        return;
+
+    memset (gui_color_pairs_displayed, 0,
+            (gui_color_num_pairs + 1) * sizeof (gui_color_pairs_displayed[0]));
+    for (y = 0; y < LINES; y++)
+    {
+        for (x = 0; x < COLS; x++)
+        {
+            pair = PAIR_NUMBER(mvwinch (curscr, y, x) & A_COLOR);
+            if ((pair >= 1) && (pair <= gui_color_num_pairs))
+                gui_color_pairs_displayed[pair] = 1;
+        }
+    }
+    gui_color_pairs_displayed_frame = gui_color_pairs_frame;
+}
+
+/*
+ * Searches for a pair that can be reused: the least recently used pair which
+ * is not used in current frame and not displayed on screen.
+ *
+ * If count is not NULL, it is set with the number of pairs that can be reused.
+ *
+ * Returns pair found, 0 if no pair can be reused.
+ */
+
+int
+gui_color_pairs_search_lru (int *count)
+{
+    int i, pair;
+
+    if (count)
+        *count = 0;
+
+    if (!gui_color_pairs_index || !gui_color_pairs_last_used)
+        return 0;
+
+    gui_color_pairs_scan_displayed ();
+
+    pair = 0;
+    for (i = 1; i <= gui_color_pairs_used; i++)
+    {
+        if ((gui_color_pairs_index[i] > 0)
+            && (gui_color_pairs_last_used[i] != gui_color_pairs_frame)
+            && (!gui_color_pairs_displayed || !gui_color_pairs_displayed[i]))
+        {
+            if (count)
+                (*count)++;
+            if ((pair == 0)
+                || (gui_color_pairs_last_used[i] < gui_color_pairs_last_used[pair]))
+            {
+                pair = i;
+            }
+        }
+    }
+
+    return pair;
+}
+
+/*
+ * Ends current frame: the pairs used in next frame will be considered as more
+ * recently used than pairs used so far.
+ *
+ * This function must be called after each refresh of terminal.
+ */
+
+void
+gui_color_pairs_end_frame ()
+{
+    gui_color_pairs_frame++;
+}
+
+/*
+ * Checks if the number of available pairs (pairs not used or that can be
+ * reused) is lower or equal to the limit set in option
+ * weechat.look.color_pairs_auto_reset; if so, an auto reset of pairs is asked.
+ */
+
+void
+gui_color_pairs_check_auto_reset ()
+{
+    int available, count;
+
+    if ((gui_color_num_pairs <= 1) || gui_color_pairs_auto_reset_pending
+        || (CONFIG_INTEGER(config_look_color_pairs_auto_reset) < 0))
+        return;
+
+    available = gui_color_num_pairs - gui_color_pairs_used;
+    if (available > CONFIG_INTEGER(config_look_color_pairs_auto_reset))
+        return;
+
+    gui_color_pairs_search_lru (&count);
+    if (available + count <= CONFIG_INTEGER(config_look_color_pairs_auto_reset))
+        gui_color_pairs_auto_reset = 1;
+}
+
 /*
  * Gets a pair with given foreground/background colors.
  *
- * If no pair is found for fg/bg, a new pair is created.
+ * If no pair is found for fg/bg, a new pair is created; if table of pairs is
+ * full, the least recently used pair not displayed on screen is reused (so
+ * that no full refresh of screen is needed).
  *
  * Returns a value between 0 and COLOR_PAIRS-1.
  */
@@ -376,7 +493,7 @@ gui_color_timer_warning_pairs_full (void *data, int remaining_calls)
 int
 gui_color_get_pair (int fg, int bg)
 {
-    int index;
+    int index, pair;
 
     /* only one color when displaying terminal colors */
     if (gui_color_use_term_colors)
@@ -396,31 +513,47 @@ gui_color_get_pair (int fg, int bg)
     {
         if (gui_color_pairs_used >= gui_color_num_pairs)
         {
-            /* oh no, no more pair available! */
-            if (!gui_color_warning_pairs_full
-                && (CONFIG_INTEGER(config_look_color_pairs_auto_reset) < 0))
+            /* no more pair available: try to reuse an old pair */
+            pair = gui_color_pairs_search_lru (NULL);
+            if (pair == 0)
             {
-                /* display warning if auto reset of pairs is disabled */
-                hook_timer (NULL, 1, 0, 1,
-                            &gui_color_timer_warning_pairs_full, NULL);
-                gui_color_warning_pairs_full = 1;
+                /* oh no, no pair can be reused! */
+                if (CONFIG_INTEGER(config_look_color_pairs_auto_reset) >= 0)
+                {
+                    if (!gui_color_pairs_auto_reset_pending)
+                        gui_color_pairs_auto_reset = 1;
+                }
+                else if (!gui_color_warning_pairs_full)
+                {
+                    /* display warning if auto reset of pairs is disabled */
+                    hook_timer (NULL, 1, 0, 1,
+                                &gui_color_timer_warning_pairs_full, NULL);
+                    gui_color_warning_pairs_full = 1;
+                }
+                return 1;
             }
-            return 1;
+            gui_color_pairs[gui_color_pairs_index[pair]] = 0;
+            gui_color_pairs_recycled++;
         }
-
-        /* create a new pair if no pair exists for this fg/bg */
-        gui_color_pairs_used++;
-        gui_color_pairs[index] = gui_color_pairs_used;
-        init_pair (gui_color_pairs_used, fg, bg);
-        if ((gui_color_num_pairs > 1) && !gui_color_pairs_auto_reset_pending
-            && (CONFIG_INTEGER(config_look_color_pairs_auto_reset) >= 0)
-            && (gui_color_num_pairs - gui_color_pairs_used <= CONFIG_INTEGER(config_look_color_pairs_auto_reset)))
+        else
         {
-            gui_color_pairs_auto_reset = 1;
+            /* create a new pair if no pair exists for this fg/bg */
+            gui_color_pairs_used++;
+            pair = gui_color_pairs_used;
         }
+        gui_color_pairs[index] = pair;
+        if (gui_color_pairs_index)
+            gui_color_pairs_index[pair] = index;
+        init_pair (pair, fg, bg);
+        if (gui_color_pairs_last_used)
+            gui_color_pairs_last_used[pair] = gui_color_pairs_frame;
+        gui_color_pairs_check_auto_reset ();
         gui_color_buffer_refresh_needed = 1;
     }
 
+    if (gui_color_pairs_last_used)
+        gui_color_pairs_last_used[gui_color_pairs[index]] = gui_color_pairs_frame;
+
     return gui_color_pairs[index];
 }
 
@@ -551,6 +684,53 @@ gui_color_build (int number, int foreground, int background)
     }
 }
 
+/*
+ * Allocates arrays used to reuse least recently used pairs (when table of
+ * pairs is full).
+ */
+
+void
+gui_color_alloc_pairs_lru ()
+{
+    gui_color_pairs_index = calloc (gui_color_num_pairs + 1,
+                                    sizeof (gui_color_pairs_index[0]));
+    gui_color_pairs_last_used = calloc (gui_color_num_pairs + 1,
+                                        sizeof (gui_color_pairs_last_used[0]));
+    gui_color_pairs_displayed = calloc (gui_color_num_pairs + 1,
+                                        sizeof (gui_color_pairs_displayed[0]));
+    gui_color_pairs_displayed_frame = 0;
+}
+
+/*
+ * Frees table of pairs and arrays used to reuse pairs.
+ */
+
+void
+gui_color_free_pairs ()
+{
+    if (gui_color_pairs)
+    {
+        free (gui_color_pairs);
+        gui_color_pairs = NULL;
+    }
+    if (gui_color_pairs_index)
+    {
+        free (gui_color_pairs_index);
+        gui_color_pairs_index = NULL;
+    }
+    if (gui_color_pairs_last_used)
+    {
+        free (gui_color_pairs_last_used);
+        gui_color_pairs_last_used = NULL;
+    }
+    if (gui_color_pairs_displayed)
+    {
+        free (gui_color_pairs_displayed);
+        gui_color_pairs_displayed = NULL;
+    }
+    gui_color_pairs_used = 0;
+}
+
 /*
  * Initializes color variables using terminal infos.
  */
@@ -565,12 +745,7 @@ gui_color_init_vars ()
     gui_color_term_color_pairs = 0;
     gui_color_term_can_change_color = 0;
     gui_color_num_pairs = 63;
-    if (gui_color_pairs)
-    {
-        free (gui_color_pairs);
-        gui_color_pairs = NULL;
-    }
-    gui_color_pairs_used = 0;
+    gui_color_free_pairs ();
 
     if (gui_color_term_has_colors)
     {
@@ -587,6 +762,7 @@ gui_color_init_vars ()
         if (gui_color_pairs)
             memset (gui_color_pairs, 0, size);
         gui_color_pairs_used = 0;
+        gui_color_alloc_pairs_lru ();
 
         /* reserved for future usage */
         /*
@@ -615,6 +791,7 @@ gui_color_init_vars ()
         if (gui_color_pairs)
             memset (gui_color_pairs, 0, size);
         gui_color_pairs_used = 0;
+        gui_color_alloc_pairs_lru ();
     }
 }
 
@@ -625,11 +802,7 @@ gui_color_init_vars ()
 void
 gui_color_free_vars ()
 {
-    if (gui_color_pairs)
-    {
-        free (gui_color_pairs);
-        gui_color_pairs = NULL;
-    }
+    gui_color_free_pairs ();
     if (gui_color_term_color_content)
     {
         free (gui_color_term_color_content);
@@ -1120,6 +1293,19 @@ gui_color_reset_pairs ()
                 (gui_color_term_colors + 2)
                 * (gui_color_term_colors + 2)
                 * sizeof (gui_color_pairs[0]));
+        if (gui_color_pairs_index)
+        {
+            memset (gui_color_pairs_index, 0,
+                    (gui_color_num_pairs + 1)
+                    * sizeof (gui_color_pairs_index[0]));
+        }
+        if (gui_color_pairs_last_used)
+        {
+            memset (gui_color_pairs_last_used, 0,
+                    (gui_color_num_pairs + 1)
+                    * sizeof (gui_color_pairs_last_used[0]));
+        }
+        gui_color_pairs_displayed_frame = 0;
         gui_color_pairs_used = 0;
         gui_color_warning_pairs_full = 0;
         gui_color_buffer_refresh_needed = 1;
@@ -1512,6 +1698,10 @@ gui_color_dump ()
                      _("WeeChat colors (in use: %d, left: %d):"),
                      gui_color_pairs_used,
                      gui_color_num_pairs - gui_color_pairs_used);
+    gui_chat_printf (NULL,
+                     _("  pairs reused: %d, current frame: %u"),
+                     gui_color_pairs_recycled,
+                     gui_color_pairs_frame);
     if (gui_color_pairs)
     {
         used = 0;
@@ -528,6 +528,9 @@ gui_key_read_cb (void *data, int fd)
     if (ret < 0)
         return WEECHAT_RC_OK;
 
+    /* display keys pressed without waiting for next frame */
+    gui_main_refresh_immediate = 1;
+
     for (i = 0; i < ret; i++)
     {
         /*
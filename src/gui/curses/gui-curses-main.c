@@ -29,6 +29,7 @@
 #include <string.h>
 #include <signal.h>
 #include <time.h>
+#include <sys/time.h>
 
 #include "../../core/weechat.h"
 #include "../../core/wee-command.h"
@@ -63,6 +64,9 @@
 int gui_signal_sigwinch_received = 0;  /* sigwinch signal (term resized)    */
 int gui_term_cols = 0;                 /* number of columns in terminal     */
 int gui_term_lines = 0;                /* number of lines in terminal       */
+int gui_main_refresh_immediate = 0;    /* 1 to refresh screen without       */
+                                       /* waiting for next frame (keyboard) */
+struct timeval gui_main_refresh_last;  /* time of last refresh of screen    */
 
 
 /*
@@ -79,6 +83,14 @@ gui_main_get_password (const char *prompt1, const char *prompt2,
 {
     int i, ch;
 
+    /* no terminal in headless mode: empty password */
+    if (weechat_headless)
+    {
+        if (size > 0)
+            password[0] = '\0';
+        return;
+    }
+
     initscr ();
     cbreak ();
     noecho ();
@@ -236,6 +248,7 @@ void
 gui_main_signal_sigwinch ()
 {
     gui_signal_sigwinch_received = 1;
+    gui_main_refresh_immediate = 1;
 
     gui_window_ask_refresh (2);
 }
@@ -285,8 +298,15 @@ gui_main_refreshs ()
                 gui_line_compute_buffer_max_length (ptr_buffer,
                                                     ptr_buffer->own_lines);
             }
-            if (ptr_buffer->own_lines->prefix_max_length_refresh)
+            /*
+             * own lines of a merged buffer are not displayed, so prefix max
+             * length is computed later (when buffer is unmerged)
+             */
+            if (ptr_buffer->own_lines->prefix_max_length_refresh
+                && (ptr_buffer->lines == ptr_buffer->own_lines))
+            {
                 gui_line_compute_prefix_max_length (ptr_buffer->own_lines);
+            }
         }
 
         /* compute buffer/prefix max length for mixed_lines */
@@ -356,12 +376,107 @@ gui_main_refreshs ()
             }
         }
 
+        /* update terminal with all windows/bars drawn */
+        gui_window_flush ();
+
         /* move cursor (for cursor mode) */
         if (gui_cursor_mode)
             gui_window_move_cursor ();
     }
 }
 
+/*
+ * Checks if something has to be drawn on screen (same checks as in function
+ * gui_main_refreshs).
+ *
+ * Returns:
+ *   1: a refresh of screen is pending
+ *   0: nothing to refresh
+ */
+
+int
+gui_main_refresh_pending ()
+{
+    struct t_gui_window *ptr_win;
+    struct t_gui_buffer *ptr_buffer;
+    struct t_gui_bar *ptr_bar;
+
+    if (gui_color_buffer_refresh_needed || gui_window_refresh_needed
+        || gui_color_pairs_auto_reset_pending)
+    {
+        return 1;
+    }
+
+    for (ptr_buffer = gui_buffers; ptr_buffer;
+         ptr_buffer = ptr_buffer->next_buffer)
+    {
+        if (ptr_buffer->chat_refresh_needed)
+            return 1;
+        /*
+         * prefix max length of own lines is computed only if buffer is not
+         * merged (see function gui_main_refreshs)
+         */
+        if (ptr_buffer->own_lines
+            && (ptr_buffer->own_lines->buffer_max_length_refresh
+                || (ptr_buffer->own_lines->prefix_max_length_refresh
+                    && (ptr_buffer->lines == ptr_buffer->own_lines))))
+        {
+            return 1;
+        }
+        if (ptr_buffer->mixed_lines
+            && (ptr_buffer->mixed_lines->buffer_max_length_refresh
+                || ptr_buffer->mixed_lines->prefix_max_length_refresh))
+        {
+            return 1;
+        }
+    }
+
+    for (ptr_bar = gui_bars; ptr_bar; ptr_bar = ptr_bar->next_bar)
+    {
+        if (ptr_bar->bar_refresh_needed)
+            return 1;
+    }
+
+    for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
+    {
+        if (ptr_win->refresh_needed)
+            return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * Returns the time to wait (in milliseconds) before next refresh of screen,
+ * according to option weechat.look.max_fps.
+ *
+ * Returns 0 if the screen can be refreshed now.
+ */
+
+long
+gui_main_refresh_delay ()
+{
+    struct timeval tv_now;
+    long interval, diff;
+
+    if (gui_main_refresh_immediate
+        || (CONFIG_INTEGER(config_look_max_fps) <= 0))
+    {
+        return 0;
+    }
+
+    interval = 1000 / CONFIG_INTEGER(config_look_max_fps);
+    if (interval <= 0)
+        return 0;
+
+    gettimeofday (&tv_now, NULL);
+    diff = util_timeval_diff (&gui_main_refresh_last, &tv_now);
+    if ((diff < 0) || (diff >= interval))
+        return 0;
+
+    return interval - diff;
+}
+
 /*
  * Main loop for WeeChat with ncurses GUI.
  */
@@ -373,14 +488,23 @@ gui_main_loop ()
     struct timeval tv_timeout;
     fd_set read_fds, write_fds, except_fds;
     int max_fd;
-    int ready;
+    int ready, refresh_delayed;
+    long refresh_delay;
 
-    /* catch SIGWINCH signal: redraw screen */
-    util_catch_signal (SIGWINCH, &gui_main_signal_sigwinch);
+    hook_fd_keyboard = NULL;
+    refresh_delay = 0;
+    refresh_delayed = 0;
 
-    /* hook stdin (read keyboard) */
-    hook_fd_keyboard = hook_fd (NULL, STDIN_FILENO, 1, 0, 0,
-                                &gui_key_read_cb, NULL);
+    /* no terminal (so no keyboard and no resize) in headless mode */
+    if (!weechat_headless)
+    {
+        /* catch SIGWINCH signal: redraw screen */
+        util_catch_signal (SIGWINCH, &gui_main_signal_sigwinch);
+
+        /* hook stdin (read keyboard) */
+        hook_fd_keyboard = hook_fd (NULL, STDIN_FILENO, 1, 0, 0,
+                                    &gui_key_read_cb, NULL);
+    }
 
     gui_window_ask_refresh (1);
 
@@ -398,9 +522,31 @@ gui_main_loop ()
             gui_color_pairs_auto_reset_pending = 1;
         }
 
-        gui_main_refreshs ();
-        if (gui_window_refresh_needed && !gui_window_bare_display)
-            gui_main_refreshs ();
+        /*
+         * nothing is drawn in daemon mode (nobody can see the screen);
+         * the screen is refreshed at most "max_fps" times per second: all
+         * changes done before next frame (for example many messages received
+         * during a flood) are displayed with a single refresh; if nothing has
+         * to be drawn, there's no need to wake up for next frame
+         */
+        refresh_delayed = 0;
+        if (!weechat_daemon)
+        {
+            refresh_delay = gui_main_refresh_delay ();
+            if (refresh_delay > 0)
+            {
+                if (gui_main_refresh_pending ())
+                    refresh_delayed = 1;
+            }
+            else
+            {
+                gui_main_refreshs ();
+                if (gui_window_refresh_needed && !gui_window_bare_display)
+                    gui_main_refreshs ();
+                gettimeofday (&gui_main_refresh_last, NULL);
+                gui_main_refresh_immediate = 0;
+            }
+        }
 
         if (gui_signal_sigwinch_received)
         {
@@ -409,7 +555,9 @@ gui_main_loop ()
             gui_signal_sigwinch_received = 0;
         }
 
-        gui_color_pairs_auto_reset_pending = 0;
+        /* color pairs are allocated again on next refresh of screen */
+        if (!refresh_delayed && (refresh_delay <= 0))
+            gui_color_pairs_auto_reset_pending = 0;
 
         /* wait for keyboard or network activity */
         FD_ZERO (&read_fds);
@@ -417,6 +565,14 @@ gui_main_loop ()
         FD_ZERO (&except_fds);
         max_fd = hook_fd_set (&read_fds, &write_fds, &except_fds);
         hook_timer_time_to_next (&tv_timeout);
+        if (refresh_delayed
+            && ((tv_timeout.tv_sec * 1000) + (tv_timeout.tv_usec / 1000)
+                > refresh_delay))
+        {
+            /* wake up for next frame (to refresh screen) */
+            tv_timeout.tv_sec = refresh_delay / 1000;
+            tv_timeout.tv_usec = (refresh_delay % 1000) * 1000;
+        }
         ready = select (max_fd + 1, &read_fds, &write_fds, &except_fds,
                         &tv_timeout);
         if (ready > 0)
@@ -426,7 +582,8 @@ gui_main_loop ()
     }
 
     /* remove keyboard hook */
-    unhook (hook_fd_keyboard);
+    if (hook_fd_keyboard)
+        unhook (hook_fd_keyboard);
 }
 
 /*
@@ -445,8 +602,9 @@ gui_main_end (int clean_exit)
          * final refreshs, to see messages just before exiting
          * (if we are upgrading, don't refresh anything!)
          */
-        if (!weechat_upgrading)
+        if (!weechat_upgrading && !weechat_daemon)
         {
+            gui_bar_item_update_flush ();
             gui_main_refreshs ();
             if (gui_window_refresh_needed)
                 gui_main_refreshs ();
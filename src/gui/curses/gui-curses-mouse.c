@@ -88,7 +88,8 @@ void
 gui_mouse_enable ()
 {
     gui_mouse_enabled = 1;
-    fprintf (stderr, "\033[?1005h\033[?1000h\033[?1002h");
+    if (!weechat_headless)
+        fprintf (stderr, "\033[?1005h\033[?1000h\033[?1002h");
 }
 
 /*
@@ -99,7 +100,8 @@ void
 gui_mouse_disable ()
 {
     gui_mouse_enabled = 0;
-    fprintf (stderr, "\033[?1002l\033[?1000l\033[?1005l");
+    if (!weechat_headless)
+        fprintf (stderr, "\033[?1002l\033[?1000l\033[?1005l");
 }
 
 /*
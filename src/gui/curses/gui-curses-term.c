@@ -23,6 +23,8 @@
 #include "config.h"
 #endif
 
+#include "../../core/weechat.h"
+
 #ifdef HAVE_NCURSESW_CURSES_H
 #ifdef __sun
 #include <ncurses/term.h>
@@ -46,6 +48,10 @@ void
 gui_term_set_eat_newline_glitch (int value)
 {
 #ifdef HAVE_EAT_NEWLINE_GLITCH
+    /* no terminal in headless mode */
+    if (weechat_headless)
+        return;
+
     eat_newline_glitch = value;
 #else
     /* make C compiler happy */
@@ -30,6 +30,7 @@
 #include <ctype.h>
 #include <stdarg.h>
 #include <libgen.h>
+#include <fcntl.h>
 #include <sys/ioctl.h>
 #include <termios.h>
 
@@ -69,6 +70,15 @@ struct t_gui_window_saved_style gui_window_saved_style[GUI_WINDOW_MAX_SAVED_STYL
                                        /* circular list of saved styles     */
 int gui_window_saved_style_index = 0;  /* index in list of savec styles     */
 
+/* output to terminal (one refresh per frame) */
+int gui_window_flush_needed = 0;       /* 1 if windows must be flushed      */
+int gui_window_tty_bytes_available = 1; /* 0 if bytes written are unknown   */
+unsigned long gui_window_tty_frames = 0; /* number of frames flushed        */
+unsigned long gui_window_tty_bytes_frames = 0; /* frames measured (debug) */
+unsigned long long gui_window_tty_bytes_total = 0; /* bytes written to tty  */
+unsigned long gui_window_tty_bytes_last_frame = 0; /* bytes of last frame   */
+unsigned long gui_window_tty_bytes_max_frame = 0;  /* max bytes in a frame  */
+
 
 /*
  * Gets screen width (terminal width in chars for Curses).
@@ -134,6 +144,15 @@ gui_window_objects_init (struct t_gui_window *window)
         GUI_WINDOW_OBJECTS(window)->win_chat = NULL;
         GUI_WINDOW_OBJECTS(window)->win_separator_horiz = NULL;
         GUI_WINDOW_OBJECTS(window)->win_separator_vertic = NULL;
+        GUI_WINDOW_OBJECTS(window)->chat_lines = NULL;
+        GUI_WINDOW_OBJECTS(window)->chat_last_line = NULL;
+        GUI_WINDOW_OBJECTS(window)->chat_last_line_rows = 0;
+        GUI_WINDOW_OBJECTS(window)->chat_last_line_marker = 0;
+        GUI_WINDOW_OBJECTS(window)->chat_width = 0;
+        GUI_WINDOW_OBJECTS(window)->chat_height = 0;
+        GUI_WINDOW_OBJECTS(window)->chat_prefix_max_length = 0;
+        GUI_WINDOW_OBJECTS(window)->chat_buffer_max_length = 0;
+        GUI_WINDOW_OBJECTS(window)->chat_rows_generation = 0;
         return 1;
     }
     return 0;
@@ -151,6 +170,7 @@ gui_window_objects_free (struct t_gui_window *window, int free_separators)
         delwin (GUI_WINDOW_OBJECTS(window)->win_chat);
         GUI_WINDOW_OBJECTS(window)->win_chat = NULL;
     }
+    GUI_WINDOW_OBJECTS(window)->chat_last_line = NULL;
     if (free_separators)
     {
         if  (GUI_WINDOW_OBJECTS(window)->win_separator_horiz)
@@ -1255,6 +1275,9 @@ gui_window_switch_to_buffer (struct t_gui_window *window,
                                                        window->win_chat_width,
                                                        window->win_chat_y,
                                                        window->win_chat_x);
+        /* allow use of terminal scrolling when new lines are displayed */
+        if (GUI_WINDOW_OBJECTS(window)->win_chat)
+            idlok (GUI_WINDOW_OBJECTS(window)->win_chat, TRUE);
     }
     gui_window_draw_separators (window);
     gui_buffer_ask_chat_refresh (window->buffer, 2);
@@ -2349,6 +2372,95 @@ gui_window_refresh_screen (int full_refresh)
     gui_window_refresh_windows ();
 }
 
+/*
+ * Gets number of bytes written so far by current thread (only on Linux, with
+ * file /proc/thread-self/io).
+ *
+ * Returns number of bytes written, 0 if not available (in this case, variable
+ * "gui_window_tty_bytes_available" is set to 0).
+ */
+
+unsigned long long
+gui_window_tty_bytes_written ()
+{
+    int fd;
+    ssize_t num_read;
+    char buffer[512], *pos;
+    unsigned long long bytes;
+
+    if (!gui_window_tty_bytes_available)
+        return 0;
+
+    bytes = 0;
+    num_read = -1;
+    fd = open ("/proc/thread-self/io", O_RDONLY);
+    if (fd >= 0)
+    {
+        num_read = read (fd, buffer, sizeof (buffer) - 1);
+        close (fd);
+    }
+    if (num_read <= 0)
+    {
+        gui_window_tty_bytes_available = 0;
+        return 0;
+    }
+    buffer[num_read] = '\0';
+    pos = strstr (buffer, "wchar:");
+    if (!pos || (sscanf (pos + 6, "%llu", &bytes) != 1))
+    {
+        gui_window_tty_bytes_available = 0;
+        return 0;
+    }
+
+    return bytes;
+}
+
+/*
+ * Flushes to terminal all windows refreshed since the last flush.
+ *
+ * Windows and bars are only copied to the virtual screen when they are
+ * drawn (with "wnoutrefresh"), and terminal is updated once per frame by this
+ * function: the output to terminal is computed by ncurses only on the final
+ * content of screen.
+ *
+ * The number of bytes written is measured only if debug is enabled for core
+ * (reading it costs two system calls per frame).
+ */
+
+void
+gui_window_flush ()
+{
+    unsigned long long bytes_before, bytes_after;
+
+    if (!gui_window_flush_needed || gui_window_bare_display)
+        return;
+
+    gui_window_tty_frames++;
+
+    if (weechat_debug_core < 1)
+    {
+        refresh ();
+    }
+    else
+    {
+        bytes_before = gui_window_tty_bytes_written ();
+        refresh ();
+        bytes_after = gui_window_tty_bytes_written ();
+        gui_window_tty_bytes_frames++;
+        if (gui_window_tty_bytes_available && (bytes_after >= bytes_before))
+        {
+            gui_window_tty_bytes_last_frame = bytes_after - bytes_before;
+            gui_window_tty_bytes_total += gui_window_tty_bytes_last_frame;
+            if (gui_window_tty_bytes_last_frame > gui_window_tty_bytes_max_frame)
+                gui_window_tty_bytes_max_frame = gui_window_tty_bytes_last_frame;
+        }
+    }
+
+    gui_color_pairs_end_frame ();
+
+    gui_window_flush_needed = 0;
+}
+
 /*
  * Callback for bare display timer.
  */
@@ -2432,6 +2544,9 @@ gui_window_set_title (const char *title)
 {
     char *new_title, *envterm, *envshell, *shell, *shellname;
 
+    if (weechat_headless)
+        return;
+
     envterm = getenv ("TERM");
     if (!envterm)
         return;
@@ -2505,6 +2620,9 @@ gui_window_send_clipboard (const char *storage_unit, const char *text)
     char *text_base64;
     int length;
 
+    if (weechat_headless)
+        return;
+
     length = strlen (text);
     text_base64 = malloc ((length * 4) + 1);
     if (text_base64)
@@ -2527,6 +2645,9 @@ gui_window_set_bracketed_paste_mode (int enable)
     char *envterm, *envtmux;
     int tmux, screen;
 
+    if (weechat_headless)
+        return;
+
     envtmux = getenv ("TMUX");
     tmux = (envtmux && envtmux[0]);
 
@@ -2564,6 +2685,31 @@ gui_window_term_display_infos ()
     gui_chat_printf (NULL, _("Terminal infos:"));
     gui_chat_printf (NULL, _("  TERM='%s', size: %dx%d"),
                      getenv("TERM"), gui_term_cols, gui_term_lines);
+    if (!gui_window_tty_bytes_available)
+    {
+        gui_chat_printf (NULL,
+                         _("  frames: %lu, bytes written: unknown"),
+                         gui_window_tty_frames);
+    }
+    else if (gui_window_tty_bytes_frames == 0)
+    {
+        gui_chat_printf (NULL,
+                         _("  frames: %lu, bytes written: not measured "
+                           "(measured only with \"/debug set core 1\")"),
+                         gui_window_tty_frames);
+    }
+    else
+    {
+        gui_chat_printf (NULL,
+                         _("  frames: %lu, bytes written in %lu frames: %llu "
+                           "(last frame: %lu, max: %lu, average: %llu)"),
+                         gui_window_tty_frames,
+                         gui_window_tty_bytes_frames,
+                         gui_window_tty_bytes_total,
+                         gui_window_tty_bytes_last_frame,
+                         gui_window_tty_bytes_max_frame,
+                         gui_window_tty_bytes_total / gui_window_tty_bytes_frames);
+    }
 }
 
 /*
@@ -2578,4 +2724,13 @@ gui_window_objects_print_log (struct t_gui_window *window)
     log_printf ("    win_chat. . . . . . . : 0x%lx", GUI_WINDOW_OBJECTS(window)->win_chat);
     log_printf ("    win_separator_horiz . : 0x%lx", GUI_WINDOW_OBJECTS(window)->win_separator_horiz);
     log_printf ("    win_separator_vertic. : 0x%lx", GUI_WINDOW_OBJECTS(window)->win_separator_vertic);
+    log_printf ("    chat_lines. . . . . . : 0x%lx", GUI_WINDOW_OBJECTS(window)->chat_lines);
+    log_printf ("    chat_last_line. . . . : 0x%lx", GUI_WINDOW_OBJECTS(window)->chat_last_line);
+    log_printf ("    chat_last_line_rows . : %d",    GUI_WINDOW_OBJECTS(window)->chat_last_line_rows);
+    log_printf ("    chat_last_line_marker : %d",    GUI_WINDOW_OBJECTS(window)->chat_last_line_marker);
+    log_printf ("    chat_width. . . . . . : %d",    GUI_WINDOW_OBJECTS(window)->chat_width);
+    log_printf ("    chat_height . . . . . : %d",    GUI_WINDOW_OBJECTS(window)->chat_height);
+    log_printf ("    chat_prefix_max_length: %d",    GUI_WINDOW_OBJECTS(window)->chat_prefix_max_length);
+    log_printf ("    chat_buffer_max_length: %d",    GUI_WINDOW_OBJECTS(window)->chat_buffer_max_length);
+    log_printf ("    chat_rows_generation. : %u",    GUI_WINDOW_OBJECTS(window)->chat_rows_generation);
 }
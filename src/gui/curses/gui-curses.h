@@ -31,6 +31,7 @@
 #endif
 
 struct t_gui_buffer;
+struct t_gui_lines;
 struct t_gui_line;
 struct t_gui_window;
 struct t_gui_bar_window;
@@ -63,6 +64,18 @@ struct t_gui_window_curses_objects
     WINDOW *win_chat;               /* chat window (example: channel)       */
     WINDOW *win_separator_horiz;    /* horizontal separator (optional)      */
     WINDOW *win_separator_vertic;   /* vertical separator (optional)        */
+    /* content of chat window (to display only new lines at bottom) */
+    struct t_gui_lines *chat_lines; /* lines displayed in chat window       */
+    struct t_gui_line *chat_last_line; /* last line displayed on last row   */
+                                    /* (NULL if end of buffer is not        */
+                                    /* displayed at bottom of window)       */
+    int chat_last_line_rows;        /* rows of last line (with day change)  */
+    int chat_last_line_marker;      /* 1 if read marker is after last line  */
+    int chat_width;                 /* width of chat window                 */
+    int chat_height;                /* height of chat window                */
+    int chat_prefix_max_length;     /* "prefix_max_length" of lines         */
+    int chat_buffer_max_length;     /* "buffer_max_length" of lines         */
+    unsigned int chat_rows_generation; /* generation of rows (options)      */
 };
 
 struct t_gui_bar_window_curses_objects
@@ -80,6 +93,8 @@ extern int gui_color_pairs_auto_reset_pending;
 extern time_t gui_color_pairs_auto_reset_last;
 extern int gui_color_buffer_refresh_needed;
 extern int gui_window_current_emphasis;
+extern int gui_window_flush_needed;
+extern int gui_main_refresh_immediate;
 
 /* main functions */
 extern void gui_main_init ();
@@ -90,6 +105,7 @@ extern int gui_color_get_extended_attrs (int color);
 extern int gui_color_get_pair (int fg, int bg);
 extern int gui_color_weechat_get_pair (int weechat_color);
 extern void gui_color_alloc ();
+extern void gui_color_pairs_end_frame ();
 
 /* chat functions */
 extern void gui_chat_calculate_line_diff (struct t_gui_window *window,
@@ -138,5 +154,6 @@ extern void gui_window_hline (WINDOW *window, int x, int y, int width,
 extern void gui_window_vline (WINDOW *window, int x, int y, int height,
                               const char *string);
 extern void gui_window_set_title (const char *title);
+extern void gui_window_flush ();
 
 #endif /* WEECHAT_GUI_CURSES_H */
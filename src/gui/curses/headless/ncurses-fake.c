@@ -0,0 +1,606 @@
+/*
+ * ncurses-fake.c - fake ncurses lib (for headless mode and tests)
+ *
+ * Copyright (C) 2014 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * This lib implements the ncurses functions used by WeeChat, without any
+ * output: windows only keep their size and cursor position, and nothing is
+ * ever written on the terminal.
+ *
+ * The headers of ncurses are used (so that the WINDOW structure is the same
+ * as the one used by the Curses GUI), but macros are disabled: all functions
+ * are defined here.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#define NCURSES_NOMACROS 1
+
+#ifdef HAVE_NCURSESW_CURSES_H
+#include <ncursesw/ncurses.h>
+#ifdef __sun
+#include <ncurses/term.h>
+#else
+#include <ncursesw/term.h>
+#endif
+#elif HAVE_NCURSES_H
+#include <ncurses.h>
+#include <term.h>
+#else
+#include <curses.h>
+#include <term.h>
+#endif
+
+
+/* simulate a 80x25 terminal with 256 colors */
+#define NCURSES_FAKE_COLS   80
+#define NCURSES_FAKE_LINES  25
+#define NCURSES_FAKE_COLORS 256
+
+/* macros COLOR_PAIR and PAIR_NUMBER are disabled by NCURSES_NOMACROS */
+#define NCURSES_FAKE_COLOR_PAIR(n) (NCURSES_BITS((n), 0) & A_COLOR)
+#define NCURSES_FAKE_PAIR_NUMBER(a)                                     \
+    ((int)(((a) & A_COLOR) >> NCURSES_ATTR_SHIFT))
+
+WINDOW ncurses_fake_stdscr;
+WINDOW ncurses_fake_curscr;
+
+WINDOW *stdscr = &ncurses_fake_stdscr;
+WINDOW *curscr = &ncurses_fake_curscr;
+WINDOW *newscr = &ncurses_fake_curscr;
+int COLS = NCURSES_FAKE_COLS;
+int LINES = NCURSES_FAKE_LINES;
+int COLORS = 0;
+int COLOR_PAIRS = 0;
+chtype acs_map[128];
+TERMINAL *cur_term = NULL;
+
+
+/*
+ * Initializes a fake window with a size and position.
+ */
+
+void
+ncurses_fake_init_window (WINDOW *win, int nlines, int ncols,
+                          int begin_y, int begin_x)
+{
+    memset (win, 0, sizeof (*win));
+    win->_maxy = nlines - 1;
+    win->_maxx = ncols - 1;
+    win->_begy = begin_y;
+    win->_begx = begin_x;
+}
+
+/*
+ * Initializes screen.
+ */
+
+WINDOW *
+initscr ()
+{
+    ncurses_fake_init_window (&ncurses_fake_stdscr, LINES, COLS, 0, 0);
+    ncurses_fake_init_window (&ncurses_fake_curscr, LINES, COLS, 0, 0);
+    return stdscr;
+}
+
+/*
+ * Ends screen.
+ */
+
+int
+endwin ()
+{
+    return OK;
+}
+
+/*
+ * Resizes terminal.
+ */
+
+int
+resizeterm (int nlines, int ncols)
+{
+    if ((nlines > 0) && (ncols > 0))
+    {
+        LINES = nlines;
+        COLS = ncols;
+        ncurses_fake_init_window (&ncurses_fake_stdscr, LINES, COLS, 0, 0);
+        ncurses_fake_init_window (&ncurses_fake_curscr, LINES, COLS, 0, 0);
+    }
+    return OK;
+}
+
+/*
+ * Creates a new window.
+ */
+
+WINDOW *
+newwin (int nlines, int ncols, int begin_y, int begin_x)
+{
+    WINDOW *win;
+
+    win = malloc (sizeof (*win));
+    if (!win)
+        return NULL;
+
+    ncurses_fake_init_window (win,
+                              (nlines > 0) ? nlines : LINES - begin_y,
+                              (ncols > 0) ? ncols : COLS - begin_x,
+                              begin_y, begin_x);
+
+    return win;
+}
+
+/*
+ * Deletes a window.
+ */
+
+int
+delwin (WINDOW *win)
+{
+    if (!win)
+        return ERR;
+
+    if ((win != &ncurses_fake_stdscr) && (win != &ncurses_fake_curscr))
+        free (win);
+
+    return OK;
+}
+
+/*
+ * Moves cursor in a window.
+ */
+
+int
+wmove (WINDOW *win, int y, int x)
+{
+    if (!win)
+        return ERR;
+
+    win->_cury = y;
+    win->_curx = x;
+
+    return OK;
+}
+
+/*
+ * Turns on attributes.
+ */
+
+int
+wattr_on (WINDOW *win, attr_t attrs, void *opts)
+{
+    (void) opts;
+
+    if (!win)
+        return ERR;
+
+    win->_attrs |= attrs;
+
+    return OK;
+}
+
+/*
+ * Turns off attributes.
+ */
+
+int
+wattr_off (WINDOW *win, attr_t attrs, void *opts)
+{
+    (void) opts;
+
+    if (!win)
+        return ERR;
+
+    win->_attrs &= ~attrs;
+
+    return OK;
+}
+
+/*
+ * Gets attributes and color pair.
+ */
+
+int
+wattr_get (WINDOW *win, attr_t *attrs, NCURSES_PAIRS_T *pair, void *opts)
+{
+    (void) opts;
+
+    if (!win)
+        return ERR;
+
+    if (attrs)
+        *attrs = win->_attrs & ~A_COLOR;
+    if (pair)
+        *pair = NCURSES_FAKE_PAIR_NUMBER(win->_attrs);
+
+    return OK;
+}
+
+/*
+ * Sets attributes and color pair.
+ */
+
+int
+wattr_set (WINDOW *win, attr_t attrs, NCURSES_PAIRS_T pair, void *opts)
+{
+    (void) opts;
+
+    if (!win)
+        return ERR;
+
+    win->_attrs = (attrs & ~A_COLOR) | NCURSES_FAKE_COLOR_PAIR(pair);
+
+    return OK;
+}
+
+/*
+ * Sets color pair.
+ */
+
+int
+wcolor_set (WINDOW *win, NCURSES_PAIRS_T pair, void *opts)
+{
+    (void) opts;
+
+    if (!win)
+        return ERR;
+
+    win->_attrs = (win->_attrs & ~A_COLOR) | NCURSES_FAKE_COLOR_PAIR(pair);
+
+    return OK;
+}
+
+/*
+ * Changes attributes of chars in a window.
+ */
+
+int
+wchgat (WINDOW *win, int n, attr_t attr, NCURSES_PAIRS_T pair,
+        const void *opts)
+{
+    (void) win;
+    (void) n;
+    (void) attr;
+    (void) pair;
+    (void) opts;
+
+    return OK;
+}
+
+/*
+ * Sets background of a window.
+ */
+
+void
+wbkgdset (WINDOW *win, chtype ch)
+{
+    (void) win;
+    (void) ch;
+}
+
+/*
+ * Adds a string in a window.
+ */
+
+int
+waddnstr (WINDOW *win, const char *str, int n)
+{
+    (void) win;
+    (void) str;
+    (void) n;
+
+    return OK;
+}
+
+/*
+ * Prints a formatted string in a window.
+ */
+
+int
+mvwprintw (WINDOW *win, int y, int x, const char *fmt, ...)
+{
+    (void) fmt;
+
+    return wmove (win, y, x);
+}
+
+/*
+ * Draws a horizontal line in a window.
+ */
+
+int
+whline (WINDOW *win, chtype ch, int n)
+{
+    (void) win;
+    (void) ch;
+    (void) n;
+
+    return OK;
+}
+
+/*
+ * Draws a vertical line in a window.
+ */
+
+int
+wvline (WINDOW *win, chtype ch, int n)
+{
+    (void) win;
+    (void) ch;
+    (void) n;
+
+    return OK;
+}
+
+/*
+ * Gets char and attributes at cursor position in a window.
+ */
+
+chtype
+winch (WINDOW *win)
+{
+    (void) win;
+
+    return ' ';
+}
+
+/*
+ * Clears a window.
+ */
+
+int
+wclear (WINDOW *win)
+{
+    (void) win;
+
+    return OK;
+}
+
+/*
+ * Erases a window.
+ */
+
+int
+werase (WINDOW *win)
+{
+    (void) win;
+
+    return OK;
+}
+
+/*
+ * Clears a window from cursor to bottom.
+ */
+
+int
+wclrtobot (WINDOW *win)
+{
+    (void) win;
+
+    return OK;
+}
+
+/*
+ * Clears a window from cursor to end of line.
+ */
+
+int
+wclrtoeol (WINDOW *win)
+{
+    (void) win;
+
+    return OK;
+}
+
+/*
+ * Scrolls a window.
+ */
+
+int
+wscrl (WINDOW *win, int n)
+{
+    (void) win;
+    (void) n;
+
+    return OK;
+}
+
+/*
+ * Enables/disables scrolling in a window.
+ */
+
+int
+scrollok (WINDOW *win, bool bf)
+{
+    (void) win;
+    (void) bf;
+
+    return OK;
+}
+
+/*
+ * Enables/disables use of insert/delete line feature of terminal.
+ */
+
+int
+idlok (WINDOW *win, bool bf)
+{
+    (void) win;
+    (void) bf;
+
+    return OK;
+}
+
+/*
+ * Copies a window to virtual screen.
+ */
+
+int
+wnoutrefresh (WINDOW *win)
+{
+    (void) win;
+
+    return OK;
+}
+
+/*
+ * Refreshes a window on terminal.
+ */
+
+int
+wrefresh (WINDOW *win)
+{
+    (void) win;
+
+    return OK;
+}
+
+/*
+ * Reads a char (there is never any char to read).
+ */
+
+int
+wgetch (WINDOW *win)
+{
+    (void) win;
+
+    return ERR;
+}
+
+/*
+ * Sets non-blocking mode for read.
+ */
+
+int
+nodelay (WINDOW *win, bool bf)
+{
+    (void) win;
+    (void) bf;
+
+    return OK;
+}
+
+/*
+ * Sets cursor visibility.
+ */
+
+int
+curs_set (int visibility)
+{
+    (void) visibility;
+
+    return 1;  /* 0 == invisible, 1 == normal, 2 == very visible */
+}
+
+/*
+ * Sets cbreak mode.
+ */
+
+int
+cbreak ()
+{
+    return OK;
+}
+
+/*
+ * Sets raw mode.
+ */
+
+int
+raw ()
+{
+    return OK;
+}
+
+/*
+ * Disables echo of chars typed.
+ */
+
+int
+noecho ()
+{
+    return OK;
+}
+
+/*
+ * Checks if terminal has colors.
+ */
+
+bool
+has_colors ()
+{
+    return TRUE;
+}
+
+/*
+ * Checks if terminal can change colors.
+ */
+
+bool
+can_change_color ()
+{
+    /* not supported in WeeChat anyway */
+    return FALSE;
+}
+
+/*
+ * Starts colors.
+ */
+
+int
+start_color ()
+{
+    COLORS = NCURSES_FAKE_COLORS;
+    COLOR_PAIRS = NCURSES_FAKE_COLORS;
+
+    return OK;
+}
+
+/*
+ * Uses default colors of terminal (color -1).
+ */
+
+int
+use_default_colors ()
+{
+    return OK;
+}
+
+/*
+ * Initializes a color pair.
+ */
+
+int
+init_pair (NCURSES_PAIRS_T pair, NCURSES_COLOR_T f, NCURSES_COLOR_T b)
+{
+    (void) f;
+    (void) b;
+
+    if ((pair < 0) || (pair >= COLOR_PAIRS))
+        return ERR;
+
+    return OK;
+}
@@ -37,6 +37,7 @@
 #include "../core/wee-log.h"
 #include "../core/wee-string.h"
 #include "../core/wee-utf8.h"
+#include "../core/wee-util.h"
 #include "../plugins/plugin.h"
 #include "gui-bar-item.h"
 #include "gui-bar.h"
@@ -79,6 +80,8 @@ char *gui_bar_items_default_for_bars[][2] =
 };
 struct t_gui_bar_item_hook *gui_bar_item_hooks = NULL;
 struct t_hook *gui_bar_item_timer = NULL;
+struct t_hook *gui_bar_item_update_timer = NULL; /* timer for delayed       */
+                                                 /* updates of items        */
 
 struct t_hdata *gui_bar_item_hdata_bar_item = NULL;
 
@@ -357,11 +360,13 @@ gui_bar_item_get_vars (const char *item_name,
  * For example:  if item == "[time]"
  *               returns: color(delimiter) + "[" +
  *                        (value of item "time") + color(delimiter) + "]"
+ *
+ * Argument "extra_info" (can be NULL) is sent to the callback.
  */
 
 char *
 gui_bar_item_get_value (struct t_gui_bar *bar, struct t_gui_window *window,
-                        int item, int subitem)
+                        int item, int subitem, struct t_hashtable *extra_info)
 {
     char *item_value, delimiter_color[32], bar_color[32];
     char *result, str_attr[8];
@@ -391,7 +396,7 @@ gui_bar_item_get_value (struct t_gui_bar *bar, struct t_gui_window *window,
         {
             item_value = (ptr_item->build_callback) (ptr_item->build_callback_data,
                                                      ptr_item, window, buffer,
-                                                     NULL);
+                                                     extra_info);
         }
         if (item_value && !item_value[0])
         {
@@ -540,6 +545,9 @@ gui_bar_item_new (struct t_weechat_plugin *plugin, const char *name,
         new_bar_item->name = strdup (name);
         new_bar_item->build_callback = build_callback;
         new_bar_item->build_callback_data = build_callback_data;
+        new_bar_item->last_update.tv_sec = 0;
+        new_bar_item->last_update.tv_usec = 0;
+        new_bar_item->update_pending = 0;
 
         /* add bar item to bar items queue */
         new_bar_item->prev_item = last_gui_bar_item;
@@ -558,11 +566,12 @@ gui_bar_item_new (struct t_weechat_plugin *plugin, const char *name,
 }
 
 /*
- * Updates an item on all bars displayed on screen.
+ * Asks refresh of an item on all bars displayed on screen (the item is
+ * rebuilt on next refresh of bars).
  */
 
 void
-gui_bar_item_update (const char *item_name)
+gui_bar_item_update_bars (const char *item_name)
 {
     struct t_gui_bar *ptr_bar;
     struct t_gui_window *ptr_window;
@@ -605,6 +614,164 @@ gui_bar_item_update (const char *item_name)
     }
 }
 
+/*
+ * Updates all items with a delayed update.
+ *
+ * If "force" is 1, all items are updated, otherwise only items with the delay
+ * elapsed are updated.
+ *
+ * Returns the remaining time (in milliseconds) before next update, -1 if
+ * there is no more delayed update.
+ */
+
+long
+gui_bar_item_update_pending (int force)
+{
+    struct t_gui_bar_item *ptr_item;
+    struct timeval tv_now;
+    long delay, diff, next_update;
+
+    delay = CONFIG_INTEGER(config_look_bar_item_update_delay);
+    next_update = -1;
+
+    gettimeofday (&tv_now, NULL);
+
+    for (ptr_item = gui_bar_items; ptr_item; ptr_item = ptr_item->next_item)
+    {
+        if (!ptr_item->update_pending)
+            continue;
+        diff = util_timeval_diff (&ptr_item->last_update, &tv_now);
+        if (force || (diff < 0) || (diff >= delay))
+        {
+            ptr_item->update_pending = 0;
+            ptr_item->last_update = tv_now;
+            gui_bar_item_update_bars (ptr_item->name);
+        }
+        else if ((next_update < 0) || (delay - diff < next_update))
+        {
+            next_update = delay - diff;
+        }
+    }
+
+    return next_update;
+}
+
+/*
+ * Timer callback for delayed updates of items.
+ */
+
+int
+gui_bar_item_update_timer_cb (void *data, int remaining_calls)
+{
+    long next_update;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) remaining_calls;
+
+    /* timer is removed after this call (only one call) */
+    gui_bar_item_update_timer = NULL;
+
+    next_update = gui_bar_item_update_pending (0);
+    if (next_update >= 0)
+    {
+        gui_bar_item_update_timer = hook_timer (NULL,
+                                                (next_update > 0) ?
+                                                next_update : 1,
+                                                0, 1,
+                                                &gui_bar_item_update_timer_cb,
+                                                NULL);
+    }
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Schedules the timer for delayed updates of items: the timer is called when
+ * the first delayed update must be done.
+ */
+
+void
+gui_bar_item_update_schedule (long delay)
+{
+    if (gui_bar_item_update_timer)
+        return;
+
+    if (delay < 1)
+        delay = 1;
+
+    gui_bar_item_update_timer = hook_timer (NULL, delay, 0, 1,
+                                            &gui_bar_item_update_timer_cb,
+                                            NULL);
+}
+
+/*
+ * Updates an item on all bars displayed on screen.
+ *
+ * If the item was updated less than "weechat.look.bar_item_update_delay"
+ * milliseconds ago, the update is delayed: many updates of the item during
+ * this delay cause only one rebuild of the item (at the end of delay).
+ *
+ * Items "input_text" and "input_search" are always updated immediately, so
+ * that the input line follows the keys typed.
+ */
+
+void
+gui_bar_item_update (const char *item_name)
+{
+    struct t_gui_bar_item *ptr_item;
+    struct timeval tv_now;
+    long delay, diff;
+
+    if (!item_name)
+        return;
+
+    delay = CONFIG_INTEGER(config_look_bar_item_update_delay);
+    ptr_item = ((delay > 0)
+                && (strcmp (item_name,
+                            gui_bar_item_names[GUI_BAR_ITEM_INPUT_TEXT]) != 0)
+                && (strcmp (item_name,
+                            gui_bar_item_names[GUI_BAR_ITEM_INPUT_SEARCH]) != 0)) ?
+        gui_bar_item_search (item_name) : NULL;
+    if (!ptr_item)
+    {
+        gui_bar_item_update_bars (item_name);
+        return;
+    }
+
+    /* update already scheduled */
+    if (ptr_item->update_pending)
+        return;
+
+    gettimeofday (&tv_now, NULL);
+    diff = util_timeval_diff (&ptr_item->last_update, &tv_now);
+    if ((diff < 0) || (diff >= delay))
+    {
+        ptr_item->last_update = tv_now;
+        gui_bar_item_update_bars (item_name);
+        return;
+    }
+
+    /* too many updates: delay the update */
+    ptr_item->update_pending = 1;
+    gui_bar_item_update_schedule (delay - diff);
+}
+
+/*
+ * Updates immediately all items with a delayed update.
+ */
+
+void
+gui_bar_item_update_flush ()
+{
+    gui_bar_item_update_pending (1);
+    if (gui_bar_item_update_timer)
+    {
+        unhook (gui_bar_item_update_timer);
+        gui_bar_item_update_timer = NULL;
+    }
+}
+
 /*
  * Deletes a bar item.
  */
@@ -613,7 +780,7 @@ void
 gui_bar_item_free (struct t_gui_bar_item *item)
 {
     /* force refresh of bars displaying this bar item */
-    gui_bar_item_update (item->name);
+    gui_bar_item_update_bars (item->name);
 
     /* remove bar item from bar items list */
     if (item->prev_item)
@@ -905,8 +1072,6 @@ gui_bar_item_default_time (void *data, struct t_gui_bar_item *item,
                            struct t_gui_buffer *buffer,
                            struct t_hashtable *extra_info)
 {
-    time_t date;
-    struct tm *local_time;
     char text_time[128], text_time2[128];
 
     /* make C compiler happy */
@@ -916,11 +1081,9 @@ gui_bar_item_default_time (void *data, struct t_gui_bar_item *item,
     (void) buffer;
     (void) extra_info;
 
-    date = time (NULL);
-    local_time = localtime (&date);
-    if (strftime (text_time, sizeof (text_time),
-                  CONFIG_STRING(config_look_item_time_format),
-                  local_time) == 0)
+    if (util_strftime (text_time, sizeof (text_time),
+                       CONFIG_STRING(config_look_item_time_format),
+                       time (NULL)) == 0)
         return NULL;
 
     snprintf (text_time2, sizeof (text_time2), "%s%s",
@@ -1552,8 +1715,75 @@ gui_bar_item_default_buffer_title (void *data, struct t_gui_bar_item *item,
     return (buffer->title) ? strdup (buffer->title) : NULL;
 }
 
+/*
+ * Checks if a group or nick is displayed in nicklist.
+ *
+ * Returns:
+ *   1: group/nick is displayed
+ *   0: group/nick is not displayed
+ */
+
+int
+gui_bar_item_nicklist_displayed (struct t_gui_buffer *buffer,
+                                 struct t_gui_nick_group *group,
+                                 struct t_gui_nick *nick)
+{
+    if (nick)
+        return nick->visible;
+
+    return (group && buffer->nicklist_display_groups && group->visible) ?
+        1 : 0;
+}
+
+/*
+ * Gets next group or nick displayed in nicklist.
+ */
+
+void
+gui_bar_item_nicklist_get_next_displayed (struct t_gui_buffer *buffer,
+                                          struct t_gui_nick_group **group,
+                                          struct t_gui_nick **nick)
+{
+    gui_nicklist_get_next_item (buffer, group, nick);
+    while ((*group || *nick)
+           && !gui_bar_item_nicklist_displayed (buffer, *group, *nick))
+    {
+        gui_nicklist_get_next_item (buffer, group, nick);
+    }
+}
+
+/*
+ * Adds color of a group or nick in nicklist (color can be a color name or
+ * an option name).
+ */
+
+void
+gui_bar_item_nicklist_add_color (char *string, const char *color)
+{
+    struct t_config_option *ptr_option;
+
+    if (!color)
+        return;
+
+    if (strchr (color, '.'))
+    {
+        config_file_search_with_string (color, NULL, NULL, &ptr_option, NULL);
+        if (ptr_option)
+            strcat (string, gui_color_get_custom (gui_color_get_name (CONFIG_COLOR(ptr_option))));
+    }
+    else
+    {
+        strcat (string, gui_color_get_custom (color));
+    }
+}
+
 /*
  * Default item for nicklist.
+ *
+ * If "extra_info" contains "_bar_item_first_line" and "_bar_item_max_lines"
+ * (bar window displaying only this item), only these lines are returned, and
+ * the total number of lines and max length of lines are returned in
+ * "extra_info" ("_bar_item_lines" and "_bar_item_max_length").
  */
 
 char *
@@ -1562,131 +1792,136 @@ gui_bar_item_default_buffer_nicklist (void *data, struct t_gui_bar_item *item,
                                       struct t_gui_buffer *buffer,
                                       struct t_hashtable *extra_info)
 {
-    struct t_gui_nick_group *ptr_group;
-    struct t_gui_nick *ptr_nick;
-    struct t_config_option *ptr_option;
-    int i, length;
-    char *str_nicklist;
+    struct t_gui_nick_group *ptr_group, *start_group;
+    struct t_gui_nick *ptr_nick, *start_nick;
+    int i, length, first_line, max_lines, lines;
+    long number;
+    char *str_nicklist, *ptr_end, *error, str_value[32];
+    const char *ptr_value;
 
     /* make C compiler happy */
     (void) data;
     (void) item;
     (void) window;
-    (void) extra_info;
 
     if (!buffer)
         return NULL;
 
-    length = 1;
-    ptr_group = NULL;
-    ptr_nick = NULL;
-    gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
-    while (ptr_group || ptr_nick)
+    first_line = 0;
+    max_lines = -1;
+    if (extra_info)
     {
-        if ((ptr_nick && ptr_nick->visible)
-            || (ptr_group && !ptr_nick
-                && buffer->nicklist_display_groups
-                && ptr_group->visible))
+        ptr_value = hashtable_get (extra_info, "_bar_item_first_line");
+        if (ptr_value)
         {
-            if (ptr_nick)
-                length += ptr_nick->group->level + 16 /* color */
-                    + ((ptr_nick->prefix) ? strlen (ptr_nick->prefix) : 0)
-                    + 16 /* color */
-                    + strlen (ptr_nick->name) + 1;
-            else
-                length += ptr_group->level - 1
-                    + 16 /* color */
-                    + strlen (gui_nicklist_get_group_start (ptr_group->name))
-                    + 1;
+            error = NULL;
+            number = strtol (ptr_value, &error, 10);
+            if (error && !error[0] && (number >= 0))
+                first_line = number;
+        }
+        ptr_value = hashtable_get (extra_info, "_bar_item_max_lines");
+        if (ptr_value)
+        {
+            error = NULL;
+            number = strtol (ptr_value, &error, 10);
+            if (error && !error[0] && (number > 0))
+                max_lines = number;
+        }
+    }
+
+    /* get first group/nick displayed */
+    start_group = NULL;
+    start_nick = NULL;
+    if (max_lines > 0)
+    {
+        gui_nicklist_get_item_at_line (buffer, first_line,
+                                       &start_group, &start_nick);
+        snprintf (str_value, sizeof (str_value),
+                  "%d", buffer->nicklist_visible_count);
+        hashtable_set (extra_info, "_bar_item_lines", str_value);
+        snprintf (str_value, sizeof (str_value),
+                  "%d", buffer->nicklist_max_length);
+        hashtable_set (extra_info, "_bar_item_max_length", str_value);
+    }
+    else
+    {
+        gui_nicklist_get_next_item (buffer, &start_group, &start_nick);
+        if (!gui_bar_item_nicklist_displayed (buffer, start_group, start_nick))
+        {
+            gui_bar_item_nicklist_get_next_displayed (buffer,
+                                                      &start_group,
+                                                      &start_nick);
         }
-        gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
+    }
+
+    length = 1;
+    lines = 0;
+    ptr_group = start_group;
+    ptr_nick = start_nick;
+    while ((ptr_group || ptr_nick) && ((max_lines < 0) || (lines < max_lines)))
+    {
+        if (ptr_nick)
+            length += ptr_nick->group->level + 16 /* color */
+                + ((ptr_nick->prefix) ? strlen (ptr_nick->prefix) : 0)
+                + 16 /* color */
+                + strlen (ptr_nick->name) + 1;
+        else
+            length += ptr_group->level - 1
+                + 16 /* color */
+                + strlen (gui_nicklist_get_group_start (ptr_group->name))
+                + 1;
+        lines++;
+        gui_bar_item_nicklist_get_next_displayed (buffer,
+                                                  &ptr_group, &ptr_nick);
     }
 
     str_nicklist = malloc (length);
     if (str_nicklist)
     {
         str_nicklist[0] = '\0';
-        ptr_group = NULL;
-        ptr_nick = NULL;
-        gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
-        while (ptr_group || ptr_nick)
+        ptr_end = str_nicklist;
+        lines = 0;
+        ptr_group = start_group;
+        ptr_nick = start_nick;
+        while ((ptr_group || ptr_nick)
+               && ((max_lines < 0) || (lines < max_lines)))
         {
-            if ((ptr_nick && ptr_nick->visible)
-                || (ptr_group && !ptr_nick
-                    && buffer->nicklist_display_groups
-                    && ptr_group->visible))
-            {
-                if (str_nicklist[0])
-                    strcat (str_nicklist, "\n");
+            if (lines > 0)
+                strcat (ptr_end, "\n");
 
-                if (ptr_nick)
+            if (ptr_nick)
+            {
+                if (buffer->nicklist_display_groups)
                 {
-                    if (buffer->nicklist_display_groups)
+                    for (i = 0; i < ptr_nick->group->level; i++)
                     {
-                        for (i = 0; i < ptr_nick->group->level; i++)
-                        {
-                            strcat (str_nicklist, " ");
-                        }
+                        strcat (ptr_end, " ");
                     }
-                    if (ptr_nick->prefix_color)
-                    {
-                        if (strchr (ptr_nick->prefix_color, '.'))
-                        {
-                            config_file_search_with_string (ptr_nick->prefix_color,
-                                                            NULL, NULL, &ptr_option,
-                                                            NULL);
-                            if (ptr_option)
-                                strcat (str_nicklist, gui_color_get_custom (gui_color_get_name (CONFIG_COLOR(ptr_option))));
-                        }
-                        else
-                        {
-                            strcat (str_nicklist, gui_color_get_custom (ptr_nick->prefix_color));
-                        }
-                    }
-                    if (ptr_nick->prefix)
-                        strcat (str_nicklist, ptr_nick->prefix);
-                    if (ptr_nick->color)
-                    {
-                        if (strchr (ptr_nick->color, '.'))
-                        {
-                            config_file_search_with_string (ptr_nick->color,
-                                                            NULL, NULL, &ptr_option,
-                                                            NULL);
-                            if (ptr_option)
-                                strcat (str_nicklist, gui_color_get_custom (gui_color_get_name (CONFIG_COLOR(ptr_option))));
-                        }
-                        else
-                        {
-                            strcat (str_nicklist, gui_color_get_custom (ptr_nick->color));
-                        }
-                    }
-                    strcat (str_nicklist, ptr_nick->name);
                 }
-                else
+                gui_bar_item_nicklist_add_color (ptr_end,
+                                                 ptr_nick->prefix_color);
+                if (ptr_nick->prefix)
+                    strcat (ptr_end, ptr_nick->prefix);
+                gui_bar_item_nicklist_add_color (ptr_end, ptr_nick->color);
+                strcat (ptr_end, ptr_nick->name);
+            }
+            else
+            {
+                for (i = 0; i < ptr_group->level - 1; i++)
                 {
-                    for (i = 0; i < ptr_group->level - 1; i++)
-                    {
-                        strcat (str_nicklist, " ");
-                    }
-                    if (ptr_group->color)
-                    {
-                        if (strchr (ptr_group->color, '.'))
-                        {
-                            config_file_search_with_string (ptr_group->color,
-                                                            NULL, NULL, &ptr_option,
-                                                            NULL);
-                            if (ptr_option)
-                                strcat (str_nicklist, gui_color_get_custom (gui_color_get_name (CONFIG_COLOR(ptr_option))));
-                        }
-                        else
-                        {
-                            strcat (str_nicklist, gui_color_get_custom (ptr_group->color));
-                        }
-                    }
-                    strcat (str_nicklist, gui_nicklist_get_group_start (ptr_group->name));
+                    strcat (ptr_end, " ");
                 }
+                gui_bar_item_nicklist_add_color (ptr_end, ptr_group->color);
+                strcat (ptr_end,
+                        gui_nicklist_get_group_start (ptr_group->name));
             }
-            gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
+
+            /* next strcat will start at end of this line */
+            ptr_end += strlen (ptr_end);
+
+            lines++;
+            gui_bar_item_nicklist_get_next_displayed (buffer,
+                                                      &ptr_group, &ptr_nick);
         }
     }
 
@@ -1729,7 +1964,7 @@ gui_bar_item_focus_buffer_nicklist (void *data,
 {
     struct t_gui_nick_group *ptr_group;
     struct t_gui_nick *ptr_nick;
-    int i, rc, bar_item_line;
+    int rc, bar_item_line;
     unsigned long int value;
     const char *str_window, *str_buffer, *str_bar_item_line;
     struct t_gui_window *window;
@@ -1778,25 +2013,9 @@ gui_bar_item_focus_buffer_nicklist (void *data,
     if (!error || error[0])
         return NULL;
 
-    i = 0;
-    ptr_group = NULL;
-    ptr_nick = NULL;
-    gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
-    while (ptr_group || ptr_nick)
-    {
-        if ((ptr_nick && ptr_nick->visible)
-            || (ptr_group && !ptr_nick
-                && buffer->nicklist_display_groups
-                && ptr_group->visible))
-        {
-            if (i == bar_item_line)
-                break;
-            i++;
-        }
-        gui_nicklist_get_next_item (buffer, &ptr_group, &ptr_nick);
-    }
-
-    if (i != bar_item_line)
+    gui_nicklist_get_item_at_line (buffer, bar_item_line,
+                                   &ptr_group, &ptr_nick);
+    if (!ptr_group && !ptr_nick)
         return NULL;
 
     if (ptr_nick)
@@ -1820,19 +2039,15 @@ gui_bar_item_focus_buffer_nicklist (void *data,
 int
 gui_bar_item_timer_cb (void *data, int remaining_calls)
 {
-    time_t date;
-    struct tm *local_time;
     static char item_time_text[128] = { '\0' };
     char new_item_time_text[128];
 
     /* make C compiler happy */
     (void) remaining_calls;
 
-    date = time (NULL);
-    local_time = localtime (&date);
-    if (strftime (new_item_time_text, sizeof (new_item_time_text),
-                  CONFIG_STRING(config_look_item_time_format),
-                  local_time) == 0)
+    if (util_strftime (new_item_time_text, sizeof (new_item_time_text),
+                       CONFIG_STRING(config_look_item_time_format),
+                       time (NULL)) == 0)
         return WEECHAT_RC_OK;
 
     /*
@@ -2150,6 +2365,13 @@ gui_bar_item_end ()
         gui_bar_item_hooks = next_bar_item_hook;
     }
 
+    /* remove timer for delayed updates of items */
+    if (gui_bar_item_update_timer)
+    {
+        unhook (gui_bar_item_update_timer);
+        gui_bar_item_update_timer = NULL;
+    }
+
     /* remove bar items */
     gui_bar_item_free_all ();
 }
@@ -2233,6 +2455,10 @@ gui_bar_item_print_log ()
         log_printf ("  name . . . . . . . . . : '%s'",  ptr_item->name);
         log_printf ("  build_callback . . . . : 0x%lx", ptr_item->build_callback);
         log_printf ("  build_callback_data. . : 0x%lx", ptr_item->build_callback_data);
+        log_printf ("  last_update. . . . . . : %ld.%06ld",
+                    (long)(ptr_item->last_update.tv_sec),
+                    (long)(ptr_item->last_update.tv_usec));
+        log_printf ("  update_pending . . . . : %d", ptr_item->update_pending);
         log_printf ("  prev_item. . . . . . . : 0x%lx", ptr_item->prev_item);
         log_printf ("  next_item. . . . . . . : 0x%lx", ptr_item->next_item);
     }
@@ -20,6 +20,8 @@
 #ifndef WEECHAT_GUI_BAR_ITEM_H
 #define WEECHAT_GUI_BAR_ITEM_H 1
 
+#include <sys/time.h>
+
 enum t_gui_bar_item_weechat
 {
     GUI_BAR_ITEM_INPUT_PASTE = 0,
@@ -60,6 +62,9 @@ struct t_gui_bar_item
                             struct t_hashtable *extra_info);
                                      /* callback called for building item   */
     void *build_callback_data;       /* data for callback                   */
+    struct timeval last_update;      /* last update of item in bars         */
+    int update_pending;              /* 1 if update is delayed (too many    */
+                                     /* updates of item)                    */
     struct t_gui_bar_item *prev_item; /* link to previous bar item          */
     struct t_gui_bar_item *next_item; /* link to next bar item              */
 };
@@ -92,7 +97,8 @@ extern void gui_bar_item_get_vars (const char *item_name,
                                    char **suffix);
 extern char *gui_bar_item_get_value (struct t_gui_bar *bar,
                                      struct t_gui_window *window,
-                                     int item, int subitem);
+                                     int item, int subitem,
+                                     struct t_hashtable *extra_info);
 extern int gui_bar_item_count_lines (char *string);
 extern struct t_gui_bar_item *gui_bar_item_new (struct t_weechat_plugin *plugin,
                                                 const char *name,
@@ -103,6 +109,7 @@ extern struct t_gui_bar_item *gui_bar_item_new (struct t_weechat_plugin *plugin,
                                                                         struct t_hashtable *extra_info),
                                                 void *build_callback_data);
 extern void gui_bar_item_update (const char *name);
+extern void gui_bar_item_update_flush ();
 extern void gui_bar_item_free (struct t_gui_bar_item *item);
 extern void gui_bar_item_free_all ();
 extern void gui_bar_item_free_all_plugin (struct t_weechat_plugin *plugin);
@@ -30,6 +30,7 @@
 
 #include "../core/weechat.h"
 #include "../core/wee-config.h"
+#include "../core/wee-hashtable.h"
 #include "../core/wee-hdata.h"
 #include "../core/wee-infolist.h"
 #include "../core/wee-log.h"
@@ -562,6 +563,77 @@ gui_bar_window_content_free (struct t_gui_bar_window *bar_window)
     }
 }
 
+/*
+ * Checks if content of a bar window can be built only with lines displayed:
+ * this is possible for a bar with vertical filling displaying only the item
+ * "buffer_nicklist" (without prefix/suffix).
+ *
+ * Returns:
+ *   1: only lines displayed can be built
+ *   0: all lines must be built
+ */
+
+int
+gui_bar_window_content_virtual (struct t_gui_bar_window *bar_window)
+{
+    struct t_gui_bar *ptr_bar;
+
+    ptr_bar = bar_window->bar;
+
+    if (gui_bar_get_filling (ptr_bar) != GUI_BAR_FILLING_VERTICAL)
+        return 0;
+
+    if ((ptr_bar->items_count != 1) || (ptr_bar->items_subcount[0] != 1)
+        || (bar_window->items_count != 1)
+        || !bar_window->items_subcount
+        || (bar_window->items_subcount[0] != 1))
+    {
+        return 0;
+    }
+
+    if (!ptr_bar->items_name[0][0]
+        || ptr_bar->items_prefix[0][0] || ptr_bar->items_suffix[0][0])
+    {
+        return 0;
+    }
+
+    return (strcmp (ptr_bar->items_name[0][0],
+                    gui_bar_item_names[GUI_BAR_ITEM_BUFFER_NICKLIST]) == 0) ?
+        1 : 0;
+}
+
+/*
+ * Sets lines asked to item when only lines displayed are built (max_lines
+ * is 0 to build all lines).
+ *
+ * Items are rebuilt on next refresh if lines asked have changed.
+ */
+
+void
+gui_bar_window_content_set_virtual (struct t_gui_bar_window *bar_window,
+                                    int first_line, int max_lines)
+{
+    int i, j;
+
+    if ((first_line == bar_window->virtual_first_line)
+        && (max_lines == bar_window->virtual_max_lines))
+        return;
+
+    bar_window->virtual_first_line = first_line;
+    bar_window->virtual_max_lines = max_lines;
+
+    if (bar_window->items_refresh_needed)
+    {
+        for (i = 0; i < bar_window->items_count; i++)
+        {
+            for (j = 0; j < bar_window->items_subcount[i]; j++)
+            {
+                bar_window->items_refresh_needed[i][j] = 1;
+            }
+        }
+    }
+}
+
 /*
  * Builds content of an item for a bar window.
  */
@@ -571,6 +643,11 @@ gui_bar_window_content_build_item (struct t_gui_bar_window *bar_window,
                                    struct t_gui_window *window,
                                    int index_item, int index_subitem)
 {
+    struct t_hashtable *extra_info;
+    const char *ptr_lines, *ptr_max_length;
+    char str_value[32], *error1, *error2;
+    long lines, max_length;
+
     if (bar_window->items_content)
     {
         if (bar_window->items_content[index_item][index_subitem])
@@ -579,17 +656,64 @@ gui_bar_window_content_build_item (struct t_gui_bar_window *bar_window,
             bar_window->items_content[index_item][index_subitem] = NULL;
         }
         bar_window->items_num_lines[index_item][index_subitem] = 0;
+        bar_window->virtual_lines = -1;
 
         /* build item, but only if there's a buffer in window */
         if ((window && window->buffer)
             || (gui_current_window && gui_current_window->buffer))
         {
+            /* ask only lines displayed to item if possible */
+            extra_info = NULL;
+            if ((bar_window->virtual_max_lines > 0)
+                && gui_bar_window_content_virtual (bar_window))
+            {
+                extra_info = hashtable_new (32,
+                                            WEECHAT_HASHTABLE_STRING,
+                                            WEECHAT_HASHTABLE_STRING,
+                                            NULL,
+                                            NULL);
+                if (extra_info)
+                {
+                    snprintf (str_value, sizeof (str_value),
+                              "%d", bar_window->virtual_first_line);
+                    hashtable_set (extra_info, "_bar_item_first_line",
+                                   str_value);
+                    snprintf (str_value, sizeof (str_value),
+                              "%d", bar_window->virtual_max_lines);
+                    hashtable_set (extra_info, "_bar_item_max_lines",
+                                   str_value);
+                }
+            }
             bar_window->items_content[index_item][index_subitem] =
                 gui_bar_item_get_value (bar_window->bar, window,
-                                        index_item, index_subitem);
+                                        index_item, index_subitem,
+                                        extra_info);
             bar_window->items_num_lines[index_item][index_subitem] =
                 gui_bar_item_count_lines (bar_window->items_content[index_item][index_subitem]);
             bar_window->items_refresh_needed[index_item][index_subitem] = 0;
+            if (extra_info)
+            {
+                /* item has returned only lines asked? */
+                ptr_lines = hashtable_get (extra_info, "_bar_item_lines");
+                ptr_max_length = hashtable_get (extra_info,
+                                                "_bar_item_max_length");
+                if (ptr_lines && ptr_max_length)
+                {
+                    error1 = NULL;
+                    lines = strtol (ptr_lines, &error1, 10);
+                    error2 = NULL;
+                    max_length = strtol (ptr_max_length, &error2, 10);
+                    if (error1 && !error1[0] && error2 && !error2[0]
+                        && (lines >= 0) && (max_length >= 0))
+                    {
+                        bar_window->virtual_lines = lines;
+                        bar_window->virtual_max_length = max_length;
+                        bar_window->items_num_lines[index_item][index_subitem] =
+                            lines;
+                    }
+                }
+                hashtable_free (extra_info);
+            }
         }
     }
 }
@@ -1110,6 +1234,10 @@ gui_bar_window_new (struct t_gui_bar *bar, struct t_gui_window *window)
         new_bar_window->items_content = NULL;
         new_bar_window->items_num_lines = NULL;
         new_bar_window->items_refresh_needed = NULL;
+        new_bar_window->virtual_first_line = 0;
+        new_bar_window->virtual_max_lines = 0;
+        new_bar_window->virtual_lines = -1;
+        new_bar_window->virtual_max_length = 0;
         new_bar_window->screen_col_size = 0;
         new_bar_window->screen_lines = 0;
         new_bar_window->coords_count = 0;
@@ -1581,6 +1709,10 @@ gui_bar_window_print_log (struct t_gui_bar_window *bar_window)
             log_printf ("    items_content. . . . . . : 0x%lx", bar_window->items_content);
         }
     }
+    log_printf ("    virtual_first_line . . : %d", bar_window->virtual_first_line);
+    log_printf ("    virtual_max_lines. . . : %d", bar_window->virtual_max_lines);
+    log_printf ("    virtual_lines. . . . . : %d", bar_window->virtual_lines);
+    log_printf ("    virtual_max_length . . : %d", bar_window->virtual_max_length);
     log_printf ("    screen_col_size. . . . : %d", bar_window->screen_col_size);
     log_printf ("    screen_lines . . . . . : %d", bar_window->screen_lines);
     log_printf ("    coords_count . . . . . : %d", bar_window->coords_count);
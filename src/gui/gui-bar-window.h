@@ -48,6 +48,12 @@ struct t_gui_bar_window
     char ***items_content;          /* content for each (sub)item of bar    */
     int **items_num_lines;          /* number of lines for each (sub)item   */
     int **items_refresh_needed;     /* refresh needed for (sub)item?        */
+    int virtual_first_line;         /* first line asked to item, when only  */
+                                    /* lines displayed are built            */
+    int virtual_max_lines;          /* max lines asked (0 = all lines)      */
+    int virtual_lines;              /* total number of lines of item (-1 if */
+                                    /* content has all lines of item)       */
+    int virtual_max_length;         /* max length of lines of item          */
     int screen_col_size;            /* size of columns on screen            */
                                     /* (for filling with columns)           */
     int screen_lines;               /* number of lines on screen            */
@@ -73,6 +79,10 @@ extern void gui_bar_window_search_by_xy (struct t_gui_window *window,
                                          struct t_gui_buffer **buffer);
 extern void gui_bar_window_calculate_pos_size (struct t_gui_bar_window *bar_window,
                                                struct t_gui_window *window);
+extern int gui_bar_window_content_virtual (struct t_gui_bar_window *bar_window);
+extern void gui_bar_window_content_set_virtual (struct t_gui_bar_window *bar_window,
+                                                int first_line,
+                                                int max_lines);
 extern void gui_bar_window_content_build (struct t_gui_bar_window *bar_window,
                                           struct t_gui_window *window);
 extern char *gui_bar_window_content_get_with_filling (struct t_gui_bar_window *bar_window,
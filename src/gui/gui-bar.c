@@ -366,6 +366,44 @@ gui_bar_insert (struct t_gui_bar *bar)
     }
 }
 
+/*
+ * Compiles conditions of a bar (the special conditions "active", "inactive"
+ * and "nicklist" are not compiled).
+ */
+
+void
+gui_bar_set_conditions_eval (struct t_gui_bar *bar, const char *conditions)
+{
+    struct t_hashtable *options;
+
+    if (bar->conditions_eval)
+    {
+        eval_compiled_free (bar->conditions_eval);
+        bar->conditions_eval = NULL;
+    }
+
+    if (!conditions || !conditions[0]
+        || (string_strcasecmp (conditions, "active") == 0)
+        || (string_strcasecmp (conditions, "inactive") == 0)
+        || (string_strcasecmp (conditions, "nicklist") == 0))
+    {
+        return;
+    }
+
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL,
+                             NULL);
+    if (options)
+        hashtable_set (options, "type", "condition");
+
+    bar->conditions_eval = eval_compile (conditions, options);
+
+    if (options)
+        hashtable_free (options);
+}
+
 /*
  * Checks if bar must be displayed in window according to conditions.
  *
@@ -381,7 +419,7 @@ gui_bar_check_conditions_for_window (struct t_gui_bar *bar,
     int rc;
     char str_modifier[256], str_window[128], *str_displayed, *result;
     const char *conditions;
-    struct t_hashtable *pointers, *extra_vars, *options;
+    struct t_hashtable *pointers, *extra_vars;
 
     /* check bar condition(s) */
     conditions = CONFIG_STRING(bar->options[GUI_BAR_OPTION_CONDITIONS]);
@@ -426,15 +464,10 @@ gui_bar_check_conditions_for_window (struct t_gui_bar *bar,
             hashtable_set (extra_vars, "nicklist",
                            (window->buffer && window->buffer->nicklist) ? "1" : "0");
         }
-        options = hashtable_new (32,
-                                 WEECHAT_HASHTABLE_STRING,
-                                 WEECHAT_HASHTABLE_POINTER,
-                                 NULL,
-                                 NULL);
-        if (options)
-            hashtable_set (options, "type", "condition");
 
-        result = eval_expression (conditions, pointers, extra_vars, options);
+        if (!bar->conditions_eval)
+            gui_bar_set_conditions_eval (bar, conditions);
+        result = eval_exec (bar->conditions_eval, pointers, extra_vars);
 
         rc = eval_is_true (result);
         if (result)
@@ -443,8 +476,6 @@ gui_bar_check_conditions_for_window (struct t_gui_bar *bar,
             hashtable_free (pointers);
         if (extra_vars)
             hashtable_free (extra_vars);
-        if (options)
-            hashtable_free (options);
         if (!rc)
             return 0;
     }
@@ -958,9 +989,14 @@ gui_bar_config_change_priority (void *data, struct t_config_option *option)
 void
 gui_bar_config_change_conditions (void *data, struct t_config_option *option)
 {
+    struct t_gui_bar *ptr_bar;
+
     /* make C compiler happy */
     (void) data;
-    (void) option;
+
+    ptr_bar = gui_bar_search_with_option_name (option->name);
+    if (ptr_bar)
+        gui_bar_set_conditions_eval (ptr_bar, CONFIG_STRING(option));
 
     gui_window_ask_refresh (1);
 }
@@ -1568,6 +1604,7 @@ gui_bar_alloc (const char *name)
         new_bar->items_prefix = NULL;
         new_bar->items_name = NULL;
         new_bar->items_suffix = NULL;
+        new_bar->conditions_eval = NULL;
         new_bar->bar_window = NULL;
         new_bar->bar_refresh_needed = 0;
         new_bar->prev_bar = NULL;
@@ -1630,6 +1667,8 @@ gui_bar_new_with_options (const char *name,
     new_bar->items_name = NULL;
     new_bar->items_suffix = NULL;
     gui_bar_set_items_array (new_bar, CONFIG_STRING(items));
+    new_bar->conditions_eval = NULL;
+    gui_bar_set_conditions_eval (new_bar, CONFIG_STRING(conditions));
     new_bar->bar_window = NULL;
     new_bar->bar_refresh_needed = 1;
 
@@ -2201,6 +2240,8 @@ gui_bar_free (struct t_gui_bar *bar)
             config_file_option_free (bar->options[i]);
     }
     gui_bar_free_items_arrays (bar);
+    if (bar->conditions_eval)
+        eval_compiled_free (bar->conditions_eval);
 
     free (bar);
 }
@@ -2433,6 +2474,7 @@ gui_bar_print_log ()
                             ptr_bar->items_suffix[i][j]);
             }
         }
+        log_printf ("  conditions_eval. . . . : 0x%lx", ptr_bar->conditions_eval);
         log_printf ("  bar_window . . . . . . : 0x%lx", ptr_bar->bar_window);
         log_printf ("  bar_refresh_needed . . : %d",    ptr_bar->bar_refresh_needed);
         log_printf ("  prev_bar . . . . . . . : 0x%lx", ptr_bar->prev_bar);
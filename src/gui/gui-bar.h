@@ -23,6 +23,7 @@
 struct t_infolist;
 struct t_weechat_plugin;
 struct t_gui_window;
+struct t_eval_compiled;
 
 #define GUI_BAR_DEFAULT_NAME_INPUT    "input"
 #define GUI_BAR_DEFAULT_NAME_TITLE    "title"
@@ -91,6 +92,8 @@ struct t_gui_bar
     char ***items_prefix;               /* prefix for each (sub)item        */
     char ***items_name;                 /* name for each (sub)item          */
     char ***items_suffix;               /* suffix for each (sub)item        */
+    struct t_eval_compiled *conditions_eval; /* compiled conditions (NULL   */
+                                        /* if empty or special condition)   */
     struct t_gui_bar_window *bar_window; /* pointer to bar window           */
                                         /* (for type root only)             */
     int bar_refresh_needed;             /* refresh for bar is needed?       */
@@ -31,6 +31,7 @@
 #include <string.h>
 #include <signal.h>
 #include <time.h>
+#include <sys/time.h>
 #include <ctype.h>
 
 #include "../core/weechat.h"
@@ -79,7 +80,7 @@ char *gui_buffer_properties_get_integer[] =
 { "number", "layout_number", "layout_number_merge_order", "type", "notify",
   "num_displayed", "active", "hidden", "zoomed", "print_hooks_enabled",
   "day_change", "clear", "filter", "closing", "lines_hidden",
-  "prefix_max_length", "time_for_each_line", "nicklist",
+  "prefix_max_length", "time_for_each_line", "next_line_id", "nicklist",
   "nicklist_case_sensitive", "nicklist_max_length", "nicklist_display_groups",
   "nicklist_count", "nicklist_groups_count", "nicklist_nicks_count",
   "nicklist_visible_count", "input", "input_get_unknown_commands",
@@ -92,6 +93,7 @@ char *gui_buffer_properties_get_string[] =
 { "plugin", "name", "full_name", "short_name", "title", "input",
   "text_search_input", "highlight_words", "highlight_regex",
   "highlight_tags_restrict", "highlight_tags", "hotlist_max_level_nicks",
+  "line_id_epoch",
   NULL
 };
 char *gui_buffer_properties_get_pointer[] =
@@ -526,6 +528,46 @@ gui_buffer_input_buffer_init (struct t_gui_buffer *buffer)
     buffer->input_buffer_1st_display = 0;
 }
 
+/*
+ * Builds a new epoch for line ids of a buffer: a string with current time
+ * (seconds and microseconds), always different from previous epoch built
+ * (even if two buffers are created in the same microsecond).
+ *
+ * This epoch changes each time ids of lines start again at 0 (buffer created
+ * again with same name, restart of WeeChat), so that a client can detect that
+ * a line id it received before is not valid any more.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+gui_buffer_new_line_id_epoch ()
+{
+    static struct timeval last_epoch = { 0, 0 };
+    struct timeval tv_now;
+    char str_epoch[64];
+
+    gettimeofday (&tv_now, NULL);
+    if ((tv_now.tv_sec < last_epoch.tv_sec)
+        || ((tv_now.tv_sec == last_epoch.tv_sec)
+            && (tv_now.tv_usec <= last_epoch.tv_usec)))
+    {
+        tv_now = last_epoch;
+        tv_now.tv_usec++;
+        if (tv_now.tv_usec >= 1000000)
+        {
+            tv_now.tv_sec++;
+            tv_now.tv_usec = 0;
+        }
+    }
+    last_epoch = tv_now;
+
+    snprintf (str_epoch, sizeof (str_epoch),
+              "%ld.%06ld", (long)tv_now.tv_sec, (long)tv_now.tv_usec);
+
+    return strdup (str_epoch);
+}
+
 /*
  * Creates a new buffer in current window.
  *
@@ -614,12 +656,17 @@ gui_buffer_new (struct t_weechat_plugin *plugin,
     new_buffer->lines = new_buffer->own_lines;
     new_buffer->time_for_each_line = 1;
     new_buffer->chat_refresh_needed = 2;
+    new_buffer->chat_refresh_new_lines = 0;
+    new_buffer->next_line_id = 0;
+    new_buffer->line_id_epoch = gui_buffer_new_line_id_epoch ();
 
     /* nicklist */
     new_buffer->nicklist = 0;
     new_buffer->nicklist_case_sensitive = 0;
     new_buffer->nicklist_root = NULL;
     new_buffer->nicklist_max_length = 0;
+    new_buffer->nicklist_length_count = NULL;
+    new_buffer->nicklist_length_count_size = 0;
     new_buffer->nicklist_display_groups = 1;
     new_buffer->nicklist_count = 0;
     new_buffer->nicklist_groups_count = 0;
@@ -1004,6 +1051,8 @@ gui_buffer_get_integer (struct t_gui_buffer *buffer, const char *property)
             return buffer->lines->prefix_max_length;
         else if (string_strcasecmp (property, "time_for_each_line") == 0)
             return buffer->time_for_each_line;
+        else if (string_strcasecmp (property, "next_line_id") == 0)
+            return buffer->next_line_id;
         else if (string_strcasecmp (property, "nicklist") == 0)
             return buffer->nicklist;
         else if (string_strcasecmp (property, "nicklist_case_sensitive") == 0)
@@ -1084,6 +1133,8 @@ gui_buffer_get_string (struct t_gui_buffer *buffer, const char *property)
             return buffer->highlight_tags;
         else if (string_strcasecmp (property, "hotlist_max_level_nicks") == 0)
             return hashtable_get_string (buffer->hotlist_max_level_nicks, "keys_values");
+        else if (string_strcasecmp (property, "line_id_epoch") == 0)
+            return buffer->line_id_epoch;
         else if (string_strncasecmp (property, "localvar_", 9) == 0)
         {
             ptr_value = (const char *)hashtable_get (buffer->local_variables,
@@ -1125,6 +1176,26 @@ gui_buffer_ask_chat_refresh (struct t_gui_buffer *buffer, int refresh)
 {
     if (refresh > buffer->chat_refresh_needed)
         buffer->chat_refresh_needed = refresh;
+    if (refresh > 0)
+        buffer->chat_refresh_new_lines = 0;
+}
+
+/*
+ * Sets flag "chat_refresh_needed" after lines have been added at the end of
+ * buffer.
+ *
+ * If no other refresh was asked, the windows displaying the end of buffer can
+ * scroll and display only the new lines.
+ */
+
+void
+gui_buffer_ask_chat_refresh_new_lines (struct t_gui_buffer *buffer)
+{
+    if (buffer->chat_refresh_needed == 0)
+    {
+        buffer->chat_refresh_needed = 1;
+        buffer->chat_refresh_new_lines = 1;
+    }
 }
 
 /*
@@ -2620,9 +2691,9 @@ gui_buffer_close (struct t_gui_buffer *buffer)
     /* free all lines */
     gui_line_free_all (buffer);
     if (buffer->own_lines)
-        free (buffer->own_lines);
+        gui_lines_free (buffer->own_lines);
     if (buffer->mixed_lines)
-        free (buffer->mixed_lines);
+        gui_lines_free (buffer->mixed_lines);
 
     /* free some data */
     gui_buffer_undo_free_all (buffer);
@@ -2631,6 +2702,8 @@ gui_buffer_close (struct t_gui_buffer *buffer)
         gui_completion_free (buffer->completion);
     gui_nicklist_remove_all (buffer);
     gui_nicklist_remove_group (buffer, buffer->nicklist_root);
+    if (buffer->nicklist_length_count)
+        free (buffer->nicklist_length_count);
     if (buffer->hotlist_max_level_nicks)
         hashtable_free (buffer->hotlist_max_level_nicks);
     gui_key_free_all (&buffer->keys, &buffer->last_key,
@@ -2658,6 +2731,8 @@ gui_buffer_close (struct t_gui_buffer *buffer)
         regfree (buffer->text_search_regex_compiled);
         free (buffer->text_search_regex_compiled);
     }
+    if (buffer->line_id_epoch)
+        free (buffer->line_id_epoch);
     if (buffer->highlight_words)
         free (buffer->highlight_words);
     if (buffer->highlight_regex)
@@ -3976,6 +4051,9 @@ gui_buffer_hdata_buffer_cb (void *data, const char *hdata_name)
         HDATA_VAR(struct t_gui_buffer, lines, POINTER, 0, NULL, "lines");
         HDATA_VAR(struct t_gui_buffer, time_for_each_line, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, chat_refresh_needed, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, chat_refresh_new_lines, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, next_line_id, INTEGER, 0, NULL, NULL);
+        HDATA_VAR(struct t_gui_buffer, line_id_epoch, STRING, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist_case_sensitive, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_buffer, nicklist_root, POINTER, 0, NULL, "nick_group");
@@ -4162,6 +4240,10 @@ gui_buffer_add_to_infolist (struct t_infolist *infolist,
         return 0;
     if (!infolist_new_var_integer (ptr_item, "time_for_each_line", buffer->time_for_each_line))
         return 0;
+    if (!infolist_new_var_integer (ptr_item, "next_line_id", buffer->next_line_id))
+        return 0;
+    if (!infolist_new_var_string (ptr_item, "line_id_epoch", buffer->line_id_epoch))
+        return 0;
     if (!infolist_new_var_integer (ptr_item, "nicklist_case_sensitive", buffer->nicklist_case_sensitive))
         return 0;
     if (!infolist_new_var_integer (ptr_item, "nicklist_display_groups", buffer->nicklist_display_groups))
@@ -4375,10 +4457,15 @@ gui_buffer_print_log ()
         log_printf ("  lines . . . . . . . . . : 0x%lx", ptr_buffer->lines);
         log_printf ("  time_for_each_line. . . : %d",    ptr_buffer->time_for_each_line);
         log_printf ("  chat_refresh_needed . . : %d",    ptr_buffer->chat_refresh_needed);
+        log_printf ("  chat_refresh_new_lines. : %d",    ptr_buffer->chat_refresh_new_lines);
+        log_printf ("  next_line_id. . . . . . : %d",    ptr_buffer->next_line_id);
+        log_printf ("  line_id_epoch . . . . . : '%s'",  ptr_buffer->line_id_epoch);
         log_printf ("  nicklist. . . . . . . . : %d",    ptr_buffer->nicklist);
         log_printf ("  nicklist_case_sensitive : %d",    ptr_buffer->nicklist_case_sensitive);
         log_printf ("  nicklist_root . . . . . : 0x%lx", ptr_buffer->nicklist_root);
         log_printf ("  nicklist_max_length . . : %d",    ptr_buffer->nicklist_max_length);
+        log_printf ("  nicklist_length_count . : 0x%lx", ptr_buffer->nicklist_length_count);
+        log_printf ("  nicklist_length_count_size: %d",  ptr_buffer->nicklist_length_count_size);
         log_printf ("  nicklist_display_groups : %d",    ptr_buffer->nicklist_display_groups);
         log_printf ("  nicklist_count. . . . . : %d",    ptr_buffer->nicklist_count);
         log_printf ("  nicklist_groups_count . : %d",    ptr_buffer->nicklist_groups_count);
@@ -122,12 +122,21 @@ struct t_gui_buffer
     int time_for_each_line;            /* time is displayed for each line?  */
     int chat_refresh_needed;           /* refresh for chat is needed ?      */
                                        /* (1=refresh, 2=erase+refresh)      */
+    int chat_refresh_new_lines;        /* 1 if refresh is needed only for   */
+                                       /* new lines added at end of buffer  */
+    int next_line_id;                  /* id of next line (incremented for  */
+                                       /* each line added, never reused)    */
+    char *line_id_epoch;               /* epoch of line ids: unique string, */
+                                       /* changed when ids restart at 0     */
 
     /* nicklist */
     int nicklist;                      /* = 1 if nicklist is enabled        */
     int nicklist_case_sensitive;       /* nicks are case sensitive ?        */
     struct t_gui_nick_group *nicklist_root; /* pointer to groups root       */
     int nicklist_max_length;           /* max length for a nick             */
+    int *nicklist_length_count;        /* number of nicks/groups displayed  */
+                                       /* for each length                   */
+    int nicklist_length_count_size;    /* size of nicklist_length_count     */
     int nicklist_display_groups;       /* display groups ?                  */
     int nicklist_count;                /* number of nicks/groups            */
     int nicklist_groups_count;         /* number of groups                  */
@@ -239,6 +248,7 @@ extern const char *gui_buffer_get_short_name (struct t_gui_buffer *buffer);
 extern void gui_buffer_build_full_name (struct t_gui_buffer *buffer);
 extern void gui_buffer_notify_set_all ();
 extern void gui_buffer_input_buffer_init (struct t_gui_buffer *buffer);
+extern char *gui_buffer_new_line_id_epoch ();
 extern struct t_gui_buffer *gui_buffer_new (struct t_weechat_plugin *plugin,
                                             const char *name,
                                             int (*input_callback)(void *data,
@@ -266,6 +276,7 @@ extern void *gui_buffer_get_pointer (struct t_gui_buffer *buffer,
                                      const char *property);
 extern void gui_buffer_ask_chat_refresh (struct t_gui_buffer *buffer,
                                          int refresh);
+extern void gui_buffer_ask_chat_refresh_new_lines (struct t_gui_buffer *buffer);
 extern void gui_buffer_set_title (struct t_gui_buffer *buffer,
                                   const char *new_title);
 extern void gui_buffer_set_highlight_words (struct t_gui_buffer *buffer,
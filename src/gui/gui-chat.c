@@ -38,6 +38,7 @@
 #include "../core/wee-hook.h"
 #include "../core/wee-string.h"
 #include "../core/wee-utf8.h"
+#include "../core/wee-util.h"
 #include "../plugins/plugin.h"
 #include "gui-chat.h"
 #include "gui-buffer.h"
@@ -55,10 +56,43 @@ int gui_chat_time_length = 0;    /* length of time for each line (in chars) */
 int gui_chat_mute = GUI_CHAT_MUTE_DISABLED;     /* mute mode                */
 struct t_gui_buffer *gui_chat_mute_buffer = NULL; /* mute buffer            */
 int gui_chat_display_tags = 0;                  /* display tags?            */
+unsigned int gui_chat_rows_generation = 1;      /* generation of rows of    */
+                                                /* lines (cache)            */
 char *gui_chat_lines_waiting_buffer = NULL;     /* lines waiting for core   */
                                                 /* buffer                   */
 
 
+/*
+ * Invalidates the rows of all lines (cached number of rows on screen): they
+ * will be computed again on next display.
+ */
+
+void
+gui_chat_rows_invalidate ()
+{
+    gui_chat_rows_generation++;
+    if (gui_chat_rows_generation == 0)
+        gui_chat_rows_generation = 1;
+}
+
+/*
+ * Callback for changes on WeeChat options: rows of lines can change with
+ * many options (time format, alignment, nick prefix/suffix, ...).
+ */
+
+int
+gui_chat_config_cb (void *data, const char *option, const char *value)
+{
+    /* make C compiler happy */
+    (void) data;
+    (void) option;
+    (void) value;
+
+    gui_chat_rows_invalidate ();
+
+    return WEECHAT_RC_OK;
+}
+
 /*
  * Initializes some variables for chat area (called before reading WeeChat
  * configuration file).
@@ -88,6 +122,9 @@ gui_chat_init ()
                   &gui_chat_hsignal_quote_line_cb, NULL);
     hook_hsignal (NULL, "chat_quote_message",
                   &gui_chat_hsignal_quote_line_cb, NULL);
+
+    /* rows of lines must be computed again if any WeeChat option is changed */
+    hook_config (NULL, "weechat.*", &gui_chat_config_cb, NULL);
 }
 
 /*
@@ -393,7 +430,6 @@ gui_chat_get_time_string (time_t date)
     char text_time[128], text_time2[(128*3)+16], text_time_char[2];
     char *text_with_color;
     int i, time_first_digit, time_last_digit, last_color;
-    struct tm *local_time;
 
     if (date == 0)
         return NULL;
@@ -402,12 +438,9 @@ gui_chat_get_time_string (time_t date)
         || !CONFIG_STRING(config_look_buffer_time_format)[0])
         return NULL;
 
-    local_time = localtime (&date);
-    if (!local_time)
-        return NULL;
-    if (strftime (text_time, sizeof (text_time),
-                  CONFIG_STRING(config_look_buffer_time_format),
-                  local_time) == 0)
+    if (util_strftime (text_time, sizeof (text_time),
+                       CONFIG_STRING(config_look_buffer_time_format),
+                       date) == 0)
         return NULL;
 
     if (strstr (text_time, "${"))
@@ -823,7 +856,7 @@ gui_chat_printf_date_tags (struct t_gui_buffer *buffer, time_t date,
     }
 
     if (gui_init_ok && at_least_one_message_printed)
-        gui_buffer_ask_chat_refresh (buffer, 1);
+        gui_buffer_ask_chat_refresh_new_lines (buffer);
 
 end:
     free (vbuffer);
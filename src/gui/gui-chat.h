@@ -60,6 +60,7 @@ extern int gui_chat_time_length;
 extern int gui_chat_mute;
 extern struct t_gui_buffer *gui_chat_mute_buffer;
 extern int gui_chat_display_tags;
+extern unsigned int gui_chat_rows_generation;
 
 /* chat functions */
 
@@ -89,6 +90,7 @@ extern void gui_chat_printf_date_tags (struct t_gui_buffer *buffer,
 extern void gui_chat_printf_y (struct t_gui_buffer *buffer, int y,
                                const char *message, ...);
 extern void gui_chat_print_lines_waiting_buffer (FILE *f);
+extern void gui_chat_rows_invalidate ();
 extern int gui_chat_hsignal_quote_line_cb (void *data, const char *signal,
                                            struct t_hashtable *hashtable);
 extern void gui_chat_end ();
@@ -104,5 +106,9 @@ extern char *gui_chat_string_next_char (struct t_gui_window *window,
 extern void gui_chat_draw (struct t_gui_buffer *buffer, int clear_chat);
 extern void gui_chat_draw_line (struct t_gui_buffer *buffer,
                                 struct t_gui_line *line);
+extern int gui_chat_get_line_rows (struct t_gui_window *window,
+                                   struct t_gui_line *line);
+extern void gui_chat_remove_line (struct t_gui_window *window,
+                                  struct t_gui_line *line);
 
 #endif /* WEECHAT_GUI_CHAT_H */
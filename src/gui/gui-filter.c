@@ -119,11 +119,14 @@ gui_filter_buffer (struct t_gui_buffer *buffer,
 {
     struct t_gui_line *ptr_line;
     struct t_gui_line_data *ptr_line_data;
+    struct t_gui_buffer *ptr_buffer;
     struct t_gui_window *ptr_window;
-    int lines_changed, line_displayed, lines_hidden;
+    int lines_changed, line_changed, line_displayed, lines_hidden;
+    int update_prefix;
 
     lines_changed = 0;
     lines_hidden = buffer->lines->lines_hidden;
+    update_prefix = 0;
 
     ptr_line = buffer->lines->first_line;
     while (ptr_line || line_data)
@@ -132,8 +135,16 @@ gui_filter_buffer (struct t_gui_buffer *buffer,
 
         line_displayed = gui_filter_check_line (ptr_line_data);
 
-        if (ptr_line_data->displayed != line_displayed)
+        line_changed = (ptr_line_data->displayed != line_displayed) ? 1 : 0;
+        if (line_changed)
         {
+            if (!lines_changed)
+            {
+                /* displayed lines are counted in index of lines */
+                gui_lines_index_invalidate (buffer->own_lines);
+                if (buffer->mixed_lines)
+                    gui_lines_index_invalidate (buffer->mixed_lines);
+            }
             lines_changed = 1;
             lines_hidden += (line_displayed) ? -1 : 1;
         }
@@ -143,13 +154,46 @@ gui_filter_buffer (struct t_gui_buffer *buffer,
         if (line_data)
             break;
 
+        /*
+         * update prefix length counted for the line if it is hidden/displayed,
+         * and for the next displayed line (its prefix depends on previous
+         * displayed line)
+         */
+        if (line_changed || update_prefix)
+        {
+            gui_line_prefix_length_update (buffer->lines, ptr_line);
+            if (line_changed)
+                update_prefix = 1;
+            else if (line_displayed)
+                update_prefix = 0;
+        }
+
         ptr_line = ptr_line->next_line;
     }
 
-    if (line_data)
-        line_data->buffer->lines->prefix_max_length_refresh = 1;
-    else
-        buffer->lines->prefix_max_length_refresh = 1;
+    if (lines_changed)
+    {
+        if (line_data)
+        {
+            /* line is not known in lines: compute again prefix max length */
+            buffer->own_lines->prefix_max_length_refresh = 1;
+            if (buffer->mixed_lines)
+                buffer->mixed_lines->prefix_max_length_refresh = 1;
+        }
+        else if (buffer->lines != buffer->own_lines)
+        {
+            /*
+             * buffer is merged: only mixed lines have been updated, so compute
+             * again prefix max length for own lines of merged buffers
+             */
+            for (ptr_buffer = gui_buffers; ptr_buffer;
+                 ptr_buffer = ptr_buffer->next_buffer)
+            {
+                if (ptr_buffer->number == buffer->number)
+                    ptr_buffer->own_lines->prefix_max_length_refresh = 1;
+            }
+        }
+    }
 
     if (buffer->lines->lines_hidden != lines_hidden)
     {
@@ -587,6 +587,45 @@ gui_input_search_text (struct t_gui_buffer *buffer)
     }
 }
 
+/*
+ * Searches for a given text in buffer (used by command /search): text search
+ * is started if needed, then the text is set in input and searched.
+ *
+ * Options "exact", "regex" and "where" are used if they are >= 0, otherwise
+ * the default values are used (options weechat.look.buffer_search_*).
+ */
+
+void
+gui_input_search_text_string (struct t_gui_buffer *buffer, const char *text,
+                              int exact, int regex, int where)
+{
+    struct t_gui_window *window;
+
+    if (!text || !text[0])
+        return;
+
+    window = gui_window_search_with_buffer (buffer);
+    if (!window)
+        return;
+
+    if (window->buffer->text_search == GUI_TEXT_SEARCH_DISABLED)
+        gui_window_search_start (window);
+    else
+        gui_input_delete_line (window->buffer);
+
+    gui_window_search_set_default_options (window->buffer);
+    if (exact >= 0)
+        window->buffer->text_search_exact = exact;
+    if (regex >= 0)
+        window->buffer->text_search_regex = regex;
+    if ((where > 0) && (window->buffer->type == GUI_BUFFER_TYPE_FORMATTED))
+        window->buffer->text_search_where = where;
+
+    gui_input_insert_string (window->buffer, text, -1);
+    gui_window_search_restart (window);
+    gui_input_search_signal (buffer);
+}
+
 /*
  * Compiles regex used to search text in buffer.
  */
@@ -44,6 +44,9 @@ extern void gui_input_return (struct t_gui_buffer *buffer);
 extern void gui_input_complete_next (struct t_gui_buffer *buffer);
 extern void gui_input_complete_previous (struct t_gui_buffer *buffer);
 extern void gui_input_search_text (struct t_gui_buffer *buffer);
+extern void gui_input_search_text_string (struct t_gui_buffer *buffer,
+                                          const char *text, int exact,
+                                          int regex, int where);
 extern void gui_input_search_compile_regex (struct t_gui_buffer *buffer);
 extern void gui_input_search_switch_case (struct t_gui_buffer *buffer);
 extern void gui_input_search_switch_regex (struct t_gui_buffer *buffer);
@@ -71,19 +71,814 @@ gui_lines_alloc ()
         new_lines->buffer_max_length_refresh = 0;
         new_lines->prefix_max_length = CONFIG_INTEGER(config_look_prefix_align_min);
         new_lines->prefix_max_length_refresh = 0;
+        new_lines->prefix_length_count = NULL;
+        new_lines->prefix_length_count_size = 0;
+        new_lines->index_lines = NULL;
+        new_lines->index_displayed = NULL;
+        new_lines->index_date_max = NULL;
+        new_lines->index_start = 0;
+        new_lines->index_end = 0;
+        new_lines->index_size = 0;
+        new_lines->index_valid = 0;
+        new_lines->index_last_unsorted = -1;
+        new_lines->search_text = NULL;
+        new_lines->search_exact = 0;
+        new_lines->search_where = 0;
+        new_lines->search_found = NULL;
+        new_lines->search_found_start = 0;
+        new_lines->search_found_end = 0;
+        new_lines->search_found_size = 0;
+        new_lines->search_first_line = NULL;
+        new_lines->search_last_line = NULL;
     }
 
     return new_lines;
 }
 
+/*
+ * Frees index of lines.
+ */
+
+void
+gui_lines_index_free (struct t_gui_lines *lines)
+{
+    if (lines->index_lines)
+    {
+        free (lines->index_lines);
+        lines->index_lines = NULL;
+    }
+    if (lines->index_displayed)
+    {
+        free (lines->index_displayed);
+        lines->index_displayed = NULL;
+    }
+    if (lines->index_date_max)
+    {
+        free (lines->index_date_max);
+        lines->index_date_max = NULL;
+    }
+    lines->index_start = 0;
+    lines->index_end = 0;
+    lines->index_size = 0;
+    lines->index_valid = 0;
+    lines->index_last_unsorted = -1;
+}
+
 /*
  * Frees a "t_gui_lines" structure.
  */
 
-void
-gui_lines_free (struct t_gui_lines *lines)
-{
-    free (lines);
+void
+gui_lines_free (struct t_gui_lines *lines)
+{
+    if (lines->prefix_length_count)
+        free (lines->prefix_length_count);
+    gui_lines_index_free (lines);
+    gui_lines_search_invalidate (lines);
+    free (lines);
+}
+
+/*
+ * Invalidates index of lines: it will be built again on next use.
+ *
+ * This function must be called when a line is inserted or removed in the
+ * middle of lines, or when the date or flag "displayed" of lines is changed
+ * (lines added at the end or removed at beginning are updated in index).
+ */
+
+void
+gui_lines_index_invalidate (struct t_gui_lines *lines)
+{
+    lines->index_valid = 0;
+}
+
+/*
+ * Resizes arrays of index of lines.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (not enough memory)
+ */
+
+int
+gui_lines_index_resize (struct t_gui_lines *lines, int new_size)
+{
+    struct t_gui_line **new_index_lines;
+    int *new_index_displayed;
+    time_t *new_index_date_max;
+
+    new_index_lines = realloc (lines->index_lines,
+                               new_size * sizeof (*new_index_lines));
+    if (!new_index_lines)
+        return 0;
+    lines->index_lines = new_index_lines;
+
+    new_index_displayed = realloc (lines->index_displayed,
+                                   new_size * sizeof (*new_index_displayed));
+    if (!new_index_displayed)
+        return 0;
+    lines->index_displayed = new_index_displayed;
+
+    new_index_date_max = realloc (lines->index_date_max,
+                                  new_size * sizeof (*new_index_date_max));
+    if (!new_index_date_max)
+        return 0;
+    lines->index_date_max = new_index_date_max;
+
+    lines->index_size = new_size;
+
+    return 1;
+}
+
+/*
+ * Moves lines at beginning of arrays in index of lines (lines removed at
+ * beginning leave unused positions in arrays).
+ */
+
+void
+gui_lines_index_compact (struct t_gui_lines *lines)
+{
+    int i, count, displayed_before;
+
+    if (lines->index_start == 0)
+        return;
+
+    count = lines->index_end - lines->index_start;
+    displayed_before = lines->index_displayed[lines->index_start - 1];
+
+    for (i = 0; i < count; i++)
+    {
+        lines->index_lines[i] = lines->index_lines[lines->index_start + i];
+        lines->index_lines[i]->index_pos = i;
+        lines->index_displayed[i] =
+            lines->index_displayed[lines->index_start + i] - displayed_before;
+        lines->index_date_max[i] =
+            lines->index_date_max[lines->index_start + i];
+    }
+
+    lines->index_last_unsorted =
+        (lines->index_last_unsorted >= lines->index_start) ?
+        lines->index_last_unsorted - lines->index_start : -1;
+    lines->index_start = 0;
+    lines->index_end = count;
+}
+
+/*
+ * Adds a line at the end of index of lines (if the index is up-to-date).
+ */
+
+void
+gui_lines_index_add (struct t_gui_lines *lines, struct t_gui_line *line)
+{
+    int pos, displayed;
+    time_t date_max;
+
+    line->index_pos = -1;
+
+    if (!lines->index_valid)
+        return;
+
+    if (lines->index_end >= lines->index_size)
+    {
+        if ((lines->index_start > 0)
+            && (lines->index_start >= lines->index_size / 2))
+        {
+            gui_lines_index_compact (lines);
+        }
+        else if (!gui_lines_index_resize (lines,
+                                          (lines->index_size < 64) ?
+                                          64 : lines->index_size * 2))
+        {
+            gui_lines_index_free (lines);
+            return;
+        }
+    }
+
+    pos = lines->index_end;
+    displayed = (pos > 0) ? lines->index_displayed[pos - 1] : 0;
+    date_max = (pos > 0) ? lines->index_date_max[pos - 1] : 0;
+
+    /* lines without date are ignored to check if dates are sorted */
+    if ((line->data->date != 0) && (line->data->date < date_max))
+        lines->index_last_unsorted = pos;
+
+    lines->index_lines[pos] = line;
+    lines->index_displayed[pos] = displayed +
+        ((line->data->displayed) ? 1 : 0);
+    lines->index_date_max[pos] = (line->data->date > date_max) ?
+        line->data->date : date_max;
+    line->index_pos = pos;
+
+    lines->index_end++;
+}
+
+/*
+ * Removes a line from index of lines (if the index is up-to-date).
+ *
+ * Only first and last lines can be removed from index, if another line is
+ * removed, the index is invalidated.
+ */
+
+void
+gui_lines_index_remove (struct t_gui_lines *lines, struct t_gui_line *line)
+{
+    if (!lines->index_valid)
+        return;
+
+    if (gui_lines_index_get_number (lines, line) < 0)
+    {
+        gui_lines_index_invalidate (lines);
+        return;
+    }
+
+    if (line->index_pos == lines->index_start)
+        lines->index_start++;
+    else if (line->index_pos == lines->index_end - 1)
+        lines->index_end--;
+    else
+    {
+        gui_lines_index_invalidate (lines);
+        return;
+    }
+
+    line->index_pos = -1;
+
+    if (lines->index_start == lines->index_end)
+    {
+        lines->index_start = 0;
+        lines->index_end = 0;
+        lines->index_last_unsorted = -1;
+    }
+}
+
+/*
+ * Builds index of lines (if it is not up-to-date).
+ *
+ * Returns:
+ *   1: index is up-to-date
+ *   0: error (not enough memory)
+ */
+
+int
+gui_lines_index_check (struct t_gui_lines *lines)
+{
+    struct t_gui_line *ptr_line;
+    int new_size;
+
+    if (lines->index_valid)
+        return 1;
+
+    new_size = ((lines->lines_count / 64) + 1) * 64;
+    if ((new_size > lines->index_size)
+        && !gui_lines_index_resize (lines, new_size))
+    {
+        gui_lines_index_free (lines);
+        return 0;
+    }
+
+    lines->index_start = 0;
+    lines->index_end = 0;
+    lines->index_last_unsorted = -1;
+    lines->index_valid = 1;
+
+    for (ptr_line = lines->first_line; ptr_line;
+         ptr_line = ptr_line->next_line)
+    {
+        gui_lines_index_add (lines, ptr_line);
+    }
+
+    return lines->index_valid;
+}
+
+/*
+ * Gets number of a line (0 for first line) using index of lines.
+ *
+ * Returns number of line, -1 if index is not up-to-date or if line is not in
+ * these lines.
+ */
+
+int
+gui_lines_index_get_number (struct t_gui_lines *lines,
+                            struct t_gui_line *line)
+{
+    if (!lines->index_valid || !line
+        || (line->index_pos < lines->index_start)
+        || (line->index_pos >= lines->index_end)
+        || (lines->index_lines[line->index_pos] != line))
+    {
+        return -1;
+    }
+
+    return line->index_pos - lines->index_start;
+}
+
+/*
+ * Gets a line by number (0 for first line) using index of lines.
+ *
+ * Returns pointer to line, NULL if not found.
+ */
+
+struct t_gui_line *
+gui_lines_index_get_line (struct t_gui_lines *lines, int number)
+{
+    if (!lines->index_valid || (number < 0)
+        || (number >= lines->index_end - lines->index_start))
+    {
+        return NULL;
+    }
+
+    return lines->index_lines[lines->index_start + number];
+}
+
+/*
+ * Counts displayed lines before a line number, using index of lines.
+ *
+ * Returns number of lines displayed before line "number" (if "number" is the
+ * number of lines, all displayed lines are counted).
+ */
+
+int
+gui_lines_index_count_displayed (struct t_gui_lines *lines, int number)
+{
+    int displayed_before;
+
+    if (!lines->index_valid || (number <= 0))
+        return 0;
+
+    if (number > lines->index_end - lines->index_start)
+        number = lines->index_end - lines->index_start;
+
+    /* all lines are displayed if filters are disabled */
+    if (!gui_filters_enabled)
+        return number;
+
+    displayed_before = (lines->index_start > 0) ?
+        lines->index_displayed[lines->index_start - 1] : 0;
+
+    return lines->index_displayed[lines->index_start + number - 1]
+        - displayed_before;
+}
+
+/*
+ * Gets a displayed line by rank (0 for first displayed line), using index of
+ * lines.
+ *
+ * Returns pointer to line, NULL if not found.
+ */
+
+struct t_gui_line *
+gui_lines_index_get_displayed (struct t_gui_lines *lines, int rank)
+{
+    int low, high, middle, displayed;
+
+    if (!lines->index_valid || (rank < 0)
+        || (lines->index_start == lines->index_end))
+    {
+        return NULL;
+    }
+
+    /* all lines are displayed if filters are disabled */
+    if (!gui_filters_enabled)
+        return gui_lines_index_get_line (lines, rank);
+
+    /* search first position with "rank + 1" lines displayed */
+    displayed = ((lines->index_start > 0) ?
+                 lines->index_displayed[lines->index_start - 1] : 0) + rank + 1;
+    low = lines->index_start;
+    high = lines->index_end - 1;
+    if (lines->index_displayed[high] < displayed)
+        return NULL;
+    while (low < high)
+    {
+        middle = low + ((high - low) / 2);
+        if (lines->index_displayed[middle] >= displayed)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    return lines->index_lines[low];
+}
+
+/*
+ * Checks if dates of lines are sorted (lines without date are ignored), using
+ * index of lines.
+ *
+ * Returns:
+ *   1: dates of lines are sorted
+ *   0: dates of lines are not sorted (or index is not up-to-date)
+ */
+
+int
+gui_lines_index_dates_sorted (struct t_gui_lines *lines)
+{
+    return (lines->index_valid
+            && (lines->index_last_unsorted < lines->index_start)) ? 1 : 0;
+}
+
+/*
+ * Searches the first line with a date greater than or equal to "date" (lines
+ * without date are ignored), using index of lines.
+ *
+ * The dates of lines must be sorted (see function
+ * gui_lines_index_dates_sorted).
+ *
+ * Returns pointer to line found, NULL if not found.
+ */
+
+struct t_gui_line *
+gui_lines_index_search_date (struct t_gui_lines *lines, time_t date)
+{
+    int low, high, middle;
+
+    if (!lines->index_valid || (lines->index_start == lines->index_end)
+        || (lines->index_date_max[lines->index_end - 1] < date))
+    {
+        return NULL;
+    }
+
+    low = lines->index_start;
+    high = lines->index_end - 1;
+    while (low < high)
+    {
+        middle = low + ((high - low) / 2);
+        if (lines->index_date_max[middle] >= date)
+            high = middle;
+        else
+            low = middle + 1;
+    }
+
+    /* skip lines without date (they have the max date of previous lines) */
+    while ((low < lines->index_end)
+           && (lines->index_lines[low]->data->date == 0))
+    {
+        low++;
+    }
+
+    return (low < lines->index_end) ? lines->index_lines[low] : NULL;
+}
+
+/*
+ * Invalidates cache of text search in lines: next search will check all
+ * lines again.
+ *
+ * This function must be called when a line is inserted or removed in the
+ * middle of lines, or when the prefix or message of a line is changed (lines
+ * added at the end or removed at beginning are updated in cache).
+ */
+
+void
+gui_lines_search_invalidate (struct t_gui_lines *lines)
+{
+    if (lines->search_text)
+    {
+        free (lines->search_text);
+        lines->search_text = NULL;
+    }
+    if (lines->search_found)
+    {
+        free (lines->search_found);
+        lines->search_found = NULL;
+    }
+    lines->search_exact = 0;
+    lines->search_where = 0;
+    lines->search_found_start = 0;
+    lines->search_found_end = 0;
+    lines->search_found_size = 0;
+    lines->search_first_line = NULL;
+    lines->search_last_line = NULL;
+}
+
+/*
+ * Adds a line found at beginning or end of lines found in cache of text
+ * search.
+ *
+ * When there is no room left in array, it is enlarged (if it is more than
+ * half full) and lines found are moved at the middle of array, so that lines
+ * can be added on both sides.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (not enough memory)
+ */
+
+int
+gui_lines_search_add_found (struct t_gui_lines *lines,
+                            struct t_gui_line *line, int at_start)
+{
+    struct t_gui_line **new_found;
+    int count, new_size, new_start;
+
+    if ((at_start && (lines->search_found_start == 0))
+        || (!at_start && (lines->search_found_end >= lines->search_found_size)))
+    {
+        count = lines->search_found_end - lines->search_found_start;
+        new_size = lines->search_found_size;
+        if (count + 1 > new_size / 2)
+        {
+            new_size = (new_size < 64) ? 64 : new_size * 2;
+            new_found = realloc (lines->search_found,
+                                 new_size * sizeof (*new_found));
+            if (!new_found)
+                return 0;
+            lines->search_found = new_found;
+            lines->search_found_size = new_size;
+        }
+        new_start = (new_size - count) / 2;
+        if (count > 0)
+        {
+            memmove (lines->search_found + new_start,
+                     lines->search_found + lines->search_found_start,
+                     count * sizeof (*lines->search_found));
+        }
+        lines->search_found_start = new_start;
+        lines->search_found_end = new_start + count;
+    }
+
+    if (at_start)
+    {
+        lines->search_found_start--;
+        lines->search_found[lines->search_found_start] = line;
+    }
+    else
+    {
+        lines->search_found[lines->search_found_end] = line;
+        lines->search_found_end++;
+    }
+
+    return 1;
+}
+
+/*
+ * Searches text in the line before first line searched (cache of text search
+ * is extended by one line).
+ *
+ * Returns:
+ *   1: line searched (text found or not in line)
+ *   0: no line searched (first line was already searched, or error)
+ */
+
+int
+gui_lines_search_check_prev (struct t_gui_lines *lines)
+{
+    struct t_gui_line *ptr_line;
+
+    if (!lines->search_first_line || !lines->search_first_line->prev_line)
+        return 0;
+
+    ptr_line = lines->search_first_line->prev_line;
+    if (gui_line_search_text_match (ptr_line, lines->search_text,
+                                    lines->search_exact, NULL,
+                                    lines->search_where)
+        && !gui_lines_search_add_found (lines, ptr_line, 1))
+    {
+        gui_lines_search_invalidate (lines);
+        return 0;
+    }
+    lines->search_first_line = ptr_line;
+
+    return 1;
+}
+
+/*
+ * Removes a line from cache of text search.
+ *
+ * Only the first line can be removed from cache (for example when the buffer
+ * is trimmed), if another line is removed, the cache is invalidated.
+ */
+
+void
+gui_lines_search_remove (struct t_gui_lines *lines, struct t_gui_line *line)
+{
+    if (!lines->search_text)
+        return;
+
+    if (line == lines->search_last_line)
+    {
+        gui_lines_search_invalidate (lines);
+        return;
+    }
+
+    if (line == lines->search_first_line)
+    {
+        if ((lines->search_found_start < lines->search_found_end)
+            && (lines->search_found[lines->search_found_start] == line))
+        {
+            lines->search_found_start++;
+        }
+        lines->search_first_line = line->next_line;
+        return;
+    }
+
+    /* a line not yet searched can only be removed at beginning of lines */
+    if (line != lines->first_line)
+        gui_lines_search_invalidate (lines);
+}
+
+/*
+ * Updates cache of text search in lines (lines where text is found, in
+ * prefix and/or message).
+ *
+ * Lines are searched from the end, only when needed (see function
+ * gui_lines_search_get_found), so the cache contains the lines found between
+ * the first and last lines searched:
+ *   - if the text or options have changed, the cache is emptied, unless the
+ *     new text contains the previous one (with same options): then only the
+ *     lines previously found are checked again (incremental search while the
+ *     user is typing text)
+ *   - lines added since last update are searched
+ *   - if "all_lines" is 1, all lines before first line searched are searched.
+ *
+ * The flag "displayed" of lines is not checked here (it must be checked when
+ * lines found are used).
+ *
+ * Returns:
+ *   1: cache is up-to-date
+ *   0: error (empty text or not enough memory)
+ */
+
+int
+gui_lines_search_update (struct t_gui_lines *lines, const char *text,
+                         int exact, int where, int all_lines)
+{
+    struct t_gui_line *ptr_line;
+    int i, count;
+
+    if (!text || !text[0] || !where)
+    {
+        gui_lines_search_invalidate (lines);
+        return 0;
+    }
+
+    if (lines->search_text
+        && (exact == lines->search_exact) && (where == lines->search_where)
+        && ((exact && strstr (text, lines->search_text))
+            || (!exact && string_strcasestr (text, lines->search_text))))
+    {
+        if (strcmp (text, lines->search_text) != 0)
+        {
+            /* text is longer: check again only lines previously found */
+            free (lines->search_text);
+            lines->search_text = strdup (text);
+            if (!lines->search_text)
+            {
+                gui_lines_search_invalidate (lines);
+                return 0;
+            }
+            count = lines->search_found_start;
+            for (i = lines->search_found_start; i < lines->search_found_end;
+                 i++)
+            {
+                if (gui_line_search_text_match (lines->search_found[i],
+                                                text, exact, NULL, where))
+                {
+                    lines->search_found[count] = lines->search_found[i];
+                    count++;
+                }
+            }
+            lines->search_found_end = count;
+        }
+    }
+    else
+    {
+        /* new search: lines will be searched from the end */
+        gui_lines_search_invalidate (lines);
+        lines->search_text = strdup (text);
+        if (!lines->search_text)
+            return 0;
+        lines->search_exact = exact;
+        lines->search_where = where;
+        /* only the last line is searched now */
+        lines->search_last_line = (lines->last_line) ?
+            lines->last_line->prev_line : NULL;
+    }
+
+    /* search lines added since last update */
+    ptr_line = (lines->search_last_line) ?
+        lines->search_last_line->next_line : lines->first_line;
+    while (ptr_line)
+    {
+        if (gui_line_search_text_match (ptr_line, text, exact, NULL, where)
+            && !gui_lines_search_add_found (lines, ptr_line, 0))
+        {
+            gui_lines_search_invalidate (lines);
+            return 0;
+        }
+        if (!lines->search_first_line)
+            lines->search_first_line = ptr_line;
+        lines->search_last_line = ptr_line;
+        ptr_line = ptr_line->next_line;
+    }
+
+    if (all_lines)
+    {
+        while (lines->search_first_line && lines->search_first_line->prev_line)
+        {
+            if (!gui_lines_search_check_prev (lines))
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Gets a displayed line found by last text search, before or after a line
+ * (the cache must be up-to-date, see function gui_lines_search_update).
+ *
+ * If line is NULL, the search starts at the end of lines (backward) or at
+ * beginning of lines (forward).
+ *
+ * Lines before the first line searched are searched only if needed (backward:
+ * until a displayed line is found, forward: all lines after "line").
+ *
+ * Returns pointer to line found, NULL if no line is found (or if the index of
+ * lines can not be built).
+ */
+
+struct t_gui_line *
+gui_lines_search_get_found (struct t_gui_lines *lines,
+                            struct t_gui_line *line, int backward)
+{
+    int number, target, low, high, middle, i;
+
+    if (!lines->search_text || !gui_lines_index_check (lines))
+        return NULL;
+
+    if (line)
+    {
+        number = gui_lines_index_get_number (lines, line);
+        if (number < 0)
+            return NULL;
+        target = (backward) ? number : number + 1;
+    }
+    else
+    {
+        target = (backward) ? lines->lines_count : 0;
+    }
+
+    if (!backward)
+    {
+        /* search lines not yet searched after "line" */
+        while (lines->search_first_line && lines->search_first_line->prev_line
+               && (gui_lines_index_get_number (lines,
+                                               lines->search_first_line) > target))
+        {
+            if (!gui_lines_search_check_prev (lines))
+                return NULL;
+        }
+    }
+
+    /* search position of first line found with number >= target */
+    low = lines->search_found_start;
+    high = lines->search_found_end;
+    while (low < high)
+    {
+        middle = low + ((high - low) / 2);
+        if (gui_lines_index_get_number (lines,
+                                        lines->search_found[middle]) < target)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    if (backward)
+    {
+        for (i = low - 1; i >= lines->search_found_start; i--)
+        {
+            if (gui_line_is_displayed (lines->search_found[i]))
+                return lines->search_found[i];
+        }
+
+        /* search lines not yet searched (before first line searched) */
+        while (lines->search_first_line && lines->search_first_line->prev_line)
+        {
+            if (!gui_lines_search_check_prev (lines))
+                return NULL;
+            if ((lines->search_found_start < lines->search_found_end)
+                && (lines->search_found[lines->search_found_start] == lines->search_first_line)
+                && gui_line_is_displayed (lines->search_first_line)
+                && (gui_lines_index_get_number (lines,
+                                                lines->search_first_line) < target))
+            {
+                return lines->search_first_line;
+            }
+        }
+    }
+    else
+    {
+        for (i = low; i < lines->search_found_end; i++)
+        {
+            if (gui_line_is_displayed (lines->search_found[i]))
+                return lines->search_found[i];
+        }
+    }
+
+    return NULL;
 }
 
 /*
@@ -120,6 +915,95 @@ gui_line_tags_free (struct t_gui_line_data *line_data)
     }
 }
 
+/*
+ * Frees prefix and message without colors in a line data (they will be
+ * computed again on next use).
+ *
+ * This function must be called before prefix or message of line is changed.
+ */
+
+void
+gui_line_free_no_color (struct t_gui_line_data *line_data)
+{
+    if (line_data->prefix_no_color)
+    {
+        string_shared_free (line_data->prefix_no_color);
+        line_data->prefix_no_color = NULL;
+    }
+    if (line_data->message_no_color)
+    {
+        if (line_data->message_no_color != line_data->message)
+            free (line_data->message_no_color);
+        line_data->message_no_color = NULL;
+    }
+}
+
+/*
+ * Gets prefix of a line without colors.
+ *
+ * The prefix without colors is computed on first call and kept in line data
+ * (as a shared string) until the prefix is changed.
+ *
+ * Returns prefix without colors, NULL if line has no prefix.
+ */
+
+const char *
+gui_line_get_prefix_no_color (struct t_gui_line_data *line_data)
+{
+    char *prefix;
+
+    if (!line_data->prefix)
+        return NULL;
+
+    if (!line_data->prefix_no_color)
+    {
+        prefix = gui_color_decode (line_data->prefix, NULL);
+        if (prefix)
+        {
+            line_data->prefix_no_color = (char *)string_shared_get (prefix);
+            free (prefix);
+        }
+    }
+
+    return line_data->prefix_no_color;
+}
+
+/*
+ * Gets message of a line without colors.
+ *
+ * The message without colors is computed on first call and kept in line data
+ * until the message is changed. If the message has no colors, no copy is kept
+ * and the message itself is returned.
+ *
+ * Returns message without colors, NULL if line has no message.
+ */
+
+const char *
+gui_line_get_message_no_color (struct t_gui_line_data *line_data)
+{
+    char *message;
+
+    if (!line_data->message)
+        return NULL;
+
+    if (!line_data->message_no_color)
+    {
+        message = gui_color_decode (line_data->message, NULL);
+        if (message)
+        {
+            if (strcmp (message, line_data->message) == 0)
+            {
+                free (message);
+                line_data->message_no_color = line_data->message;
+            }
+            else
+                line_data->message_no_color = message;
+        }
+    }
+
+    return line_data->message_no_color;
+}
+
 /*
  * Checks if prefix on line is a nick and is the same as nick on previous line.
  *
@@ -355,6 +1239,14 @@ gui_line_get_first_displayed (struct t_gui_buffer *buffer)
     struct t_gui_line *ptr_line;
 
     ptr_line = buffer->lines->first_line;
+
+    /* first line is hidden: use index to skip hidden lines */
+    if (ptr_line && !gui_line_is_displayed (ptr_line)
+        && gui_lines_index_check (buffer->lines))
+    {
+        return gui_lines_index_get_displayed (buffer->lines, 0);
+    }
+
     while (ptr_line && !gui_line_is_displayed (ptr_line))
     {
         ptr_line = ptr_line->next_line;
@@ -375,6 +1267,17 @@ gui_line_get_last_displayed (struct t_gui_buffer *buffer)
     struct t_gui_line *ptr_line;
 
     ptr_line = buffer->lines->last_line;
+
+    /* last line is hidden: use index to skip hidden lines */
+    if (ptr_line && !gui_line_is_displayed (ptr_line)
+        && gui_lines_index_check (buffer->lines))
+    {
+        return gui_lines_index_get_displayed (
+            buffer->lines,
+            gui_lines_index_count_displayed (buffer->lines,
+                                             buffer->lines->lines_count) - 1);
+    }
+
     while (ptr_line && !gui_line_is_displayed (ptr_line))
     {
         ptr_line = ptr_line->prev_line;
@@ -383,6 +1286,35 @@ gui_line_get_last_displayed (struct t_gui_buffer *buffer)
     return ptr_line;
 }
 
+/*
+ * Searches lines containing a line, with an index up-to-date (own lines or
+ * mixed lines of buffer).
+ *
+ * Returns pointer to lines found (and number of line in "number"), NULL if
+ * not found.
+ */
+
+struct t_gui_lines *
+gui_line_search_lines_indexed (struct t_gui_line *line, int *number)
+{
+    struct t_gui_lines *ptr_lines;
+
+    ptr_lines = line->data->buffer->own_lines;
+    *number = gui_lines_index_get_number (ptr_lines, line);
+    if (*number >= 0)
+        return ptr_lines;
+
+    ptr_lines = line->data->buffer->mixed_lines;
+    if (ptr_lines)
+    {
+        *number = gui_lines_index_get_number (ptr_lines, line);
+        if (*number >= 0)
+            return ptr_lines;
+    }
+
+    return NULL;
+}
+
 /*
  * Gets previous line displayed.
  *
@@ -392,8 +1324,23 @@ gui_line_get_last_displayed (struct t_gui_buffer *buffer)
 struct t_gui_line *
 gui_line_get_prev_displayed (struct t_gui_line *line)
 {
+    struct t_gui_lines *ptr_lines;
+    int number;
+
     if (line)
     {
+        /* previous line is hidden: use index (if up-to-date) */
+        if (line->prev_line && !gui_line_is_displayed (line->prev_line))
+        {
+            ptr_lines = gui_line_search_lines_indexed (line, &number);
+            if (ptr_lines)
+            {
+                return gui_lines_index_get_displayed (
+                    ptr_lines,
+                    gui_lines_index_count_displayed (ptr_lines, number) - 1);
+            }
+        }
+
         line = line->prev_line;
         while (line && !gui_line_is_displayed (line))
         {
@@ -412,8 +1359,23 @@ gui_line_get_prev_displayed (struct t_gui_line *line)
 struct t_gui_line *
 gui_line_get_next_displayed (struct t_gui_line *line)
 {
+    struct t_gui_lines *ptr_lines;
+    int number;
+
     if (line)
     {
+        /* next line is hidden: use index (if up-to-date) */
+        if (line->next_line && !gui_line_is_displayed (line->next_line))
+        {
+            ptr_lines = gui_line_search_lines_indexed (line, &number);
+            if (ptr_lines)
+            {
+                return gui_lines_index_get_displayed (
+                    ptr_lines,
+                    gui_lines_index_count_displayed (ptr_lines, number + 1));
+            }
+        }
+
         line = line->next_line;
         while (line && !gui_line_is_displayed (line))
         {
@@ -424,7 +1386,13 @@ gui_line_get_next_displayed (struct t_gui_line *line)
 }
 
 /*
- * Searches for text in a line.
+ * Searches for text (or regex) in prefix and/or message of a line.
+ *
+ * If regex is not NULL, it is used to match line, otherwise "text" is
+ * searched (case sensitive if "exact" is 1).
+ *
+ * Argument "where" is a combination of GUI_TEXT_SEARCH_IN_PREFIX and
+ * GUI_TEXT_SEARCH_IN_MESSAGE.
  *
  * Returns:
  *   1: text found in line
@@ -432,75 +1400,68 @@ gui_line_get_next_displayed (struct t_gui_line *line)
  */
 
 int
-gui_line_search_text (struct t_gui_buffer *buffer, struct t_gui_line *line)
+gui_line_search_text_match (struct t_gui_line *line, const char *text,
+                            int exact, regex_t *regex, int where)
 {
-    char *prefix, *message;
-    int rc;
+    const char *ptr_string;
 
-    if (!line || !line->data->message
-        || !buffer->input_buffer || !buffer->input_buffer[0])
-    {
+    if (!line || !line->data->message || (!regex && (!text || !text[0])))
         return 0;
-    }
-
-    rc = 0;
 
-    if ((buffer->text_search_where & GUI_TEXT_SEARCH_IN_PREFIX)
-        && line->data->prefix)
+    if ((where & GUI_TEXT_SEARCH_IN_PREFIX) && line->data->prefix)
     {
-        prefix = gui_color_decode (line->data->prefix, NULL);
-        if (prefix)
+        ptr_string = gui_line_get_prefix_no_color (line->data);
+        if (ptr_string
+            && ((regex && (regexec (regex, ptr_string, 0, NULL, 0) == 0))
+                || (!regex && exact && strstr (ptr_string, text))
+                || (!regex && !exact && string_strcasestr (ptr_string, text))))
         {
-            if (buffer->text_search_regex)
-            {
-                if (buffer->text_search_regex_compiled)
-                {
-                    if (regexec (buffer->text_search_regex_compiled,
-                                 prefix, 0, NULL, 0) == 0)
-                    {
-                        rc = 1;
-                    }
-                }
-            }
-            else if ((buffer->text_search_exact
-                      && (strstr (prefix, buffer->input_buffer)))
-                     || (!buffer->text_search_exact
-                         && (string_strcasestr (prefix, buffer->input_buffer))))
-            {
-                rc = 1;
-            }
-            free (prefix);
+            return 1;
         }
     }
 
-    if (!rc && (buffer->text_search_where & GUI_TEXT_SEARCH_IN_MESSAGE))
+    if (where & GUI_TEXT_SEARCH_IN_MESSAGE)
     {
-        message = gui_color_decode (line->data->message, NULL);
-        if (message)
+        ptr_string = gui_line_get_message_no_color (line->data);
+        if (ptr_string
+            && ((regex && (regexec (regex, ptr_string, 0, NULL, 0) == 0))
+                || (!regex && exact && strstr (ptr_string, text))
+                || (!regex && !exact && string_strcasestr (ptr_string, text))))
         {
-            if (buffer->text_search_regex)
-            {
-                if (buffer->text_search_regex_compiled)
-                {
-                    if (regexec (buffer->text_search_regex_compiled,
-                                 message, 0, NULL, 0) == 0)
-                    {
-                        rc = 1;
-                    }
-                }
-            }
-            else if ((buffer->text_search_exact
-                      && (strstr (message, buffer->input_buffer)))
-                     || (!buffer->text_search_exact
-                         && (string_strcasestr (message, buffer->input_buffer))))
-            {
-                rc = 1;
-            }
-            free (message);
+            return 1;
         }
     }
 
-    return rc;
+    return 0;
+}
+
+/*
+ * Searches for text in a line, using search options of buffer (text is the
+ * input of buffer).
+ *
+ * Returns:
+ *   1: text found in line
+ *   0: text not found in line
+ */
+
+int
+gui_line_search_text (struct t_gui_buffer *buffer, struct t_gui_line *line)
+{
+    if (!buffer->input_buffer || !buffer->input_buffer[0])
+        return 0;
+
+    if (buffer->text_search_regex)
+    {
+        if (!buffer->text_search_regex_compiled)
+            return 0;
+        return gui_line_search_text_match (line, NULL, 0,
+                                           buffer->text_search_regex_compiled,
+                                           buffer->text_search_where);
+    }
+
+    return gui_line_search_text_match (line, buffer->input_buffer,
+                                       buffer->text_search_exact, NULL,
+                                       buffer->text_search_where);
 }
 
 /*
@@ -515,21 +1476,18 @@ int
 gui_line_match_regex (struct t_gui_line_data *line_data, regex_t *regex_prefix,
                       regex_t *regex_message)
 {
-    char *prefix, *message;
+    const char *prefix, *message;
     int match_prefix, match_message;
 
     if (!line_data || (!regex_prefix && !regex_message))
         return 0;
 
-    prefix = NULL;
-    message = NULL;
-
     match_prefix = 1;
     match_message = 1;
 
     if (line_data->prefix)
     {
-        prefix = gui_color_decode (line_data->prefix, NULL);
+        prefix = gui_line_get_prefix_no_color (line_data);
         if (!prefix
             || (regex_prefix && (regexec (regex_prefix, prefix, 0, NULL, 0) != 0)))
             match_prefix = 0;
@@ -542,7 +1500,7 @@ gui_line_match_regex (struct t_gui_line_data *line_data, regex_t *regex_prefix,
 
     if (line_data->message)
     {
-        message = gui_color_decode (line_data->message, NULL);
+        message = gui_line_get_message_no_color (line_data);
         if (!message
             || (regex_message && (regexec (regex_message, message, 0, NULL, 0) != 0)))
             match_message = 0;
@@ -553,11 +1511,6 @@ gui_line_match_regex (struct t_gui_line_data *line_data, regex_t *regex_prefix,
             match_message = 0;
     }
 
-    if (prefix)
-        free (prefix);
-    if (message)
-        free (message);
-
     return (match_prefix && match_message);
 }
 
@@ -693,8 +1646,8 @@ int
 gui_line_has_highlight (struct t_gui_line *line)
 {
     int rc, i, no_highlight, action, length;
-    char *msg_no_color, *ptr_msg_no_color, *highlight_words;
-    const char *ptr_nick;
+    char *highlight_words;
+    const char *ptr_msg_no_color, *ptr_nick;
 
     /*
      * highlights are disabled on this buffer? (special value "-" means that
@@ -767,11 +1720,10 @@ gui_line_has_highlight (struct t_gui_line *line)
             return 0;
     }
 
-    /* remove color codes from line message */
-    msg_no_color = gui_color_decode (line->data->message, NULL);
-    if (!msg_no_color)
+    /* get line message without color codes */
+    ptr_msg_no_color = gui_line_get_message_no_color (line->data);
+    if (!ptr_msg_no_color)
         return 0;
-    ptr_msg_no_color = msg_no_color;
 
     /*
      * if the line is an action message and that we know the nick, we skip
@@ -820,8 +1772,6 @@ gui_line_has_highlight (struct t_gui_line *line)
                                                   line->data->buffer->highlight_regex_compiled);
     }
 
-    free (msg_no_color);
-
     return rc;
 }
 
@@ -883,30 +1833,128 @@ gui_line_compute_buffer_max_length (struct t_gui_buffer *buffer,
     lines->buffer_max_length_refresh = 0;
 }
 
+/*
+ * Adds "delta" (1 or -1) to the number of displayed lines with a prefix of
+ * this length, and updates "prefix_max_length" for a "t_gui_lines" structure.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (not enough memory)
+ */
+
+int
+gui_line_prefix_length_count_add (struct t_gui_lines *lines, int length,
+                                  int delta)
+{
+    int *new_count, new_size, i, length_min;
+
+    if (length >= lines->prefix_length_count_size)
+    {
+        new_size = ((length / 16) + 1) * 16;
+        new_count = realloc (lines->prefix_length_count,
+                             new_size * sizeof (*new_count));
+        if (!new_count)
+            return 0;
+        for (i = lines->prefix_length_count_size; i < new_size; i++)
+        {
+            new_count[i] = 0;
+        }
+        lines->prefix_length_count = new_count;
+        lines->prefix_length_count_size = new_size;
+    }
+
+    lines->prefix_length_count[length] += delta;
+
+    if (delta > 0)
+    {
+        if (length > lines->prefix_max_length)
+            lines->prefix_max_length = length;
+    }
+    else if ((length == lines->prefix_max_length)
+             && (lines->prefix_length_count[length] == 0))
+    {
+        /* last line with max length removed: look for next length used */
+        length_min = CONFIG_INTEGER(config_look_prefix_align_min);
+        while ((lines->prefix_max_length > length_min)
+               && (lines->prefix_length_count[lines->prefix_max_length] == 0))
+        {
+            lines->prefix_max_length--;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Updates the prefix length counted for a line in a "t_gui_lines" structure.
+ *
+ * This function must be called when a line is added, hidden or displayed, and
+ * for the next displayed line, because its prefix may be hidden if the nick is
+ * the same as on previous displayed line (option weechat.look.prefix_same_nick).
+ */
+
+void
+gui_line_prefix_length_update (struct t_gui_lines *lines,
+                               struct t_gui_line *line)
+{
+    int prefix_length, prefix_is_nick;
+
+    prefix_length = -1;
+    if (line->data->displayed)
+    {
+        gui_line_get_prefix_for_display (line, NULL, &prefix_length, NULL,
+                                         &prefix_is_nick);
+        if (prefix_is_nick)
+            prefix_length += config_length_nick_prefix_suffix;
+    }
+
+    if (prefix_length == line->prefix_length_counted)
+        return;
+
+    if (line->prefix_length_counted >= 0)
+    {
+        gui_line_prefix_length_count_add (lines, line->prefix_length_counted,
+                                          -1);
+        line->prefix_length_counted = -1;
+    }
+
+    if (prefix_length >= 0)
+    {
+        if (gui_line_prefix_length_count_add (lines, prefix_length, 1))
+            line->prefix_length_counted = prefix_length;
+        else if (prefix_length > lines->prefix_max_length)
+            lines->prefix_max_length = prefix_length;
+    }
+}
+
 /*
  * Computes "prefix_max_length" for a "t_gui_lines" structure.
+ *
+ * The number of lines for each prefix length is computed again with all
+ * lines, this is needed only when options used to compute prefix length are
+ * changed (otherwise "prefix_max_length" is updated when lines are added,
+ * removed, hidden or displayed).
  */
 
 void
 gui_line_compute_prefix_max_length (struct t_gui_lines *lines)
 {
     struct t_gui_line *ptr_line;
-    int prefix_length, prefix_is_nick;
 
     lines->prefix_max_length = CONFIG_INTEGER(config_look_prefix_align_min);
 
+    if (lines->prefix_length_count)
+    {
+        memset (lines->prefix_length_count, 0,
+                lines->prefix_length_count_size *
+                sizeof (lines->prefix_length_count[0]));
+    }
+
     for (ptr_line = lines->first_line; ptr_line;
          ptr_line = ptr_line->next_line)
     {
-        if (ptr_line->data->displayed)
-        {
-            gui_line_get_prefix_for_display (ptr_line, NULL, &prefix_length,
-                                             NULL, &prefix_is_nick);
-            if (prefix_is_nick)
-                prefix_length += config_length_nick_prefix_suffix;
-            if (prefix_length > lines->prefix_max_length)
-                lines->prefix_max_length = prefix_length;
-        }
+        ptr_line->prefix_length_counted = -1;
+        gui_line_prefix_length_update (lines, ptr_line);
     }
 
     lines->prefix_max_length_refresh = 0;
@@ -920,8 +1968,6 @@ void
 gui_line_add_to_list (struct t_gui_lines *lines,
                       struct t_gui_line *line)
 {
-    int prefix_length, prefix_is_nick;
-
     if (!lines->first_line)
         lines->first_line = line;
     else
@@ -930,13 +1976,11 @@ gui_line_add_to_list (struct t_gui_lines *lines,
     line->next_line = NULL;
     lines->last_line = line;
 
-    /* adjust "prefix_max_length" if this prefix length is > max */
-    gui_line_get_prefix_for_display (line, NULL, &prefix_length, NULL,
-                                     &prefix_is_nick);
-    if (prefix_is_nick)
-        prefix_length += config_length_nick_prefix_suffix;
-    if (prefix_length > lines->prefix_max_length)
-        lines->prefix_max_length = prefix_length;
+    gui_lines_index_add (lines, line);
+
+    /* count prefix length (for "prefix_max_length") */
+    line->prefix_length_counted = -1;
+    gui_line_prefix_length_update (lines, line);
 
     lines->lines_count++;
 }
@@ -953,7 +1997,7 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
 {
     struct t_gui_window *ptr_win;
     struct t_gui_window_scroll *ptr_scroll;
-    int prefix_length, prefix_is_nick;
+    struct t_gui_line *ptr_next_line;
 
     for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
     {
@@ -970,14 +2014,17 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
         }
         /* remove line from coords */
         gui_window_coords_remove_line (ptr_win, line);
+        /* remove line from content saved for chat (last line displayed) */
+        gui_chat_remove_line (ptr_win, line);
     }
 
-    gui_line_get_prefix_for_display (line, NULL, &prefix_length, NULL,
-                                     &prefix_is_nick);
-    if (prefix_is_nick)
-        prefix_length += config_length_nick_prefix_suffix;
-    if (prefix_length == lines->prefix_max_length)
-        lines->prefix_max_length_refresh = 1;
+    /* remove prefix length of line (for "prefix_max_length") */
+    if (line->prefix_length_counted >= 0)
+    {
+        gui_line_prefix_length_count_add (lines, line->prefix_length_counted,
+                                          -1);
+        line->prefix_length_counted = -1;
+    }
 
     /* move read marker if it was on line we are removing */
     if (lines->last_read_line == line)
@@ -987,12 +2034,16 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
         gui_buffer_ask_chat_refresh (buffer, 1);
     }
 
+    gui_lines_index_remove (lines, line);
+    gui_lines_search_remove (lines, line);
+
     /* free data */
     if (free_data)
     {
         if (line->data->str_time)
             free (line->data->str_time);
         gui_line_tags_free (line->data);
+        gui_line_free_no_color (line->data);
         if (line->data->prefix)
             string_shared_free (line->data->prefix);
         if (line->data->message)
@@ -1012,6 +2063,18 @@ gui_line_remove_from_list (struct t_gui_buffer *buffer,
 
     lines->lines_count--;
 
+    /*
+     * the prefix of next displayed line may have changed (if it was the same
+     * nick as on this line)
+     */
+    ptr_next_line = line->next_line;
+    while (ptr_next_line && !ptr_next_line->data->displayed)
+    {
+        ptr_next_line = ptr_next_line->next_line;
+    }
+    if (ptr_next_line)
+        gui_line_prefix_length_update (lines, ptr_next_line);
+
     free (line);
 }
 
@@ -1206,6 +2269,7 @@ gui_line_add (struct t_gui_buffer *buffer, time_t date,
 
     /* fill data in new line */
     new_line->data->buffer = buffer;
+    new_line->data->id = buffer->next_line_id++;
     new_line->data->y = -1;
     new_line->data->date = date;
     new_line->data->date_printed = date_printed;
@@ -1217,6 +2281,12 @@ gui_line_add (struct t_gui_buffer *buffer, time_t date,
     new_line->data->prefix_length = (prefix) ?
         gui_chat_strlen_screen (prefix) : 0;
     new_line->data->message = (message) ? strdup (message) : strdup ("");
+    new_line->data->prefix_no_color = NULL;
+    new_line->data->message_no_color = NULL;
+    new_line->data->rows = 0;
+    new_line->data->rows_width = 0;
+    new_line->data->rows_align = 0;
+    new_line->data->rows_generation = 0;
 
     /* get notify level and max notify level for nick in buffer */
     notify_level = gui_line_get_notify_level (new_line);
@@ -1351,11 +2421,14 @@ gui_line_add_y (struct t_gui_buffer *buffer, int y, const char *message)
             return;
         }
         new_line->data = new_line_data;
+        new_line->prefix_length_counted = -1;
+        new_line->index_pos = -1;
 
         buffer->own_lines->lines_count++;
 
         /* fill data in new line */
         new_line->data->buffer = buffer;
+        new_line->data->id = y;
         new_line->data->y = y;
         new_line->data->date = 0;
         new_line->data->date_printed = 0;
@@ -1366,7 +2439,13 @@ gui_line_add_y (struct t_gui_buffer *buffer, int y, const char *message)
         new_line->data->prefix = NULL;
         new_line->data->prefix_length = 0;
         new_line->data->message = NULL;
+        new_line->data->prefix_no_color = NULL;
+        new_line->data->message_no_color = NULL;
         new_line->data->highlight = 0;
+        new_line->data->rows = 0;
+        new_line->data->rows_width = 0;
+        new_line->data->rows_align = 0;
+        new_line->data->rows_generation = 0;
 
         /* add line to lines list */
         if (ptr_line)
@@ -1392,6 +2471,8 @@ gui_line_add_y (struct t_gui_buffer *buffer, int y, const char *message)
             new_line->next_line = NULL;
         }
 
+        gui_lines_index_invalidate (buffer->own_lines);
+
         ptr_line = new_line;
     }
 
@@ -1405,12 +2486,15 @@ gui_line_add_y (struct t_gui_buffer *buffer, int y, const char *message)
         }
 
         /* free message in line */
+        gui_line_free_no_color (ptr_line->data);
         free (ptr_line->data->message);
     }
+    gui_lines_search_invalidate (buffer->own_lines);
     ptr_line->data->message = (message) ? strdup (message) : strdup ("");
 
     /* check if line is filtered or not */
     ptr_line->data->displayed = gui_filter_check_line (ptr_line->data);
+    gui_lines_index_invalidate (buffer->own_lines);
     if (!ptr_line->data->displayed)
     {
         buffer->own_lines->lines_hidden++;
@@ -1428,6 +2512,9 @@ gui_line_add_y (struct t_gui_buffer *buffer, int y, const char *message)
 void
 gui_line_clear (struct t_gui_line *line)
 {
+    gui_line_free_no_color (line->data);
+    gui_lines_search_invalidate (line->data->buffer->own_lines);
+
     if (line->data->prefix)
         string_shared_free (line->data->prefix);
     line->data->prefix = (char *)string_shared_get ("");
@@ -1435,6 +2522,7 @@ gui_line_clear (struct t_gui_line *line)
     if (line->data->message)
         free (line->data->message);
     line->data->message = strdup ("");
+    line->data->rows_generation = 0;
 }
 
 /*
@@ -1507,15 +2595,17 @@ gui_line_mix_buffers (struct t_gui_buffer *buffer)
         }
     }
 
-    /* ask refresh of prefix/buffer max length for mixed lines */
-    new_lines->prefix_max_length_refresh = 1;
+    /*
+     * ask refresh of buffer max length for mixed lines (prefix max length has
+     * been computed while adding lines)
+     */
     new_lines->buffer_max_length_refresh = 1;
 
     /* free old mixed lines */
     if (ptr_buffer_found->mixed_lines)
     {
         gui_line_mixed_free_all (ptr_buffer_found);
-        free (ptr_buffer_found->mixed_lines);
+        gui_lines_free (ptr_buffer_found->mixed_lines);
     }
 
     /* use new structure with mixed lines in all buffers with correct number */
@@ -1614,6 +2704,9 @@ gui_line_hdata_line_data_update_cb (void *data,
             if (line_data->str_time)
                 free (line_data->str_time);
             line_data->str_time = gui_chat_get_time_string (line_data->date);
+            gui_lines_index_invalidate (line_data->buffer->own_lines);
+            if (line_data->buffer->mixed_lines)
+                gui_lines_index_invalidate (line_data->buffer->mixed_lines);
             rc++;
             update_coords = 1;
         }
@@ -1640,10 +2733,13 @@ gui_line_hdata_line_data_update_cb (void *data,
     if (hashtable_has_key (hashtable, "prefix"))
     {
         value = hashtable_get (hashtable, "prefix");
+        gui_line_free_no_color (line_data);
         hdata_set (hdata, pointer, "prefix", value);
         line_data->prefix_length = (line_data->prefix) ?
             gui_chat_strlen_screen (line_data->prefix) : 0;
-        line_data->buffer->lines->prefix_max_length_refresh = 1;
+        line_data->buffer->own_lines->prefix_max_length_refresh = 1;
+        if (line_data->buffer->mixed_lines)
+            line_data->buffer->mixed_lines->prefix_max_length_refresh = 1;
         rc++;
         update_coords = 1;
     }
@@ -1651,6 +2747,7 @@ gui_line_hdata_line_data_update_cb (void *data,
     if (hashtable_has_key (hashtable, "message"))
     {
         value = hashtable_get (hashtable, "message");
+        gui_line_free_no_color (line_data);
         hdata_set (hdata, pointer, "message", value);
         rc++;
         update_coords = 1;
@@ -1658,12 +2755,16 @@ gui_line_hdata_line_data_update_cb (void *data,
 
     if (rc > 0)
     {
+        line_data->rows_generation = 0;
         if (update_coords)
         {
             for (ptr_win = gui_windows; ptr_win; ptr_win = ptr_win->next_window)
             {
                 gui_window_coords_remove_line_data (ptr_win, line_data);
             }
+            gui_lines_search_invalidate (line_data->buffer->own_lines);
+            if (line_data->buffer->mixed_lines)
+                gui_lines_search_invalidate (line_data->buffer->mixed_lines);
         }
         gui_filter_buffer (line_data->buffer, line_data);
         gui_buffer_ask_chat_refresh (line_data->buffer, 1);
@@ -1689,6 +2790,7 @@ gui_line_hdata_line_data_cb (void *data, const char *hdata_name)
     if (hdata)
     {
         HDATA_VAR(struct t_gui_line_data, buffer, POINTER, 0, NULL, "buffer");
+        HDATA_VAR(struct t_gui_line_data, id, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, y, INTEGER, 0, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, date, TIME, 1, NULL, NULL);
         HDATA_VAR(struct t_gui_line_data, date_printed, TIME, 1, NULL, NULL);
@@ -1729,6 +2831,8 @@ gui_line_add_to_infolist (struct t_infolist *infolist,
     if (!ptr_item)
         return 0;
 
+    if (!infolist_new_var_integer (ptr_item, "id", line->data->id))
+        return 0;
     if (!infolist_new_var_integer (ptr_item, "y", line->data->y))
         return 0;
     if (!infolist_new_var_time (ptr_item, "date", line->data->date))
@@ -1801,5 +2905,23 @@ gui_lines_print_log (struct t_gui_lines *lines)
         log_printf ("    buffer_max_length_refresh: %d",    lines->buffer_max_length_refresh);
         log_printf ("    prefix_max_length. . . . : %d",    lines->prefix_max_length);
         log_printf ("    prefix_max_length_refresh: %d",    lines->prefix_max_length_refresh);
+        log_printf ("    prefix_length_count. . . : 0x%lx", lines->prefix_length_count);
+        log_printf ("    prefix_length_count_size : %d",    lines->prefix_length_count_size);
+        log_printf ("    index_lines. . . . . . . : 0x%lx", lines->index_lines);
+        log_printf ("    index_displayed. . . . . : 0x%lx", lines->index_displayed);
+        log_printf ("    index_date_max . . . . . : 0x%lx", lines->index_date_max);
+        log_printf ("    index_start. . . . . . . : %d",    lines->index_start);
+        log_printf ("    index_end. . . . . . . . : %d",    lines->index_end);
+        log_printf ("    index_size . . . . . . . : %d",    lines->index_size);
+        log_printf ("    index_valid. . . . . . . : %d",    lines->index_valid);
+        log_printf ("    index_last_unsorted. . . : %d",    lines->index_last_unsorted);
+        log_printf ("    search_text. . . . . . . : '%s'",  lines->search_text);
+        log_printf ("    search_exact . . . . . . : %d",    lines->search_exact);
+        log_printf ("    search_where . . . . . . : %d",    lines->search_where);
+        log_printf ("    search_found . . . . . . : 0x%lx", lines->search_found);
+        log_printf ("    search_found_start . . . : %d",    lines->search_found_start);
+        log_printf ("    search_found_end . . . . : %d",    lines->search_found_end);
+        log_printf ("    search_found_size. . . . : %d",    lines->search_found_size);
+        log_printf ("    search_last_line . . . . : 0x%lx", lines->search_last_line);
     }
 }
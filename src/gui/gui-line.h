@@ -29,6 +29,8 @@ struct t_infolist;
 struct t_gui_line_data
 {
     struct t_gui_buffer *buffer;       /* pointer to buffer                 */
+    int id;                            /* line id (unique in buffer for     */
+                                       /* formatted buffer, = y for free)   */
     int y;                             /* line position (for free buffer)   */
     time_t date;                       /* date/time of line (may be past)   */
     time_t date_printed;               /* date/time when weechat print it   */
@@ -41,6 +43,17 @@ struct t_gui_line_data
     char *prefix;                      /* prefix for line (may be NULL)     */
     int prefix_length;                 /* prefix length (on screen)         */
     char *message;                     /* line content (after prefix)       */
+    char *prefix_no_color;             /* prefix without colors (shared     */
+                                       /* string, computed on first use)    */
+    char *message_no_color;            /* message without colors (computed  */
+                                       /* on first use, it is the pointer   */
+                                       /* "message" if there is no color)   */
+    int rows;                          /* cached number of rows on screen   */
+                                       /* (without day change/read marker)  */
+    int rows_width;                    /* chat width used for "rows"        */
+    int rows_align;                    /* alignment used for "rows"         */
+    unsigned int rows_generation;      /* generation of "rows" (cache is    */
+                                       /* valid if = gui_chat_rows_gen.)    */
 };
 
 struct t_gui_line
@@ -48,6 +61,10 @@ struct t_gui_line
     struct t_gui_line_data *data;      /* pointer to line data              */
     struct t_gui_line *prev_line;      /* link to previous line             */
     struct t_gui_line *next_line;      /* link to next line                 */
+    int prefix_length_counted;         /* prefix length counted in lines    */
+                                       /* (-1 if line is not counted)       */
+    int index_pos;                     /* position of line in index of      */
+                                       /* lines (-1 if not indexed)         */
 };
 
 struct t_gui_lines
@@ -63,12 +80,65 @@ struct t_gui_lines
     int buffer_max_length_refresh;     /* refresh asked for buffer max len. */
     int prefix_max_length;             /* max length for prefix align       */
     int prefix_max_length_refresh;     /* refresh asked for prefix max len. */
+    int *prefix_length_count;          /* number of displayed lines for     */
+                                       /* each prefix length                */
+    int prefix_length_count_size;      /* size of prefix_length_count       */
+    struct t_gui_line **index_lines;   /* index: lines by position (built   */
+                                       /* on first use, kept up-to-date     */
+                                       /* when lines are added/trimmed)     */
+    int *index_displayed;              /* number of displayed lines, from   */
+                                       /* first position to this position   */
+    time_t *index_date_max;            /* max date of lines, from first     */
+                                       /* position to this position         */
+    int index_start;                   /* position of first line in index   */
+    int index_end;                     /* position after last line in index */
+    int index_size;                    /* size of arrays in index           */
+    int index_valid;                   /* 1 if index is up-to-date          */
+    int index_last_unsorted;           /* position of last line older than  */
+                                       /* a previous line (-1 if none)      */
+    char *search_text;                 /* text of last search (lines found  */
+                                       /* are kept to narrow next search),  */
+                                       /* NULL if no search in cache        */
+    int search_exact;                  /* 1 if last search is case sensitive*/
+    int search_where;                  /* last search in prefix/message     */
+    struct t_gui_line **search_found;  /* lines found by last search (in    */
+                                       /* same order as lines)              */
+    int search_found_start;            /* position of first line found      */
+    int search_found_end;              /* position after last line found    */
+    int search_found_size;             /* size of array "search_found"      */
+    struct t_gui_line *search_first_line; /* first line searched (lines     */
+                                       /* before are searched when needed)  */
+    struct t_gui_line *search_last_line; /* last line searched (lines added */
+                                       /* after it are searched on next use)*/
 };
 
 /* line functions */
 
 extern struct t_gui_lines *gui_lines_alloc ();
 extern void gui_lines_free (struct t_gui_lines *lines);
+extern void gui_lines_index_invalidate (struct t_gui_lines *lines);
+extern int gui_lines_index_check (struct t_gui_lines *lines);
+extern int gui_lines_index_get_number (struct t_gui_lines *lines,
+                                       struct t_gui_line *line);
+extern struct t_gui_line *gui_lines_index_get_line (struct t_gui_lines *lines,
+                                                    int number);
+extern int gui_lines_index_count_displayed (struct t_gui_lines *lines,
+                                            int number);
+extern struct t_gui_line *gui_lines_index_get_displayed (struct t_gui_lines *lines,
+                                                         int rank);
+extern int gui_lines_index_dates_sorted (struct t_gui_lines *lines);
+extern struct t_gui_line *gui_lines_index_search_date (struct t_gui_lines *lines,
+                                                       time_t date);
+extern void gui_lines_search_invalidate (struct t_gui_lines *lines);
+extern int gui_lines_search_update (struct t_gui_lines *lines,
+                                    const char *text, int exact, int where,
+                                    int all_lines);
+extern struct t_gui_line *gui_lines_search_get_found (struct t_gui_lines *lines,
+                                                      struct t_gui_line *line,
+                                                      int backward);
+extern void gui_line_free_no_color (struct t_gui_line_data *line_data);
+extern const char *gui_line_get_prefix_no_color (struct t_gui_line_data *line_data);
+extern const char *gui_line_get_message_no_color (struct t_gui_line_data *line_data);
 extern void gui_line_get_prefix_for_display (struct t_gui_line *line,
                                              char **prefix, int *length,
                                              char **color, int *prefix_is_nick);
@@ -80,6 +150,9 @@ extern struct t_gui_line *gui_line_get_first_displayed (struct t_gui_buffer *buf
 extern struct t_gui_line *gui_line_get_last_displayed (struct t_gui_buffer *buffer);
 extern struct t_gui_line *gui_line_get_prev_displayed (struct t_gui_line *line);
 extern struct t_gui_line *gui_line_get_next_displayed (struct t_gui_line *line);
+extern int gui_line_search_text_match (struct t_gui_line *line,
+                                       const char *text, int exact,
+                                       regex_t *regex, int where);
 extern int gui_line_search_text (struct t_gui_buffer *buffer,
                                  struct t_gui_line *line);
 extern int gui_line_match_regex (struct t_gui_line_data *line_data,
@@ -95,6 +168,10 @@ extern int gui_line_has_highlight (struct t_gui_line *line);
 extern int gui_line_has_offline_nick (struct t_gui_line *line);
 extern void gui_line_compute_buffer_max_length (struct t_gui_buffer *buffer,
                                                 struct t_gui_lines *lines);
+extern int gui_line_prefix_length_count_add (struct t_gui_lines *lines,
+                                             int length, int delta);
+extern void gui_line_prefix_length_update (struct t_gui_lines *lines,
+                                           struct t_gui_line *line);
 extern void gui_line_compute_prefix_max_length (struct t_gui_lines *lines);
 extern void gui_line_set_prefix_same_nick (struct t_gui_line *line);
 extern void gui_line_mixed_free_buffer (struct t_gui_buffer *buffer);
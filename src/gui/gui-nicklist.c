@@ -45,6 +45,7 @@
 #include "../plugins/plugin.h"
 #include "gui-nicklist.h"
 #include "gui-buffer.h"
+#include "gui-chat.h"
 #include "gui-color.h"
 
 
@@ -249,6 +250,167 @@ gui_nicklist_search_group (struct t_gui_buffer *buffer,
                                                (ptr_name == name) ? 1 : 0);
 }
 
+/*
+ * Adds "delta" (1 or -1) to the number of nicks/groups displayed with this
+ * length in nicklist, and updates "nicklist_max_length" for buffer.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (not enough memory)
+ */
+
+int
+gui_nicklist_length_count_add (struct t_gui_buffer *buffer, int length,
+                               int delta)
+{
+    int *new_count, new_size, i;
+
+    if (length >= buffer->nicklist_length_count_size)
+    {
+        new_size = ((length / 16) + 1) * 16;
+        new_count = realloc (buffer->nicklist_length_count,
+                             new_size * sizeof (*new_count));
+        if (!new_count)
+            return 0;
+        for (i = buffer->nicklist_length_count_size; i < new_size; i++)
+        {
+            new_count[i] = 0;
+        }
+        buffer->nicklist_length_count = new_count;
+        buffer->nicklist_length_count_size = new_size;
+    }
+
+    buffer->nicklist_length_count[length] += delta;
+
+    if (delta > 0)
+    {
+        if (length > buffer->nicklist_max_length)
+            buffer->nicklist_max_length = length;
+    }
+    else if ((length == buffer->nicklist_max_length)
+             && (buffer->nicklist_length_count[length] == 0))
+    {
+        /* last nick/group with max length removed: look for next length */
+        while ((buffer->nicklist_max_length > 0)
+               && (buffer->nicklist_length_count[buffer->nicklist_max_length] == 0))
+        {
+            buffer->nicklist_max_length--;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * Updates the length counted for a nick or group (length is -1 if nick or
+ * group is not displayed).
+ */
+
+void
+gui_nicklist_update_length (struct t_gui_buffer *buffer, int *length_counted,
+                            int length)
+{
+    if (length == *length_counted)
+        return;
+
+    if (*length_counted >= 0)
+        gui_nicklist_length_count_add (buffer, *length_counted, -1);
+
+    *length_counted = -1;
+
+    if ((length >= 0) && gui_nicklist_length_count_add (buffer, length, 1))
+        *length_counted = length;
+}
+
+/*
+ * Returns length on screen of a group displayed in nicklist, -1 if group is
+ * not displayed.
+ */
+
+int
+gui_nicklist_group_get_length (struct t_gui_buffer *buffer,
+                               struct t_gui_nick_group *group)
+{
+    if (!buffer->nicklist_display_groups || !group->visible)
+        return -1;
+
+    return ((group->level > 1) ? group->level - 1 : 0)
+        + gui_chat_strlen_screen (gui_nicklist_get_group_start (group->name));
+}
+
+/*
+ * Returns length on screen of a nick displayed in nicklist, -1 if nick is not
+ * displayed (nicks of a group with children are not displayed).
+ */
+
+int
+gui_nicklist_nick_get_length (struct t_gui_buffer *buffer,
+                              struct t_gui_nick *nick)
+{
+    if (!nick->visible || nick->group->children)
+        return -1;
+
+    return ((buffer->nicklist_display_groups) ? nick->group->level : 0)
+        + ((nick->prefix) ? gui_chat_strlen_screen (nick->prefix) : 0)
+        + gui_chat_strlen_screen (nick->name);
+}
+
+/*
+ * Updates the length counted for all nicks of a group.
+ */
+
+void
+gui_nicklist_update_nicks_length (struct t_gui_buffer *buffer,
+                                  struct t_gui_nick_group *group)
+{
+    struct t_gui_nick *ptr_nick;
+
+    for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
+    {
+        gui_nicklist_update_length (buffer, &ptr_nick->length_counted,
+                                    gui_nicklist_nick_get_length (buffer,
+                                                                  ptr_nick));
+    }
+}
+
+/*
+ * Updates number of lines displayed for a group, and adds the difference to
+ * its parents and to the number of lines displayed in buffer nicklist.
+ */
+
+void
+gui_nicklist_update_lines_count (struct t_gui_buffer *buffer,
+                                 struct t_gui_nick_group *group)
+{
+    struct t_gui_nick_group *ptr_group;
+    int lines_count, diff;
+
+    lines_count = (buffer->nicklist_display_groups && group->visible) ? 1 : 0;
+    if (group->children)
+    {
+        for (ptr_group = group->children; ptr_group;
+             ptr_group = ptr_group->next_group)
+        {
+            lines_count += ptr_group->lines_count;
+        }
+    }
+    else
+    {
+        lines_count += group->nicks_visible_count;
+    }
+
+    diff = lines_count - group->lines_count;
+    if (diff == 0)
+        return;
+
+    for (ptr_group = group; ptr_group; ptr_group = ptr_group->parent)
+    {
+        ptr_group->lines_count += diff;
+        if (ptr_group == buffer->nicklist_root)
+            buffer->nicklist_visible_count += diff;
+    }
+}
+
 /*
  * Adds a group to nicklist.
  *
@@ -261,6 +423,7 @@ gui_nicklist_add_group (struct t_gui_buffer *buffer,
                         const char *color, int visible)
 {
     struct t_gui_nick_group *new_group;
+    int first_child;
 
     if (!buffer || !name || gui_nicklist_search_group (buffer, parent_group, name))
         return NULL;
@@ -278,11 +441,18 @@ gui_nicklist_add_group (struct t_gui_buffer *buffer,
     new_group->last_child = NULL;
     new_group->nicks = NULL;
     new_group->last_nick = NULL;
+    new_group->nicks_visible_count = 0;
+    new_group->lines_count = 0;
+    new_group->length_counted = -1;
+    new_group->seek_nick = NULL;
+    new_group->seek_index = 0;
     new_group->prev_group = NULL;
     new_group->next_group = NULL;
 
+    first_child = 0;
     if (new_group->parent)
     {
+        first_child = (new_group->parent->children) ? 0 : 1;
         gui_nicklist_insert_group_sorted (&(new_group->parent->children),
                                           &(new_group->parent->last_child),
                                           new_group);
@@ -294,8 +464,17 @@ gui_nicklist_add_group (struct t_gui_buffer *buffer,
         buffer->nicklist_root = new_group;
     }
 
-    if (buffer->nicklist_display_groups && visible)
-        buffer->nicklist_visible_count++;
+    gui_nicklist_update_length (buffer, &new_group->length_counted,
+                                gui_nicklist_group_get_length (buffer,
+                                                               new_group));
+    gui_nicklist_update_lines_count (buffer, new_group);
+
+    if (first_child)
+    {
+        /* nicks of parent are not displayed any more */
+        gui_nicklist_update_nicks_length (buffer, new_group->parent);
+        gui_nicklist_update_lines_count (buffer, new_group->parent);
+    }
 
     gui_nicklist_send_signal ("nicklist_group_added", buffer, name);
     gui_nicklist_send_hsignal ("nicklist_group_added", buffer, new_group, NULL);
@@ -448,6 +627,7 @@ gui_nicklist_add_nick (struct t_gui_buffer *buffer,
     new_nick->prefix = (prefix) ? (char *)string_shared_get (prefix) : NULL;
     new_nick->prefix_color = (prefix_color) ? (char *)string_shared_get (prefix_color) : NULL;
     new_nick->visible = visible;
+    new_nick->length_counted = -1;
 
     gui_nicklist_insert_nick_sorted (new_nick->group, new_nick);
 
@@ -455,7 +635,12 @@ gui_nicklist_add_nick (struct t_gui_buffer *buffer,
     buffer->nicklist_nicks_count++;
 
     if (visible)
-        buffer->nicklist_visible_count++;
+        new_nick->group->nicks_visible_count++;
+    new_nick->group->seek_nick = NULL;
+    gui_nicklist_update_length (buffer, &new_nick->length_counted,
+                                gui_nicklist_nick_get_length (buffer,
+                                                              new_nick));
+    gui_nicklist_update_lines_count (buffer, new_nick->group);
 
     if (CONFIG_BOOLEAN(config_look_color_nick_offline))
         gui_buffer_ask_chat_refresh (buffer, 1);
@@ -494,6 +679,13 @@ gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
     if ((nick->group)->last_nick == nick)
         (nick->group)->last_nick = nick->prev_nick;
 
+    /* update counts for nicklist display */
+    gui_nicklist_update_length (buffer, &nick->length_counted, -1);
+    if (nick->visible && ((nick->group)->nicks_visible_count > 0))
+        (nick->group)->nicks_visible_count--;
+    (nick->group)->seek_nick = NULL;
+    gui_nicklist_update_lines_count (buffer, nick->group);
+
     /* free data */
     if (nick->name)
         string_shared_free (nick->name);
@@ -507,12 +699,6 @@ gui_nicklist_remove_nick (struct t_gui_buffer *buffer,
     buffer->nicklist_count--;
     buffer->nicklist_nicks_count--;
 
-    if (nick->visible)
-    {
-        if (buffer->nicklist_visible_count > 0)
-            buffer->nicklist_visible_count--;
-    }
-
     free (nick);
 
     if (CONFIG_BOOLEAN(config_look_color_nick_offline))
@@ -554,6 +740,8 @@ gui_nicklist_remove_group (struct t_gui_buffer *buffer,
     gui_nicklist_send_signal ("nicklist_group_removing", buffer, group_removed);
     gui_nicklist_send_hsignal ("nicklist_group_removing", buffer, group, NULL);
 
+    gui_nicklist_update_length (buffer, &group->length_counted, -1);
+
     if (group->parent)
     {
         /* remove group from list */
@@ -568,10 +756,16 @@ gui_nicklist_remove_group (struct t_gui_buffer *buffer,
 
         buffer->nicklist_count--;
         buffer->nicklist_groups_count--;
+
+        /* nicks of parent are displayed if it has no more children */
+        if (!(group->parent)->children)
+            gui_nicklist_update_nicks_length (buffer, group->parent);
+        gui_nicklist_update_lines_count (buffer, group->parent);
     }
     else
     {
         buffer->nicklist_root = NULL;
+        buffer->nicklist_visible_count = 0;
     }
 
     /* free data */
@@ -580,13 +774,6 @@ gui_nicklist_remove_group (struct t_gui_buffer *buffer,
     if (group->color)
         string_shared_free (group->color);
 
-    if (group->visible)
-    {
-        if (buffer->nicklist_display_groups
-            && (buffer->nicklist_visible_count > 0))
-            buffer->nicklist_visible_count--;
-    }
-
     free (group);
 
     gui_nicklist_send_signal ("nicklist_group_removed", buffer, group_removed);
@@ -691,6 +878,86 @@ gui_nicklist_get_next_item (struct t_gui_buffer *buffer,
     *group = NULL;
 }
 
+/*
+ * Gets group or nick displayed at a line of nicklist (first line is 0).
+ *
+ * The number of lines displayed for each group is used to find the group
+ * quickly, then the nick is searched in group, starting from the last nick
+ * found in this group if it is before the line.
+ *
+ * Group and nick are set to NULL if there is no such line.
+ */
+
+void
+gui_nicklist_get_item_at_line (struct t_gui_buffer *buffer, int line,
+                               struct t_gui_nick_group **group,
+                               struct t_gui_nick **nick)
+{
+    struct t_gui_nick_group *ptr_group;
+    struct t_gui_nick *ptr_nick;
+    int index;
+
+    *group = NULL;
+    *nick = NULL;
+
+    if (!buffer || !buffer->nicklist_root || (line < 0)
+        || (line >= buffer->nicklist_root->lines_count))
+    {
+        return;
+    }
+
+    ptr_group = buffer->nicklist_root;
+    while (ptr_group)
+    {
+        if (buffer->nicklist_display_groups && ptr_group->visible)
+        {
+            if (line == 0)
+            {
+                *group = ptr_group;
+                return;
+            }
+            line--;
+        }
+        if (!ptr_group->children)
+            break;
+        for (ptr_group = ptr_group->children; ptr_group;
+             ptr_group = ptr_group->next_group)
+        {
+            if (line < ptr_group->lines_count)
+                break;
+            line -= ptr_group->lines_count;
+        }
+    }
+
+    if (!ptr_group)
+        return;
+
+    /* search nick in group */
+    ptr_nick = ptr_group->nicks;
+    index = 0;
+    if (ptr_group->seek_nick && (ptr_group->seek_index <= line))
+    {
+        ptr_nick = ptr_group->seek_nick;
+        index = ptr_group->seek_index;
+    }
+    while (ptr_nick)
+    {
+        if (ptr_nick->visible)
+        {
+            if (index == line)
+            {
+                ptr_group->seek_nick = ptr_nick;
+                ptr_group->seek_index = index;
+                *group = ptr_group;
+                *nick = ptr_nick;
+                return;
+            }
+            index++;
+        }
+        ptr_nick = ptr_nick->next_nick;
+    }
+}
+
 /*
  * Returns first char of a group that will be displayed on screen.
  *
@@ -766,7 +1033,9 @@ gui_nicklist_get_max_length (struct t_gui_buffer *buffer,
 }
 
 /*
- * Computes visible_count variable for a nicklist.
+ * Computes visible_count variable for a nicklist, number of lines displayed
+ * for groups and lengths of nicks/groups (this function must be called with
+ * the root group of nicklist).
  */
 
 void
@@ -779,22 +1048,35 @@ gui_nicklist_compute_visible_count (struct t_gui_buffer *buffer,
     if (!buffer || !group)
         return;
 
+    group->lines_count = (buffer->nicklist_display_groups && group->visible) ?
+        1 : 0;
+
     /* count for children */
     for (ptr_group = group->children; ptr_group;
          ptr_group = ptr_group->next_group)
     {
         gui_nicklist_compute_visible_count (buffer, ptr_group);
+        group->lines_count += ptr_group->lines_count;
     }
 
-    /* count current group */
-    if (buffer->nicklist_display_groups && group->visible)
-        buffer->nicklist_visible_count++;
-
     /* count nicks in group */
+    group->nicks_visible_count = 0;
     for (ptr_nick = group->nicks; ptr_nick; ptr_nick = ptr_nick->next_nick)
     {
-        buffer->nicklist_visible_count++;
+        if (ptr_nick->visible)
+            group->nicks_visible_count++;
     }
+    if (!group->children)
+        group->lines_count += group->nicks_visible_count;
+    group->seek_nick = NULL;
+
+    /* update lengths of group and its nicks */
+    gui_nicklist_update_length (buffer, &group->length_counted,
+                                gui_nicklist_group_get_length (buffer, group));
+    gui_nicklist_update_nicks_length (buffer, group);
+
+    if (group == buffer->nicklist_root)
+        buffer->nicklist_visible_count = group->lines_count;
 }
 
 /*
@@ -895,6 +1177,10 @@ gui_nicklist_group_set (struct t_gui_buffer *buffer,
         number = strtol (value, &error, 10);
         if (error && !error[0])
             group->visible = (number) ? 1 : 0;
+        gui_nicklist_update_length (buffer, &group->length_counted,
+                                    gui_nicklist_group_get_length (buffer,
+                                                                   group));
+        gui_nicklist_update_lines_count (buffer, group);
         group_changed = 1;
     }
 
@@ -1005,6 +1291,9 @@ gui_nicklist_nick_set (struct t_gui_buffer *buffer,
         if (nick->prefix)
             string_shared_free (nick->prefix);
         nick->prefix = (value[0]) ? (char *)string_shared_get (value) : NULL;
+        gui_nicklist_update_length (buffer, &nick->length_counted,
+                                    gui_nicklist_nick_get_length (buffer,
+                                                                  nick));
         nick_changed = 1;
     }
     else if (string_strcasecmp (property, "prefix_color") == 0)
@@ -1019,7 +1308,22 @@ gui_nicklist_nick_set (struct t_gui_buffer *buffer,
         error = NULL;
         number = strtol (value, &error, 10);
         if (error && !error[0])
-            nick->visible = (number) ? 1 : 0;
+        {
+            number = (number) ? 1 : 0;
+            if (number != nick->visible)
+            {
+                nick->visible = number;
+                if (nick->visible)
+                    (nick->group)->nicks_visible_count++;
+                else if ((nick->group)->nicks_visible_count > 0)
+                    (nick->group)->nicks_visible_count--;
+                (nick->group)->seek_nick = NULL;
+                gui_nicklist_update_length (buffer, &nick->length_counted,
+                                            gui_nicklist_nick_get_length (buffer,
+                                                                          nick));
+                gui_nicklist_update_lines_count (buffer, nick->group);
+            }
+        }
         nick_changed = 1;
     }
 
@@ -1272,6 +1576,26 @@ gui_nicklist_print_log (struct t_gui_nick_group *group, int indent)
               "%%-%dslast_nick . : 0x%%lx",
               (indent * 2) + 6);
     log_printf (format, " ", group->last_nick);
+    snprintf (format, sizeof (format),
+              "%%-%dsnicks_visible_count: %%d",
+              (indent * 2) + 6);
+    log_printf (format, " ", group->nicks_visible_count);
+    snprintf (format, sizeof (format),
+              "%%-%dslines_count: %%d",
+              (indent * 2) + 6);
+    log_printf (format, " ", group->lines_count);
+    snprintf (format, sizeof (format),
+              "%%-%dslength_counted: %%d",
+              (indent * 2) + 6);
+    log_printf (format, " ", group->length_counted);
+    snprintf (format, sizeof (format),
+              "%%-%dsseek_nick . : 0x%%lx",
+              (indent * 2) + 6);
+    log_printf (format, " ", group->seek_nick);
+    snprintf (format, sizeof (format),
+              "%%-%dsseek_index. : %%d",
+              (indent * 2) + 6);
+    log_printf (format, " ", group->seek_index);
     snprintf (format, sizeof (format),
               "%%-%dsprev_group. : 0x%%lx",
               (indent * 2) + 6);
@@ -1323,6 +1647,10 @@ gui_nicklist_print_log (struct t_gui_nick_group *group, int indent)
                   "%%-%dsvisible . . . . : %%d",
                   (indent * 2) + 6);
         log_printf (format, " ", ptr_nick->visible);
+        snprintf (format, sizeof (format),
+                  "%%-%dslength_counted. : %%d",
+                  (indent * 2) + 6);
+        log_printf (format, " ", ptr_nick->length_counted);
         snprintf (format, sizeof (format),
                   "%%-%dsprev_nick . . . : 0x%%lx",
                   (indent * 2) + 6);
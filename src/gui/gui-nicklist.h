@@ -34,6 +34,16 @@ struct t_gui_nick_group
     struct t_gui_nick_group *last_child; /* last child                      */
     struct t_gui_nick *nicks;          /* nicks for group                   */
     struct t_gui_nick *last_nick;      /* last nick for group               */
+    int nicks_visible_count;           /* number of visible nicks in group  */
+    int lines_count;                   /* number of lines displayed for     */
+                                       /* group and its children (index     */
+                                       /* used to find a line by number)    */
+    int length_counted;                /* length of group counted for max   */
+                                       /* length of nicklist (-1 if group   */
+                                       /* is not displayed)                 */
+    struct t_gui_nick *seek_nick;      /* last nick found by line number    */
+    int seek_index;                    /* index of this nick in visible     */
+                                       /* nicks of group                    */
     struct t_gui_nick_group *prev_group; /* link to previous group          */
     struct t_gui_nick_group *next_group; /* link to next group              */
 };
@@ -46,6 +56,9 @@ struct t_gui_nick
     char *prefix;                      /* prefix for nick (for admins, ..)  */
     char *prefix_color;                /* color for prefix                  */
     int visible;                       /* 1 if nick is displayed            */
+    int length_counted;                /* length of nick counted for max    */
+                                       /* length of nicklist (-1 if nick is */
+                                       /* not displayed)                    */
     struct t_gui_nick *prev_nick;      /* link to previous nick             */
     struct t_gui_nick *next_nick;      /* link to next nick                 */
 };
@@ -78,6 +91,10 @@ extern void gui_nicklist_remove_all (struct t_gui_buffer *buffer);
 extern void gui_nicklist_get_next_item (struct t_gui_buffer *buffer,
                                         struct t_gui_nick_group **group,
                                         struct t_gui_nick **nick);
+extern void gui_nicklist_get_item_at_line (struct t_gui_buffer *buffer,
+                                           int line,
+                                           struct t_gui_nick_group **group,
+                                           struct t_gui_nick **nick);
 extern const char *gui_nicklist_get_group_start (const char *name);
 extern void gui_nicklist_compute_visible_count (struct t_gui_buffer *buffer,
                                                 struct t_gui_nick_group *group);
@@ -908,6 +908,33 @@ gui_window_coords_remove_line_data (struct t_gui_window *window,
     }
 }
 
+/*
+ * Scrolls coordinates of window by "rows" rows (up): first rows are removed
+ * and rows at the end are reinitialized.
+ */
+
+void
+gui_window_coords_scroll (struct t_gui_window *window, int rows)
+{
+    int i;
+
+    if (!window->coords || (rows <= 0))
+        return;
+
+    if (rows < window->coords_size)
+    {
+        memmove (window->coords, window->coords + rows,
+                 (window->coords_size - rows) * sizeof (window->coords[0]));
+    }
+    else
+        rows = window->coords_size;
+
+    for (i = window->coords_size - rows; i < window->coords_size; i++)
+    {
+        gui_window_coords_init_line (window, i);
+    }
+}
+
 /*
  * Allocates and initializes coordinates for window.
  */
@@ -1081,6 +1108,107 @@ gui_window_switch_by_buffer (struct t_gui_window *window, int buffer_number)
     }
 }
 
+/*
+ * Searches line where a scroll by time stops (for example "-2h"), using index
+ * of lines: this is the first line (in direction of scroll) with a date
+ * distant from "line" by at least "number" times the unit of time.
+ *
+ * The index can be used only for a formatted buffer with dates of lines
+ * sorted, and for a scroll with a number (a scroll to the previous/next
+ * hour, day, ... compares the calendar dates and walks through lines).
+ *
+ * Returns:
+ *   1: index used, "line_found" is the line found (NULL if not found)
+ *   0: index can not be used (caller must walk through lines)
+ */
+
+int
+gui_window_scroll_search_index (struct t_gui_window *window,
+                                struct t_gui_line *line,
+                                int direction, long number,
+                                char time_letter,
+                                struct t_gui_line **line_found)
+{
+    struct t_gui_lines *ptr_lines;
+    struct t_gui_line *ptr_line;
+    time_t delay;
+    int line_number;
+
+    ptr_lines = window->buffer->lines;
+
+    if ((window->buffer->type != GUI_BUFFER_TYPE_FORMATTED)
+        || (number <= 0) || (line->data->date == 0))
+    {
+        return 0;
+    }
+
+    switch (time_letter)
+    {
+        case 's': /* seconds */
+            delay = number;
+            break;
+        case 'm': /* minutes */
+            delay = number * 60;
+            break;
+        case 'h': /* hours */
+            delay = number * 60 * 60;
+            break;
+        case 'd': /* days */
+            delay = number * 60 * 60 * 24;
+            break;
+        case 'M': /* months (30 days) */
+            delay = number * 60 * 60 * 24 * 30;
+            break;
+        case 'y': /* years (365 days) */
+            delay = number * 60 * 60 * 24 * 365;
+            break;
+        default:
+            return 0;
+    }
+
+    if (!gui_lines_index_check (ptr_lines)
+        || !gui_lines_index_dates_sorted (ptr_lines))
+    {
+        return 0;
+    }
+
+    if (direction < 0)
+    {
+        /*
+         * search last line with date <= line date - delay: this is the line
+         * before first line with date >= line date - delay + 1
+         */
+        ptr_line = gui_lines_index_search_date (ptr_lines,
+                                                line->data->date - delay + 1);
+        line_number = (ptr_line) ?
+            gui_lines_index_get_number (ptr_lines, ptr_line) :
+            ptr_lines->lines_count;
+        ptr_line = gui_lines_index_get_displayed (
+            ptr_lines,
+            gui_lines_index_count_displayed (ptr_lines, line_number) - 1);
+        while (ptr_line && (ptr_line->data->date == 0))
+        {
+            ptr_line = gui_line_get_prev_displayed (ptr_line);
+        }
+    }
+    else
+    {
+        /* search first line with date >= line date + delay */
+        ptr_line = gui_lines_index_search_date (ptr_lines,
+                                                line->data->date + delay);
+        while (ptr_line
+               && (!gui_line_is_displayed (ptr_line)
+                   || (ptr_line->data->date == 0)))
+        {
+            ptr_line = gui_line_get_next_displayed (ptr_line);
+        }
+    }
+
+    *line_found = ptr_line;
+
+    return 1;
+}
+
 /*
  * Scrolls window by a number of messages or time.
  */
@@ -1093,7 +1221,7 @@ gui_window_scroll (struct t_gui_window *window, char *scroll)
     time_t old_date, diff_date;
     char *pos, *error;
     long number;
-    struct t_gui_line *ptr_line;
+    struct t_gui_line *ptr_line, *ptr_line_found;
     struct tm *date_tmp, line_date, old_line_date;
 
     if (!window->buffer->lines->first_line)
@@ -1193,6 +1321,24 @@ gui_window_scroll (struct t_gui_window *window, char *scroll)
         date_tmp = localtime (&old_date);
         if (date_tmp)
             memcpy (&old_line_date, date_tmp, sizeof (struct tm));
+
+        /* scroll by time: search line with index of lines (if possible) */
+        if ((time_letter != ' ')
+            && gui_window_scroll_search_index (window, ptr_line, direction,
+                                               number, time_letter,
+                                               &ptr_line_found))
+        {
+            if (ptr_line_found)
+            {
+                window->scroll->start_line = ptr_line_found;
+                window->scroll->start_line_pos = 0;
+                window->scroll->first_line_displayed =
+                    (window->scroll->start_line == gui_line_get_first_displayed (window->buffer));
+                gui_buffer_ask_chat_refresh (window->buffer, 2);
+                return;
+            }
+            ptr_line = NULL;
+        }
     }
 
     while (ptr_line)
@@ -1505,6 +1651,10 @@ gui_window_scroll_unread (struct t_gui_window *window)
 /*
  * Searches for text in a buffer.
  *
+ * For a text search (not regex), the lines found are kept in cache (in lines
+ * of buffer): when the text grows (user typing text), only the lines
+ * previously found are checked again.
+ *
  * Returns:
  *   1: line has been found with text
  *   0: no line found with text
@@ -1513,55 +1663,108 @@ gui_window_scroll_unread (struct t_gui_window *window)
 int
 gui_window_search_text (struct t_gui_window *window)
 {
+    struct t_gui_lines *ptr_lines;
     struct t_gui_line *ptr_line;
+    int backward;
 
-    if (window->buffer->text_search == GUI_TEXT_SEARCH_BACKWARD)
+    if ((window->buffer->text_search != GUI_TEXT_SEARCH_BACKWARD)
+        && (window->buffer->text_search != GUI_TEXT_SEARCH_FORWARD))
     {
-        if (window->buffer->lines->first_line
-            && window->buffer->input_buffer && window->buffer->input_buffer[0])
+        return 0;
+    }
+
+    ptr_lines = window->buffer->lines;
+
+    if (!ptr_lines->first_line
+        || !window->buffer->input_buffer || !window->buffer->input_buffer[0])
+    {
+        return 0;
+    }
+
+    backward = (window->buffer->text_search == GUI_TEXT_SEARCH_BACKWARD);
+
+    if (!window->buffer->text_search_regex
+        && gui_lines_search_update (ptr_lines,
+                                    window->buffer->input_buffer,
+                                    window->buffer->text_search_exact,
+                                    window->buffer->text_search_where,
+                                    0)
+        && gui_lines_index_check (ptr_lines)
+        && (!window->scroll->start_line
+            || (gui_lines_index_get_number (ptr_lines,
+                                            window->scroll->start_line) >= 0)))
+    {
+        /* use lines found in cache */
+        ptr_line = gui_lines_search_get_found (ptr_lines,
+                                               window->scroll->start_line,
+                                               backward);
+    }
+    else
+    {
+        /* search text in all lines, from current scroll position */
+        if (backward)
         {
             ptr_line = (window->scroll->start_line) ?
                 gui_line_get_prev_displayed (window->scroll->start_line) :
                 gui_line_get_last_displayed (window->buffer);
-            while (ptr_line)
-            {
-                if (gui_line_search_text (window->buffer, ptr_line))
-                {
-                    window->scroll->start_line = ptr_line;
-                    window->scroll->start_line_pos = 0;
-                    window->scroll->first_line_displayed =
-                        (window->scroll->start_line == gui_line_get_first_displayed (window->buffer));
-                    gui_buffer_ask_chat_refresh (window->buffer, 2);
-                    return 1;
-                }
-                ptr_line = gui_line_get_prev_displayed (ptr_line);
-            }
         }
-    }
-    else if (window->buffer->text_search == GUI_TEXT_SEARCH_FORWARD)
-    {
-        if (window->buffer->lines->first_line
-            && window->buffer->input_buffer && window->buffer->input_buffer[0])
+        else
         {
             ptr_line = (window->scroll->start_line) ?
                 gui_line_get_next_displayed (window->scroll->start_line) :
                 gui_line_get_first_displayed (window->buffer);
-            while (ptr_line)
-            {
-                if (gui_line_search_text (window->buffer, ptr_line))
-                {
-                    window->scroll->start_line = ptr_line;
-                    window->scroll->start_line_pos = 0;
-                    window->scroll->first_line_displayed =
-                        (window->scroll->start_line == window->buffer->lines->first_line);
-                    gui_buffer_ask_chat_refresh (window->buffer, 2);
-                    return 1;
-                }
-                ptr_line = gui_line_get_next_displayed (ptr_line);
-            }
+        }
+        while (ptr_line && !gui_line_search_text (window->buffer, ptr_line))
+        {
+            ptr_line = (backward) ?
+                gui_line_get_prev_displayed (ptr_line) :
+                gui_line_get_next_displayed (ptr_line);
         }
     }
-    return 0;
+
+    if (!ptr_line)
+        return 0;
+
+    window->scroll->start_line = ptr_line;
+    window->scroll->start_line_pos = 0;
+    window->scroll->first_line_displayed = (backward) ?
+        (window->scroll->start_line == gui_line_get_first_displayed (window->buffer)) :
+        (window->scroll->start_line == ptr_lines->first_line);
+    gui_buffer_ask_chat_refresh (window->buffer, 2);
+
+    return 1;
+}
+
+/*
+ * Sets default options for text search in a buffer (using options
+ * weechat.look.buffer_search_*).
+ */
+
+void
+gui_window_search_set_default_options (struct t_gui_buffer *buffer)
+{
+    buffer->text_search_exact = CONFIG_BOOLEAN(config_look_buffer_search_case_sensitive);
+    buffer->text_search_regex = CONFIG_BOOLEAN(config_look_buffer_search_regex);
+    if (buffer->type == GUI_BUFFER_TYPE_FORMATTED)
+    {
+        switch (CONFIG_INTEGER(config_look_buffer_search_where))
+        {
+            case CONFIG_LOOK_BUFFER_SEARCH_PREFIX:
+                buffer->text_search_where = GUI_TEXT_SEARCH_IN_PREFIX;
+                break;
+            case CONFIG_LOOK_BUFFER_SEARCH_MESSAGE:
+                buffer->text_search_where = GUI_TEXT_SEARCH_IN_MESSAGE;
+                break;
+            case CONFIG_LOOK_BUFFER_SEARCH_PREFIX_MESSAGE:
+                buffer->text_search_where = GUI_TEXT_SEARCH_IN_PREFIX | GUI_TEXT_SEARCH_IN_MESSAGE;
+                break;
+            default:
+                buffer->text_search_where = GUI_TEXT_SEARCH_IN_MESSAGE;
+                break;
+        }
+    }
+    else
+        buffer->text_search_where = GUI_TEXT_SEARCH_IN_MESSAGE;
 }
 
 /*
@@ -1579,28 +1782,7 @@ gui_window_search_start (struct t_gui_window *window)
         ||  CONFIG_BOOLEAN(config_look_buffer_search_force_default))
     {
         /* set default search values */
-        window->buffer->text_search_exact = CONFIG_BOOLEAN(config_look_buffer_search_case_sensitive);
-        window->buffer->text_search_regex = CONFIG_BOOLEAN(config_look_buffer_search_regex);
-        if (window->buffer->type == GUI_BUFFER_TYPE_FORMATTED)
-        {
-            switch (CONFIG_INTEGER(config_look_buffer_search_where))
-            {
-                case CONFIG_LOOK_BUFFER_SEARCH_PREFIX:
-                    window->buffer->text_search_where = GUI_TEXT_SEARCH_IN_PREFIX;
-                    break;
-                case CONFIG_LOOK_BUFFER_SEARCH_MESSAGE:
-                    window->buffer->text_search_where = GUI_TEXT_SEARCH_IN_MESSAGE;
-                    break;
-                case CONFIG_LOOK_BUFFER_SEARCH_PREFIX_MESSAGE:
-                    window->buffer->text_search_where = GUI_TEXT_SEARCH_IN_PREFIX | GUI_TEXT_SEARCH_IN_MESSAGE;
-                    break;
-                default:
-                    window->buffer->text_search_where = GUI_TEXT_SEARCH_IN_MESSAGE;
-                    break;
-            }
-        }
-        else
-            window->buffer->text_search_where = GUI_TEXT_SEARCH_IN_MESSAGE;
+        gui_window_search_set_default_options (window->buffer);
     }
 
     window->buffer->text_search_found = 0;
@@ -1669,6 +1851,7 @@ gui_window_search_stop (struct t_gui_window *window)
         free (window->buffer->text_search_input);
         window->buffer->text_search_input = NULL;
     }
+    gui_lines_search_invalidate (window->buffer->lines);
     window->scroll->start_line = NULL;
     window->scroll->start_line_pos = 0;
     gui_hotlist_remove_buffer (window->buffer);
@@ -169,6 +169,7 @@ extern void gui_window_coords_remove_line (struct t_gui_window *window,
                                            struct t_gui_line *line);
 extern void gui_window_coords_remove_line_data (struct t_gui_window *window,
                                                 struct t_gui_line_data *line_data);
+extern void gui_window_coords_scroll (struct t_gui_window *window, int rows);
 extern void gui_window_coords_alloc (struct t_gui_window *window);
 extern void gui_window_free (struct t_gui_window *window);
 extern void gui_window_switch_previous (struct t_gui_window *window);
@@ -181,6 +182,7 @@ extern void gui_window_scroll_horiz (struct t_gui_window *window, char *scroll);
 extern void gui_window_scroll_previous_highlight (struct t_gui_window *window);
 extern void gui_window_scroll_next_highlight (struct t_gui_window *window);
 extern void gui_window_scroll_unread (struct t_gui_window *window);
+extern void gui_window_search_set_default_options (struct t_gui_buffer *buffer);
 extern void gui_window_search_start (struct t_gui_window *window);
 extern void gui_window_search_restart (struct t_gui_window *window);
 extern void gui_window_search_stop (struct t_gui_window *window);
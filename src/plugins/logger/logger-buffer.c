@@ -30,11 +30,15 @@
 #include "../weechat-plugin.h"
 #include "logger.h"
 #include "logger-buffer.h"
+#include "logger-writer.h"
 
 
 struct t_logger_buffer *logger_buffers = NULL;
 struct t_logger_buffer *last_logger_buffer = NULL;
 
+/* hashtable to quickly find a logger buffer with a buffer pointer */
+struct t_hashtable *logger_buffers_hashtable = NULL;
+
 
 /*
  * Checks if a logger buffer pointer is valid.
@@ -86,12 +90,27 @@ logger_buffer_add (struct t_gui_buffer *buffer, int log_level)
                              weechat_buffer_get_string (buffer, "name"));
     }
 
+    if (!logger_buffers_hashtable)
+    {
+        logger_buffers_hashtable = weechat_hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_POINTER,
+            WEECHAT_HASHTABLE_POINTER,
+            NULL,
+            NULL);
+        if (!logger_buffers_hashtable)
+            return NULL;
+    }
+
     new_logger_buffer = malloc (sizeof (*new_logger_buffer));
     if (new_logger_buffer)
     {
         new_logger_buffer->buffer = buffer;
+        new_logger_buffer->log_mask = NULL;
         new_logger_buffer->log_filename = NULL;
         new_logger_buffer->log_file = NULL;
+        new_logger_buffer->log_index = NULL;
+        new_logger_buffer->log_size = 0;
         new_logger_buffer->log_enabled = 1;
         new_logger_buffer->log_level = log_level;
         new_logger_buffer->write_start_info_line = 1;
@@ -104,6 +123,9 @@ logger_buffer_add (struct t_gui_buffer *buffer, int log_level)
         else
             logger_buffers = new_logger_buffer;
         last_logger_buffer = new_logger_buffer;
+
+        weechat_hashtable_set (logger_buffers_hashtable,
+                               buffer, new_logger_buffer);
     }
 
     return new_logger_buffer;
@@ -118,17 +140,10 @@ logger_buffer_add (struct t_gui_buffer *buffer, int log_level)
 struct t_logger_buffer *
 logger_buffer_search_buffer (struct t_gui_buffer *buffer)
 {
-    struct t_logger_buffer *ptr_logger_buffer;
-
-    for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
-         ptr_logger_buffer = ptr_logger_buffer->next_buffer)
-    {
-        if (ptr_logger_buffer->buffer == buffer)
-            return ptr_logger_buffer;
-    }
+    if (!buffer || !logger_buffers_hashtable)
+        return NULL;
 
-    /* logger buffer not found */
-    return NULL;
+    return weechat_hashtable_get (logger_buffers_hashtable, buffer);
 }
 
 /*
@@ -159,6 +174,27 @@ logger_buffer_search_log_filename (const char *log_filename)
     return NULL;
 }
 
+/*
+ * Resets the cached filename mask in all logger buffers (called when a mask
+ * option is changed, created or deleted).
+ */
+
+void
+logger_buffer_reset_mask_all ()
+{
+    struct t_logger_buffer *ptr_logger_buffer;
+
+    for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
+         ptr_logger_buffer = ptr_logger_buffer->next_buffer)
+    {
+        if (ptr_logger_buffer->log_mask)
+        {
+            free (ptr_logger_buffer->log_mask);
+            ptr_logger_buffer->log_mask = NULL;
+        }
+    }
+}
+
 /*
  * Removes a logger buffer from list.
  */
@@ -185,16 +221,29 @@ logger_buffer_free (struct t_logger_buffer *logger_buffer)
     if (logger_buffer->next_buffer)
         (logger_buffer->next_buffer)->prev_buffer = logger_buffer->prev_buffer;
 
+    if (logger_buffers_hashtable)
+        weechat_hashtable_remove (logger_buffers_hashtable, ptr_buffer);
+
     /* free data */
+    if (logger_buffer->log_file)
+        logger_writer_close (logger_buffer->log_file,
+                             logger_buffer->log_index,
+                             logger_buffer->log_filename);
+    if (logger_buffer->log_mask)
+        free (logger_buffer->log_mask);
     if (logger_buffer->log_filename)
         free (logger_buffer->log_filename);
-    if (logger_buffer->log_file)
-        fclose (logger_buffer->log_file);
 
     free (logger_buffer);
 
     logger_buffers = new_logger_buffers;
 
+    if (!logger_buffers && logger_buffers_hashtable)
+    {
+        weechat_hashtable_free (logger_buffers_hashtable);
+        logger_buffers_hashtable = NULL;
+    }
+
     if (weechat_logger_plugin->debug)
     {
         weechat_printf_tags (NULL,
@@ -218,6 +267,7 @@ logger_buffer_add_to_infolist (struct t_infolist *infolist,
                                struct t_logger_buffer *logger_buffer)
 {
     struct t_infolist_item *ptr_item;
+    char value[64];
 
     if (!infolist || !logger_buffer)
         return 0;
@@ -228,10 +278,17 @@ logger_buffer_add_to_infolist (struct t_infolist *infolist,
 
     if (!weechat_infolist_new_var_pointer (ptr_item, "buffer", logger_buffer->buffer))
         return 0;
+    if (!weechat_infolist_new_var_string (ptr_item, "log_mask", logger_buffer->log_mask))
+        return 0;
     if (!weechat_infolist_new_var_string (ptr_item, "log_filename", logger_buffer->log_filename))
         return 0;
     if (!weechat_infolist_new_var_pointer (ptr_item, "log_file", logger_buffer->log_file))
         return 0;
+    if (!weechat_infolist_new_var_pointer (ptr_item, "log_index", logger_buffer->log_index))
+        return 0;
+    snprintf (value, sizeof (value), "%lu", logger_buffer->log_size);
+    if (!weechat_infolist_new_var_string (ptr_item, "log_size", value))
+        return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "log_enabled", logger_buffer->log_enabled))
         return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "log_level", logger_buffer->log_level))
@@ -21,12 +21,19 @@
 #define WEECHAT_LOGGER_BUFFER_H 1
 
 struct t_infolist;
+struct t_logger_index;
 
 struct t_logger_buffer
 {
     struct t_gui_buffer *buffer;          /* pointer to buffer              */
+    char *log_mask;                       /* filename mask (cached, NULL if */
+                                          /* not yet resolved)              */
     char *log_filename;                   /* log filename                   */
     FILE *log_file;                       /* log file                       */
+    struct t_logger_index *log_index;     /* index of log file (NULL if     */
+                                          /* index is disabled)             */
+    unsigned long log_size;               /* size of log file (approximate, */
+                                          /* used for rotation)             */
     int log_enabled;                      /* log enabled ?                  */
     int log_level;                        /* log level (0..9)               */
     int write_start_info_line;            /* 1 if start info line must be   */
@@ -44,6 +51,7 @@ extern struct t_logger_buffer *logger_buffer_add (struct t_gui_buffer *,
                                                   int log_level);
 extern struct t_logger_buffer *logger_buffer_search_buffer (struct t_gui_buffer *buffer);
 extern struct t_logger_buffer *logger_buffer_search_log_filename (const char *log_filename);
+extern void logger_buffer_reset_mask_all ();
 extern void logger_buffer_free (struct t_logger_buffer *logger_buffer);
 extern int logger_buffer_add_to_infolist (struct t_infolist *infolist,
                                           struct t_logger_buffer *logger_buffer);
@@ -21,9 +21,11 @@
 
 #include <stdlib.h>
 #include <limits.h>
+#include <stdio.h>
 
 #include "../weechat-plugin.h"
 #include "logger.h"
+#include "logger-buffer.h"
 #include "logger-config.h"
 
 
@@ -46,6 +48,8 @@ struct t_config_option *logger_config_color_backlog_line;
 
 struct t_config_option *logger_config_file_auto_log;
 struct t_config_option *logger_config_file_flush_delay;
+struct t_config_option *logger_config_file_index;
+struct t_config_option *logger_config_file_index_lines;
 struct t_config_option *logger_config_file_info_lines;
 struct t_config_option *logger_config_file_mask;
 struct t_config_option *logger_config_file_name_lower_case;
@@ -53,6 +57,10 @@ struct t_config_option *logger_config_file_nick_prefix;
 struct t_config_option *logger_config_file_nick_suffix;
 struct t_config_option *logger_config_file_path;
 struct t_config_option *logger_config_file_replacement_char;
+struct t_config_option *logger_config_file_rotation_compression_level;
+struct t_config_option *logger_config_file_rotation_compression_type;
+struct t_config_option *logger_config_file_rotation_size_max;
+struct t_config_option *logger_config_file_rotation_time;
 struct t_config_option *logger_config_file_time_format;
 
 
@@ -69,10 +77,29 @@ logger_config_change_file_option_restart_log (void *data,
     (void) data;
     (void) option;
 
+    logger_buffer_reset_mask_all ();
+
     if (!logger_config_loading)
         logger_adjust_log_filenames ();
 }
 
+/*
+ * Callback for changes on options "logger.file.index" and
+ * "logger.file.index_lines".
+ */
+
+void
+logger_config_index_change (void *data, struct t_config_option *option)
+{
+    /* make C compiler happy */
+    (void) data;
+    (void) option;
+
+    /* log files are opened again (with or without index) on next line */
+    if (!logger_config_loading)
+        logger_close_log_files ();
+}
+
 /*
  * Callback for changes on option "logger.file.flush_delay".
  */
@@ -251,6 +278,8 @@ logger_config_mask_change (void *data,
     (void) data;
     (void) option;
 
+    logger_buffer_reset_mask_all ();
+
     if (!logger_config_loading)
         logger_adjust_log_filenames ();
 }
@@ -272,6 +301,7 @@ logger_config_mask_delete_option (void *data,
 
     weechat_config_option_free (option);
 
+    logger_buffer_reset_mask_all ();
     logger_adjust_log_filenames ();
 
     return WEECHAT_CONFIG_OPTION_UNSET_OK_REMOVED;
@@ -330,6 +360,8 @@ logger_config_mask_create_option (void *data,
         }
     }
 
+    logger_buffer_reset_mask_all ();
+
     if (!logger_config_loading)
         logger_adjust_log_filenames ();
 
@@ -433,6 +465,22 @@ logger_config_init ()
            "files immediately for each line printed)"),
         NULL, 0, 3600, "120", NULL, 0, NULL, NULL,
         &logger_config_flush_delay_change, NULL, NULL, NULL);
+    logger_config_file_index = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "index", "boolean",
+        N_("write an index file next to each log file (same name with "
+           "extension \".idx\"), with date and nicks/words of blocks of lines; "
+           "it is used by command \"/logger search\" and to read backlog "
+           "(lines written before the index is enabled are not indexed)"),
+        NULL, 0, 0, "off", NULL, 0, NULL, NULL,
+        &logger_config_index_change, NULL, NULL, NULL);
+    logger_config_file_index_lines = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "index_lines", "integer",
+        N_("number of lines in each block of index file (a lower value makes "
+           "searches faster but index files bigger)"),
+        NULL, 16, 65536, "128", NULL, 0, NULL, NULL,
+        &logger_config_index_change, NULL, NULL, NULL);
     logger_config_file_info_lines = weechat_config_new_option (
         logger_config_file, ptr_section,
         "info_lines", "boolean",
@@ -480,12 +528,42 @@ logger_config_init ()
            "(like directory delimiter)"),
         NULL, 0, 0, "_", NULL, 0, NULL, NULL,
         &logger_config_change_file_option_restart_log, NULL, NULL, NULL);
+    logger_config_file_rotation_compression_level = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "rotation_compression_level", "integer",
+        N_("compression level for rotated log files (1 = fast, low "
+           "compression ... 9 = slow, best compression)"),
+        NULL, 1, 9, "6", NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL);
+    logger_config_file_rotation_compression_type = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "rotation_compression_type", "integer",
+        N_("compression of rotated log files: none = no compression, gzip = "
+           "compress with gzip (file is compressed by logger thread, the "
+           "extension \".gz\" is added)"),
+        "none|gzip", 0, 0, "none", NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL);
+    logger_config_file_rotation_size_max = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "rotation_size_max", "integer",
+        N_("when this size (in kilobytes) is reached, the log file is "
+           "rotated: it is renamed with date/time of rotation as extension "
+           "(for example \"irc.freenode.#weechat.weechatlog.20140301-120000\") "
+           "and a new log file is started (0 = no rotation by size)"),
+        NULL, 0, INT_MAX, "0", NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL);
+    logger_config_file_rotation_time = weechat_config_new_option (
+        logger_config_file, ptr_section,
+        "rotation_time", "integer",
+        N_("rotate log files when the day changes: none = no rotation by "
+           "time, daily = each day, weekly = each monday, monthly = first "
+           "day of each month"),
+        "none|daily|weekly|monthly", 0, 0, "none", NULL, 0, NULL, NULL,
+        NULL, NULL, NULL, NULL);
     logger_config_file_time_format = weechat_config_new_option (
         logger_config_file, ptr_section,
         "time_format", "string",
         N_("timestamp used in log files (see man strftime for date/time "
            "specifiers)"),
-        NULL, 0, 0, "%Y-%m-%d %H:%M:%S", NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL);
+        NULL, 0, 0, "%Y-%m-%d %H:%M:%S", NULL, 0, NULL, NULL,
+        NULL, NULL, NULL, NULL);
 
     /* level */
     ptr_section = weechat_config_new_section (logger_config_file, "level",
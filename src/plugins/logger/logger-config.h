@@ -22,6 +22,24 @@
 
 #define LOGGER_CONFIG_NAME "logger"
 
+enum t_logger_config_rotation_compression
+{
+    LOGGER_CONFIG_ROTATION_COMPRESSION_NONE = 0,
+    LOGGER_CONFIG_ROTATION_COMPRESSION_GZIP,
+    /* number of compression types */
+    LOGGER_CONFIG_NUM_ROTATION_COMPRESSIONS,
+};
+
+enum t_logger_config_rotation_time
+{
+    LOGGER_CONFIG_ROTATION_TIME_NONE = 0,
+    LOGGER_CONFIG_ROTATION_TIME_DAILY,
+    LOGGER_CONFIG_ROTATION_TIME_WEEKLY,
+    LOGGER_CONFIG_ROTATION_TIME_MONTHLY,
+    /* number of rotation times */
+    LOGGER_CONFIG_NUM_ROTATION_TIMES,
+};
+
 
 extern struct t_config_option *logger_config_look_backlog;
 
@@ -30,6 +48,8 @@ extern struct t_config_option *logger_config_color_backlog_line;
 
 extern struct t_config_option *logger_config_file_auto_log;
 extern struct t_config_option *logger_config_file_flush_delay;
+extern struct t_config_option *logger_config_file_index;
+extern struct t_config_option *logger_config_file_index_lines;
 extern struct t_config_option *logger_config_file_info_lines;
 extern struct t_config_option *logger_config_file_mask;
 extern struct t_config_option *logger_config_file_name_lower_case;
@@ -37,6 +57,10 @@ extern struct t_config_option *logger_config_file_nick_prefix;
 extern struct t_config_option *logger_config_file_nick_suffix;
 extern struct t_config_option *logger_config_file_path;
 extern struct t_config_option *logger_config_file_replacement_char;
+extern struct t_config_option *logger_config_file_rotation_compression_level;
+extern struct t_config_option *logger_config_file_rotation_compression_type;
+extern struct t_config_option *logger_config_file_rotation_size_max;
+extern struct t_config_option *logger_config_file_rotation_time;
 extern struct t_config_option *logger_config_file_time_format;
 
 extern struct t_config_option *logger_config_get_level (const char *name);
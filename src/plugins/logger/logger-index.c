@@ -0,0 +1,896 @@
+/*
+ * logger-index.c - sidecar index for log files (time index, bloom filters)
+ *
+ * Copyright (C) 2003-2014 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * When option logger.file.index is enabled, a file "<log>.idx" is written
+ * next to each log file. After a header, it contains blocks of fixed size:
+ * each block describes N consecutive lines of the log file (offset and size
+ * in log file, date of first/last line, number of lines) and has a bloom
+ * filter with nicks and words of these lines.
+ *
+ * The index is written by the writer thread (see logger-writer.c), so
+ * functions called by this thread must not use WeeChat API.
+ *
+ * Parts of log file which are not covered by a block (lines written before
+ * the index was enabled, or not yet in a complete block) are read entirely
+ * when searching.
+ */
+
+/* this define is needed for strptime() (not on OpenBSD/Sun) */
+#if !defined(__OpenBSD__) && !defined(__sun)
+#define _XOPEN_SOURCE 700
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <time.h>
+
+#include "../weechat-plugin.h"
+#include "logger.h"
+#include "logger-index.h"
+#include "logger-tail.h"
+
+
+/* size of block without bloom filter */
+#define LOGGER_INDEX_BLOCK_INFO_SIZE                                    \
+    offsetof(struct t_logger_index_block, bloom)
+
+/* lower case for ASCII chars only (the function can be used in any thread) */
+#define LOGGER_INDEX_TOLOWER(c)                                         \
+    ((((c) >= 'A') && ((c) <= 'Z')) ? (c) - 'A' + 'a' : (c))
+
+/* chars allowed in a word: ASCII letters/digits and all non-ASCII chars */
+#define LOGGER_INDEX_IS_WORD_CHAR(c)                                    \
+    ((((unsigned char)(c)) >= 0x80)                                     \
+     || (((c) >= 'a') && ((c) <= 'z'))                                  \
+     || (((c) >= 'A') && ((c) <= 'Z'))                                  \
+     || (((c) >= '0') && ((c) <= '9')))
+
+
+/*
+ * Builds name of index file for a log file.
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+logger_index_filename (const char *log_filename)
+{
+    char *filename;
+    int length;
+
+    if (!log_filename)
+        return NULL;
+
+    length = strlen (log_filename) + strlen (LOGGER_INDEX_EXTENSION) + 1;
+    filename = malloc (length);
+    if (!filename)
+        return NULL;
+
+    snprintf (filename, length, "%s%s", log_filename, LOGGER_INDEX_EXTENSION);
+
+    return filename;
+}
+
+/*
+ * Searches for next word in a string.
+ *
+ * Returns pointer to word found (and its length in "length"), NULL if no
+ * more words are found.
+ */
+
+const char *
+logger_index_next_word (const char *string, int *length)
+{
+    const char *ptr_word;
+
+    while (string[0] && !LOGGER_INDEX_IS_WORD_CHAR(string[0]))
+    {
+        string++;
+    }
+    if (!string[0])
+        return NULL;
+
+    ptr_word = string;
+    while (string[0] && LOGGER_INDEX_IS_WORD_CHAR(string[0]))
+    {
+        string++;
+    }
+    *length = string - ptr_word;
+
+    return ptr_word;
+}
+
+/*
+ * Computes the two hashes of a key for bloom filter (FNV-1a, 64 bits).
+ *
+ * The key is the type ('n' for a nick, 'w' for a word) followed by the
+ * string (case insensitive, for ASCII chars).
+ */
+
+void
+logger_index_bloom_hash (char type, const char *string, int length,
+                         uint32_t *hash1, uint32_t *hash2)
+{
+    uint64_t hash;
+    int i;
+
+    hash = 14695981039346656037ULL;
+    hash ^= (unsigned char)type;
+    hash *= 1099511628211ULL;
+    for (i = 0; i < length; i++)
+    {
+        hash ^= (unsigned char)LOGGER_INDEX_TOLOWER(string[i]);
+        hash *= 1099511628211ULL;
+    }
+
+    *hash1 = (uint32_t)hash;
+    *hash2 = (uint32_t)(hash >> 32) | 1;
+}
+
+/*
+ * Adds a key in a bloom filter.
+ */
+
+void
+logger_index_bloom_add (unsigned char *bloom, char type, const char *string,
+                        int length)
+{
+    uint32_t hash1, hash2, bit;
+    int i;
+
+    logger_index_bloom_hash (type, string, length, &hash1, &hash2);
+    for (i = 0; i < LOGGER_INDEX_BLOOM_HASHES; i++)
+    {
+        bit = (hash1 + (i * hash2)) % (LOGGER_INDEX_BLOOM_SIZE * 8);
+        bloom[bit / 8] |= (1 << (bit % 8));
+    }
+}
+
+/*
+ * Checks if a key may be in a bloom filter.
+ *
+ * Returns:
+ *   1: key may be in bloom filter
+ *   0: key is not in bloom filter
+ */
+
+int
+logger_index_bloom_check (const unsigned char *bloom, char type,
+                          const char *string, int length)
+{
+    uint32_t hash1, hash2, bit;
+    int i;
+
+    logger_index_bloom_hash (type, string, length, &hash1, &hash2);
+    for (i = 0; i < LOGGER_INDEX_BLOOM_HASHES; i++)
+    {
+        bit = (hash1 + (i * hash2)) % (LOGGER_INDEX_BLOOM_SIZE * 8);
+        if (!(bloom[bit / 8] & (1 << (bit % 8))))
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Resets current block of an index (new block starts at end of log file).
+ */
+
+void
+logger_index_block_reset (struct t_logger_index *index)
+{
+    memset (&index->block, 0, sizeof (index->block));
+    index->block.offset = index->log_size;
+}
+
+/*
+ * Checks header and blocks of an index file (file position is set after
+ * the header).
+ *
+ * Returns number of blocks in index, -1 if the index is invalid or does not
+ * match the log file.
+ */
+
+int
+logger_index_check_file (FILE *file, uint64_t log_size)
+{
+    struct t_logger_index_header header;
+    struct t_logger_index_block block;
+    long size;
+    int num_blocks;
+
+    if (fseek (file, 0, SEEK_END) != 0)
+        return -1;
+    size = ftell (file);
+    if ((size < (long)sizeof (header))
+        || ((size - sizeof (header)) % sizeof (block) != 0))
+    {
+        return -1;
+    }
+    num_blocks = (size - sizeof (header)) / sizeof (block);
+
+    /* check header */
+    if ((fseek (file, 0, SEEK_SET) != 0)
+        || (fread (&header, sizeof (header), 1, file) != 1)
+        || (memcmp (header.magic, LOGGER_INDEX_MAGIC, sizeof (header.magic)) != 0)
+        || (header.byte_order != LOGGER_INDEX_BYTE_ORDER)
+        || (header.bloom_size != LOGGER_INDEX_BLOOM_SIZE))
+    {
+        return -1;
+    }
+
+    /* last block must be in log file (log file may have been truncated) */
+    if (num_blocks > 0)
+    {
+        if ((fseek (file, sizeof (header) + ((num_blocks - 1) * sizeof (block)),
+                    SEEK_SET) != 0)
+            || (fread (&block, LOGGER_INDEX_BLOCK_INFO_SIZE, 1, file) != 1)
+            || (block.offset + block.size > log_size))
+        {
+            return -1;
+        }
+    }
+
+    if (fseek (file, sizeof (header), SEEK_SET) != 0)
+        return -1;
+
+    return num_blocks;
+}
+
+/*
+ * Opens (or creates) index file for a log file (called by main thread when
+ * log file is opened).
+ *
+ * An existing index is kept only if it matches the log file, otherwise it is
+ * created again (lines already in log file are then not indexed).
+ *
+ * Returns pointer to index, NULL if error.
+ */
+
+struct t_logger_index *
+logger_index_open (const char *log_filename, FILE *log_file,
+                   int lines_per_block)
+{
+    struct t_logger_index *new_index;
+    struct t_logger_index_header header;
+    struct stat st;
+    char *filename;
+    FILE *file;
+
+    if (!log_filename || !log_file)
+        return NULL;
+
+    if (fstat (fileno (log_file), &st) != 0)
+        return NULL;
+
+    filename = logger_index_filename (log_filename);
+    if (!filename)
+        return NULL;
+
+    file = NULL;
+
+    /* use existing index */
+    if (st.st_size > 0)
+    {
+        file = fopen (filename, "r+b");
+        if (file && (logger_index_check_file (file, st.st_size) < 0))
+        {
+            fclose (file);
+            file = NULL;
+        }
+    }
+
+    /* create a new index */
+    if (!file)
+    {
+        file = fopen (filename, "w+b");
+        if (file)
+        {
+            memset (&header, 0, sizeof (header));
+            memcpy (header.magic, LOGGER_INDEX_MAGIC, sizeof (header.magic));
+            header.byte_order = LOGGER_INDEX_BYTE_ORDER;
+            header.bloom_size = LOGGER_INDEX_BLOOM_SIZE;
+            if (fwrite (&header, sizeof (header), 1, file) != 1)
+            {
+                fclose (file);
+                file = NULL;
+            }
+        }
+    }
+
+    free (filename);
+
+    if (!file)
+        return NULL;
+
+    fseek (file, 0, SEEK_END);
+
+    new_index = malloc (sizeof (*new_index));
+    if (!new_index)
+    {
+        fclose (file);
+        return NULL;
+    }
+    new_index->file = file;
+    new_index->log_size = st.st_size;
+    new_index->lines_per_block = (lines_per_block > 0) ? lines_per_block : 1;
+    new_index->error = 0;
+    logger_index_block_reset (new_index);
+
+    return new_index;
+}
+
+/*
+ * Writes current block in index file (called by writer thread).
+ */
+
+void
+logger_index_write_block (struct t_logger_index *index)
+{
+    if (index->error || (index->block.lines == 0))
+        return;
+
+    if (fwrite (&index->block, sizeof (index->block), 1, index->file) != 1)
+        index->error = 1;
+    fflush (index->file);
+
+    logger_index_block_reset (index);
+}
+
+/*
+ * Adds a line written in log file to index (called by writer thread).
+ *
+ * Argument "message" is the message of line (without date and prefix), its
+ * words are added to the bloom filter of block, and "bytes" is the number of
+ * bytes written in log file (whole line: date, prefix, message and end of
+ * line).
+ */
+
+void
+logger_index_add_line (struct t_logger_index *index, time_t date,
+                       const char *nick, const char *message, int bytes)
+{
+    struct t_logger_index_block *ptr_block;
+    const char *ptr_word;
+    int length;
+
+    if (!index || index->error)
+        return;
+
+    if (bytes < 0)
+    {
+        /* write error in log file: offsets would be wrong */
+        index->error = 1;
+        return;
+    }
+
+    ptr_block = &index->block;
+
+    if ((ptr_block->lines > 0)
+        && ((uint64_t)ptr_block->size + bytes > UINT32_MAX))
+    {
+        logger_index_write_block (index);
+    }
+
+    ptr_block->size += bytes;
+    ptr_block->lines++;
+    index->log_size += bytes;
+
+    if (date > 0)
+    {
+        if ((ptr_block->date_first == 0) || (date < ptr_block->date_first))
+            ptr_block->date_first = date;
+        if (date > ptr_block->date_last)
+            ptr_block->date_last = date;
+        if (nick && nick[0])
+        {
+            logger_index_bloom_add (ptr_block->bloom, 'n',
+                                    nick, strlen (nick));
+        }
+        if (message)
+        {
+            ptr_word = message;
+            while ((ptr_word = logger_index_next_word (ptr_word, &length)))
+            {
+                logger_index_bloom_add (ptr_block->bloom, 'w',
+                                        ptr_word, length);
+                ptr_word += length;
+            }
+        }
+    }
+
+    if (ptr_block->lines >= (uint32_t)index->lines_per_block)
+        logger_index_write_block (index);
+}
+
+/*
+ * Writes last block and closes index (called by writer thread).
+ */
+
+void
+logger_index_close (struct t_logger_index *index)
+{
+    if (!index)
+        return;
+
+    logger_index_write_block (index);
+    fclose (index->file);
+    free (index);
+}
+
+/*
+ * Gets offset in log file where the last "n_lines" lines begin, using the
+ * index file.
+ *
+ * Returns offset, 0 if the index file does not exist or if it does not
+ * cover enough lines.
+ */
+
+uint64_t
+logger_index_tail_offset (const char *log_filename, uint64_t log_size,
+                          int n_lines)
+{
+    struct t_logger_index_block block;
+    char *filename;
+    FILE *file;
+    uint64_t offset;
+    int num_blocks, i, lines;
+
+    filename = logger_index_filename (log_filename);
+    if (!filename)
+        return 0;
+    file = fopen (filename, "rb");
+    free (filename);
+    if (!file)
+        return 0;
+
+    offset = 0;
+    lines = 0;
+    num_blocks = logger_index_check_file (file, log_size);
+    for (i = num_blocks - 1; i >= 0; i--)
+    {
+        if ((fseek (file,
+                    sizeof (struct t_logger_index_header) + (i * sizeof (block)),
+                    SEEK_SET) != 0)
+            || (fread (&block, LOGGER_INDEX_BLOCK_INFO_SIZE, 1, file) != 1)
+            || (block.offset > log_size))
+        {
+            break;
+        }
+        lines += block.lines;
+        if (lines >= n_lines)
+        {
+            offset = block.offset;
+            break;
+        }
+    }
+
+    fclose (file);
+
+    return offset;
+}
+
+/*
+ * Parses a date given by user: a timestamp, or "YYYY-MM-DD" with optional
+ * time ("YYYY-MM-DDTHH:MM" or "YYYY-MM-DDTHH:MM:SS").
+ *
+ * If "end_of_day" is 1 and that no time is given, the date returned is the
+ * last second of the day.
+ *
+ * Returns date, 0 if the string is not a valid date.
+ */
+
+time_t
+logger_index_parse_date (const char *string, int end_of_day)
+{
+    const char *formats[] = { "%Y-%m-%dT%H:%M:%S", "%Y-%m-%dT%H:%M",
+                              "%Y-%m-%d", NULL };
+    struct tm tm_date;
+    char *error;
+    long long number;
+    int i;
+
+    if (!string || !string[0])
+        return 0;
+
+    number = strtoll (string, &error, 10);
+    if (error && !error[0])
+        return (number > 0) ? (time_t)number : 0;
+
+    for (i = 0; formats[i]; i++)
+    {
+        memset (&tm_date, 0, sizeof (tm_date));
+        error = strptime (string, formats[i], &tm_date);
+        if (error && !error[0])
+        {
+            if (end_of_day && !formats[i + 1])
+            {
+                tm_date.tm_hour = 23;
+                tm_date.tm_min = 59;
+                tm_date.tm_sec = 59;
+            }
+            tm_date.tm_isdst = -1;
+            return mktime (&tm_date);
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Checks if prefix of a line in log file is the nick searched.
+ *
+ * Text written before/after nick (options logger.file.nick_prefix and
+ * logger.file.nick_suffix) and nick modes (like "@" or "+") are ignored.
+ *
+ * Returns:
+ *   1: prefix is the nick
+ *   0: prefix is not the nick
+ */
+
+int
+logger_index_match_nick (struct t_logger_index_search *search,
+                         const char *prefix)
+{
+    int length, length_suffix;
+
+    length = strlen (prefix);
+    if (search->nick_prefix && search->nick_prefix[0]
+        && (strncmp (prefix, search->nick_prefix,
+                     strlen (search->nick_prefix)) == 0))
+    {
+        prefix += strlen (search->nick_prefix);
+        length -= strlen (search->nick_prefix);
+    }
+    length_suffix = (search->nick_suffix) ? strlen (search->nick_suffix) : 0;
+    if ((length_suffix > 0) && (length >= length_suffix)
+        && (strcmp (prefix + length - length_suffix,
+                    search->nick_suffix) == 0))
+    {
+        length -= length_suffix;
+    }
+    while ((length > 0) && strchr ("@+%~&!", prefix[0]))
+    {
+        prefix++;
+        length--;
+    }
+
+    return (((int)strlen (search->nick) == length)
+            && (weechat_strncasecmp (prefix, search->nick, length) == 0)) ?
+        1 : 0;
+}
+
+/*
+ * Checks if a message contains the word searched.
+ *
+ * If the word searched is a single word (as stored in bloom filters), only
+ * whole words of message are compared, otherwise the word is searched
+ * anywhere in message.
+ *
+ * Returns:
+ *   1: message contains the word
+ *   0: message does not contain the word
+ */
+
+int
+logger_index_match_word (struct t_logger_index_search *search,
+                         int single_word, const char *message)
+{
+    const char *ptr_word;
+    int length, length_search, i;
+
+    if (!single_word)
+        return (weechat_strcasestr (message, search->word)) ? 1 : 0;
+
+    length_search = strlen (search->word);
+    ptr_word = message;
+    while ((ptr_word = logger_index_next_word (ptr_word, &length)))
+    {
+        if (length == length_search)
+        {
+            for (i = 0; i < length; i++)
+            {
+                if (LOGGER_INDEX_TOLOWER(ptr_word[i])
+                    != LOGGER_INDEX_TOLOWER(search->word[i]))
+                    break;
+            }
+            if (i == length)
+                return 1;
+        }
+        ptr_word += length;
+    }
+
+    return 0;
+}
+
+/*
+ * Checks if a block of index may contain lines searched.
+ *
+ * Returns:
+ *   1: block may contain lines searched
+ *   0: block does not contain lines searched
+ */
+
+int
+logger_index_match_block (struct t_logger_index_search *search,
+                          int single_word,
+                          struct t_logger_index_block *block)
+{
+    /* no line with a date in block */
+    if (block->date_first == 0)
+        return 0;
+
+    if ((search->date_start > 0) && (block->date_last < search->date_start))
+        return 0;
+    if ((search->date_end > 0) && (block->date_first > search->date_end))
+        return 0;
+
+    if (search->nick
+        && !logger_index_bloom_check (block->bloom, 'n', search->nick,
+                                      strlen (search->nick)))
+    {
+        return 0;
+    }
+
+    if (search->word && single_word
+        && !logger_index_bloom_check (block->bloom, 'w', search->word,
+                                      strlen (search->word)))
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+/*
+ * Searches lines in a part of log file (from "start" to "end").
+ *
+ * Returns:
+ *   1: OK
+ *   0: limit of lines reached or error
+ */
+
+int
+logger_index_search_data (struct t_logger_index_search *search,
+                          struct t_logger_tail_date_cache *date_cache,
+                          int single_word,
+                          const char *data, uint64_t start, uint64_t end,
+                          char **line, int *line_size,
+                          void (*callback)(void *data,
+                                           time_t date,
+                                           const char *prefix,
+                                           const char *message),
+                          void *callback_data)
+{
+    const char *pos_eol;
+    char *pos_tab, *prefix, *message, *new_line;
+    uint64_t line_end;
+    int length;
+    time_t date;
+
+    while (start < end)
+    {
+        if ((search->limit > 0) && (search->lines_found >= search->limit))
+            return 0;
+
+        pos_eol = memchr (data + start, '\n', end - start);
+        line_end = (pos_eol) ? (uint64_t)(pos_eol - data) : end;
+        length = line_end - start;
+        if ((length > 0) && (data[start + length - 1] == '\r'))
+            length--;
+        if (length > 0)
+        {
+            if (length + 1 > *line_size)
+            {
+                new_line = realloc (*line, length + 1);
+                if (!new_line)
+                    return 0;
+                *line = new_line;
+                *line_size = length + 1;
+            }
+            memcpy (*line, data + start, length);
+            (*line)[length] = '\0';
+
+            pos_tab = strchr (*line, '\t');
+            if (pos_tab)
+            {
+                pos_tab[0] = '\0';
+                date = logger_tail_get_date (date_cache, *line);
+                if ((date > 0)
+                    && ((search->date_start == 0) || (date >= search->date_start))
+                    && ((search->date_end == 0) || (date <= search->date_end)))
+                {
+                    prefix = pos_tab + 1;
+                    message = strchr (prefix, '\t');
+                    if (message)
+                    {
+                        message[0] = '\0';
+                        message++;
+                    }
+                    else
+                    {
+                        message = prefix;
+                        prefix = "";
+                    }
+                    if ((!search->nick
+                         || logger_index_match_nick (search, prefix))
+                        && (!search->word
+                            || logger_index_match_word (search, single_word,
+                                                        message)))
+                    {
+                        search->lines_found++;
+                        (callback) (callback_data, date,
+                                     prefix, message);
+                    }
+                }
+            }
+        }
+
+        start = line_end + 1;
+    }
+
+    return 1;
+}
+
+/*
+ * Searches lines in a log file, using the index file (if it exists) to skip
+ * blocks of lines that can not contain lines searched.
+ *
+ * Callback is called for each line found.
+ *
+ * Returns number of lines found, -1 if error.
+ */
+
+int
+logger_index_search (const char *log_filename,
+                     struct t_logger_index_search *search,
+                     void (*callback)(void *data,
+                                      time_t date,
+                                      const char *prefix,
+                                      const char *message),
+                     void *callback_data)
+{
+    struct t_logger_index_block block;
+    struct t_logger_tail_date_cache date_cache;
+    struct stat st;
+    const char *ptr_word;
+    char *filename, *line;
+    void *data;
+    FILE *file;
+    uint64_t pos;
+    int fd, i, single_word, length, line_size, rc;
+
+    if (!log_filename || !search || !callback)
+        return -1;
+
+    search->indexed = 0;
+    search->blocks_total = 0;
+    search->blocks_read = 0;
+    search->lines_found = 0;
+
+    /* map log file in memory */
+    fd = open (log_filename, O_RDONLY);
+    if (fd == -1)
+        return -1;
+    if (fstat (fd, &st) != 0)
+    {
+        close (fd);
+        return -1;
+    }
+    if (st.st_size == 0)
+    {
+        close (fd);
+        return 0;
+    }
+    data = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close (fd);
+    if (data == MAP_FAILED)
+        return -1;
+
+    /* a single word can be checked with bloom filters */
+    single_word = 0;
+    if (search->word)
+    {
+        ptr_word = logger_index_next_word (search->word, &length);
+        single_word = (ptr_word == search->word)
+            && ((int)strlen (search->word) == length);
+    }
+
+    logger_tail_date_cache_init (&date_cache, search->time_format);
+
+    line = NULL;
+    line_size = 0;
+    pos = 0;
+    rc = 1;
+
+    /* read blocks which may contain lines searched */
+    filename = logger_index_filename (log_filename);
+    file = (filename) ? fopen (filename, "rb") : NULL;
+    if (filename)
+        free (filename);
+    if (file)
+    {
+        search->blocks_total = logger_index_check_file (file, st.st_size);
+        if (search->blocks_total > 0)
+        {
+            search->indexed = 1;
+            for (i = 0; rc && (i < search->blocks_total); i++)
+            {
+                if ((fread (&block, sizeof (block), 1, file) != 1)
+                    || (block.offset < pos)
+                    || (block.offset + block.size > (uint64_t)st.st_size))
+                {
+                    /* invalid block: read the end of log file */
+                    break;
+                }
+                if (block.offset > pos)
+                {
+                    /* lines not indexed before the block */
+                    rc = logger_index_search_data (search, &date_cache,
+                                                   single_word, data,
+                                                   pos, block.offset,
+                                                   &line, &line_size,
+                                                   callback, callback_data);
+                }
+                if (rc && logger_index_match_block (search, single_word,
+                                                    &block))
+                {
+                    search->blocks_read++;
+                    rc = logger_index_search_data (search, &date_cache,
+                                                   single_word, data,
+                                                   block.offset,
+                                                   block.offset + block.size,
+                                                   &line, &line_size,
+                                                   callback, callback_data);
+                }
+                pos = block.offset + block.size;
+            }
+        }
+        else
+        {
+            search->blocks_total = 0;
+        }
+        fclose (file);
+    }
+
+    /* lines not indexed after last block */
+    if (rc)
+    {
+        logger_index_search_data (search, &date_cache, single_word, data,
+                                  pos, st.st_size, &line, &line_size,
+                                  callback, callback_data);
+    }
+
+    if (line)
+        free (line);
+    munmap (data, st.st_size);
+
+    return search->lines_found;
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2003-2014 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_LOGGER_INDEX_H
+#define WEECHAT_LOGGER_INDEX_H 1
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#define LOGGER_INDEX_EXTENSION   ".idx"
+#define LOGGER_INDEX_MAGIC       "WLOGIDX1"
+#define LOGGER_INDEX_BYTE_ORDER  0x01020304
+
+#define LOGGER_INDEX_BLOOM_SIZE   1024  /* size of bloom filter (in bytes)  */
+#define LOGGER_INDEX_BLOOM_HASHES 3     /* number of hashes per key         */
+
+/* header of index file */
+
+struct t_logger_index_header
+{
+    char magic[8];                     /* "WLOGIDX1"                        */
+    uint32_t byte_order;               /* LOGGER_INDEX_BYTE_ORDER (integers */
+                                       /* are stored in native byte order)  */
+    uint32_t bloom_size;               /* LOGGER_INDEX_BLOOM_SIZE           */
+};
+
+/* block of lines in log file (written as-is in index file, after header) */
+
+struct t_logger_index_block
+{
+    uint64_t offset;                   /* offset of block in log file       */
+    int64_t date_first;                /* date of first line with a date    */
+    int64_t date_last;                 /* date of last line with a date     */
+    uint32_t size;                     /* size of block in log file (bytes) */
+    uint32_t lines;                    /* number of lines in block          */
+    unsigned char bloom[LOGGER_INDEX_BLOOM_SIZE]; /* bloom filter with      */
+                                       /* nicks and words of lines          */
+};
+
+/* index being written (used only by writer thread after creation) */
+
+struct t_logger_index
+{
+    FILE *file;                        /* index file                        */
+    uint64_t log_size;                 /* size of log file                  */
+    int lines_per_block;               /* number of lines in a block        */
+    int error;                         /* 1 if a write error occurred       */
+    struct t_logger_index_block block; /* current block (not yet written)   */
+};
+
+/* search in a log file */
+
+struct t_logger_index_search
+{
+    time_t date_start;                 /* first date (0 = no limit)         */
+    time_t date_end;                   /* last date (0 = no limit)          */
+    const char *nick;                  /* nick (NULL = any nick)            */
+    const char *word;                  /* word (NULL = any message)         */
+    int limit;                         /* max lines returned (0 = no limit) */
+    const char *time_format;           /* time format used in log file      */
+    const char *nick_prefix;           /* text written before nick          */
+    const char *nick_suffix;           /* text written after nick           */
+    /* result */
+    int indexed;                       /* 1 if index file was used          */
+    int blocks_total;                  /* number of blocks in index         */
+    int blocks_read;                   /* number of blocks read             */
+    int lines_found;                   /* number of lines found             */
+};
+
+extern char *logger_index_filename (const char *log_filename);
+extern struct t_logger_index *logger_index_open (const char *log_filename,
+                                                 FILE *log_file,
+                                                 int lines_per_block);
+extern void logger_index_add_line (struct t_logger_index *index,
+                                   time_t date, const char *nick,
+                                   const char *message, int bytes);
+extern void logger_index_close (struct t_logger_index *index);
+extern uint64_t logger_index_tail_offset (const char *log_filename,
+                                          uint64_t log_size, int n_lines);
+extern time_t logger_index_parse_date (const char *string, int end_of_day);
+extern int logger_index_search (const char *log_filename,
+                                struct t_logger_index_search *search,
+                                void (*callback)(void *data,
+                                                 time_t date,
+                                                 const char *prefix,
+                                                 const char *message),
+                                void *callback_data);
+
+#endif /* WEECHAT_LOGGER_INDEX_H */
@@ -21,12 +21,106 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "../weechat-plugin.h"
 #include "logger.h"
 #include "logger-buffer.h"
+#include "logger-index.h"
 
 
+/*
+ * Callback for lines found by search: adds line in infolist.
+ */
+
+void
+logger_info_search_cb (void *data, time_t date,
+                       const char *prefix, const char *message)
+{
+    struct t_infolist_item *ptr_item;
+    char *prefix2, *message2;
+
+    ptr_item = weechat_infolist_new_item ((struct t_infolist *)data);
+    if (!ptr_item)
+        return;
+
+    prefix2 = (logger_charset) ?
+        weechat_iconv_to_internal (logger_charset, prefix) : NULL;
+    message2 = (logger_charset) ?
+        weechat_iconv_to_internal (logger_charset, message) : NULL;
+
+    weechat_infolist_new_var_time (ptr_item, "date", date);
+    weechat_infolist_new_var_string (ptr_item, "prefix",
+                                     (prefix2) ? prefix2 : prefix);
+    weechat_infolist_new_var_string (ptr_item, "message",
+                                     (message2) ? message2 : message);
+
+    if (prefix2)
+        free (prefix2);
+    if (message2)
+        free (message2);
+}
+
+/*
+ * Returns infolist with lines found in log file of a buffer.
+ *
+ * Arguments: "date_start,date_end,limit,nick,word" (dates are timestamps,
+ * empty values and 0 are ignored, word can contain commas).
+ */
+
+struct t_infolist *
+logger_info_search (struct t_gui_buffer *buffer, const char *arguments)
+{
+    struct t_infolist *ptr_infolist;
+    struct t_logger_index_search search;
+    const char *ptr_args, *pos_comma;
+    char *fields[4];
+    int i;
+
+    memset (&search, 0, sizeof (search));
+    for (i = 0; i < 4; i++)
+    {
+        fields[i] = NULL;
+    }
+
+    /* split arguments: date_start, date_end, limit, nick and word */
+    ptr_args = (arguments) ? arguments : "";
+    for (i = 0; i < 4; i++)
+    {
+        pos_comma = strchr (ptr_args, ',');
+        fields[i] = (pos_comma) ?
+            weechat_strndup (ptr_args, pos_comma - ptr_args) : strdup (ptr_args);
+        ptr_args = (pos_comma) ? pos_comma + 1 : "";
+    }
+    if (fields[0])
+        search.date_start = atol (fields[0]);
+    if (fields[1])
+        search.date_end = atol (fields[1]);
+    if (fields[2])
+        search.limit = atoi (fields[2]);
+    search.nick = (fields[3] && fields[3][0]) ? fields[3] : NULL;
+    search.word = (ptr_args[0]) ? ptr_args : NULL;
+
+    ptr_infolist = weechat_infolist_new ();
+    if (ptr_infolist)
+    {
+        if (logger_search (buffer, &search, &logger_info_search_cb,
+                           ptr_infolist) < 0)
+        {
+            weechat_infolist_free (ptr_infolist);
+            ptr_infolist = NULL;
+        }
+    }
+
+    for (i = 0; i < 4; i++)
+    {
+        if (fields[i])
+            free (fields[i]);
+    }
+
+    return ptr_infolist;
+}
+
 /*
  * Returns infolist with logger info.
  */
@@ -40,11 +134,17 @@ logger_info_get_infolist_cb (void *data, const char *infolist_name,
 
     /* make C compiler happy */
     (void) data;
-    (void) arguments;
 
     if (!infolist_name || !infolist_name[0])
         return NULL;
 
+    if (weechat_strcasecmp (infolist_name, "logger_search") == 0)
+    {
+        if (!pointer)
+            return NULL;
+        return logger_info_search (pointer, arguments);
+    }
+
     if (weechat_strcasecmp (infolist_name, "logger_buffer") == 0)
     {
         if (pointer && !logger_buffer_valid (pointer))
@@ -95,4 +195,11 @@ logger_info_init ()
                            N_("logger pointer (optional)"),
                            NULL,
                            &logger_info_get_infolist_cb, NULL);
+    weechat_hook_infolist ("logger_search",
+                           N_("lines found in log file of a buffer"),
+                           N_("buffer pointer (mandatory)"),
+                           N_("\"date_start,date_end,limit,nick,word\": "
+                              "dates are timestamps, empty values or 0 are "
+                              "ignored (optional)"),
+                           &logger_info_get_infolist_cb, NULL);
 }
@@ -1,5 +1,5 @@
 /*
- * logger-tail.c - return last lines of a file
+ * logger-tail.c - return last lines of a file and parse their dates
  *
  * Copyright (C) 2003-2014 Sébastien Helleu <flashcode@flashtux.org>
  *
@@ -19,31 +19,67 @@
  * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+/* this define is needed for strptime() (not on OpenBSD/Sun) */
+#if !defined(__OpenBSD__) && !defined(__sun)
+#define _XOPEN_SOURCE 700
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include "config.h"
 #endif
 
 #include <unistd.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
+#include <dirent.h>
 #include <string.h>
+#include <time.h>
+#include <zlib.h>
 
 #include "logger.h"
+#include "logger-index.h"
 #include "logger-tail.h"
 
 
-#define LOGGER_TAIL_BUFSIZE 4096
+#define LOGGER_TAIL_GZIP_BUFSIZE (256 * 1024)
+
+#define LOGGER_TAIL_ONES  0x0101010101010101ULL
+#define LOGGER_TAIL_HIGHS 0x8080808080808080ULL
+#define LOGGER_TAIL_LF    0x0A0A0A0A0A0A0A0AULL
+#define LOGGER_TAIL_CR    0x0D0D0D0D0D0D0D0DULL
+
+/* non-zero if one of the 8 bytes in "word" is zero */
+#define LOGGER_TAIL_HAS_ZERO(word)                                      \
+    (((word) - LOGGER_TAIL_ONES) & ~(word) & LOGGER_TAIL_HIGHS)
 
 
 /*
- * Searches for last EOL in a string.
+ * Searches for last EOL ('\n' or '\r') in a string, from "string_ptr" back
+ * to "string_start" (both included).
+ *
+ * The string is scanned 8 bytes at a time, until a word with an EOL is found.
  */
 
 char *
 logger_tail_last_eol (const char *string_start, const char *string_ptr)
 {
+    uint64_t word;
+
+    while (string_ptr - string_start >= 7)
+    {
+        memcpy (&word, string_ptr - 7, sizeof (word));
+        if (LOGGER_TAIL_HAS_ZERO(word ^ LOGGER_TAIL_LF)
+            || LOGGER_TAIL_HAS_ZERO(word ^ LOGGER_TAIL_CR))
+        {
+            break;
+        }
+        string_ptr -= 8;
+    }
+
     while (string_ptr >= string_start)
     {
         if ((string_ptr[0] == '\n') || (string_ptr[0] == '\r'))
@@ -56,180 +92,715 @@ logger_tail_last_eol (const char *string_start, const char *string_ptr)
 }
 
 /*
- * Returns last lines of a file.
+ * Returns last lines of data (empty lines are ignored).
  *
  * Note: result must be freed with function "logger_tail_free".
  */
 
-struct t_logger_line *
-logger_tail_file (const char *filename, int n_lines)
+struct t_logger_tail *
+logger_tail_data (const char *data, size_t size, int n_lines)
+{
+    struct t_logger_tail *tail;
+    const char *pos_eol;
+    size_t *bounds, *new_bounds, start, end, length;
+    int count, bounds_size, i;
+    char *ptr_data;
+
+    if (!data || (size == 0) || (n_lines <= 0))
+        return NULL;
+
+    /*
+     * scan data backwards, store start/end of lines (in reverse order) in
+     * array "bounds"
+     */
+    bounds_size = (n_lines < 1024) ? n_lines : 1024;
+    bounds = malloc (bounds_size * 2 * sizeof (*bounds));
+    if (!bounds)
+        return NULL;
+    count = 0;
+    length = 0;
+    end = size;
+    while ((count < n_lines) && (end > 0))
+    {
+        pos_eol = logger_tail_last_eol (data, data + end - 1);
+        start = (pos_eol) ? (size_t)(pos_eol - data) + 1 : 0;
+        if (end > start)
+        {
+            if (count == bounds_size)
+            {
+                bounds_size = (bounds_size * 2 < n_lines) ?
+                    bounds_size * 2 : n_lines;
+                new_bounds = realloc (bounds,
+                                      bounds_size * 2 * sizeof (*bounds));
+                if (!new_bounds)
+                {
+                    free (bounds);
+                    return NULL;
+                }
+                bounds = new_bounds;
+            }
+            bounds[count * 2] = start;
+            bounds[(count * 2) + 1] = end;
+            length += end - start + 1;
+            count++;
+        }
+        if (!pos_eol)
+            break;
+        end = pos_eol - data;
+    }
+
+    if (count == 0)
+    {
+        free (bounds);
+        return NULL;
+    }
+
+    /* copy lines (in file order) to a single block */
+    tail = malloc (sizeof (*tail));
+    if (!tail)
+    {
+        free (bounds);
+        return NULL;
+    }
+    tail->data = malloc (length);
+    tail->lines = malloc (count * sizeof (*tail->lines));
+    if (!tail->data || !tail->lines)
+    {
+        free (bounds);
+        logger_tail_free (tail);
+        return NULL;
+    }
+    tail->num_lines = count;
+    ptr_data = tail->data;
+    for (i = 0; i < count; i++)
+    {
+        start = bounds[(count - i - 1) * 2];
+        end = bounds[((count - i - 1) * 2) + 1];
+        memcpy (ptr_data, data + start, end - start);
+        ptr_data[end - start] = '\0';
+        tail->lines[i] = ptr_data;
+        ptr_data += end - start + 1;
+    }
+
+    free (bounds);
+
+    return tail;
+}
+
+/*
+ * Returns last lines of a file (file is mapped in memory).
+ *
+ * If the file has an index, only the end of file with the last lines is
+ * mapped.
+ *
+ * Note: result must be freed with function "logger_tail_free".
+ */
+
+struct t_logger_tail *
+logger_tail_map_file (const char *filename, int n_lines)
 {
     int fd;
-    off_t file_length, file_pos;
-    size_t to_read;
-    ssize_t bytes_read;
-    char buf[LOGGER_TAIL_BUFSIZE + 1];
-    char *ptr_buf, *pos_eol, *part_of_line, *new_part_of_line;
-    struct t_logger_line *ptr_line, *new_line;
-
-    /* open file */
+    struct stat st;
+    void *data;
+    uint64_t offset, offset_map;
+    long page_size;
+    struct t_logger_tail *tail;
+
     fd = open (filename, O_RDONLY);
     if (fd == -1)
         return NULL;
 
-    /* seek to the end of file */
-    file_length = lseek (fd, (off_t)0, SEEK_END);
-    if (file_length <= 0)
+    if ((fstat (fd, &st) != 0) || (st.st_size <= 0))
     {
         close (fd);
         return NULL;
     }
-    to_read = file_length;
-    file_pos = file_length - LOGGER_TAIL_BUFSIZE;
-    if (file_pos < 0)
-        file_pos = 0;
-    else
-        to_read = LOGGER_TAIL_BUFSIZE;
-    lseek (fd, file_pos, SEEK_SET);
 
-    /* loop until we have "n_lines" lines in list */
-    part_of_line = NULL;
-    ptr_line = NULL;
-    while (n_lines > 0)
+    /* start of last lines (offset for mmap must be a multiple of page size) */
+    offset = logger_index_tail_offset (filename, st.st_size, n_lines);
+    page_size = sysconf (_SC_PAGESIZE);
+    offset_map = (page_size > 0) ? offset - (offset % page_size) : 0;
+    if (offset_map == 0)
+        offset = 0;
+
+    while (1)
     {
-        lseek (fd, file_pos, SEEK_SET);
-        bytes_read = read (fd, buf, to_read);
-        if (bytes_read <= 0)
+        data = mmap (NULL, st.st_size - offset_map, PROT_READ, MAP_PRIVATE,
+                     fd, offset_map);
+        if (data == MAP_FAILED)
         {
-            logger_tail_free (ptr_line);
-            close (fd);
-            return NULL;
+            tail = NULL;
+            break;
         }
-        buf[bytes_read] = '\0';
-        ptr_buf = buf + bytes_read - 1;
-        while (ptr_buf && (ptr_buf >= buf))
+        tail = logger_tail_data ((const char *)data + (offset - offset_map),
+                                 st.st_size - offset, n_lines);
+        munmap (data, st.st_size - offset_map);
+        if ((tail && (tail->num_lines >= n_lines)) || (offset == 0))
+            break;
+        /* not enough lines after offset (index not up to date): read all */
+        if (tail)
+            logger_tail_free (tail);
+        offset = 0;
+        offset_map = 0;
+    }
+
+    close (fd);
+
+    return tail;
+}
+
+/*
+ * Adds the lines of "tail" in a ring of "n_lines" lines (the oldest lines in
+ * ring are replaced when the ring is full).
+ *
+ * Argument "ring_next" is the index of next line to replace in ring and
+ * "ring_count" the number of lines in ring; both are updated.
+ *
+ * Returns:
+ *   1: OK
+ *   0: not enough memory
+ */
+
+int
+logger_tail_ring_add (char **ring, int n_lines, int *ring_next,
+                      int *ring_count, struct t_logger_tail *tail)
+{
+    int i;
+
+    for (i = 0; i < tail->num_lines; i++)
+    {
+        if (ring[*ring_next])
+            free (ring[*ring_next]);
+        ring[*ring_next] = strdup (tail->lines[i]);
+        if (!ring[*ring_next])
+            return 0;
+        *ring_next = (*ring_next + 1) % n_lines;
+        if (*ring_count < n_lines)
+            (*ring_count)++;
+    }
+
+    return 1;
+}
+
+/*
+ * Returns lines of a ring (built with function "logger_tail_ring_add"), from
+ * oldest to newest.
+ *
+ * Note: result must be freed with function "logger_tail_free".
+ */
+
+struct t_logger_tail *
+logger_tail_ring_get (char **ring, int n_lines, int ring_next, int ring_count)
+{
+    struct t_logger_tail *tail;
+    char *ptr_data;
+    size_t length;
+    int i, index, index_start, length_line;
+
+    if (ring_count == 0)
+        return NULL;
+
+    index_start = (ring_count < n_lines) ? 0 : ring_next;
+
+    length = 0;
+    for (i = 0; i < ring_count; i++)
+    {
+        length += strlen (ring[(index_start + i) % n_lines]) + 1;
+    }
+
+    tail = malloc (sizeof (*tail));
+    if (!tail)
+        return NULL;
+    tail->data = malloc (length);
+    tail->lines = malloc (ring_count * sizeof (*tail->lines));
+    if (!tail->data || !tail->lines)
+    {
+        logger_tail_free (tail);
+        return NULL;
+    }
+    tail->num_lines = ring_count;
+    ptr_data = tail->data;
+    for (i = 0; i < ring_count; i++)
+    {
+        index = (index_start + i) % n_lines;
+        length_line = strlen (ring[index]);
+        memcpy (ptr_data, ring[index], length_line + 1);
+        tail->lines[i] = ptr_data;
+        ptr_data += length_line + 1;
+    }
+
+    return tail;
+}
+
+/*
+ * Returns last lines of a file compressed with gzip.
+ *
+ * The file is decompressed by chunks: the last lines of each chunk are kept
+ * in a ring of "n_lines" lines, so that the memory used does not depend on
+ * the size of file (an incomplete line at the end of a chunk is kept in
+ * buffer and completed with next chunk).
+ *
+ * Note: result must be freed with function "logger_tail_free".
+ */
+
+struct t_logger_tail *
+logger_tail_gzip_file (const char *filename, int n_lines)
+{
+    gzFile gz_file;
+    char *data, *new_data, **ring;
+    const char *pos_eol;
+    size_t size, length, length_lines;
+    int bytes_read, ring_next, ring_count, error, i;
+    struct t_logger_tail *tail;
+
+    if (n_lines <= 0)
+        return NULL;
+
+    gz_file = gzopen (filename, "rb");
+    if (!gz_file)
+        return NULL;
+
+    size = LOGGER_TAIL_GZIP_BUFSIZE;
+    length = 0;
+    data = malloc (size);
+    ring = calloc (n_lines, sizeof (*ring));
+    ring_next = 0;
+    ring_count = 0;
+    error = (!data || !ring);
+
+    while (!error)
+    {
+        if (length == size)
         {
-            pos_eol = logger_tail_last_eol (buf, ptr_buf);
-            if ((pos_eol && (pos_eol[1] || part_of_line)) || (file_pos == 0))
+            /* buffer full with a single incomplete line: grow buffer */
+            new_data = realloc (data, size * 2);
+            if (!new_data)
             {
-                /* use data and part_of_line (if existing) to build a new line */
-                if (!pos_eol)
-                {
-                    ptr_buf = NULL;
-                    pos_eol = buf;
-                }
-                else
-                {
-                    ptr_buf = pos_eol - 1;
-                    pos_eol[0] = '\0';
-                    pos_eol++;
-                }
-                if (part_of_line || pos_eol[0])
-                {
-                    new_line = malloc (sizeof (*new_line));
-                    if (!new_line)
-                    {
-                        logger_tail_free (ptr_line);
-                        ptr_line = NULL;
-                        break;
-                    }
-                    if (part_of_line)
-                    {
-                        new_line->data = malloc ((strlen (pos_eol) +
-                                                  strlen (part_of_line) + 1));
-                        if (!new_line->data)
-                        {
-                            free (part_of_line);
-                            logger_tail_free (ptr_line);
-                            close (fd);
-                            return NULL;
-                        }
-                        strcpy (new_line->data, pos_eol);
-                        strcat (new_line->data, part_of_line);
-                        free (part_of_line);
-                        part_of_line = NULL;
-                    }
-                    else
-                    {
-                        new_line->data = strdup (pos_eol);
-                    }
-                    new_line->next_line = ptr_line;
-                    ptr_line = new_line;
-                    n_lines--;
-                    if (n_lines <= 0)
-                        break;
-                }
+                error = 1;
+                break;
             }
-            else if (!pos_eol)
+            data = new_data;
+            size *= 2;
+        }
+        bytes_read = gzread (gz_file, data + length, size - length);
+        if (bytes_read < 0)
+        {
+            /* error in compressed data: use lines decompressed so far */
+            bytes_read = 0;
+        }
+        length += bytes_read;
+        if (length == 0)
+            break;
+
+        /*
+         * add complete lines to the ring (all data at end of file), and keep
+         * the incomplete line in buffer
+         */
+        if (bytes_read == 0)
+        {
+            length_lines = length;
+        }
+        else
+        {
+            pos_eol = logger_tail_last_eol (data, data + length - 1);
+            length_lines = (pos_eol) ? (size_t)(pos_eol - data) + 1 : 0;
+        }
+        if (length_lines > 0)
+        {
+            tail = logger_tail_data (data, length_lines, n_lines);
+            if (tail)
             {
-                /*
-                 * beginning of read buffer reached without EOL, then we
-                 * add string to part_of_line, we'll use that later
-                 */
-                if (part_of_line)
-                {
-                    new_part_of_line = malloc (strlen (buf) + strlen (part_of_line) + 1);
-                    if (!new_part_of_line)
-                    {
-                        free (part_of_line);
-                        logger_tail_free (ptr_line);
-                        close (fd);
-                        return NULL;
-                    }
-                    strcpy (new_part_of_line, buf);
-                    strcat (new_part_of_line, part_of_line);
-                    free (part_of_line);
-                    part_of_line = new_part_of_line;
-                }
-                else
-                {
-                    part_of_line = malloc (strlen (buf) + 1);
-                    strcpy (part_of_line, buf);
-                }
-                ptr_buf = NULL;
+                error = !logger_tail_ring_add (ring, n_lines, &ring_next,
+                                               &ring_count, tail);
+                logger_tail_free (tail);
             }
-            else
-                ptr_buf = pos_eol - 1;
+            length -= length_lines;
+            if (length > 0)
+                memmove (data, data + length_lines, length);
         }
-        if (file_pos == 0)
+        if (bytes_read == 0)
             break;
-        to_read = file_pos;
-        file_pos -= LOGGER_TAIL_BUFSIZE;
-        if (file_pos < 0)
-            file_pos = 0;
-        else
-            to_read = LOGGER_TAIL_BUFSIZE;
     }
+    gzclose (gz_file);
 
-    if (part_of_line)
-        free (part_of_line);
+    tail = (error) ?
+        NULL : logger_tail_ring_get (ring, n_lines, ring_next, ring_count);
 
-    close (fd);
+    if (data)
+        free (data);
+    if (ring)
+    {
+        for (i = 0; i < n_lines; i++)
+        {
+            if (ring[i])
+                free (ring[i]);
+        }
+        free (ring);
+    }
 
-    return ptr_line;
+    return tail;
 }
 
 /*
- * Frees structure returned by function "logger_tail_file".
+ * Checks if a string is the extension of a rotated log file (without the
+ * first "."): "YYYYMMDD-HHMMSS", optionally followed by "-N" and ".gz".
+ *
+ * Returns:
+ *   1: string is an extension of rotated log file
+ *   0: string is not an extension of rotated log file
  */
 
-void
-logger_tail_free (struct t_logger_line *lines)
+int
+logger_tail_is_rotated_extension (const char *string)
+{
+    int i;
+
+    for (i = 0; i < 15; i++)
+    {
+        if (i == 8)
+        {
+            if (string[i] != '-')
+                return 0;
+        }
+        else if ((string[i] < '0') || (string[i] > '9'))
+            return 0;
+    }
+    string += 15;
+
+    if ((string[0] == '-') && (string[1] >= '0') && (string[1] <= '9'))
+    {
+        string++;
+        while ((string[0] >= '0') && (string[0] <= '9'))
+        {
+            string++;
+        }
+    }
+
+    return ((string[0] == '\0') || (strcmp (string, ".gz") == 0)) ? 1 : 0;
+}
+
+/*
+ * Compares extensions of two rotated log files (without the first ".").
+ *
+ * Returns:
+ *   < 0: extension1 is older than extension2
+ *     0: same extensions
+ *   > 0: extension1 is newer than extension2
+ */
+
+int
+logger_tail_rotated_extension_cmp (const char *extension1,
+                                   const char *extension2)
+{
+    int rc, number1, number2;
+
+    /* compare date/time of rotation */
+    rc = strncmp (extension1, extension2, 15);
+    if (rc != 0)
+        return rc;
+
+    /* compare counters (file rotated many times in same second) */
+    number1 = (extension1[15] == '-') ? atoi (extension1 + 16) : 0;
+    number2 = (extension2[15] == '-') ? atoi (extension2 + 16) : 0;
+    if (number1 != number2)
+        return (number1 < number2) ? -1 : 1;
+
+    /* prefer uncompressed file (compression may be in progress) */
+    return strcmp (extension2, extension1);
+}
+
+/*
+ * Searches for the last rotated file of a log file (rotated files are in the
+ * same directory as log file, with date/time of rotation as extension).
+ *
+ * Note: result must be freed after use.
+ *
+ * Returns path to last rotated file, NULL if there is no rotated file.
+ */
+
+char *
+logger_tail_last_rotated_file (const char *filename)
+{
+    DIR *dir;
+    struct dirent *entry;
+    const char *pos_last_sep, *ptr_base;
+    char *dir_name, *last_name, *path;
+    int length_base, length;
+
+    pos_last_sep = strrchr (filename, '/');
+    ptr_base = (pos_last_sep) ? pos_last_sep + 1 : filename;
+    length_base = strlen (ptr_base);
+    dir_name = (pos_last_sep) ?
+        strndup (filename, pos_last_sep - filename + 1) : strdup (".");
+    if (!dir_name)
+        return NULL;
+
+    dir = opendir (dir_name);
+    if (!dir)
+    {
+        free (dir_name);
+        return NULL;
+    }
+
+    last_name = NULL;
+    while ((entry = readdir (dir)))
+    {
+        if ((strncmp (entry->d_name, ptr_base, length_base) == 0)
+            && (entry->d_name[length_base] == '.')
+            && logger_tail_is_rotated_extension (entry->d_name + length_base + 1)
+            && (!last_name
+                || (logger_tail_rotated_extension_cmp (
+                        entry->d_name + length_base + 1,
+                        last_name + length_base + 1) > 0)))
+        {
+            if (last_name)
+                free (last_name);
+            last_name = strdup (entry->d_name);
+        }
+    }
+    closedir (dir);
+
+    path = NULL;
+    if (last_name)
+    {
+        length = strlen (dir_name) + 1 + strlen (last_name) + 1;
+        path = malloc (length);
+        if (path)
+        {
+            snprintf (path, length, "%s%s%s",
+                      dir_name,
+                      (pos_last_sep) ? "" : "/",
+                      last_name);
+        }
+        free (last_name);
+    }
+    free (dir_name);
+
+    return path;
+}
+
+/*
+ * Concatenates lines of two tails (lines of "tail1" are before lines of
+ * "tail2"); both tails are freed.
+ *
+ * Returns new tail, NULL if error.
+ */
+
+struct t_logger_tail *
+logger_tail_concat (struct t_logger_tail *tail1, struct t_logger_tail *tail2)
+{
+    struct t_logger_tail *tail;
+    size_t length1, length2;
+    int i;
+
+    tail = malloc (sizeof (*tail));
+    if (!tail)
+        goto end;
+
+    length1 = (tail1->lines[tail1->num_lines - 1] - tail1->data) +
+        strlen (tail1->lines[tail1->num_lines - 1]) + 1;
+    length2 = (tail2->lines[tail2->num_lines - 1] - tail2->data) +
+        strlen (tail2->lines[tail2->num_lines - 1]) + 1;
+    tail->num_lines = tail1->num_lines + tail2->num_lines;
+    tail->data = malloc (length1 + length2);
+    tail->lines = malloc (tail->num_lines * sizeof (*tail->lines));
+    if (!tail->data || !tail->lines)
+    {
+        logger_tail_free (tail);
+        tail = NULL;
+        goto end;
+    }
+    memcpy (tail->data, tail1->data, length1);
+    memcpy (tail->data + length1, tail2->data, length2);
+    for (i = 0; i < tail1->num_lines; i++)
+    {
+        tail->lines[i] = tail->data + (tail1->lines[i] - tail1->data);
+    }
+    for (i = 0; i < tail2->num_lines; i++)
+    {
+        tail->lines[tail1->num_lines + i] = tail->data + length1 +
+            (tail2->lines[i] - tail2->data);
+    }
+
+end:
+    logger_tail_free (tail1);
+    logger_tail_free (tail2);
+
+    return tail;
+}
+
+/*
+ * Returns last lines of a log file.
+ *
+ * If the log file has less than "n_lines" lines (for example just after a
+ * rotation), the missing lines are read in the last rotated file (which can
+ * be compressed).
+ *
+ * Note: result must be freed with function "logger_tail_free".
+ */
+
+struct t_logger_tail *
+logger_tail_file (const char *filename, int n_lines)
 {
-    struct t_logger_line *ptr_line, *next_line;
+    struct t_logger_tail *tail, *tail_rotated;
+    char *filename_rotated;
+    int length;
+
+    tail = logger_tail_map_file (filename, n_lines);
+    if (tail && (tail->num_lines >= n_lines))
+        return tail;
 
-    if (!lines)
+    filename_rotated = logger_tail_last_rotated_file (filename);
+    if (!filename_rotated)
+        return tail;
+
+    n_lines -= (tail) ? tail->num_lines : 0;
+    length = strlen (filename_rotated);
+    if ((length > 3) && (strcmp (filename_rotated + length - 3, ".gz") == 0))
+        tail_rotated = logger_tail_gzip_file (filename_rotated, n_lines);
+    else
+        tail_rotated = logger_tail_map_file (filename_rotated, n_lines);
+    free (filename_rotated);
+
+    if (!tail_rotated)
+        return tail;
+    if (!tail)
+        return tail_rotated;
+
+    return logger_tail_concat (tail_rotated, tail);
+}
+
+/*
+ * Frees structure returned by functions "logger_tail_data" and
+ * "logger_tail_file".
+ */
+
+void
+logger_tail_free (struct t_logger_tail *tail)
+{
+    if (!tail)
         return;
 
-    ptr_line = lines;
-    while (ptr_line)
+    if (tail->data)
+        free (tail->data);
+    if (tail->lines)
+        free (tail->lines);
+    free (tail);
+}
+
+/*
+ * Initializes a cache for dates parsed with function "logger_tail_get_date".
+ */
+
+void
+logger_tail_date_cache_init (struct t_logger_tail_date_cache *date_cache,
+                             const char *time_format)
+{
+    time_t time_now;
+
+    date_cache->time_format = time_format;
+    date_cache->fast_parse = (strcmp (time_format,
+                                      LOGGER_TAIL_TIME_FORMAT_DEFAULT) == 0);
+    date_cache->key[0] = '\0';
+    date_cache->time = 0;
+
+    /*
+     * we get current time to initialize daylight saving time in structure
+     * tm_now (used by strptime), otherwise printed time will be shifted and
+     * will not use DST used on machine
+     */
+    memset (&date_cache->tm_now, 0, sizeof (date_cache->tm_now));
+    time_now = time (NULL);
+    localtime_r (&time_now, &date_cache->tm_now);
+}
+
+/*
+ * Reads a number with exactly "digits" digits in a string.
+ *
+ * Returns the number, -1 if the string does not start with "digits" digits.
+ */
+
+int
+logger_tail_get_number (const char *string, int digits)
+{
+    int i, number;
+
+    number = 0;
+    for (i = 0; i < digits; i++)
     {
-        next_line = ptr_line->next_line;
+        if ((string[i] < '0') || (string[i] > '9'))
+            return -1;
+        number = (number * 10) + (string[i] - '0');
+    }
+
+    return number;
+}
+
+/*
+ * Parses date of a line (string must contain only the date, without the tab
+ * and the message).
+ *
+ * With default time format ("%Y-%m-%d %H:%M:%S"), the date is parsed without
+ * strptime, and mktime is called only when the day or hour changes (result
+ * is cached in "date_cache").
+ *
+ * Returns date parsed, 0 if the string is not a valid date.
+ */
 
-        if (ptr_line->data)
-            free (ptr_line->data);
-        free (ptr_line);
+time_t
+logger_tail_get_date (struct t_logger_tail_date_cache *date_cache,
+                      const char *string)
+{
+    struct tm tm_line;
+    char *error;
+    int year, month, day, hour, min, sec;
 
-        ptr_line = next_line;
+    if (date_cache->fast_parse)
+    {
+        /* format: "YYYY-MM-DD HH:MM:SS" */
+        if ((strlen (string) != 19)
+            || (string[4] != '-') || (string[7] != '-') || (string[10] != ' ')
+            || (string[13] != ':') || (string[16] != ':'))
+        {
+            return 0;
+        }
+        min = logger_tail_get_number (string + 14, 2);
+        sec = logger_tail_get_number (string + 17, 2);
+        if ((min < 0) || (min > 59) || (sec < 0) || (sec > 60))
+            return 0;
+        if (strncmp (string, date_cache->key, 13) != 0)
+        {
+            year = logger_tail_get_number (string, 4);
+            month = logger_tail_get_number (string + 5, 2);
+            day = logger_tail_get_number (string + 8, 2);
+            hour = logger_tail_get_number (string + 11, 2);
+            if ((year <= 1900) || (month < 1) || (month > 12)
+                || (day < 1) || (day > 31) || (hour < 0) || (hour > 23))
+            {
+                return 0;
+            }
+            memset (&tm_line, 0, sizeof (tm_line));
+            tm_line.tm_year = year - 1900;
+            tm_line.tm_mon = month - 1;
+            tm_line.tm_mday = day;
+            tm_line.tm_hour = hour;
+            tm_line.tm_isdst = -1;
+            date_cache->time = mktime (&tm_line);
+            if (date_cache->time == (time_t)-1)
+            {
+                date_cache->key[0] = '\0';
+                return 0;
+            }
+            memcpy (date_cache->key, string, 13);
+            date_cache->key[13] = '\0';
+        }
+        return date_cache->time + (min * 60) + sec;
     }
+
+    memcpy (&tm_line, &date_cache->tm_now, sizeof (tm_line));
+    error = strptime (string, date_cache->time_format, &tm_line);
+    if (error && !error[0] && (tm_line.tm_year > 0))
+        return mktime (&tm_line);
+
+    return 0;
 }
@@ -20,14 +20,37 @@
 #ifndef WEECHAT_LOGGER_TAIL_H
 #define WEECHAT_LOGGER_TAIL_H 1
 
-struct t_logger_line
+#include <time.h>
+
+#define LOGGER_TAIL_TIME_FORMAT_DEFAULT "%Y-%m-%d %H:%M:%S"
+
+struct t_logger_tail
+{
+    char *data;                        /* content of lines (each line is    */
+                                       /* ended by '\0')                    */
+    char **lines;                      /* pointers to lines in "data"       */
+    int num_lines;                     /* number of lines                   */
+};
+
+struct t_logger_tail_date_cache
 {
-    char *data;                        /* line content                      */
-    struct t_logger_line *next_line;   /* link to next line                 */
+    const char *time_format;           /* time format used in log file      */
+    int fast_parse;                    /* 1 if time format is the default   */
+                                       /* one (parsed without strptime)     */
+    char key[14];                      /* day and hour of last date parsed  */
+                                       /* ("YYYY-MM-DD HH")                 */
+    time_t time;                       /* time for "key" (at HH:00:00)      */
+    struct tm tm_now;                  /* current local time (for strptime) */
 };
 
-extern struct t_logger_line *logger_tail_file (const char *filename,
+extern struct t_logger_tail *logger_tail_data (const char *data, size_t size,
+                                               int n_lines);
+extern struct t_logger_tail *logger_tail_file (const char *filename,
                                                int n_lines);
-extern void logger_tail_free (struct t_logger_line *lines);
+extern void logger_tail_free (struct t_logger_tail *tail);
+extern void logger_tail_date_cache_init (struct t_logger_tail_date_cache *date_cache,
+                                         const char *time_format);
+extern time_t logger_tail_get_date (struct t_logger_tail_date_cache *date_cache,
+                                    const char *string);
 
 #endif /* WEECHAT_LOGGER_TAIL_H */
@@ -0,0 +1,871 @@
+/*
+ * logger-writer.c - thread writing lines in log files
+ *
+ * Copyright (C) 2003-2014 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Lines are converted to terminal charset and written by a dedicated thread,
+ * so that a slow disk does not block WeeChat.
+ *
+ * The main thread (single producer) sends records to the writer thread
+ * (single consumer) using a lock-free linked list: the producer only changes
+ * the tail and the consumer only changes the head (the head is a "stub"
+ * record, already processed). The mutex and conditions are used only to wake
+ * up the writer thread when it is sleeping, and to wait for a fence or for
+ * the close of a file.
+ *
+ * Rotated log files are compressed by the writer thread too, by chunks and
+ * only when there is no record to process, so that records sent after a
+ * rotation (lines, close of files) are never delayed by compression.
+ *
+ * Note: the writer thread must not call any WeeChat API function which is
+ * not thread-safe (only iconv functions are used).
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <zlib.h>
+
+#include "../weechat-plugin.h"
+#include "logger.h"
+#include "logger-index.h"
+#include "logger-writer.h"
+
+
+#define LOGGER_WRITER_MAX_FLUSH_FILES 64
+#define LOGGER_WRITER_COMPRESS_BUFSIZE (64 * 1024)
+
+/* queue (head is read by writer thread, tail is written by main thread) */
+struct t_logger_writer_record *logger_writer_head = NULL;
+struct t_logger_writer_record *logger_writer_tail = NULL;
+
+pthread_t logger_writer_thread_id;
+int logger_writer_thread_running = 0;
+pthread_mutex_t logger_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t logger_writer_cond = PTHREAD_COND_INITIALIZER;
+pthread_cond_t logger_writer_cond_fence = PTHREAD_COND_INITIALIZER;
+pthread_cond_t logger_writer_cond_close = PTHREAD_COND_INITIALIZER;
+int logger_writer_sleeping = 0;        /* 1 if writer waits for records     */
+unsigned long logger_writer_fence_sent = 0; /* last fence sent (main)       */
+unsigned long logger_writer_fence_done = 0; /* last fence done (writer)     */
+int logger_writer_close_sent = 0;      /* last close sent (main)            */
+int logger_writer_close_done = 0;      /* last close done (writer)          */
+
+/* files closed: filename -> close id (used only by main thread) */
+struct t_hashtable *logger_writer_closes = NULL;
+
+/* data used only by writer thread (or main thread if there's no thread) */
+FILE *logger_writer_flush_files[LOGGER_WRITER_MAX_FLUSH_FILES];
+int logger_writer_num_flush_files = 0;
+struct t_logger_writer_compress *logger_writer_compress_head = NULL;
+struct t_logger_writer_compress *logger_writer_compress_tail = NULL;
+
+
+/*
+ * Flushes files written since last flush (called when there are no more
+ * records to process, so that many lines are written with only one flush).
+ */
+
+void
+logger_writer_flush_pending ()
+{
+    int i;
+
+    for (i = 0; i < logger_writer_num_flush_files; i++)
+    {
+        fflush (logger_writer_flush_files[i]);
+    }
+    logger_writer_num_flush_files = 0;
+}
+
+/*
+ * Adds a file in list of files to flush.
+ */
+
+void
+logger_writer_add_flush_file (FILE *file)
+{
+    int i;
+
+    for (i = 0; i < logger_writer_num_flush_files; i++)
+    {
+        if (logger_writer_flush_files[i] == file)
+            return;
+    }
+
+    if (logger_writer_num_flush_files >= LOGGER_WRITER_MAX_FLUSH_FILES)
+        logger_writer_flush_pending ();
+
+    logger_writer_flush_files[logger_writer_num_flush_files++] = file;
+}
+
+/*
+ * Removes a file from list of files to flush (when file is closed).
+ */
+
+void
+logger_writer_remove_flush_file (FILE *file)
+{
+    int i;
+
+    for (i = 0; i < logger_writer_num_flush_files; i++)
+    {
+        if (logger_writer_flush_files[i] == file)
+        {
+            logger_writer_flush_files[i] =
+                logger_writer_flush_files[logger_writer_num_flush_files - 1];
+            logger_writer_num_flush_files--;
+            return;
+        }
+    }
+}
+
+/*
+ * Writes a line in a file.
+ */
+
+void
+logger_writer_write_line (struct t_logger_writer_record *record)
+{
+    char *message, *nick, *words;
+    int bytes, converted;
+
+    message = (record->charset) ?
+        weechat_iconv_from_internal (record->charset, record->data) : NULL;
+    bytes = fprintf (record->file, "%s\n",
+                     (message) ? message : record->data);
+    if (record->index)
+    {
+        /* index is built with data as written in file (terminal charset) */
+        converted = (message && (strcmp (message, record->data) != 0));
+        nick = (converted && record->nick) ?
+            weechat_iconv_from_internal (record->charset, record->nick) : NULL;
+        words = (converted && (record->date > 0)) ?
+            weechat_iconv_from_internal (
+                record->charset,
+                record->data + record->message_offset) : NULL;
+        logger_index_add_line (record->index, record->date,
+                               (nick) ? nick : record->nick,
+                               (words) ?
+                               words : record->data + record->message_offset,
+                               bytes);
+        if (nick)
+            free (nick);
+        if (words)
+            free (words);
+    }
+
+    if (message)
+        free (message);
+
+    if (record->flush)
+        logger_writer_add_flush_file (record->file);
+}
+
+/*
+ * Adds a file in list of files to compress.
+ */
+
+void
+logger_writer_compress_add (const char *filename, int compression_level)
+{
+    struct t_logger_writer_compress *new_compress;
+
+    new_compress = malloc (sizeof (*new_compress));
+    if (!new_compress)
+        return;
+
+    new_compress->filename = strdup (filename);
+    if (!new_compress->filename)
+    {
+        free (new_compress);
+        return;
+    }
+    new_compress->compression_level = compression_level;
+    new_compress->file = NULL;
+    new_compress->gz_file = NULL;
+    new_compress->next_compress = NULL;
+
+    if (logger_writer_compress_tail)
+        logger_writer_compress_tail->next_compress = new_compress;
+    else
+        logger_writer_compress_head = new_compress;
+    logger_writer_compress_tail = new_compress;
+}
+
+/*
+ * Ends compression of first file in list: if "error" is 0, "file.gz.part" is
+ * renamed to "file.gz" and "file" is deleted; otherwise "file.gz.part" is
+ * deleted (and the file is not changed).
+ *
+ * The file is then removed from list.
+ */
+
+void
+logger_writer_compress_end (int error)
+{
+    struct t_logger_writer_compress *ptr_compress;
+    char *filename_gz, *filename_part;
+    size_t length;
+
+    ptr_compress = logger_writer_compress_head;
+
+    if (ptr_compress->file)
+    {
+        if (ferror (ptr_compress->file))
+            error = 1;
+        fclose (ptr_compress->file);
+        if (gzclose (ptr_compress->gz_file) != Z_OK)
+            error = 1;
+
+        length = strlen (ptr_compress->filename) + 16;
+        filename_gz = malloc (length);
+        filename_part = malloc (length);
+        if (filename_gz && filename_part)
+        {
+            snprintf (filename_gz, length, "%s.gz", ptr_compress->filename);
+            snprintf (filename_part, length, "%s.gz.part",
+                      ptr_compress->filename);
+            if (error || (rename (filename_part, filename_gz) != 0))
+                unlink (filename_part);
+            else
+                unlink (ptr_compress->filename);
+        }
+        if (filename_gz)
+            free (filename_gz);
+        if (filename_part)
+            free (filename_part);
+    }
+
+    logger_writer_compress_head = ptr_compress->next_compress;
+    if (!logger_writer_compress_head)
+        logger_writer_compress_tail = NULL;
+    free (ptr_compress->filename);
+    free (ptr_compress);
+}
+
+/*
+ * Compresses a chunk of first file in list of files to compress: "file" is
+ * compressed to "file.gz" (written first as "file.gz.part"), then "file" is
+ * deleted.
+ *
+ * If an error occurs, the file is not changed.
+ *
+ * Returns:
+ *   1: there are still data to compress
+ *   0: no more files to compress
+ */
+
+int
+logger_writer_compress_step ()
+{
+    struct t_logger_writer_compress *ptr_compress;
+    char *filename_part, mode[8];
+    char buffer[LOGGER_WRITER_COMPRESS_BUFSIZE];
+    size_t length, bytes_read;
+
+    ptr_compress = logger_writer_compress_head;
+    if (!ptr_compress)
+        return 0;
+
+    if (!ptr_compress->file)
+    {
+        /* start compression of file */
+        length = strlen (ptr_compress->filename) + 16;
+        filename_part = malloc (length);
+        if (filename_part)
+        {
+            snprintf (filename_part, length, "%s.gz.part",
+                      ptr_compress->filename);
+            snprintf (mode, sizeof (mode), "wb%d",
+                      ptr_compress->compression_level);
+            ptr_compress->file = fopen (ptr_compress->filename, "rb");
+            if (ptr_compress->file)
+            {
+                ptr_compress->gz_file = gzopen (filename_part, mode);
+                if (!ptr_compress->gz_file)
+                {
+                    fclose (ptr_compress->file);
+                    ptr_compress->file = NULL;
+                }
+            }
+            free (filename_part);
+        }
+        if (!ptr_compress->file)
+        {
+            logger_writer_compress_end (1);
+            return (logger_writer_compress_head) ? 1 : 0;
+        }
+    }
+
+    bytes_read = fread (buffer, 1, sizeof (buffer), ptr_compress->file);
+    if (bytes_read > 0)
+    {
+        if (gzwrite (ptr_compress->gz_file, buffer, bytes_read)
+            != (int)bytes_read)
+        {
+            logger_writer_compress_end (1);
+        }
+    }
+    else
+    {
+        /* end of file (or read error) */
+        logger_writer_compress_end (0);
+    }
+
+    return (logger_writer_compress_head) ? 1 : 0;
+}
+
+/*
+ * Removes all files from list of files to compress (compressions in progress
+ * are cancelled, files are not changed).
+ */
+
+void
+logger_writer_compress_free_all ()
+{
+    while (logger_writer_compress_head)
+    {
+        logger_writer_compress_end (1);
+    }
+}
+
+/*
+ * Processes a record (in writer thread, or main thread if there is no writer
+ * thread).
+ *
+ * Returns:
+ *   1: OK
+ *   0: writer must stop
+ */
+
+int
+logger_writer_process_record (struct t_logger_writer_record *record)
+{
+    switch (record->type)
+    {
+        case LOGGER_WRITER_RECORD_LINE:
+            if (record->file && record->data)
+                logger_writer_write_line (record);
+            break;
+        case LOGGER_WRITER_RECORD_FLUSH:
+            if (record->file)
+            {
+                logger_writer_remove_flush_file (record->file);
+                fflush (record->file);
+            }
+            break;
+        case LOGGER_WRITER_RECORD_CLOSE:
+            if (record->file)
+            {
+                logger_writer_remove_flush_file (record->file);
+                fclose (record->file);
+            }
+            if (record->index)
+                logger_index_close (record->index);
+            pthread_mutex_lock (&logger_writer_mutex);
+            logger_writer_close_done = record->fence;
+            pthread_cond_broadcast (&logger_writer_cond_close);
+            pthread_mutex_unlock (&logger_writer_mutex);
+            break;
+        case LOGGER_WRITER_RECORD_COMPRESS:
+            if (record->data)
+            {
+                logger_writer_compress_add (record->data,
+                                            record->compression_level);
+                /* without writer thread, compress file immediately */
+                if (!logger_writer_thread_running)
+                {
+                    while (logger_writer_compress_step ())
+                    {
+                    }
+                }
+            }
+            break;
+        case LOGGER_WRITER_RECORD_FENCE:
+            logger_writer_flush_pending ();
+            pthread_mutex_lock (&logger_writer_mutex);
+            logger_writer_fence_done = record->fence;
+            pthread_cond_broadcast (&logger_writer_cond_fence);
+            pthread_mutex_unlock (&logger_writer_mutex);
+            break;
+        case LOGGER_WRITER_RECORD_STOP:
+            logger_writer_flush_pending ();
+            while (logger_writer_compress_step ())
+            {
+            }
+            return 0;
+        case LOGGER_WRITER_NUM_RECORD_TYPES:
+            break;
+    }
+
+    return 1;
+}
+
+/*
+ * Gets next record in queue (called by writer thread only).
+ *
+ * Returns pointer to record, NULL if queue is empty.
+ */
+
+struct t_logger_writer_record *
+logger_writer_pop ()
+{
+    struct t_logger_writer_record *next;
+
+    next = __atomic_load_n (&logger_writer_head->next_record,
+                            __ATOMIC_ACQUIRE);
+    if (!next)
+        return NULL;
+
+    /* old head (already processed) is freed, next record becomes the head */
+    free (logger_writer_head);
+    logger_writer_head = next;
+
+    return next;
+}
+
+/*
+ * Main function of writer thread.
+ */
+
+void *
+logger_writer_thread (void *arg)
+{
+    struct t_logger_writer_record *ptr_record;
+    int rc;
+
+    /* make C compiler happy */
+    (void) arg;
+
+    while (1)
+    {
+        ptr_record = logger_writer_pop ();
+        if (ptr_record)
+        {
+            rc = logger_writer_process_record (ptr_record);
+            if (ptr_record->data)
+            {
+                free (ptr_record->data);
+                ptr_record->data = NULL;
+            }
+            if (ptr_record->nick)
+            {
+                free (ptr_record->nick);
+                ptr_record->nick = NULL;
+            }
+            if (!rc)
+                break;
+            continue;
+        }
+
+        /* no more records: flush files */
+        logger_writer_flush_pending ();
+
+        /* compress a chunk of rotated file (if any), then check records */
+        if (logger_writer_compress_step ())
+            continue;
+
+        /* nothing to do: wait for new records */
+
+        pthread_mutex_lock (&logger_writer_mutex);
+        __atomic_store_n (&logger_writer_sleeping, 1, __ATOMIC_SEQ_CST);
+        if (!__atomic_load_n (&logger_writer_head->next_record,
+                              __ATOMIC_SEQ_CST))
+        {
+            pthread_cond_wait (&logger_writer_cond, &logger_writer_mutex);
+        }
+        __atomic_store_n (&logger_writer_sleeping, 0, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock (&logger_writer_mutex);
+    }
+
+    return NULL;
+}
+
+/*
+ * Sends a record to writer thread (or processes it immediately if there is
+ * no writer thread).
+ */
+
+void
+logger_writer_push (struct t_logger_writer_record *record)
+{
+    if (!logger_writer_thread_running)
+    {
+        logger_writer_process_record (record);
+        if (record->data)
+            free (record->data);
+        if (record->nick)
+            free (record->nick);
+        free (record);
+        logger_writer_flush_pending ();
+        return;
+    }
+
+    record->next_record = NULL;
+    __atomic_store_n (&logger_writer_tail->next_record, record,
+                      __ATOMIC_SEQ_CST);
+    logger_writer_tail = record;
+
+    /* wake up writer thread if it is sleeping */
+    if (__atomic_load_n (&logger_writer_sleeping, __ATOMIC_SEQ_CST))
+    {
+        pthread_mutex_lock (&logger_writer_mutex);
+        pthread_cond_signal (&logger_writer_cond);
+        pthread_mutex_unlock (&logger_writer_mutex);
+    }
+}
+
+/*
+ * Creates a new record.
+ *
+ * Returns pointer to new record, NULL if error.
+ */
+
+struct t_logger_writer_record *
+logger_writer_record_new (enum t_logger_writer_record_type type, FILE *file)
+{
+    struct t_logger_writer_record *new_record;
+
+    new_record = malloc (sizeof (*new_record));
+    if (!new_record)
+        return NULL;
+
+    new_record->type = type;
+    new_record->file = file;
+    new_record->index = NULL;
+    new_record->date = 0;
+    new_record->charset = NULL;
+    new_record->flush = 0;
+    new_record->compression_level = 0;
+    new_record->data = NULL;
+    new_record->nick = NULL;
+    new_record->fence = 0;
+    new_record->next_record = NULL;
+
+    return new_record;
+}
+
+/*
+ * Adds a line to write in a file (line is written as-is, date of line is
+ * used only for the index).
+ *
+ * Argument "data" is used by the writer and freed after write (so it must
+ * not be freed by the caller).
+ *
+ * If "index" is not NULL, the line is added to the index of file (with the
+ * nick, if not NULL, and the words of message, which starts at
+ * "message_offset" in "data").
+ */
+
+void
+logger_writer_add_line (FILE *file, struct t_logger_index *index,
+                        time_t date, const char *charset, char *data,
+                        int message_offset, const char *nick, int flush)
+{
+    struct t_logger_writer_record *new_record;
+
+    if (!file || !data)
+    {
+        if (data)
+            free (data);
+        return;
+    }
+
+    new_record = logger_writer_record_new (LOGGER_WRITER_RECORD_LINE, file);
+    if (!new_record)
+    {
+        free (data);
+        return;
+    }
+    new_record->index = index;
+    new_record->date = date;
+    new_record->charset = charset;
+    new_record->flush = flush;
+    new_record->data = data;
+    new_record->message_offset = message_offset;
+    new_record->nick = (index && nick) ? strdup (nick) : NULL;
+
+    logger_writer_push (new_record);
+}
+
+/*
+ * Asks writer to flush a file.
+ */
+
+void
+logger_writer_flush (FILE *file)
+{
+    struct t_logger_writer_record *new_record;
+
+    if (!file)
+        return;
+
+    new_record = logger_writer_record_new (LOGGER_WRITER_RECORD_FLUSH, file);
+    if (new_record)
+        logger_writer_push (new_record);
+}
+
+/*
+ * Removes a file from hashtable with files closed if its close is done
+ * (callback called for each file in hashtable).
+ */
+
+void
+logger_writer_closes_purge_cb (void *data, struct t_hashtable *hashtable,
+                               const void *key, const void *value)
+{
+    /* make C compiler happy */
+    (void) data;
+
+    if (*((int *)value) <= __atomic_load_n (&logger_writer_close_done,
+                                            __ATOMIC_SEQ_CST))
+    {
+        weechat_hashtable_remove (hashtable, key);
+    }
+}
+
+/*
+ * Asks writer to close a file and its index (if not NULL); the file and index
+ * must not be used any more by caller.
+ *
+ * Argument "filename" is the path of file, used to wait for the close before
+ * opening the same file again (see function "logger_writer_wait_close").
+ */
+
+void
+logger_writer_close (FILE *file, struct t_logger_index *index,
+                     const char *filename)
+{
+    struct t_logger_writer_record *new_record;
+    int close_id;
+
+    if (!file)
+        return;
+
+    new_record = logger_writer_record_new (LOGGER_WRITER_RECORD_CLOSE, file);
+    if (new_record)
+    {
+        new_record->index = index;
+        close_id = ++logger_writer_close_sent;
+        new_record->fence = close_id;
+        if (logger_writer_thread_running && logger_writer_closes && filename)
+        {
+            /* remove files already closed, if there are many files */
+            if (weechat_hashtable_get_integer (logger_writer_closes,
+                                               "items_count") >= 64)
+            {
+                weechat_hashtable_map (logger_writer_closes,
+                                       &logger_writer_closes_purge_cb, NULL);
+            }
+            weechat_hashtable_set (logger_writer_closes, filename, &close_id);
+        }
+        logger_writer_push (new_record);
+    }
+    else
+    {
+        logger_writer_fence ();
+        fclose (file);
+        if (index)
+            logger_index_close (index);
+    }
+}
+
+/*
+ * Asks writer to compress a rotated log file (the file must not be used any
+ * more by caller).
+ */
+
+void
+logger_writer_compress (const char *filename, int compression_level)
+{
+    struct t_logger_writer_record *new_record;
+
+    if (!filename)
+        return;
+
+    new_record = logger_writer_record_new (LOGGER_WRITER_RECORD_COMPRESS,
+                                           NULL);
+    if (!new_record)
+        return;
+
+    new_record->compression_level = compression_level;
+    new_record->data = strdup (filename);
+    logger_writer_push (new_record);
+}
+
+/*
+ * Waits until all records sent to writer thread are processed (lines written
+ * and files flushed if asked).
+ */
+
+void
+logger_writer_fence ()
+{
+    struct t_logger_writer_record *new_record;
+    unsigned long fence;
+
+    if (!logger_writer_thread_running)
+        return;
+
+    new_record = logger_writer_record_new (LOGGER_WRITER_RECORD_FENCE, NULL);
+    if (!new_record)
+        return;
+
+    fence = ++logger_writer_fence_sent;
+    new_record->fence = fence;
+    logger_writer_push (new_record);
+
+    pthread_mutex_lock (&logger_writer_mutex);
+    while (logger_writer_fence_done < fence)
+    {
+        pthread_cond_wait (&logger_writer_cond_fence, &logger_writer_mutex);
+    }
+    pthread_mutex_unlock (&logger_writer_mutex);
+}
+
+/*
+ * Waits until a file closed by main thread is really closed by writer thread
+ * (only the records sent before the close of this file are waited: lines and
+ * close of other files, but never compression of rotated files).
+ *
+ * This function must be called before opening a log file (and its index),
+ * because the same file may still be open in writer thread, with lines and
+ * index not yet written (and then the size of file and the end of index would
+ * be wrong).
+ */
+
+void
+logger_writer_wait_close (const char *filename)
+{
+    int *ptr_close_id, close_id;
+
+    if (!logger_writer_thread_running || !logger_writer_closes || !filename)
+        return;
+
+    ptr_close_id = weechat_hashtable_get (logger_writer_closes, filename);
+    if (!ptr_close_id)
+        return;
+    close_id = *ptr_close_id;
+    weechat_hashtable_remove (logger_writer_closes, filename);
+
+    pthread_mutex_lock (&logger_writer_mutex);
+    while (logger_writer_close_done < close_id)
+    {
+        pthread_cond_wait (&logger_writer_cond_close, &logger_writer_mutex);
+    }
+    pthread_mutex_unlock (&logger_writer_mutex);
+}
+
+/*
+ * Initializes writer: creates the queue and starts the writer thread.
+ *
+ * If the thread can not be created, lines are written immediately by the
+ * main thread.
+ *
+ * Returns:
+ *   1: OK (writer thread started)
+ *   0: error (no writer thread)
+ */
+
+int
+logger_writer_init ()
+{
+    logger_writer_num_flush_files = 0;
+
+    logger_writer_closes = weechat_hashtable_new (32,
+                                                  WEECHAT_HASHTABLE_STRING,
+                                                  WEECHAT_HASHTABLE_INTEGER,
+                                                  NULL, NULL);
+
+    /* the first record in queue is a "stub" (already processed) */
+    logger_writer_head = logger_writer_record_new (LOGGER_WRITER_RECORD_FENCE,
+                                                   NULL);
+    if (!logger_writer_head)
+        return 0;
+    logger_writer_tail = logger_writer_head;
+
+    if (pthread_create (&logger_writer_thread_id, NULL,
+                        &logger_writer_thread, NULL) != 0)
+    {
+        weechat_printf_tags (NULL,
+                             "no_log",
+                             _("%s%s: unable to create thread for writing "
+                               "log files, files will be written by main "
+                               "thread"),
+                             weechat_prefix ("error"), LOGGER_PLUGIN_NAME);
+        return 0;
+    }
+
+    logger_writer_thread_running = 1;
+
+    return 1;
+}
+
+/*
+ * Ends writer: waits for end of writes and stops the writer thread.
+ */
+
+void
+logger_writer_end ()
+{
+    struct t_logger_writer_record *new_record, *ptr_record;
+
+    if (logger_writer_thread_running)
+    {
+        new_record = logger_writer_record_new (LOGGER_WRITER_RECORD_STOP,
+                                               NULL);
+        if (new_record)
+        {
+            logger_writer_push (new_record);
+            pthread_join (logger_writer_thread_id, NULL);
+        }
+        else
+        {
+            logger_writer_fence ();
+            pthread_cancel (logger_writer_thread_id);
+            pthread_join (logger_writer_thread_id, NULL);
+        }
+        logger_writer_thread_running = 0;
+    }
+
+    /* free queue (records not processed, if any, and the stub) */
+    while (logger_writer_head)
+    {
+        ptr_record = logger_writer_head->next_record;
+        if (logger_writer_head->data)
+            free (logger_writer_head->data);
+        free (logger_writer_head);
+        logger_writer_head = ptr_record;
+    }
+    logger_writer_tail = NULL;
+
+    /* cancel compressions not done (if writer thread was cancelled) */
+    logger_writer_compress_free_all ();
+
+    if (logger_writer_closes)
+    {
+        weechat_hashtable_free (logger_writer_closes);
+        logger_writer_closes = NULL;
+    }
+}
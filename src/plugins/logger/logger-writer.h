@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2003-2014 Sébastien Helleu <flashcode@flashtux.org>
+ *
+ * This file is part of WeeChat, the extensible chat client.
+ *
+ * WeeChat is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * WeeChat is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with WeeChat.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WEECHAT_LOGGER_WRITER_H
+#define WEECHAT_LOGGER_WRITER_H 1
+
+#include <stdio.h>
+#include <time.h>
+#include <zlib.h>
+
+struct t_logger_index;
+
+/* type of records sent to writer thread */
+
+enum t_logger_writer_record_type
+{
+    LOGGER_WRITER_RECORD_LINE = 0,     /* write a line in file              */
+    LOGGER_WRITER_RECORD_FLUSH,        /* flush file                        */
+    LOGGER_WRITER_RECORD_CLOSE,        /* close file                        */
+    LOGGER_WRITER_RECORD_COMPRESS,     /* compress a rotated log file       */
+    LOGGER_WRITER_RECORD_FENCE,        /* wake up main thread (all records  */
+                                       /* before were processed)            */
+    LOGGER_WRITER_RECORD_STOP,         /* stop writer thread                */
+    /* number of record types */
+    LOGGER_WRITER_NUM_RECORD_TYPES,
+};
+
+/* record sent by main thread to writer thread (single producer/consumer) */
+
+struct t_logger_writer_record
+{
+    enum t_logger_writer_record_type type; /* type of record                */
+    FILE *file;                        /* file (for line/flush/close)       */
+    struct t_logger_index *index;      /* index of file (for line/close)    */
+    time_t date;                       /* date of line (for index, 0 if     */
+                                       /* line has no date)                 */
+    const char *charset;               /* charset for file (can be NULL)    */
+    int flush;                         /* 1 to flush file after write       */
+    int compression_level;             /* compression level (for compress)  */
+    char *data;                        /* line (or filename to compress)    */
+    int message_offset;                /* offset of message in line (for    */
+                                       /* index of file)                    */
+    char *nick;                        /* nick (for index of file)          */
+    unsigned long fence;               /* fence id (for type "fence") or    */
+                                       /* close id (for type "close")       */
+    struct t_logger_writer_record *next_record; /* next record in queue     */
+};
+
+/* rotated log file to compress (compressed by chunks in writer thread) */
+
+struct t_logger_writer_compress
+{
+    char *filename;                    /* file to compress                  */
+    int compression_level;             /* compression level (gzip)          */
+    FILE *file;                        /* file to compress (NULL if         */
+                                       /* compression is not started)       */
+    gzFile gz_file;                    /* compressed file ("file.gz.part")  */
+    struct t_logger_writer_compress *next_compress; /* next file           */
+};
+
+extern int logger_writer_init ();
+extern void logger_writer_add_line (FILE *file, struct t_logger_index *index,
+                                    time_t date, const char *charset,
+                                    char *data, int message_offset,
+                                    const char *nick, int flush);
+extern void logger_writer_flush (FILE *file);
+extern void logger_writer_close (FILE *file, struct t_logger_index *index,
+                                 const char *filename);
+extern void logger_writer_compress (const char *filename,
+                                    int compression_level);
+extern void logger_writer_fence ();
+extern void logger_writer_wait_close (const char *filename);
+extern void logger_writer_end ();
+
+#endif /* WEECHAT_LOGGER_WRITER_H */
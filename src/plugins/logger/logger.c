@@ -41,8 +41,10 @@
 #include "logger.h"
 #include "logger-buffer.h"
 #include "logger-config.h"
+#include "logger-index.h"
 #include "logger-info.h"
 #include "logger-tail.h"
+#include "logger-writer.h"
 
 
 WEECHAT_PLUGIN_NAME(LOGGER_PLUGIN_NAME);
@@ -54,6 +56,7 @@ WEECHAT_PLUGIN_LICENSE(WEECHAT_LICENSE);
 struct t_weechat_plugin *weechat_logger_plugin = NULL;
 
 struct t_hook *logger_timer = NULL;    /* timer to flush log files          */
+const char *logger_charset = NULL;     /* charset used in log files         */
 
 
 /*
@@ -409,17 +412,22 @@ end:
 }
 
 /*
- * Builds log filename for a buffer.
+ * Builds log filename for a logger buffer.
+ *
+ * The filename mask is resolved once and cached in the logger buffer (the
+ * cache is reset when a mask option is changed).
  */
 
 char *
-logger_get_filename (struct t_gui_buffer *buffer)
+logger_get_filename (struct t_logger_buffer *logger_buffer)
 {
+    struct t_gui_buffer *buffer;
     char *res, *mask_expanded, *file_path;
     const char *mask;
     const char *dir_separator, *weechat_dir;
     int length;
 
+    buffer = logger_buffer->buffer;
     res = NULL;
     mask_expanded = NULL;
     file_path = NULL;
@@ -432,7 +440,13 @@ logger_get_filename (struct t_gui_buffer *buffer)
         return NULL;
 
     /* get filename mask for buffer */
-    mask = logger_get_mask_for_buffer (buffer);
+    if (!logger_buffer->log_mask)
+    {
+        mask = logger_get_mask_for_buffer (buffer);
+        if (mask)
+            logger_buffer->log_mask = strdup (mask);
+    }
+    mask = logger_buffer->log_mask;
     if (!mask)
     {
         weechat_printf_tags (NULL,
@@ -485,7 +499,7 @@ logger_set_log_filename (struct t_logger_buffer *logger_buffer)
     struct t_logger_buffer *ptr_logger_buffer;
 
     /* get log filename for buffer */
-    log_filename = logger_get_filename (logger_buffer->buffer);
+    log_filename = logger_get_filename (logger_buffer);
     if (!log_filename)
     {
         weechat_printf_tags (NULL,
@@ -531,104 +545,291 @@ logger_set_log_filename (struct t_logger_buffer *logger_buffer)
 }
 
 /*
- * Writes a line to log file.
+ * Creates log file for a logger buffer (if not already opened), and writes
+ * the start info line in file (if asked).
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (the logger buffer is freed)
  */
 
-void
-logger_write_line (struct t_logger_buffer *logger_buffer,
-                   const char *format, ...)
+int
+logger_create_log_file (struct t_logger_buffer *logger_buffer)
 {
-    char *message, buf_time[256], buf_beginning[1024];
-    const char *charset;
-    time_t seconds;
-    struct tm *date_tmp;
-    int log_level;
+    char buf_time[256], buf_beginning[1024];
+    struct stat statbuf;
 
-    charset = weechat_info_get ("charset_terminal", "");
+    if (logger_buffer->log_file)
+        return 1;
+
+    /* level is resolved when logging starts and when level options change */
+    if (logger_buffer->log_level == 0)
+    {
+        logger_buffer_free (logger_buffer);
+        return 0;
+    }
+    if (!logger_create_directory ())
+    {
+        weechat_printf_tags (NULL,
+                             "no_log",
+                             _("%s%s: unable to create directory for logs "
+                               "(\"%s\")"),
+                             weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                             weechat_config_string (logger_config_file_path));
+        logger_buffer_free (logger_buffer);
+        return 0;
+    }
+    if (!logger_buffer->log_filename)
+        logger_set_log_filename (logger_buffer);
+    if (!logger_buffer->log_filename)
+    {
+        logger_buffer_free (logger_buffer);
+        return 0;
+    }
+
+    /* the file may be still open in writer thread (closed just before) */
+    logger_writer_wait_close (logger_buffer->log_filename);
 
+    logger_buffer->log_file =
+        fopen (logger_buffer->log_filename, "a");
     if (!logger_buffer->log_file)
     {
-        log_level = logger_get_level_for_buffer (logger_buffer->buffer);
-        if (log_level == 0)
-        {
-            logger_buffer_free (logger_buffer);
-            return;
-        }
-        if (!logger_create_directory ())
-        {
-            weechat_printf_tags (NULL,
-                                 "no_log",
-                                 _("%s%s: unable to create directory for logs "
-                                   "(\"%s\")"),
-                                 weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
-                                 weechat_config_string (logger_config_file_path));
-            logger_buffer_free (logger_buffer);
-            return;
-        }
-        if (!logger_buffer->log_filename)
-            logger_set_log_filename (logger_buffer);
-        if (!logger_buffer->log_filename)
-        {
-            logger_buffer_free (logger_buffer);
-            return;
-        }
+        weechat_printf_tags (NULL,
+                             "no_log",
+                             _("%s%s: unable to write log file \"%s\""),
+                             weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                             logger_buffer->log_filename);
+        logger_buffer_free (logger_buffer);
+        return 0;
+    }
 
-        logger_buffer->log_file =
-            fopen (logger_buffer->log_filename, "a");
-        if (!logger_buffer->log_file)
+    logger_buffer->log_size =
+        (fstat (fileno (logger_buffer->log_file), &statbuf) == 0) ?
+        (unsigned long)statbuf.st_size : 0;
+
+    if (weechat_config_boolean (logger_config_file_index))
+    {
+        logger_buffer->log_index = logger_index_open (
+            logger_buffer->log_filename,
+            logger_buffer->log_file,
+            weechat_config_integer (logger_config_file_index_lines));
+        if (!logger_buffer->log_index)
         {
             weechat_printf_tags (NULL,
                                  "no_log",
-                                 _("%s%s: unable to write log file \"%s\""),
+                                 _("%s%s: unable to write index for log file "
+                                   "\"%s\""),
                                  weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
                                  logger_buffer->log_filename);
-            logger_buffer_free (logger_buffer);
-            return;
         }
+    }
 
-        if (weechat_config_boolean (logger_config_file_info_lines)
-            && logger_buffer->write_start_info_line)
-        {
-            buf_time[0] = '\0';
-            seconds = time (NULL);
-            date_tmp = localtime (&seconds);
-            if (date_tmp)
-            {
-                strftime (buf_time, sizeof (buf_time) - 1,
-                          weechat_config_string (logger_config_file_time_format),
-                          date_tmp);
-            }
-            snprintf (buf_beginning, sizeof (buf_beginning),
-                      _("%s\t****  Beginning of log  ****"),
-                      buf_time);
-            message = (charset) ?
-                weechat_iconv_from_internal (charset, buf_beginning) : NULL;
-            fprintf (logger_buffer->log_file,
-                     "%s\n", (message) ? message : buf_beginning);
-            if (message)
-                free (message);
-            logger_buffer->flush_needed = 1;
-        }
-        logger_buffer->write_start_info_line = 0;
+    if (weechat_config_boolean (logger_config_file_info_lines)
+        && logger_buffer->write_start_info_line)
+    {
+        weechat_util_strftime (
+            buf_time, sizeof (buf_time),
+            weechat_config_string (logger_config_file_time_format),
+            time (NULL));
+        snprintf (buf_beginning, sizeof (buf_beginning),
+                  _("%s\t****  Beginning of log  ****"),
+                  buf_time);
+        logger_writer_add_line (logger_buffer->log_file,
+                                logger_buffer->log_index, 0, logger_charset,
+                                strdup (buf_beginning), 0, NULL,
+                                (logger_timer) ? 0 : 1);
+        logger_buffer->flush_needed = (logger_timer) ? 1 : 0;
     }
+    logger_buffer->write_start_info_line = 0;
 
-    weechat_va_format (format);
-    if (vbuffer)
+    return 1;
+}
+
+/*
+ * Checks if a rotated log file (or its compressed version) exists.
+ *
+ * Returns:
+ *   1: rotated file exists
+ *   0: rotated file does not exist
+ */
+
+int
+logger_rotated_file_exists (const char *filename)
+{
+    char *filename_gz;
+    int length, rc;
+
+    if (access (filename, F_OK) == 0)
+        return 1;
+
+    length = strlen (filename) + 16;
+    filename_gz = malloc (length);
+    if (!filename_gz)
+        return 0;
+    snprintf (filename_gz, length, "%s.gz", filename);
+    rc = (access (filename_gz, F_OK) == 0);
+    snprintf (filename_gz, length, "%s.gz.part", filename);
+    rc |= (access (filename_gz, F_OK) == 0);
+    free (filename_gz);
+
+    return rc;
+}
+
+/*
+ * Rotates log file of a logger buffer: the file is renamed with date/time of
+ * rotation as extension (for example "irc.freenode.#weechat.weechatlog" is
+ * renamed to "irc.freenode.#weechat.weechatlog.20141019-235959"), and then
+ * compressed by the writer thread if option
+ * logger.file.rotation_compression_type is set.
+ *
+ * The next line written in buffer will create a new log file.
+ */
+
+void
+logger_rotate (struct t_logger_buffer *logger_buffer)
+{
+    char suffix[64], *filename_rotated, *filename_index;
+    time_t seconds;
+    struct tm *date_tmp;
+    int length, i;
+
+    if (!logger_buffer->log_filename
+        || (access (logger_buffer->log_filename, F_OK) != 0))
+        return;
+
+    suffix[0] = '\0';
+    seconds = time (NULL);
+    date_tmp = localtime (&seconds);
+    if (date_tmp)
+        strftime (suffix, sizeof (suffix), ".%Y%m%d-%H%M%S", date_tmp);
+    if (!suffix[0])
+        return;
+
+    length = strlen (logger_buffer->log_filename) + strlen (suffix) + 16;
+    filename_rotated = malloc (length);
+    if (!filename_rotated)
+        return;
+    for (i = 0; i < 1000; i++)
     {
-        message = (charset) ?
-            weechat_iconv_from_internal (charset, vbuffer) : NULL;
-        fprintf (logger_buffer->log_file,
-                 "%s\n", (message) ? message : vbuffer);
-        if (message)
-            free (message);
-        logger_buffer->flush_needed = 1;
-        if (!logger_timer)
+        if (i == 0)
+        {
+            snprintf (filename_rotated, length, "%s%s",
+                      logger_buffer->log_filename, suffix);
+        }
+        else
         {
-            fflush (logger_buffer->log_file);
-            logger_buffer->flush_needed = 0;
+            snprintf (filename_rotated, length, "%s%s-%d",
+                      logger_buffer->log_filename, suffix, i);
         }
-        free (vbuffer);
+        if (!logger_rotated_file_exists (filename_rotated))
+            break;
     }
+    if ((i == 1000)
+        || (rename (logger_buffer->log_filename, filename_rotated) != 0))
+    {
+        weechat_printf_tags (NULL,
+                             "no_log",
+                             _("%s%s: unable to rotate log file \"%s\""),
+                             weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                             logger_buffer->log_filename);
+        free (filename_rotated);
+        return;
+    }
+
+    /*
+     * lines not yet written by the writer thread will go in the rotated file
+     * (the file is still opened), then file is closed and compressed
+     */
+    if (logger_buffer->log_file)
+    {
+        logger_writer_close (logger_buffer->log_file,
+                             logger_buffer->log_index,
+                             logger_buffer->log_filename);
+        logger_buffer->log_file = NULL;
+        logger_buffer->log_index = NULL;
+        logger_buffer->flush_needed = 0;
+    }
+    filename_index = logger_index_filename (logger_buffer->log_filename);
+    if (filename_index)
+    {
+        unlink (filename_index);
+        free (filename_index);
+    }
+    if (weechat_config_integer (logger_config_file_rotation_compression_type)
+        == LOGGER_CONFIG_ROTATION_COMPRESSION_GZIP)
+    {
+        logger_writer_compress (
+            filename_rotated,
+            weechat_config_integer (logger_config_file_rotation_compression_level));
+    }
+
+    if (weechat_logger_plugin->debug)
+    {
+        weechat_printf_tags (NULL,
+                             "no_log",
+                             "%s: log file \"%s\" rotated to \"%s\"",
+                             LOGGER_PLUGIN_NAME,
+                             logger_buffer->log_filename,
+                             filename_rotated);
+    }
+
+    logger_buffer->log_size = 0;
+    logger_buffer->write_start_info_line = 1;
+
+    free (filename_rotated);
+}
+
+/*
+ * Writes data to log file: the data is sent to the writer thread, which
+ * converts data to terminal charset and writes it in file.
+ *
+ * Argument "data" is freed by the writer (it must not be freed by caller).
+ * Arguments "date" (can be 0), "message_offset" (offset of message in data,
+ * after date and prefix) and "nick" (can be NULL) are used for the index of
+ * log file.
+ */
+
+void
+logger_write_data (struct t_logger_buffer *logger_buffer, time_t date,
+                   char *data, int message_offset, const char *nick)
+{
+    int size_max;
+
+    if (!data)
+        return;
+
+    if (!logger_create_log_file (logger_buffer))
+    {
+        free (data);
+        return;
+    }
+
+    logger_buffer->log_size += strlen (data) + 1;
+
+    logger_writer_add_line (logger_buffer->log_file, logger_buffer->log_index,
+                            date, logger_charset, data, message_offset, nick,
+                            (logger_timer) ? 0 : 1);
+    logger_buffer->flush_needed = (logger_timer) ? 1 : 0;
+
+    size_max = weechat_config_integer (logger_config_file_rotation_size_max);
+    if ((size_max > 0)
+        && (logger_buffer->log_size >= (unsigned long)size_max * 1024))
+    {
+        logger_rotate (logger_buffer);
+    }
+}
+
+/*
+ * Writes a line to log file.
+ */
+
+void
+logger_write_line (struct t_logger_buffer *logger_buffer,
+                   const char *format, ...)
+{
+    weechat_va_format (format);
+    if (vbuffer)
+        logger_write_data (logger_buffer, 0, vbuffer, 0, NULL);
 }
 
 /*
@@ -638,8 +839,6 @@ logger_write_line (struct t_logger_buffer *logger_buffer,
 void
 logger_stop (struct t_logger_buffer *logger_buffer, int write_info_line)
 {
-    time_t seconds;
-    struct tm *date_tmp;
     char buf_time[256];
 
     if (!logger_buffer)
@@ -649,21 +848,19 @@ logger_stop (struct t_logger_buffer *logger_buffer, int write_info_line)
     {
         if (write_info_line && weechat_config_boolean (logger_config_file_info_lines))
         {
-            buf_time[0] = '\0';
-            seconds = time (NULL);
-            date_tmp = localtime (&seconds);
-            if (date_tmp)
-            {
-                strftime (buf_time, sizeof (buf_time) - 1,
-                          weechat_config_string (logger_config_file_time_format),
-                          date_tmp);
-            }
+            weechat_util_strftime (
+                buf_time, sizeof (buf_time),
+                weechat_config_string (logger_config_file_time_format),
+                time (NULL));
             logger_write_line (logger_buffer,
                                _("%s\t****  End of log  ****"),
                                buf_time);
         }
-        fclose (logger_buffer->log_file);
+        logger_writer_close (logger_buffer->log_file,
+                             logger_buffer->log_index,
+                             logger_buffer->log_filename);
         logger_buffer->log_file = NULL;
+        logger_buffer->log_index = NULL;
     }
     logger_buffer_free (logger_buffer);
 }
@@ -681,6 +878,31 @@ logger_stop_all (int write_info_line)
     }
 }
 
+/*
+ * Closes log files of all buffers (logging is not stopped: files are opened
+ * again on next line written).
+ */
+
+void
+logger_close_log_files ()
+{
+    struct t_logger_buffer *ptr_logger_buffer;
+
+    for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
+         ptr_logger_buffer = ptr_logger_buffer->next_buffer)
+    {
+        if (ptr_logger_buffer->log_file)
+        {
+            logger_writer_close (ptr_logger_buffer->log_file,
+                                 ptr_logger_buffer->log_index,
+                                 ptr_logger_buffer->log_filename);
+            ptr_logger_buffer->log_file = NULL;
+            ptr_logger_buffer->log_index = NULL;
+            ptr_logger_buffer->flush_needed = 0;
+        }
+    }
+}
+
 /*
  * Starts logging for a buffer.
  */
@@ -722,8 +944,11 @@ logger_start_buffer (struct t_gui_buffer *buffer, int write_info_line)
                 {
                     if (ptr_logger_buffer->log_file)
                     {
-                        fclose (ptr_logger_buffer->log_file);
+                        logger_writer_close (ptr_logger_buffer->log_file,
+                                             ptr_logger_buffer->log_index,
+                                             ptr_logger_buffer->log_filename);
                         ptr_logger_buffer->log_file = NULL;
+                        ptr_logger_buffer->log_index = NULL;
                     }
                 }
             }
@@ -862,12 +1087,211 @@ logger_flush ()
                                      LOGGER_PLUGIN_NAME,
                                      ptr_logger_buffer->log_filename);
             }
-            fflush (ptr_logger_buffer->log_file);
+            logger_writer_flush (ptr_logger_buffer->log_file);
             ptr_logger_buffer->flush_needed = 0;
         }
     }
 }
 
+/*
+ * Searches lines in log file of a buffer (using index of log file if it
+ * exists).
+ *
+ * Nick and word in "search" must be in internal charset; prefix and message
+ * sent to callback are in charset of log file.
+ *
+ * Returns number of lines found, -1 if error (buffer is not logged or log
+ * file not found).
+ */
+
+int
+logger_search (struct t_gui_buffer *buffer,
+               struct t_logger_index_search *search,
+               void (*callback)(void *data, time_t date,
+                                const char *prefix, const char *message),
+               void *callback_data)
+{
+    struct t_logger_buffer *ptr_logger_buffer;
+    const char *ptr_nick, *ptr_word;
+    char *nick, *word;
+    int rc;
+
+    ptr_logger_buffer = logger_buffer_search_buffer (buffer);
+    if (!ptr_logger_buffer)
+        return -1;
+    if (!ptr_logger_buffer->log_filename)
+        logger_set_log_filename (ptr_logger_buffer);
+    if (!ptr_logger_buffer->log_filename)
+        return -1;
+
+    /* write pending lines in log file and index */
+    if (ptr_logger_buffer->log_file)
+    {
+        logger_writer_flush (ptr_logger_buffer->log_file);
+        ptr_logger_buffer->flush_needed = 0;
+    }
+    logger_writer_fence ();
+
+    /* search nick/word as written in log file */
+    ptr_nick = search->nick;
+    ptr_word = search->word;
+    nick = (search->nick && logger_charset) ?
+        weechat_iconv_from_internal (logger_charset, search->nick) : NULL;
+    word = (search->word && logger_charset) ?
+        weechat_iconv_from_internal (logger_charset, search->word) : NULL;
+    if (nick)
+        search->nick = nick;
+    if (word)
+        search->word = word;
+    search->time_format = weechat_config_string (logger_config_file_time_format);
+    search->nick_prefix = weechat_config_string (logger_config_file_nick_prefix);
+    search->nick_suffix = weechat_config_string (logger_config_file_nick_suffix);
+
+    rc = logger_index_search (ptr_logger_buffer->log_filename, search,
+                              callback, callback_data);
+
+    search->nick = ptr_nick;
+    search->word = ptr_word;
+    if (nick)
+        free (nick);
+    if (word)
+        free (word);
+
+    return rc;
+}
+
+/*
+ * Callback for lines found by command "/logger search": displays line in
+ * buffer.
+ */
+
+void
+logger_search_print_cb (void *data, time_t date,
+                        const char *prefix, const char *message)
+{
+    char *prefix2, *message2;
+
+    prefix2 = (logger_charset) ?
+        weechat_iconv_to_internal (logger_charset, prefix) : NULL;
+    message2 = (logger_charset) ?
+        weechat_iconv_to_internal (logger_charset, message) : NULL;
+
+    weechat_printf_date_tags ((struct t_gui_buffer *)data, date,
+                              "no_highlight,notify_none,no_log,logger_search",
+                              "%s%s\t%s%s",
+                              weechat_color (weechat_config_string (logger_config_color_backlog_line)),
+                              (prefix2) ? prefix2 : prefix,
+                              weechat_color (weechat_config_string (logger_config_color_backlog_line)),
+                              (message2) ? message2 : message);
+
+    if (prefix2)
+        free (prefix2);
+    if (message2)
+        free (message2);
+}
+
+/*
+ * Runs command "/logger search" on a buffer.
+ */
+
+void
+logger_search_command (struct t_gui_buffer *buffer, int argc, char **argv,
+                       char **argv_eol)
+{
+    struct t_logger_index_search search;
+    char *error;
+    long number;
+    int i, rc;
+
+    memset (&search, 0, sizeof (search));
+    search.limit = 100;
+
+    for (i = 2; i < argc; i++)
+    {
+        if ((weechat_strcasecmp (argv[i], "-from") == 0) && (i + 1 < argc))
+        {
+            search.date_start = logger_index_parse_date (argv[++i], 0);
+            if (search.date_start == 0)
+                goto error_date;
+        }
+        else if ((weechat_strcasecmp (argv[i], "-to") == 0) && (i + 1 < argc))
+        {
+            search.date_end = logger_index_parse_date (argv[++i], 1);
+            if (search.date_end == 0)
+                goto error_date;
+        }
+        else if ((weechat_strcasecmp (argv[i], "-nick") == 0)
+                 && (i + 1 < argc))
+        {
+            search.nick = argv[++i];
+        }
+        else if ((weechat_strcasecmp (argv[i], "-limit") == 0)
+                 && (i + 1 < argc))
+        {
+            error = NULL;
+            number = strtol (argv[++i], &error, 10);
+            if (!error || error[0] || (number < 0))
+            {
+                weechat_printf_tags (NULL,
+                                     "no_log",
+                                     _("%s%s: invalid number: \"%s\""),
+                                     weechat_prefix ("error"),
+                                     LOGGER_PLUGIN_NAME, argv[i]);
+                return;
+            }
+            search.limit = number;
+        }
+        else
+        {
+            search.word = argv_eol[i];
+            break;
+        }
+    }
+
+    rc = logger_search (buffer, &search, &logger_search_print_cb, buffer);
+    if (rc < 0)
+    {
+        weechat_printf_tags (NULL,
+                             "no_log",
+                             _("%s%s: unable to search in log file of buffer "
+                               "\"%s\""),
+                             weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                             weechat_buffer_get_string (buffer, "name"));
+        return;
+    }
+
+    if (search.indexed)
+    {
+        weechat_printf_tags (buffer,
+                             "no_log,logger_search_end",
+                             _("%s===\t%s========== %d lines found "
+                               "(%d/%d blocks read) =========="),
+                             weechat_color (weechat_config_string (logger_config_color_backlog_end)),
+                             weechat_color (weechat_config_string (logger_config_color_backlog_end)),
+                             search.lines_found,
+                             search.blocks_read,
+                             search.blocks_total);
+    }
+    else
+    {
+        weechat_printf_tags (buffer,
+                             "no_log,logger_search_end",
+                             _("%s===\t%s========== %d lines found "
+                               "(no index) =========="),
+                             weechat_color (weechat_config_string (logger_config_color_backlog_end)),
+                             weechat_color (weechat_config_string (logger_config_color_backlog_end)),
+                             search.lines_found);
+    }
+    return;
+
+error_date:
+    weechat_printf_tags (NULL,
+                         "no_log",
+                         _("%s%s: invalid date: \"%s\""),
+                         weechat_prefix ("error"), LOGGER_PLUGIN_NAME,
+                         argv[i]);
+}
+
 /*
  * Callback for command "/logger".
  */
@@ -878,7 +1302,6 @@ logger_command_cb (void *data, struct t_gui_buffer *buffer,
 {
     /* make C compiler happy */
     (void) data;
-    (void) argv_eol;
 
     if ((argc == 1)
         || ((argc == 2) && (weechat_strcasecmp (argv[1], "list") == 0)))
@@ -897,6 +1320,7 @@ logger_command_cb (void *data, struct t_gui_buffer *buffer,
     if (weechat_strcasecmp (argv[1], "flush") == 0)
     {
         logger_flush ();
+        logger_writer_fence ();
         return WEECHAT_RC_OK;
     }
 
@@ -906,6 +1330,12 @@ logger_command_cb (void *data, struct t_gui_buffer *buffer,
         return WEECHAT_RC_OK;
     }
 
+    if (weechat_strcasecmp (argv[1], "search") == 0)
+    {
+        logger_search_command (buffer, argc, argv, argv_eol);
+        return WEECHAT_RC_OK;
+    }
+
     return WEECHAT_RC_ERROR;
 }
 
@@ -972,79 +1402,71 @@ void
 logger_backlog (struct t_gui_buffer *buffer, const char *filename, int lines)
 {
     const char *charset;
-    struct t_logger_line *last_lines, *ptr_lines;
-    char *pos_message, *pos_tab, *error, *message;
-    time_t datetime, time_now;
-    struct tm tm_line;
-    int num_lines;
+    struct t_logger_tail *last_lines;
+    struct t_logger_tail_date_cache date_cache;
+    char *color_line, *ptr_line, *pos_message, *pos_tab, *message;
+    time_t datetime;
+    int i;
+
+    /* read last lines of log file (all lines are read in one block) */
+    last_lines = logger_tail_file (filename, lines);
+    if (!last_lines)
+        return;
 
     charset = weechat_info_get ("charset_terminal", "");
+    color_line = strdup (weechat_color (weechat_config_string (logger_config_color_backlog_line)));
+    logger_tail_date_cache_init (&date_cache,
+                                 weechat_config_string (logger_config_file_time_format));
 
     weechat_buffer_set (buffer, "print_hooks_enabled", "0");
 
-    num_lines = 0;
-    last_lines = logger_tail_file (filename, lines);
-    ptr_lines = last_lines;
-    while (ptr_lines)
+    datetime = 0;
+    for (i = 0; i < last_lines->num_lines; i++)
     {
+        ptr_line = last_lines->lines[i];
         datetime = 0;
-        pos_message = strchr (ptr_lines->data, '\t');
+        pos_message = strchr (ptr_line, '\t');
         if (pos_message)
         {
-            /* initialize structure, because strptime does not do it */
-            memset (&tm_line, 0, sizeof (struct tm));
-            /*
-             * we get current time to initialize daylight saving time in
-             * structure tm_line, otherwise printed time will be shifted
-             * and will not use DST used on machine
-             */
-            time_now = time (NULL);
-            localtime_r (&time_now, &tm_line);
             pos_message[0] = '\0';
-            error = strptime (ptr_lines->data,
-                              weechat_config_string (logger_config_file_time_format),
-                              &tm_line);
-            if (error && !error[0] && (tm_line.tm_year > 0))
-                datetime = mktime (&tm_line);
+            datetime = logger_tail_get_date (&date_cache, ptr_line);
             pos_message[0] = '\t';
         }
         pos_message = (pos_message && (datetime != 0)) ?
-            pos_message + 1 : ptr_lines->data;
-        message = (charset) ?
-            weechat_iconv_to_internal (charset, pos_message) : strdup (pos_message);
+            pos_message + 1 : ptr_line;
+
+        /* convert charset only if line is not valid UTF-8 */
+        message = (charset && !weechat_utf8_is_valid (pos_message, NULL)) ?
+            weechat_iconv_to_internal (charset, pos_message) : NULL;
         if (message)
-        {
-            pos_tab = strchr (message, '\t');
-            if (pos_tab)
-                pos_tab[0] = '\0';
-            weechat_printf_date_tags (buffer, datetime,
-                                      "no_highlight,notify_none,logger_backlog",
-                                      "%s%s%s%s%s",
-                                      weechat_color (weechat_config_string (logger_config_color_backlog_line)),
-                                      message,
-                                      (pos_tab) ? "\t" : "",
-                                      (pos_tab) ? weechat_color (weechat_config_string (logger_config_color_backlog_line)) : "",
-                                      (pos_tab) ? pos_tab + 1 : "");
-            if (pos_tab)
-                pos_tab[0] = '\t';
-            free (message);
-        }
-        num_lines++;
-        ptr_lines = ptr_lines->next_line;
-    }
-    if (last_lines)
-        logger_tail_free (last_lines);
-    if (num_lines > 0)
-    {
+            pos_message = message;
+
+        pos_tab = strchr (pos_message, '\t');
+        if (pos_tab)
+            pos_tab[0] = '\0';
         weechat_printf_date_tags (buffer, datetime,
-                                  "no_highlight,notify_none,logger_backlog_end",
-                                  _("%s===\t%s========== End of backlog (%d lines) =========="),
-                                  weechat_color (weechat_config_string (logger_config_color_backlog_end)),
-                                  weechat_color (weechat_config_string (logger_config_color_backlog_end)),
-                                  num_lines);
-        weechat_buffer_set (buffer, "unread", "");
+                                  "no_highlight,notify_none,logger_backlog",
+                                  "%s%s%s%s%s",
+                                  (color_line) ? color_line : "",
+                                  pos_message,
+                                  (pos_tab) ? "\t" : "",
+                                  (pos_tab && color_line) ? color_line : "",
+                                  (pos_tab) ? pos_tab + 1 : "");
+        if (message)
+            free (message);
     }
+    weechat_printf_date_tags (buffer, datetime,
+                              "no_highlight,notify_none,logger_backlog_end",
+                              _("%s===\t%s========== End of backlog (%d lines) =========="),
+                              weechat_color (weechat_config_string (logger_config_color_backlog_end)),
+                              weechat_color (weechat_config_string (logger_config_color_backlog_end)),
+                              last_lines->num_lines);
+    weechat_buffer_set (buffer, "unread", "");
     weechat_buffer_set (buffer, "print_hooks_enabled", "1");
+
+    if (color_line)
+        free (color_line);
+    logger_tail_free (last_lines);
 }
 
 /*
@@ -1072,6 +1494,9 @@ logger_backlog_signal_cb (void *data, const char *signal,
 
             if (ptr_logger_buffer->log_filename)
             {
+                /* wait for lines sent to writer thread */
+                logger_writer_fence ();
+
                 ptr_logger_buffer->log_enabled = 0;
 
                 logger_backlog (signal_data,
@@ -1150,7 +1575,7 @@ logger_adjust_log_filenames ()
             ptr_logger_buffer = logger_buffer_search_buffer (ptr_buffer);
             if (ptr_logger_buffer && ptr_logger_buffer->log_filename)
             {
-                log_filename = logger_get_filename (ptr_logger_buffer->buffer);
+                log_filename = logger_get_filename (ptr_logger_buffer);
                 if (log_filename)
                 {
                     if (strcmp (log_filename, ptr_logger_buffer->log_filename) != 0)
@@ -1170,6 +1595,57 @@ logger_adjust_log_filenames ()
     }
 }
 
+/*
+ * Rotates log files according to option logger.file.rotation_time (called
+ * when the day has changed).
+ *
+ * Log files with a date in mask are not rotated (a new file is already used
+ * when the date changes).
+ */
+
+void
+logger_rotate_time ()
+{
+    struct t_logger_buffer *ptr_logger_buffer;
+    time_t seconds;
+    struct tm *date_tmp;
+    int rotate;
+
+    seconds = time (NULL);
+    date_tmp = localtime (&seconds);
+    if (!date_tmp)
+        return;
+
+    switch (weechat_config_integer (logger_config_file_rotation_time))
+    {
+        case LOGGER_CONFIG_ROTATION_TIME_DAILY:
+            rotate = 1;
+            break;
+        case LOGGER_CONFIG_ROTATION_TIME_WEEKLY:
+            rotate = (date_tmp->tm_wday == 1);
+            break;
+        case LOGGER_CONFIG_ROTATION_TIME_MONTHLY:
+            rotate = (date_tmp->tm_mday == 1);
+            break;
+        default:
+            rotate = 0;
+            break;
+    }
+    if (!rotate)
+        return;
+
+    for (ptr_logger_buffer = logger_buffers; ptr_logger_buffer;
+         ptr_logger_buffer = ptr_logger_buffer->next_buffer)
+    {
+        if (ptr_logger_buffer->log_filename
+            && !(ptr_logger_buffer->log_mask
+                 && strchr (ptr_logger_buffer->log_mask, '%')))
+        {
+            logger_rotate (ptr_logger_buffer);
+        }
+    }
+}
+
 /*
  * Callback for signal "day_changed".
  */
@@ -1186,16 +1662,20 @@ logger_day_changed_signal_cb (void *data, const char *signal,
 
     logger_adjust_log_filenames ();
 
+    logger_rotate_time ();
+
     return WEECHAT_RC_OK;
 }
 
 /*
- * Gets info with tags of line: log level and if prefix is a nick.
+ * Gets info with tags of line: log level, if prefix is a nick and the nick
+ * (tag "nick_xxx").
  */
 
 void
 logger_get_line_tag_info (int tags_count, const char **tags,
-                          int *log_level, int *prefix_is_nick)
+                          int *log_level, int *prefix_is_nick,
+                          const char **nick)
 {
     int i, log_level_set, prefix_is_nick_set;
 
@@ -1203,6 +1683,8 @@ logger_get_line_tag_info (int tags_count, const char **tags,
         *log_level = LOGGER_LEVEL_DEFAULT;
     if (prefix_is_nick)
         *prefix_is_nick = 0;
+    if (nick)
+        *nick = NULL;
 
     log_level_set = 0;
     prefix_is_nick_set = 0;
@@ -1235,6 +1717,11 @@ logger_get_line_tag_info (int tags_count, const char **tags,
                 prefix_is_nick_set = 1;
             }
         }
+        if (nick && !*nick)
+        {
+            if (strncmp (tags[i], "nick_", 5) == 0)
+                *nick = tags[i] + 5;
+        }
     }
 }
 
@@ -1249,9 +1736,9 @@ logger_print_cb (void *data, struct t_gui_buffer *buffer, time_t date,
                  const char *prefix, const char *message)
 {
     struct t_logger_buffer *ptr_logger_buffer;
-    struct tm *date_tmp;
-    char buf_time[256];
-    int line_log_level, prefix_is_nick;
+    const char *ptr_nick_prefix, *ptr_nick_suffix, *ptr_nick;
+    char buf_time[256], *line;
+    int line_log_level, prefix_is_nick, message_offset, length;
 
     /* make C compiler happy */
     (void) data;
@@ -1259,7 +1746,7 @@ logger_print_cb (void *data, struct t_gui_buffer *buffer, time_t date,
     (void) highlight;
 
     logger_get_line_tag_info (tags_count, tags, &line_log_level,
-                              &prefix_is_nick);
+                              &prefix_is_nick, &ptr_nick);
     if (line_log_level >= 0)
     {
         ptr_logger_buffer = logger_buffer_search_buffer (buffer);
@@ -1268,22 +1755,30 @@ logger_print_cb (void *data, struct t_gui_buffer *buffer, time_t date,
             && (date > 0)
             && (line_log_level <= ptr_logger_buffer->log_level))
         {
-            buf_time[0] = '\0';
-            date_tmp = localtime (&date);
-            if (date_tmp)
+            weechat_util_strftime (
+                buf_time, sizeof (buf_time),
+                weechat_config_string (logger_config_file_time_format),
+                date);
+            ptr_nick_prefix = (prefix && prefix_is_nick) ?
+                weechat_config_string (logger_config_file_nick_prefix) : "";
+            ptr_nick_suffix = (prefix && prefix_is_nick) ?
+                weechat_config_string (logger_config_file_nick_suffix) : "";
+            message_offset = strlen (buf_time) + 1 +
+                strlen (ptr_nick_prefix) + ((prefix) ? strlen (prefix) : 0) +
+                strlen (ptr_nick_suffix) + 1;
+            length = message_offset + strlen (message) + 1;
+            line = malloc (length);
+            if (line)
             {
-                strftime (buf_time, sizeof (buf_time) - 1,
-                          weechat_config_string (logger_config_file_time_format),
-                          date_tmp);
+                snprintf (line, length, "%s\t%s%s%s\t%s",
+                          buf_time,
+                          ptr_nick_prefix,
+                          (prefix) ? prefix : "",
+                          ptr_nick_suffix,
+                          message);
+                logger_write_data (ptr_logger_buffer, date, line,
+                                   message_offset, ptr_nick);
             }
-
-            logger_write_line (ptr_logger_buffer,
-                               "%s\t%s%s%s\t%s",
-                               buf_time,
-                               (prefix && prefix_is_nick) ? weechat_config_string (logger_config_file_nick_prefix) : "",
-                               (prefix) ? prefix : "",
-                               (prefix && prefix_is_nick) ? weechat_config_string (logger_config_file_nick_suffix) : "",
-                               message);
         }
     }
 
@@ -1319,8 +1814,15 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
 
     weechat_plugin = plugin;
 
+    logger_charset = weechat_info_get ("charset_terminal", "");
+
+    logger_writer_init ();
+
     if (!logger_config_init ())
+    {
+        logger_writer_end ();
         return WEECHAT_RC_ERROR;
+    }
 
     logger_config_read ();
 
@@ -1331,13 +1833,26 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
         N_("list"
            " || set <level>"
            " || flush"
-           " || disable"),
+           " || disable"
+           " || search [-from <date>] [-to <date>] [-nick <nick>] "
+           "[-limit <number>] [<word>]"),
         N_("   list: show logging status for opened buffers\n"
            "    set: set logging level on current buffer\n"
            "  level: level for messages to be logged (0 = logging disabled, "
            "1 = a few messages (most important) .. 9 = all messages)\n"
            "  flush: write all log files now\n"
            "disable: disable logging on current buffer (set level to 0)\n"
+           " search: search lines in log file of current buffer (lines found "
+           "are displayed in buffer); if option logger.file.index is enabled, "
+           "the index file is used to read only blocks of lines which may "
+           "contain lines searched\n"
+           "  -from: first date: \"YYYY-MM-DD\", \"YYYY-MM-DDTHH:MM\", "
+           "\"YYYY-MM-DDTHH:MM:SS\" or a timestamp\n"
+           "    -to: last date (same format as -from)\n"
+           "  -nick: search only messages from this nick\n"
+           " -limit: max number of lines displayed (default: 100, 0 = no "
+           "limit)\n"
+           "   word: search only messages with this word (case insensitive)\n"
            "\n"
            "Options \"logger.level.*\" and \"logger.mask.*\" can be used to set "
            "level or mask for a buffer, or buffers beginning with name.\n"
@@ -1359,11 +1874,16 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
            "  disable logging for main WeeChat buffer:\n"
            "    /set logger.level.core.weechat 0\n"
            "  use a directory per IRC server and a file per channel inside:\n"
-           "    /set logger.mask.irc \"$server/$channel.weechatlog\""),
+           "    /set logger.mask.irc \"$server/$channel.weechatlog\"\n"
+           "  search messages from nick \"alice\" with word \"release\" in "
+           "March 2014:\n"
+           "    /logger search -from 2014-03-01 -to 2014-03-31 -nick alice "
+           "release"),
         "list"
         " || set 1|2|3|4|5|6|7|8|9"
         " || flush"
-        " || disable",
+        " || disable"
+        " || search -from|-to|-nick|-limit",
         &logger_command_cb, NULL);
 
     logger_start_buffer_all (1);
@@ -1403,6 +1923,9 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
 
     logger_stop_all (1);
 
+    /* wait for end of writes in log files */
+    logger_writer_end ();
+
     logger_config_free ();
 
     return WEECHAT_RC_OK;
@@ -25,13 +25,24 @@
 
 #define LOGGER_LEVEL_DEFAULT 9
 
+struct t_gui_buffer;
+struct t_logger_index_search;
+
 extern struct t_weechat_plugin *weechat_logger_plugin;
 
 extern struct t_hook *logger_timer;
+extern const char *logger_charset;
 
 extern void logger_start_buffer_all (int write_info_line);
 extern void logger_stop_all (int write_info_line);
+extern void logger_close_log_files ();
 extern void logger_adjust_log_filenames ();
+extern int logger_search (struct t_gui_buffer *buffer,
+                          struct t_logger_index_search *search,
+                          void (*callback)(void *data, time_t date,
+                                           const char *prefix,
+                                           const char *message),
+                          void *callback_data);
 extern int logger_timer_cb (void *data, int remaining_calls);
 
 #endif /* WEECHAT_LOGGER_H */
@@ -483,7 +483,8 @@ plugin_api_infolist_get_internal (void *data, const char *infolist_name,
     struct t_weechat_plugin *ptr_plugin;
     struct t_proxy *ptr_proxy;
     struct t_gui_layout *ptr_layout;
-    int context, number, i;
+    const char *ptr_text;
+    int context, number, where, i;
     char *error;
 
     /* make C compiler happy */
@@ -687,6 +688,74 @@ plugin_api_infolist_get_internal (void *data, const char *infolist_name,
             return ptr_infolist;
         }
     }
+    else if (string_strcasecmp (infolist_name, "buffer_lines_search") == 0)
+    {
+        if (!pointer)
+            pointer = gui_buffers;
+        else
+        {
+            /* invalid buffer pointer ? */
+            if (!gui_buffer_valid (pointer))
+                return NULL;
+        }
+
+        ptr_buffer = (struct t_gui_buffer *)pointer;
+
+        /* text to search: arguments, or current text search in buffer */
+        if (arguments && arguments[0])
+            ptr_text = arguments;
+        else if (ptr_buffer->text_search != GUI_TEXT_SEARCH_DISABLED)
+            ptr_text = ptr_buffer->input_buffer;
+        else
+            ptr_text = NULL;
+        if (!ptr_text || !ptr_text[0])
+            return NULL;
+
+        where = (ptr_buffer->text_search_where) ?
+            ptr_buffer->text_search_where : GUI_TEXT_SEARCH_IN_MESSAGE;
+
+        ptr_infolist = infolist_new (NULL);
+        if (ptr_infolist)
+        {
+            if ((ptr_text != arguments) && ptr_buffer->text_search_regex)
+            {
+                /* current search is a regex: check all lines */
+                for (ptr_line = ptr_buffer->lines->first_line; ptr_line;
+                     ptr_line = ptr_line->next_line)
+                {
+                    if (ptr_buffer->text_search_regex_compiled
+                        && gui_line_search_text_match (
+                            ptr_line, NULL, 0,
+                            ptr_buffer->text_search_regex_compiled, where)
+                        && !gui_line_add_to_infolist (ptr_infolist,
+                                                      ptr_buffer->lines,
+                                                      ptr_line))
+                    {
+                        infolist_free (ptr_infolist);
+                        return NULL;
+                    }
+                }
+            }
+            else if (gui_lines_search_update (ptr_buffer->lines, ptr_text,
+                                              ptr_buffer->text_search_exact,
+                                              where, 1))
+            {
+                /* use lines found in cache of text search */
+                for (i = ptr_buffer->lines->search_found_start;
+                     i < ptr_buffer->lines->search_found_end; i++)
+                {
+                    if (!gui_line_add_to_infolist (ptr_infolist,
+                                                   ptr_buffer->lines,
+                                                   ptr_buffer->lines->search_found[i]))
+                    {
+                        infolist_free (ptr_infolist);
+                        return NULL;
+                    }
+                }
+            }
+            return ptr_infolist;
+        }
+    }
     else if (string_strcasecmp (infolist_name, "filter") == 0)
     {
         ptr_infolist = infolist_new (NULL);
@@ -1232,6 +1301,12 @@ plugin_api_init ()
                    N_("buffer pointer"),
                    NULL,
                    &plugin_api_infolist_get_internal, NULL);
+    hook_infolist (NULL, "buffer_lines_search",
+                   N_("lines of a buffer matching a text search"),
+                   N_("buffer pointer"),
+                   N_("text to search (if not set, current text search in "
+                      "buffer is used) (optional)"),
+                   &plugin_api_infolist_get_internal, NULL);
     hook_infolist (NULL, "filter", N_("list of filters"),
                    NULL,
                    N_("filter name (wildcard \"*\" is allowed) (optional)"),
@@ -45,6 +45,9 @@ char *relay_irc_backlog_commands_tags[RELAY_IRC_NUM_CMD] =
 char *relay_irc_server_capabilities[RELAY_IRC_NUM_CAPAB] =
 { "server-time" };
 
+struct t_relay_irc_in2_msg relay_irc_in2_last_msg =
+{ NULL, NULL, NULL, NULL, NULL, NULL, 0, 0, NULL, 0 };
+
 
 /*
  * Checks if IRC command has to be relayed to client.
@@ -185,6 +188,64 @@ end:
     return hash_parsed;
 }
 
+/*
+ * Splits an IRC message (if it is too long) and returns message(s) ready to
+ * send to a client, each one ending with "\r\n".
+ *
+ * Argument "size" is set with the size of data returned (in bytes).
+ *
+ * Note: result must be freed after use.
+ */
+
+char *
+relay_irc_message_split (const char *server, const char *message, int *size)
+{
+    int number, length;
+    char hash_key[32], *data, *new_data;
+    const char *str_message;
+    struct t_hashtable *hashtable_in, *hashtable_out;
+
+    *size = 0;
+    data = NULL;
+
+    hashtable_in = weechat_hashtable_new (32,
+                                          WEECHAT_HASHTABLE_STRING,
+                                          WEECHAT_HASHTABLE_STRING,
+                                          NULL,
+                                          NULL);
+    if (!hashtable_in)
+        return NULL;
+
+    weechat_hashtable_set (hashtable_in, "server", server);
+    weechat_hashtable_set (hashtable_in, "message", message);
+    hashtable_out = weechat_info_get_hashtable ("irc_message_split",
+                                                hashtable_in);
+    if (hashtable_out)
+    {
+        number = 1;
+        while (1)
+        {
+            snprintf (hash_key, sizeof (hash_key), "msg%d", number);
+            str_message = weechat_hashtable_get (hashtable_out, hash_key);
+            if (!str_message)
+                break;
+            length = strlen (str_message);
+            new_data = realloc (data, *size + length + 2 + 1);
+            if (!new_data)
+                break;
+            data = new_data;
+            memcpy (data + *size, str_message, length);
+            memcpy (data + *size + length, "\r\n", 3);
+            *size += length + 2;
+            number++;
+        }
+        weechat_hashtable_free (hashtable_out);
+    }
+    weechat_hashtable_free (hashtable_in);
+
+    return data;
+}
+
 /*
  * Sends formatted data to client.
  */
@@ -192,10 +253,8 @@ end:
 void
 relay_irc_sendf (struct t_relay_client *client, const char *format, ...)
 {
-    int length, number;
-    char *pos, hash_key[32], *message;
-    const char *str_message;
-    struct t_hashtable *hashtable_in, *hashtable_out;
+    char *pos, *data;
+    int size;
 
     if (!client)
         return;
@@ -211,42 +270,137 @@ relay_irc_sendf (struct t_relay_client *client, const char *format, ...)
     if (pos)
         pos[0] = '\0';
 
-    hashtable_in = weechat_hashtable_new (32,
-                                          WEECHAT_HASHTABLE_STRING,
-                                          WEECHAT_HASHTABLE_STRING,
-                                          NULL,
-                                          NULL);
-    if (hashtable_in)
+    data = relay_irc_message_split (client->protocol_args, vbuffer, &size);
+    if (data)
     {
-        weechat_hashtable_set (hashtable_in, "server", client->protocol_args);
-        weechat_hashtable_set (hashtable_in, "message", vbuffer);
-        hashtable_out = weechat_info_get_hashtable ("irc_message_split",
-                                                    hashtable_in);
-        if (hashtable_out)
+        if (size > 0)
+            relay_client_send (client, RELAY_CLIENT_MSG_STANDARD,
+                               data, size, NULL);
+        free (data);
+    }
+
+    free (vbuffer);
+}
+
+/*
+ * Frees last message received from an IRC server.
+ */
+
+void
+relay_irc_in2_msg_free ()
+{
+    if (relay_irc_in2_last_msg.server)
+        free (relay_irc_in2_last_msg.server);
+    if (relay_irc_in2_last_msg.message)
+        free (relay_irc_in2_last_msg.message);
+    if (relay_irc_in2_last_msg.nick)
+        free (relay_irc_in2_last_msg.nick);
+    if (relay_irc_in2_last_msg.host)
+        free (relay_irc_in2_last_msg.host);
+    if (relay_irc_in2_last_msg.command)
+        free (relay_irc_in2_last_msg.command);
+    if (relay_irc_in2_last_msg.arguments)
+        free (relay_irc_in2_last_msg.arguments);
+    if (relay_irc_in2_last_msg.data)
+        free (relay_irc_in2_last_msg.data);
+
+    memset (&relay_irc_in2_last_msg, 0, sizeof (relay_irc_in2_last_msg));
+}
+
+/*
+ * Gets a message received from an IRC server, parsed and ready to send to
+ * clients.
+ *
+ * The message is parsed and formatted only once for all clients connected to
+ * the same server (the result is kept until another message is received).
+ *
+ * Returns pointer to message, NULL if error.
+ */
+
+struct t_relay_irc_in2_msg *
+relay_irc_in2_msg_get (const char *server, const char *message)
+{
+    struct t_hashtable *hash_parsed;
+    const char *ptr_value;
+    char *str_message;
+    int length;
+
+    if (!server || !message)
+        return NULL;
+
+    /* same message as last one: return it */
+    if (relay_irc_in2_last_msg.server && relay_irc_in2_last_msg.message
+        && (strcmp (relay_irc_in2_last_msg.server, server) == 0)
+        && (strcmp (relay_irc_in2_last_msg.message, message) == 0))
+    {
+        return &relay_irc_in2_last_msg;
+    }
+
+    relay_irc_in2_msg_free ();
+
+    hash_parsed = relay_irc_message_parse (message);
+    if (!hash_parsed)
+        return NULL;
+
+    relay_irc_in2_last_msg.server = strdup (server);
+    relay_irc_in2_last_msg.message = strdup (message);
+    ptr_value = weechat_hashtable_get (hash_parsed, "nick");
+    relay_irc_in2_last_msg.nick = (ptr_value) ? strdup (ptr_value) : NULL;
+    ptr_value = weechat_hashtable_get (hash_parsed, "host");
+    relay_irc_in2_last_msg.host = (ptr_value) ? strdup (ptr_value) : NULL;
+    ptr_value = weechat_hashtable_get (hash_parsed, "command");
+    relay_irc_in2_last_msg.command = (ptr_value) ? strdup (ptr_value) : NULL;
+    ptr_value = weechat_hashtable_get (hash_parsed, "arguments");
+    relay_irc_in2_last_msg.arguments = (ptr_value) ? strdup (ptr_value) : NULL;
+
+    weechat_hashtable_free (hash_parsed);
+
+    if (!relay_irc_in2_last_msg.server || !relay_irc_in2_last_msg.message)
+    {
+        relay_irc_in2_msg_free ();
+        return NULL;
+    }
+
+    /* relay all commands to client, but not ping/pong */
+    relay_irc_in2_last_msg.relay =
+        (relay_irc_in2_last_msg.command
+         && (weechat_strcasecmp (relay_irc_in2_last_msg.command, "ping") != 0)
+         && (weechat_strcasecmp (relay_irc_in2_last_msg.command, "pong") != 0)) ?
+        1 : 0;
+
+    /* messages/notices can be dropped if client is too slow */
+    relay_irc_in2_last_msg.msg_type =
+        (relay_irc_in2_last_msg.command
+         && relay_irc_command_relayed (relay_irc_in2_last_msg.command)) ?
+        RELAY_CLIENT_MSG_LINE : RELAY_CLIENT_MSG_STANDARD;
+
+    /*
+     * build message to send to clients (if there is no host in message, the
+     * address of each client is used, so the message is built for each
+     * client)
+     */
+    if (relay_irc_in2_last_msg.relay
+        && relay_irc_in2_last_msg.host && relay_irc_in2_last_msg.host[0])
+    {
+        length = strlen (relay_irc_in2_last_msg.host) +
+            strlen (relay_irc_in2_last_msg.command) +
+            ((relay_irc_in2_last_msg.arguments) ?
+             strlen (relay_irc_in2_last_msg.arguments) : 0) + 4;
+        str_message = malloc (length);
+        if (str_message)
         {
-            number = 1;
-            while (1)
-            {
-                snprintf (hash_key, sizeof (hash_key), "msg%d", number);
-                str_message = weechat_hashtable_get (hashtable_out, hash_key);
-                if (!str_message)
-                    break;
-                length = strlen (str_message) + 16 + 1;
-                message = malloc (length);
-                if (message)
-                {
-                    snprintf (message, length, "%s\r\n", str_message);
-                    relay_client_send (client, message, strlen (message), NULL);
-                    free (message);
-                }
-                number++;
-            }
-            weechat_hashtable_free (hashtable_out);
+            snprintf (str_message, length, ":%s %s %s",
+                      relay_irc_in2_last_msg.host,
+                      relay_irc_in2_last_msg.command,
+                      (relay_irc_in2_last_msg.arguments) ?
+                      relay_irc_in2_last_msg.arguments : "");
+            relay_irc_in2_last_msg.data = relay_irc_message_split (
+                server, str_message, &relay_irc_in2_last_msg.data_size);
+            free (str_message);
         }
-        weechat_hashtable_free (hashtable_in);
     }
 
-    free (vbuffer);
+    return &relay_irc_in2_last_msg;
 }
 
 /*
@@ -261,15 +415,13 @@ relay_irc_signal_irc_in2_cb (void *data, const char *signal,
                              const char *type_data, void *signal_data)
 {
     struct t_relay_client *client;
-    const char *ptr_msg, *irc_nick, *irc_host, *irc_command, *irc_args;
-    struct t_hashtable *hash_parsed;
+    struct t_relay_irc_in2_msg *ptr_msg;
 
     /* make C compiler happy */
     (void) signal;
     (void) type_data;
 
     client = (struct t_relay_client *)data;
-    ptr_msg = (const char *)signal_data;
 
     if (weechat_relay_plugin->debug >= 2)
     {
@@ -278,41 +430,42 @@ relay_irc_signal_irc_in2_cb (void *data, const char *signal,
                         RELAY_COLOR_CHAT_CLIENT,
                         client->desc,
                         RELAY_COLOR_CHAT,
-                        ptr_msg);
+                        (const char *)signal_data);
     }
 
-    hash_parsed = relay_irc_message_parse (ptr_msg);
-    if (hash_parsed)
+    ptr_msg = relay_irc_in2_msg_get (client->protocol_args,
+                                     (const char *)signal_data);
+    if (!ptr_msg)
+        return WEECHAT_RC_OK;
+
+    /* if self nick has changed, update it in client data */
+    if (ptr_msg->command && (weechat_strcasecmp (ptr_msg->command, "nick") == 0)
+        && ptr_msg->nick && ptr_msg->nick[0]
+        && ptr_msg->arguments && ptr_msg->arguments[0]
+        && (weechat_strcasecmp (ptr_msg->nick, RELAY_IRC_DATA(client, nick)) == 0))
     {
-        irc_nick = weechat_hashtable_get (hash_parsed, "nick");
-        irc_host = weechat_hashtable_get (hash_parsed, "host");
-        irc_command = weechat_hashtable_get (hash_parsed, "command");
-        irc_args = weechat_hashtable_get (hash_parsed, "arguments");
+        if (RELAY_IRC_DATA(client, nick))
+            free (RELAY_IRC_DATA(client, nick));
+        RELAY_IRC_DATA(client, nick) = strdup ((ptr_msg->arguments[0] == ':') ?
+                                               ptr_msg->arguments + 1 :
+                                               ptr_msg->arguments);
+    }
 
-        /* if self nick has changed, update it in client data */
-        if (irc_command && (weechat_strcasecmp (irc_command, "nick") == 0)
-            && irc_nick && irc_nick[0]
-            && irc_args && irc_args[0]
-            && (weechat_strcasecmp (irc_nick, RELAY_IRC_DATA(client, nick)) == 0))
+    if (ptr_msg->relay)
+    {
+        if (ptr_msg->data)
         {
-            if (RELAY_IRC_DATA(client, nick))
-                free (RELAY_IRC_DATA(client, nick));
-            RELAY_IRC_DATA(client, nick) = strdup ((irc_args[0] == ':') ?
-                                                   irc_args + 1 : irc_args);
+            /* message is the same for all clients: send it as-is */
+            relay_client_send (client, ptr_msg->msg_type,
+                               ptr_msg->data, ptr_msg->data_size, NULL);
         }
-
-        /* relay all commands to client, but not ping/pong */
-        if (irc_command
-            && (weechat_strcasecmp (irc_command, "ping") != 0)
-            && (weechat_strcasecmp (irc_command, "pong") != 0))
+        else
         {
             relay_irc_sendf (client, ":%s %s %s",
-                             (irc_host && irc_host[0]) ? irc_host : RELAY_IRC_DATA(client, address),
-                             irc_command,
-                             irc_args);
+                             RELAY_IRC_DATA(client, address),
+                             ptr_msg->command,
+                             ptr_msg->arguments);
         }
-
-        weechat_hashtable_free (hash_parsed);
     }
 
     return WEECHAT_RC_OK;
@@ -710,8 +863,8 @@ relay_irc_get_line_info (struct t_relay_client *client,
         if (!(RELAY_IRC_DATA(client, server_capabilities) & (1 << RELAY_IRC_CAPAB_SERVER_TIME))
             && time_format && time_format[0])
         {
-            tm = localtime (&msg_date);
-            strftime (str_time, sizeof (str_time), time_format, tm);
+            weechat_util_strftime (str_time, sizeof (str_time), time_format,
+                                   msg_date);
             length = strlen (str_time) + strlen (pos) + 1;
             *message = malloc (length);
             if (*message)
@@ -1952,3 +2105,13 @@ relay_irc_print_log (struct t_relay_client *client)
         weechat_log_printf ("    hook_hsignal_irc_redir. : 0x%lx", RELAY_IRC_DATA(client, hook_hsignal_irc_redir));
     }
 }
+
+/*
+ * Ends IRC protocol (frees data shared by all clients).
+ */
+
+void
+relay_irc_end ()
+{
+    relay_irc_in2_msg_free ();
+}
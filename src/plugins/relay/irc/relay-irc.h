@@ -44,6 +44,27 @@ struct t_relay_irc_data
     struct t_hook *hook_hsignal_irc_redir;  /* hsignal "irc_redirection_..."*/
 };
 
+/*
+ * last message received from an IRC server: it is parsed and formatted only
+ * once, then sent as-is to all clients connected to this server
+ */
+
+struct t_relay_irc_in2_msg
+{
+    char *server;                      /* IRC server name                   */
+    char *message;                     /* raw message received from server  */
+    char *nick;                        /* nick in message                   */
+    char *host;                        /* host in message                   */
+    char *command;                     /* IRC command                       */
+    char *arguments;                   /* arguments of command              */
+    int relay;                         /* 1 if message is sent to clients   */
+    int msg_type;                      /* type of message (line or not)     */
+    char *data;                        /* message(s) ready to send to       */
+                                       /* clients (ending with "\r\n"),     */
+                                       /* NULL if built for each client     */
+    int data_size;                     /* size of data (in bytes)           */
+};
+
 enum t_relay_irc_command
 {
     RELAY_IRC_CMD_JOIN = 0,
@@ -62,6 +83,8 @@ enum t_relay_irc_server_capab
     RELAY_IRC_NUM_CAPAB,
 };
 
+extern struct t_relay_irc_in2_msg relay_irc_in2_last_msg;
+
 extern void relay_irc_recv (struct t_relay_client *client,
                             const char *data);
 extern void relay_irc_close_connection (struct t_relay_client *client);
@@ -72,5 +95,6 @@ extern void relay_irc_free (struct t_relay_client *client);
 extern int relay_irc_add_to_infolist (struct t_infolist_item *item,
                                       struct t_relay_client *client);
 extern void relay_irc_print_log (struct t_relay_client *client);
+extern void relay_irc_end ();
 
 #endif /* WEECHAT_RELAY_IRC_H */
@@ -62,6 +62,9 @@ struct t_relay_client *relay_clients = NULL;
 struct t_relay_client *last_relay_client = NULL;
 int relay_client_count = 0;            /* number of clients                 */
 
+struct t_hook *relay_client_outqueue_hook_timer = NULL; /* timer to check   */
+                                       /* size of outqueues                 */
+
 
 /*
  * Checks if a client pointer is valid.
@@ -334,7 +337,9 @@ relay_client_recv_text (struct t_relay_client *client, const char *data)
                             handshake  = relay_websocket_build_handshake (client);
                             if (handshake)
                             {
-                                relay_client_send (client, handshake,
+                                relay_client_send (client,
+                                                   RELAY_CLIENT_MSG_STANDARD,
+                                                   handshake,
                                                    strlen (handshake), NULL);
                                 free (handshake);
                                 client->websocket = 2;
@@ -423,39 +428,256 @@ relay_client_recv_text (struct t_relay_client *client, const char *data)
     }
 }
 
+/*
+ * Ensures there is free space in receive buffer of client for next read.
+ *
+ * If "grow" is 1, the buffer is doubled (because last read filled all the
+ * free space); if the buffer is empty and larger than needed, it is shrunk.
+ *
+ * Returns:
+ *   1: OK
+ *   0: error (memory error or max size of buffer reached)
+ */
+
+int
+relay_client_recv_buffer_reserve (struct t_relay_client *client, int grow)
+{
+    char *new_buffer;
+    int new_size;
+
+    new_size = (client->recv_buffer_size > 0) ?
+        client->recv_buffer_size : RELAY_CLIENT_RECV_BUFFER_MIN_SIZE;
+
+    if (grow || (client->recv_buffer_length + 1 >= new_size))
+    {
+        /* grow buffer (partial data or last read filled the buffer) */
+        if (new_size >= RELAY_CLIENT_RECV_BUFFER_MAX_SIZE)
+        {
+            if (client->recv_buffer_length + 1 >= new_size)
+                return 0;
+        }
+        else
+            new_size *= 2;
+    }
+    else if ((client->recv_buffer_length == 0)
+             && (new_size > RELAY_CLIENT_RECV_BUFFER_MIN_SIZE))
+    {
+        /* shrink empty buffer (client does not send much data any more) */
+        new_size /= 2;
+    }
+
+    if (client->recv_buffer && (new_size == client->recv_buffer_size))
+        return 1;
+
+    new_buffer = realloc (client->recv_buffer, new_size);
+    if (!new_buffer)
+        return (client->recv_buffer_length + 1 < client->recv_buffer_size);
+    client->recv_buffer = new_buffer;
+    client->recv_buffer_size = new_size;
+
+    return 1;
+}
+
+/*
+ * Processes data in receive buffer of client.
+ *
+ * With websocket, only complete frames are decoded (in place, in the receive
+ * buffer), and an incomplete frame is kept in buffer until the end of frame
+ * is received.
+ */
+
+void
+relay_client_recv_buffer_process (struct t_relay_client *client)
+{
+    int rc;
+    unsigned long long decoded_length, length_used;
+
+    if (client->recv_buffer_length <= 0)
+        return;
+
+    if (client->websocket == 2)
+    {
+        /* websocket used, decode message */
+        rc = relay_websocket_decode_frame (
+            (unsigned char *)client->recv_buffer,
+            (unsigned long long)client->recv_buffer_length,
+            RELAY_CLIENT_RECV_BUFFER_MAX_SIZE - 1,
+            (unsigned char *)client->recv_buffer,
+            &decoded_length,
+            &length_used);
+        if (rc <= 0)
+        {
+            /* error when decoding frame or frame too big: close connection */
+            if (rc < 0)
+            {
+                weechat_printf_tags (NULL, "relay_client",
+                                     _("%s%s: websocket frame too big for "
+                                       "client %s%s%s (max size: %d bytes)"),
+                                     weechat_prefix ("error"),
+                                     RELAY_PLUGIN_NAME,
+                                     RELAY_COLOR_CHAT_CLIENT,
+                                     client->desc,
+                                     RELAY_COLOR_CHAT,
+                                     RELAY_CLIENT_RECV_BUFFER_MAX_SIZE - 1);
+            }
+            else
+            {
+                weechat_printf_tags (NULL, "relay_client",
+                                     _("%s%s: error decoding websocket frame "
+                                       "for client %s%s%s"),
+                                     weechat_prefix ("error"),
+                                     RELAY_PLUGIN_NAME,
+                                     RELAY_COLOR_CHAT_CLIENT,
+                                     client->desc,
+                                     RELAY_COLOR_CHAT);
+            }
+            client->recv_buffer_length = 0;
+            relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
+            return;
+        }
+
+        /*
+         * When decoded length is 0, assume client sent a PONG frame.
+         *
+         * RFC 6455 Section 5.5.3:
+         *
+         *   "A Pong frame MAY be sent unsolicited.  This serves as a
+         *   unidirectional heartbeat.  A response to an unsolicited
+         *   Pong
+         *   frame is not expected."
+         */
+        if ((decoded_length > 0)
+            && (client->recv_data_type == RELAY_CLIENT_DATA_TEXT))
+        {
+            relay_client_recv_text (client, client->recv_buffer);
+        }
+
+        /* keep incomplete frame (if any) in buffer */
+        if (length_used > 0)
+        {
+            client->recv_buffer_length -= (int)length_used;
+            if (client->recv_buffer_length > 0)
+            {
+                memmove (client->recv_buffer,
+                         client->recv_buffer + length_used,
+                         client->recv_buffer_length);
+            }
+        }
+    }
+    else
+    {
+        client->recv_buffer[client->recv_buffer_length] = '\0';
+        if ((client->websocket == 1)
+            || (client->recv_data_type == RELAY_CLIENT_DATA_TEXT))
+        {
+            /* websocket initializing or text data for this client */
+            relay_client_recv_text (client, client->recv_buffer);
+        }
+        else
+        {
+            /* receive buffer as-is (binary data) */
+            /* currently, all supported protocols receive only text, no binary */
+        }
+        client->recv_buffer_length = 0;
+    }
+}
+
 /*
  * Reads data from a client.
+ *
+ * Socket is read until there is no more data available (or until
+ * RELAY_CLIENT_RECV_BUDGET bytes are read, so that other clients are not
+ * blocked by a client sending a lot of data).
  */
 
 int
 relay_client_recv_cb (void *arg_client, int fd)
 {
     struct t_relay_client *client;
-    static char buffer[4096], decoded[4096 + 1];
-    const char *ptr_buffer;
-    int num_read, rc;
-    unsigned long long decoded_length;
+    char *ptr_data;
+    int num_read, size_read, total_read, grow;
 
     /* make C compiler happy */
     (void) fd;
 
     client = (struct t_relay_client *)arg_client;
 
-    if (client->status != RELAY_STATUS_CONNECTED)
-        return WEECHAT_RC_OK;
+    total_read = 0;
+    grow = 0;
+
+    while ((client->status == RELAY_STATUS_CONNECTED)
+           && (total_read < RELAY_CLIENT_RECV_BUDGET))
+    {
+        if (!relay_client_recv_buffer_reserve (client, grow))
+        {
+            weechat_printf_tags (NULL, "relay_client",
+                                 _("%s%s: not enough memory for received "
+                                   "data (client %s%s%s)"),
+                                 weechat_prefix ("error"), RELAY_PLUGIN_NAME,
+                                 RELAY_COLOR_CHAT_CLIENT,
+                                 client->desc,
+                                 RELAY_COLOR_CHAT);
+            relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
+            break;
+        }
+
+        ptr_data = client->recv_buffer + client->recv_buffer_length;
+        size_read = client->recv_buffer_size - client->recv_buffer_length - 1;
+        if (size_read > RELAY_CLIENT_RECV_BUFFER_MAX_READ)
+            size_read = RELAY_CLIENT_RECV_BUFFER_MAX_READ;
 
 #ifdef HAVE_GNUTLS
-    if (client->ssl)
-        num_read = gnutls_record_recv (client->gnutls_sess, buffer,
-                                       sizeof (buffer) - 1);
-    else
+        if (client->ssl)
+            num_read = gnutls_record_recv (client->gnutls_sess, ptr_data,
+                                           size_read);
+        else
 #endif
-        num_read = recv (client->sock, buffer, sizeof (buffer) - 1, 0);
+            num_read = recv (client->sock, ptr_data, size_read, 0);
 
-    if (num_read > 0)
-    {
-        buffer[num_read] = '\0';
-        ptr_buffer = buffer;
+        if (num_read <= 0)
+        {
+#ifdef HAVE_GNUTLS
+            if (client->ssl)
+            {
+                if ((num_read == 0)
+                    || ((num_read != GNUTLS_E_AGAIN) && (num_read != GNUTLS_E_INTERRUPTED)))
+                {
+                    weechat_printf_tags (NULL, "relay_client",
+                                         _("%s%s: reading data on socket for "
+                                           "client %s%s%s: error %d %s"),
+                                         weechat_prefix ("error"), RELAY_PLUGIN_NAME,
+                                         RELAY_COLOR_CHAT_CLIENT,
+                                         client->desc,
+                                         RELAY_COLOR_CHAT,
+                                         num_read,
+                                         (num_read == 0) ? _("(connection closed by peer)") :
+                                         gnutls_strerror (num_read));
+                    relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
+                }
+            }
+            else
+#endif
+            {
+                if ((num_read == 0)
+                    || ((errno != EAGAIN) && (errno != EWOULDBLOCK)))
+                {
+                    weechat_printf_tags (NULL, "relay_client",
+                                         _("%s%s: reading data on socket for "
+                                           "client %s%s%s: error %d %s"),
+                                         weechat_prefix ("error"), RELAY_PLUGIN_NAME,
+                                         RELAY_COLOR_CHAT_CLIENT,
+                                         client->desc,
+                                         RELAY_COLOR_CHAT,
+                                         errno,
+                                         (num_read == 0) ? _("(connection closed by peer)") :
+                                         strerror (errno));
+                    relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
+                }
+            }
+            break;
+        }
+
+        ptr_data[num_read] = '\0';
 
         /*
          * if we are receiving the first message from client, check if it looks
@@ -463,7 +685,7 @@ relay_client_recv_cb (void *arg_client, int fd)
          */
         if (client->bytes_recv == 0)
         {
-            if (relay_websocket_is_http_get_weechat (buffer))
+            if (relay_websocket_is_http_get_weechat (ptr_data))
             {
                 /*
                  * web socket is just initializing for now, it's not accepted
@@ -480,98 +702,200 @@ relay_client_recv_cb (void *arg_client, int fd)
         }
 
         client->bytes_recv += num_read;
+        client->recv_buffer_length += num_read;
+        total_read += num_read;
 
-        if (client->websocket == 2)
-        {
-            /* websocket used, decode message */
-            rc = relay_websocket_decode_frame ((unsigned char *)buffer,
-                                               (unsigned long long)num_read,
-                                               (unsigned char *)decoded,
-                                               &decoded_length);
-            if (decoded_length == 0)
-            {
-                /*
-                 * When decoded length is 0, assume client sent a PONG frame.
-                 *
-                 * RFC 6455 Section 5.5.3:
-                 *
-                 *   "A Pong frame MAY be sent unsolicited.  This serves as a
-                 *   unidirectional heartbeat.  A response to an unsolicited
-                 *   Pong
-                 *   frame is not expected."
-                 */
-                return WEECHAT_RC_OK;
-            }
-            if (!rc)
-            {
-                /* error when decoding frame: close connection */
-                weechat_printf_tags (NULL, "relay_client",
-                                     _("%s%s: error decoding websocket frame "
-                                       "for client %s%s%s"),
-                                     weechat_prefix ("error"), RELAY_PLUGIN_NAME,
-                                     RELAY_COLOR_CHAT_CLIENT,
-                                     client->desc,
-                                     RELAY_COLOR_CHAT);
-                relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
-                return WEECHAT_RC_OK;
-            }
-            ptr_buffer = decoded;
-        }
+        /* buffer was full: read more data at once next time */
+        grow = ((num_read == size_read)
+                && (client->recv_buffer_size <= RELAY_CLIENT_RECV_BUFFER_MAX_READ));
 
-        if ((client->websocket == 1)
-            || (client->recv_data_type == RELAY_CLIENT_DATA_TEXT))
-        {
-            /* websocket initializing or text data for this client */
-            relay_client_recv_text (client, ptr_buffer);
-        }
-        else
-        {
-            /* receive buffer as-is (binary data) */
-            /* currently, all supported protocols receive only text, no binary */
-        }
+        relay_client_recv_buffer_process (client);
+    }
+
+    if (total_read > 0)
         relay_buffer_refresh (NULL);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Frees a message in out queue.
+ */
+
+void
+relay_client_outqueue_free (struct t_relay_client *client,
+                            struct t_relay_client_outqueue *outqueue)
+{
+    struct t_relay_client_outqueue *new_outqueue;
+
+    /* remove outqueue message */
+    if (client->last_outqueue == outqueue)
+        client->last_outqueue = outqueue->prev_outqueue;
+    if (outqueue->prev_outqueue)
+    {
+        (outqueue->prev_outqueue)->next_outqueue = outqueue->next_outqueue;
+        new_outqueue = client->outqueue;
     }
     else
+        new_outqueue = outqueue->next_outqueue;
+
+    if (outqueue->next_outqueue)
+        (outqueue->next_outqueue)->prev_outqueue = outqueue->prev_outqueue;
+
+    client->outqueue_size -= outqueue->data_size;
+    client->outqueue_count--;
+    if (outqueue->msg_type == RELAY_CLIENT_MSG_LINE)
     {
-#ifdef HAVE_GNUTLS
-        if (client->ssl)
+        client->outqueue_lines_size -= outqueue->data_size;
+        client->outqueue_lines_count--;
+    }
+
+    /* free data */
+    if (outqueue->data)
+        free (outqueue->data);
+    if (outqueue->raw_message[0])
+        free (outqueue->raw_message[0]);
+    if (outqueue->raw_message[1])
+        free (outqueue->raw_message[1]);
+    free (outqueue);
+
+    /* set new head */
+    client->outqueue = new_outqueue;
+
+    if (!client->outqueue)
+        client->outqueue_resync = 0;
+}
+
+/*
+ * Frees all messages in out queue.
+ */
+
+void
+relay_client_outqueue_free_all (struct t_relay_client *client)
+{
+    while (client->outqueue)
+    {
+        relay_client_outqueue_free (client, client->outqueue);
+    }
+}
+
+/*
+ * Checks size of out queue: if the max size is reached, the policy defined in
+ * option relay.network.outqueue_policy is applied (drop lines, ask client to
+ * resync or disconnect it).
+ *
+ * This function must not be called when a message is added in out queue
+ * (the client may be disconnected), but only by timers (see function
+ * relay_client_outqueue_timer_cb).
+ */
+
+void
+relay_client_outqueue_check_size (struct t_relay_client *client)
+{
+    struct t_relay_client_outqueue *ptr_outqueue, *ptr_next_outqueue;
+    unsigned long max_size, lines_size;
+    int policy, lines_count, dropped;
+
+    max_size = (unsigned long)weechat_config_integer (relay_config_network_outqueue_max_size) * 1024;
+    if ((max_size == 0) || (client->outqueue_size <= max_size))
+        return;
+
+    policy = weechat_config_integer (relay_config_network_outqueue_policy);
+
+    /*
+     * lines that can be dropped: the first message is never dropped because
+     * it may have been partially sent
+     */
+    lines_size = client->outqueue_lines_size;
+    lines_count = client->outqueue_lines_count;
+    if (client->outqueue
+        && (client->outqueue->msg_type == RELAY_CLIENT_MSG_LINE))
+    {
+        lines_size -= client->outqueue->data_size;
+        lines_count--;
+    }
+
+    /*
+     * drop lines waiting in queue (oldest first), only if it's enough to
+     * reach the max size; with policy "resync", all lines are dropped
+     */
+    dropped = 0;
+    if ((policy != RELAY_CLIENT_OUTQUEUE_POLICY_DISCONNECT)
+        && (lines_count > 0)
+        && (client->outqueue_size - lines_size <= max_size))
+    {
+        ptr_outqueue = client->outqueue->next_outqueue;
+        while (ptr_outqueue && (lines_count > 0)
+               && ((policy == RELAY_CLIENT_OUTQUEUE_POLICY_RESYNC)
+                   || (client->outqueue_size > max_size)))
         {
-            if ((num_read == 0)
-                || ((num_read != GNUTLS_E_AGAIN) && (num_read != GNUTLS_E_INTERRUPTED)))
+            ptr_next_outqueue = ptr_outqueue->next_outqueue;
+            if (ptr_outqueue->msg_type == RELAY_CLIENT_MSG_LINE)
             {
-                weechat_printf_tags (NULL, "relay_client",
-                                     _("%s%s: reading data on socket for "
-                                       "client %s%s%s: error %d %s"),
-                                     weechat_prefix ("error"), RELAY_PLUGIN_NAME,
-                                     RELAY_COLOR_CHAT_CLIENT,
-                                     client->desc,
-                                     RELAY_COLOR_CHAT,
-                                     num_read,
-                                     (num_read == 0) ? _("(connection closed by peer)") :
-                                     gnutls_strerror (num_read));
-                relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
+                relay_client_outqueue_free (client, ptr_outqueue);
+                lines_count--;
+                dropped++;
             }
+            ptr_outqueue = ptr_next_outqueue;
         }
-        else
-#endif
+        client->outqueue_dropped += dropped;
+    }
+
+    if (client->outqueue_size > max_size)
+    {
+        weechat_printf_tags (NULL, "relay_client",
+                             _("%s%s: too much data waiting to be sent to "
+                               "client %s%s%s (%lu bytes), disconnecting"),
+                             weechat_prefix ("error"), RELAY_PLUGIN_NAME,
+                             RELAY_COLOR_CHAT_CLIENT,
+                             client->desc,
+                             RELAY_COLOR_CHAT,
+                             client->outqueue_size);
+        relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
+        return;
+    }
+
+    if ((dropped > 0) && (policy == RELAY_CLIENT_OUTQUEUE_POLICY_RESYNC)
+        && !client->outqueue_resync)
+    {
+        /* ask client to resync (only once until the queue is empty) */
+        client->outqueue_resync = 1;
+        switch (client->protocol)
         {
-            if ((num_read == 0)
-                || ((errno != EAGAIN) && (errno != EWOULDBLOCK)))
-            {
-                weechat_printf_tags (NULL, "relay_client",
-                                     _("%s%s: reading data on socket for "
-                                       "client %s%s%s: error %d %s"),
-                                     weechat_prefix ("error"), RELAY_PLUGIN_NAME,
-                                     RELAY_COLOR_CHAT_CLIENT,
-                                     client->desc,
-                                     RELAY_COLOR_CHAT,
-                                     errno,
-                                     (num_read == 0) ? _("(connection closed by peer)") :
-                                     strerror (errno));
-                relay_client_set_status (client, RELAY_STATUS_DISCONNECTED);
-            }
+            case RELAY_PROTOCOL_WEECHAT:
+                relay_weechat_resync (client);
+                break;
+            case RELAY_PROTOCOL_IRC:
+                break;
+            case RELAY_NUM_PROTOCOLS:
+                break;
         }
     }
+}
+
+/*
+ * Callback of timer used to check size of out queue of clients (this timer
+ * is hooked when a message is added in a full out queue, so that the policy
+ * is applied as soon as possible, but not during the add).
+ */
+
+int
+relay_client_outqueue_timer_cb (void *data, int remaining_calls)
+{
+    struct t_relay_client *ptr_client;
+
+    /* make C compiler happy */
+    (void) data;
+    (void) remaining_calls;
+
+    relay_client_outqueue_hook_timer = NULL;
+
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
+    {
+        if (!RELAY_CLIENT_HAS_ENDED(ptr_client))
+            relay_client_outqueue_check_size (ptr_client);
+    }
 
     return WEECHAT_RC_OK;
 }
@@ -582,11 +906,13 @@ relay_client_recv_cb (void *arg_client, int fd)
 
 void
 relay_client_outqueue_add (struct t_relay_client *client,
+                           enum t_relay_client_msg_type msg_type,
                            const char *data, int data_size,
                            int raw_flags[2], const char *raw_message[2],
                            int raw_size[2])
 {
     struct t_relay_client_outqueue *new_outqueue;
+    unsigned long max_size;
     int i;
 
     if (!client || !data || (data_size <= 0))
@@ -595,6 +921,7 @@ relay_client_outqueue_add (struct t_relay_client *client,
     new_outqueue = malloc (sizeof (*new_outqueue));
     if (new_outqueue)
     {
+        new_outqueue->msg_type = msg_type;
         new_outqueue->data = malloc (data_size);
         if (!new_outqueue->data)
         {
@@ -628,56 +955,23 @@ relay_client_outqueue_add (struct t_relay_client *client,
         else
             client->outqueue = new_outqueue;
         client->last_outqueue = new_outqueue;
-    }
-}
 
-/*
- * Frees a message in out queue.
- */
-
-void
-relay_client_outqueue_free (struct t_relay_client *client,
-                            struct t_relay_client_outqueue *outqueue)
-{
-    struct t_relay_client_outqueue *new_outqueue;
-
-    /* remove outqueue message */
-    if (client->last_outqueue == outqueue)
-        client->last_outqueue = outqueue->prev_outqueue;
-    if (outqueue->prev_outqueue)
-    {
-        (outqueue->prev_outqueue)->next_outqueue = outqueue->next_outqueue;
-        new_outqueue = client->outqueue;
-    }
-    else
-        new_outqueue = outqueue->next_outqueue;
-
-    if (outqueue->next_outqueue)
-        (outqueue->next_outqueue)->prev_outqueue = outqueue->prev_outqueue;
-
-    /* free data */
-    if (outqueue->data)
-        free (outqueue->data);
-    if (outqueue->raw_message[0])
-        free (outqueue->raw_message[0]);
-    if (outqueue->raw_message[1])
-        free (outqueue->raw_message[1]);
-    free (outqueue);
-
-    /* set new head */
-    client->outqueue = new_outqueue;
-}
-
-/*
- * Frees all messages in out queue.
- */
+        client->outqueue_size += data_size;
+        client->outqueue_count++;
+        if (msg_type == RELAY_CLIENT_MSG_LINE)
+        {
+            client->outqueue_lines_size += data_size;
+            client->outqueue_lines_count++;
+        }
 
-void
-relay_client_outqueue_free_all (struct t_relay_client *client)
-{
-    while (client->outqueue)
-    {
-        relay_client_outqueue_free (client, client->outqueue);
+        /* check size of out queue later, if the max size is reached */
+        max_size = (unsigned long)weechat_config_integer (relay_config_network_outqueue_max_size) * 1024;
+        if ((max_size > 0) && (client->outqueue_size > max_size)
+            && !relay_client_outqueue_hook_timer)
+        {
+            relay_client_outqueue_hook_timer = weechat_hook_timer (
+                1, 0, 1, &relay_client_outqueue_timer_cb, NULL);
+        }
     }
 }
 
@@ -691,8 +985,10 @@ relay_client_outqueue_free_all (struct t_relay_client *client)
  */
 
 int
-relay_client_send (struct t_relay_client *client, const char *data,
-                   int data_size, const char *message_raw_buffer)
+relay_client_send (struct t_relay_client *client,
+                   enum t_relay_client_msg_type msg_type,
+                   const char *data, int data_size,
+                   const char *message_raw_buffer)
 {
     int num_sent, raw_size[2], raw_flags[2], i;
     char *websocket_frame;
@@ -774,7 +1070,7 @@ relay_client_send (struct t_relay_client *client, const char *data,
      */
     if (client->outqueue)
     {
-        relay_client_outqueue_add (client, ptr_data, data_size,
+        relay_client_outqueue_add (client, msg_type, ptr_data, data_size,
                                    raw_flags, raw_msg, raw_size);
     }
     else
@@ -804,7 +1100,8 @@ relay_client_send (struct t_relay_client *client, const char *data,
             if (num_sent < data_size)
             {
                 /* some data was not sent, add it to outqueue */
-                relay_client_outqueue_add (client, ptr_data + num_sent,
+                relay_client_outqueue_add (client, RELAY_CLIENT_MSG_STANDARD,
+                                           ptr_data + num_sent,
                                            data_size - num_sent,
                                            NULL, NULL, NULL);
             }
@@ -818,7 +1115,8 @@ relay_client_send (struct t_relay_client *client, const char *data,
                     || (num_sent == GNUTLS_E_INTERRUPTED))
                 {
                     /* add message to queue (will be sent later) */
-                    relay_client_outqueue_add (client, ptr_data, data_size,
+                    relay_client_outqueue_add (client, msg_type,
+                                               ptr_data, data_size,
                                                raw_flags, raw_msg, raw_size);
                 }
                 else
@@ -842,7 +1140,8 @@ relay_client_send (struct t_relay_client *client, const char *data,
                 if ((errno == EAGAIN) || (errno == EWOULDBLOCK))
                 {
                     /* add message to queue (will be sent later) */
-                    relay_client_outqueue_add (client, ptr_data, data_size,
+                    relay_client_outqueue_add (client, msg_type,
+                                               ptr_data, data_size,
                                                raw_flags, raw_msg, raw_size);
                 }
                 else
@@ -905,6 +1204,9 @@ relay_client_timer_cb (void *data, int remaining_calls)
         }
         else if (ptr_client->sock >= 0)
         {
+            /* apply policy if out queue is full (client may be disconnected) */
+            relay_client_outqueue_check_size (ptr_client);
+
             while (ptr_client->outqueue)
             {
 #ifdef HAVE_GNUTLS
@@ -971,6 +1273,9 @@ relay_client_timer_cb (void *data, int remaining_calls)
                                 free (ptr_client->outqueue->data);
                                 ptr_client->outqueue->data = buf;
                                 ptr_client->outqueue->data_size = ptr_client->outqueue->data_size - num_sent;
+                                ptr_client->outqueue_size -= num_sent;
+                                if (ptr_client->outqueue->msg_type == RELAY_CLIENT_MSG_LINE)
+                                    ptr_client->outqueue_lines_size -= num_sent;
                             }
                         }
                         break;
@@ -1092,6 +1397,9 @@ relay_client_new (int sock, const char *address, struct t_relay_server *server)
                 break;
         }
         new_client->partial_message = NULL;
+        new_client->recv_buffer = NULL;
+        new_client->recv_buffer_size = 0;
+        new_client->recv_buffer_length = 0;
 
         relay_client_set_desc (new_client);
 
@@ -1163,6 +1471,12 @@ relay_client_new (int sock, const char *address, struct t_relay_server *server)
 
         new_client->outqueue = NULL;
         new_client->last_outqueue = NULL;
+        new_client->outqueue_size = 0;
+        new_client->outqueue_count = 0;
+        new_client->outqueue_lines_size = 0;
+        new_client->outqueue_lines_count = 0;
+        new_client->outqueue_dropped = 0;
+        new_client->outqueue_resync = 0;
 
         new_client->prev_client = NULL;
         new_client->next_client = relay_clients;
@@ -1218,6 +1532,8 @@ relay_client_new_with_infolist (struct t_infolist *infolist)
 {
     struct t_relay_client *new_client;
     const char *str;
+    void *buf;
+    int buf_size;
 
     new_client = malloc (sizeof (*new_client));
     if (new_client)
@@ -1260,6 +1576,26 @@ relay_client_new_with_infolist (struct t_infolist *infolist)
         new_client->send_data_type = weechat_infolist_integer (infolist, "send_data_type");
         str = weechat_infolist_string (infolist, "partial_message");
         new_client->partial_message = (str) ? strdup (str) : NULL;
+        new_client->recv_buffer = NULL;
+        new_client->recv_buffer_size = 0;
+        new_client->recv_buffer_length = 0;
+        buf = weechat_infolist_buffer (infolist, "recv_buffer", &buf_size);
+        if (buf && (buf_size > 0))
+        {
+            new_client->recv_buffer_size = RELAY_CLIENT_RECV_BUFFER_MIN_SIZE;
+            while (new_client->recv_buffer_size < buf_size + 1)
+            {
+                new_client->recv_buffer_size *= 2;
+            }
+            new_client->recv_buffer = malloc (new_client->recv_buffer_size);
+            if (new_client->recv_buffer)
+            {
+                memcpy (new_client->recv_buffer, buf, buf_size);
+                new_client->recv_buffer_length = buf_size;
+            }
+            else
+                new_client->recv_buffer_size = 0;
+        }
 
         str = weechat_infolist_string (infolist, "desc");
         if (str)
@@ -1283,6 +1619,12 @@ relay_client_new_with_infolist (struct t_infolist *infolist)
 
         new_client->outqueue = NULL;
         new_client->last_outqueue = NULL;
+        new_client->outqueue_size = 0;
+        new_client->outqueue_count = 0;
+        new_client->outqueue_lines_size = 0;
+        new_client->outqueue_lines_count = 0;
+        new_client->outqueue_dropped = 0;
+        new_client->outqueue_resync = 0;
 
         new_client->prev_client = NULL;
         new_client->next_client = relay_clients;
@@ -1424,6 +1766,8 @@ relay_client_free (struct t_relay_client *client)
         weechat_unhook (client->hook_fd);
     if (client->partial_message)
         free (client->partial_message);
+    if (client->recv_buffer)
+        free (client->recv_buffer);
     if (client->protocol_data)
     {
         switch (client->protocol)
@@ -1560,12 +1904,28 @@ relay_client_add_to_infolist (struct t_infolist *infolist,
     snprintf (value, sizeof (value), "%lu", client->bytes_sent);
     if (!weechat_infolist_new_var_string (ptr_item, "bytes_sent", value))
         return 0;
+    snprintf (value, sizeof (value), "%lu", client->outqueue_size);
+    if (!weechat_infolist_new_var_string (ptr_item, "outqueue_size", value))
+        return 0;
+    if (!weechat_infolist_new_var_integer (ptr_item, "outqueue_count", client->outqueue_count))
+        return 0;
+    if (!weechat_infolist_new_var_integer (ptr_item, "outqueue_dropped", client->outqueue_dropped))
+        return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "recv_data_type", client->recv_data_type))
         return 0;
     if (!weechat_infolist_new_var_integer (ptr_item, "send_data_type", client->send_data_type))
         return 0;
     if (!weechat_infolist_new_var_string (ptr_item, "partial_message", client->partial_message))
         return 0;
+    if (client->recv_buffer_length > 0)
+    {
+        if (!weechat_infolist_new_var_buffer (ptr_item, "recv_buffer",
+                                              client->recv_buffer,
+                                              client->recv_buffer_length))
+            return 0;
+    }
+    if (!weechat_infolist_new_var_integer (ptr_item, "recv_buffer_size", client->recv_buffer_size))
+        return 0;
 
     switch (client->protocol)
     {
@@ -1631,6 +1991,9 @@ relay_client_print_log ()
                             ptr_client->send_data_type,
                             relay_client_data_type_string[ptr_client->send_data_type]);
         weechat_log_printf ("  partial_message . . . : '%s'",  ptr_client->partial_message);
+        weechat_log_printf ("  recv_buffer . . . . . : 0x%lx", ptr_client->recv_buffer);
+        weechat_log_printf ("  recv_buffer_size. . . : %d",    ptr_client->recv_buffer_size);
+        weechat_log_printf ("  recv_buffer_length. . : %d",    ptr_client->recv_buffer_length);
         weechat_log_printf ("  protocol_data . . . . : 0x%lx", ptr_client->protocol_data);
         switch (ptr_client->protocol)
         {
@@ -1645,6 +2008,12 @@ relay_client_print_log ()
         }
         weechat_log_printf ("  outqueue. . . . . . . : 0x%lx", ptr_client->outqueue);
         weechat_log_printf ("  last_outqueue . . . . : 0x%lx", ptr_client->last_outqueue);
+        weechat_log_printf ("  outqueue_size . . . . : %lu",   ptr_client->outqueue_size);
+        weechat_log_printf ("  outqueue_count. . . . : %d",    ptr_client->outqueue_count);
+        weechat_log_printf ("  outqueue_lines_size . : %lu",   ptr_client->outqueue_lines_size);
+        weechat_log_printf ("  outqueue_lines_count. : %d",    ptr_client->outqueue_lines_count);
+        weechat_log_printf ("  outqueue_dropped. . . : %d",    ptr_client->outqueue_dropped);
+        weechat_log_printf ("  outqueue_resync . . . : %d",    ptr_client->outqueue_resync);
         weechat_log_printf ("  prev_client . . . . . : 0x%lx", ptr_client->prev_client);
         weechat_log_printf ("  next_client . . . . . : 0x%lx", ptr_client->next_client);
     }
@@ -49,16 +49,46 @@ enum t_relay_client_data_type
     RELAY_NUM_CLIENT_DATA_TYPES,
 };
 
+/* type of message sent to client */
+
+enum t_relay_client_msg_type
+{
+    RELAY_CLIENT_MSG_STANDARD = 0,     /* standard message                  */
+    RELAY_CLIENT_MSG_LINE,             /* line displayed in a buffer (can   */
+                                       /* be dropped if client is too slow) */
+    /* number of message types */
+    RELAY_NUM_CLIENT_MSG_TYPES,
+};
+
+/* action when outqueue is full (option relay.network.outqueue_policy) */
+
+enum t_relay_client_outqueue_policy
+{
+    RELAY_CLIENT_OUTQUEUE_POLICY_DROP_OLDEST = 0,
+    RELAY_CLIENT_OUTQUEUE_POLICY_RESYNC,
+    RELAY_CLIENT_OUTQUEUE_POLICY_DISCONNECT,
+    /* number of outqueue policies */
+    RELAY_NUM_CLIENT_OUTQUEUE_POLICIES,
+};
+
 /* macros for status */
 
 #define RELAY_CLIENT_HAS_ENDED(client)                                  \
     ((client->status == RELAY_STATUS_AUTH_FAILED) ||                    \
      (client->status == RELAY_STATUS_DISCONNECTED))
 
+/* receive buffer: initial size, max size and max bytes read by callback */
+
+#define RELAY_CLIENT_RECV_BUFFER_MIN_SIZE   4096
+#define RELAY_CLIENT_RECV_BUFFER_MAX_SIZE   (16 * 1024 * 1024)
+#define RELAY_CLIENT_RECV_BUFFER_MAX_READ   (256 * 1024)
+#define RELAY_CLIENT_RECV_BUDGET            (1024 * 1024)
+
 /* output queue of messages to client */
 
 struct t_relay_client_outqueue
 {
+    enum t_relay_client_msg_type msg_type; /* type of message           */
     char *data;                         /* data to send                     */
     int data_size;                      /* number of bytes                  */
     int raw_flags[2];                   /* flags for raw messages           */
@@ -98,9 +128,21 @@ struct t_relay_client
     enum t_relay_client_data_type recv_data_type; /* type recv from client  */
     enum t_relay_client_data_type send_data_type; /* type sent to client    */
     char *partial_message;             /* partial text message received     */
+    char *recv_buffer;                 /* data received (not yet processed) */
+    int recv_buffer_size;              /* allocated size of recv_buffer     */
+    int recv_buffer_length;            /* number of bytes in recv_buffer    */
     void *protocol_data;               /* data depending on protocol used   */
     struct t_relay_client_outqueue *outqueue; /* queue for outgoing msgs    */
     struct t_relay_client_outqueue *last_outqueue; /* last outgoing msg     */
+    unsigned long outqueue_size;       /* bytes waiting in outqueue         */
+    int outqueue_count;                /* number of messages in outqueue    */
+    unsigned long outqueue_lines_size; /* bytes of lines in outqueue (lines */
+                                       /* can be dropped if queue is full)  */
+    int outqueue_lines_count;          /* number of lines in outqueue       */
+    int outqueue_dropped;              /* number of messages dropped (when  */
+                                       /* outqueue was full)                */
+    int outqueue_resync;               /* 1 if client was asked to resync   */
+                                       /* (reset when outqueue is empty)    */
     struct t_relay_client *prev_client;/* link to previous client           */
     struct t_relay_client *next_client;/* link to next client               */
 };
@@ -116,9 +158,12 @@ extern struct t_relay_client *relay_client_search_by_id (int id);
 extern int relay_client_status_search (const char *name);
 extern void relay_client_set_desc (struct t_relay_client *client);
 extern int relay_client_recv_cb (void *arg_client, int fd);
-extern int relay_client_send (struct t_relay_client *client, const char *data,
-                              int data_size, const char *message_raw_buffer);
+extern int relay_client_send (struct t_relay_client *client,
+                              enum t_relay_client_msg_type msg_type,
+                              const char *data, int data_size,
+                              const char *message_raw_buffer);
 extern int relay_client_timer_cb (void *data, int remaining_calls);
+extern int relay_client_outqueue_timer_cb (void *data, int remaining_calls);
 extern struct t_relay_client *relay_client_new (int sock, const char *address,
                                                 struct t_relay_server *server);
 extern struct t_relay_client *relay_client_new_with_infolist (struct t_infolist *infolist);
@@ -56,6 +56,8 @@ struct t_config_option *relay_config_network_clients_purge_delay;
 struct t_config_option *relay_config_network_compression_level;
 struct t_config_option *relay_config_network_ipv6;
 struct t_config_option *relay_config_network_max_clients;
+struct t_config_option *relay_config_network_outqueue_max_size;
+struct t_config_option *relay_config_network_outqueue_policy;
 struct t_config_option *relay_config_network_password;
 struct t_config_option *relay_config_network_ssl_cert_key;
 struct t_config_option *relay_config_network_websocket_allowed_origins;
@@ -68,6 +70,11 @@ struct t_config_option *relay_config_irc_backlog_since_last_disconnect;
 struct t_config_option *relay_config_irc_backlog_tags;
 struct t_config_option *relay_config_irc_backlog_time_format;
 
+/* relay config, weechat section */
+
+struct t_config_option *relay_config_weechat_nicklist_delay;
+struct t_config_option *relay_config_weechat_nicklist_diff_max;
+
 /* other */
 
 regex_t *relay_config_regex_allowed_ips = NULL;
@@ -637,6 +644,28 @@ relay_config_init ()
         N_("maximum number of clients connecting to a port"),
         NULL, 1, 1024, "5", NULL, 0,
         NULL, NULL, NULL, NULL, NULL, NULL);
+    relay_config_network_outqueue_max_size = weechat_config_new_option (
+        relay_config_file, ptr_section,
+        "outqueue_max_size", "integer",
+        N_("maximum size of data waiting to be sent to a client (in "
+           "kilobytes), when the client does not read data fast enough; "
+           "when this size is reached, the option relay.network.outqueue_policy "
+           "is applied (0 = unlimited)"),
+        NULL, 0, 1024 * 1024, "16384", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL);
+    relay_config_network_outqueue_policy = weechat_config_new_option (
+        relay_config_file, ptr_section,
+        "outqueue_policy", "integer",
+        N_("action when the data waiting to be sent to a client reaches the "
+           "size relay.network.outqueue_max_size: drop_oldest = drop the "
+           "oldest lines waiting (the client will miss these lines), "
+           "resync = drop all lines waiting and send a message to client so "
+           "that it can get missing lines (message \"_resync\" for weechat "
+           "protocol, same as drop_oldest for irc protocol), disconnect = "
+           "disconnect the client; if there are no more lines to drop, the "
+           "client is disconnected"),
+        "drop_oldest|resync|disconnect", 0, 0, "disconnect", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL);
     relay_config_network_password = weechat_config_new_option (
         relay_config_file, ptr_section,
         "password", "string",
@@ -710,6 +739,36 @@ relay_config_init ()
            "time in backlog messages"),
         NULL, 0, 0, "[%H:%M] ", NULL, 0, NULL, NULL, NULL, NULL, NULL, NULL);
 
+    /* section weechat */
+    ptr_section = weechat_config_new_section (relay_config_file, "weechat",
+                                              0, 0,
+                                              NULL, NULL, NULL, NULL,
+                                              NULL, NULL, NULL, NULL,
+                                              NULL, NULL);
+    if (!ptr_section)
+    {
+        weechat_config_free (relay_config_file);
+        return 0;
+    }
+
+    relay_config_weechat_nicklist_delay = weechat_config_new_option (
+        relay_config_file, ptr_section,
+        "nicklist_delay", "integer",
+        N_("delay (in milliseconds) during which nicklist changes are "
+           "coalesced before being sent to clients (all changes received "
+           "during this delay are sent in a single message)"),
+        NULL, 1, 60 * 1000, "100", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL);
+    relay_config_weechat_nicklist_diff_max = weechat_config_new_option (
+        relay_config_file, ptr_section,
+        "nicklist_diff_max", "integer",
+        N_("maximum number of nicklist changes stored for a buffer; when "
+           "this number is reached, changes are sent immediately to clients, "
+           "without waiting end of delay (see option "
+           "relay.weechat.nicklist_delay)"),
+        NULL, 16, INT_MAX, "1024", NULL, 0,
+        NULL, NULL, NULL, NULL, NULL, NULL);
+
     /* section port */
     ptr_section = weechat_config_new_section (relay_config_file, "port",
                                               1, 1,
@@ -42,6 +42,8 @@ extern struct t_config_option *relay_config_network_clients_purge_delay;
 extern struct t_config_option *relay_config_network_compression_level;
 extern struct t_config_option *relay_config_network_ipv6;
 extern struct t_config_option *relay_config_network_max_clients;
+extern struct t_config_option *relay_config_network_outqueue_max_size;
+extern struct t_config_option *relay_config_network_outqueue_policy;
 extern struct t_config_option *relay_config_network_password;
 extern struct t_config_option *relay_config_network_ssl_cert_key;
 extern struct t_config_option *relay_config_network_websocket_allowed_origins;
@@ -52,6 +54,9 @@ extern struct t_config_option *relay_config_irc_backlog_since_last_disconnect;
 extern struct t_config_option *relay_config_irc_backlog_tags;
 extern struct t_config_option *relay_config_irc_backlog_time_format;
 
+extern struct t_config_option *relay_config_weechat_nicklist_delay;
+extern struct t_config_option *relay_config_weechat_nicklist_diff_max;
+
 extern regex_t *relay_config_regex_allowed_ips;
 extern regex_t *relay_config_regex_websocket_allowed_origins;
 extern struct t_hashtable *relay_config_hashtable_irc_backlog_tags;
@@ -247,33 +247,55 @@ relay_websocket_send_http (struct t_relay_client *client,
     if (message)
     {
         snprintf (message, length, "HTTP/1.1 %s\r\n\r\n", http);
-        relay_client_send (client, message, strlen (message), NULL);
+        relay_client_send (client, RELAY_CLIENT_MSG_STANDARD,
+                           message, strlen (message), NULL);
         free (message);
     }
 }
 
 /*
- * Decodes a websocket frame.
+ * Decodes websocket frames.
+ *
+ * Only complete frames are decoded: if the last frame in buffer is incomplete,
+ * it is not decoded and argument "length_used" is set to the number of bytes
+ * of complete frames (bytes after must be kept by caller and decoded when the
+ * end of frame is received).
+ *
+ * Argument "decoded" must have at least "buffer_length" + 1 bytes; it can be
+ * the same pointer as "buffer" (frames are then decoded in place: decoded data
+ * is always written before the data read in buffer, and the incomplete frame
+ * after "length_used" bytes is not modified).
+ *
+ * Argument "max_frame_size" is the max size of a frame (header included),
+ * 0 for no limit.
  *
  * Returns:
- *   1: frame decoded successfully
+ *   1: frame(s) decoded successfully
  *   0: error decoding frame (connection must be closed if it happens)
+ *  -1: frame too big (connection must be closed if it happens)
  */
 
 int
 relay_websocket_decode_frame (const unsigned char *buffer,
                               unsigned long long buffer_length,
+                              unsigned long long max_frame_size,
                               unsigned char *decoded,
-                              unsigned long long *decoded_length)
+                              unsigned long long *decoded_length,
+                              unsigned long long *length_used)
 {
-    unsigned long long i, index_buffer, length_frame_size, length_frame;
+    unsigned long long i, index_frame, index_buffer, length_frame_size;
+    unsigned long long length_frame;
+    int masks[4];
 
     *decoded_length = 0;
+    *length_used = 0;
     index_buffer = 0;
 
     /* loop to decode all frames in message */
     while (index_buffer + 2 <= buffer_length)
     {
+        index_frame = index_buffer;
+
         /*
          * check if frame is masked: client MUST send a masked frame; if frame is
          * not masked, we MUST reject it and close the connection (see RFC 6455)
@@ -288,8 +310,8 @@ relay_websocket_decode_frame (const unsigned char *buffer,
         if ((length_frame == 126) || (length_frame == 127))
         {
             length_frame_size = (length_frame == 126) ? 2 : 8;
-            if (buffer_length < 1 + length_frame_size)
-                return 0;
+            if (index_buffer + length_frame_size > buffer_length)
+                break;
             length_frame = 0;
             for (i = 0; i < length_frame_size; i++)
             {
@@ -298,11 +320,22 @@ relay_websocket_decode_frame (const unsigned char *buffer,
             index_buffer += length_frame_size;
         }
 
-        if (buffer_length < 1 + length_frame_size + 4 + length_frame)
-            return 0;
+        /* frame too big: it would never fit in buffer */
+        if ((max_frame_size > 0)
+            && ((length_frame > max_frame_size)
+                || (index_buffer - index_frame + 4 + length_frame > max_frame_size)))
+        {
+            return -1;
+        }
+
+        /* incomplete frame: wait for the end of frame */
+        if ((length_frame > buffer_length)
+            || (index_buffer + 4 + length_frame > buffer_length))
+        {
+            break;
+        }
 
         /* read masks (4 bytes) */
-        int masks[4];
         for (i = 0; i < 4; i++)
         {
             masks[i] = (int)((unsigned char)buffer[index_buffer + i]);
@@ -317,6 +350,7 @@ relay_websocket_decode_frame (const unsigned char *buffer,
         decoded[*decoded_length + length_frame] = '\0';
         *decoded_length += length_frame;
         index_buffer += length_frame;
+        *length_used = index_buffer;
     }
 
     return 1;
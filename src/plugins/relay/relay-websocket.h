@@ -29,8 +29,10 @@ extern void relay_websocket_send_http (struct t_relay_client *client,
                                        const char *http);
 extern int relay_websocket_decode_frame (const unsigned char *buffer,
                                          unsigned long long length,
+                                         unsigned long long max_frame_size,
                                          unsigned char *decoded,
-                                         unsigned long long *decoded_length);
+                                         unsigned long long *decoded_length,
+                                         unsigned long long *length_used);
 extern char *relay_websocket_encode_frame (struct t_relay_client *client,
                                            const char *buffer,
                                            unsigned long long length,
@@ -34,6 +34,8 @@
 #include "relay-raw.h"
 #include "relay-server.h"
 #include "relay-upgrade.h"
+#include "irc/relay-irc.h"
+#include "weechat/relay-weechat.h"
 
 
 WEECHAT_PLUGIN_NAME(RELAY_PLUGIN_NAME);
@@ -207,6 +209,8 @@ weechat_plugin_init (struct t_weechat_plugin *plugin, int argc, char *argv[])
 
     relay_info_init ();
 
+    relay_weechat_init ();
+
     /* look at arguments */
     upgrading = 0;
     for (i = 0; i < argc; i++)
@@ -257,6 +261,10 @@ weechat_plugin_end (struct t_weechat_plugin *plugin)
         relay_client_free_all ();
     }
 
+    relay_weechat_end ();
+
+    relay_irc_end ();
+
     relay_network_end ();
 
     relay_config_free ();
@@ -65,6 +65,10 @@ relay_weechat_msg_new (const char *id)
     }
     new_msg->data_alloc = RELAY_WEECHAT_MSG_INITIAL_ALLOC;
     new_msg->data_size = 0;
+    new_msg->compressed_data = NULL;
+    new_msg->compressed_size = 0;
+    new_msg->compressed_level = 0;
+    new_msg->compressed_time = 0;
 
     /* add size and compression flag (they will be set later) */
     relay_weechat_msg_add_int (new_msg, 0);
@@ -1010,6 +1014,65 @@ relay_weechat_msg_add_nicklist (struct t_relay_weechat_msg *msg,
     relay_weechat_msg_set_bytes (msg, pos_count, &count32, 4);
 }
 
+/*
+ * Compresses a message with zlib (if not already compressed with same level).
+ *
+ * The compressed data is kept in message, so that a message sent to many
+ * clients is compressed only once.
+ *
+ * Returns:
+ *   1: message compressed (and compressed data is smaller than message)
+ *   0: compression failed or useless
+ */
+
+int
+relay_weechat_msg_compress (struct t_relay_weechat_msg *msg, int level)
+{
+    uint32_t size32;
+    int rc;
+    Bytef *dest;
+    uLongf dest_size;
+    struct timeval tv1, tv2;
+
+    if (msg->compressed_data && (msg->compressed_level == level))
+        return 1;
+
+    if (msg->compressed_data)
+    {
+        free (msg->compressed_data);
+        msg->compressed_data = NULL;
+        msg->compressed_size = 0;
+    }
+
+    dest_size = compressBound (msg->data_size - 5);
+    dest = malloc (dest_size + 5);
+    if (!dest)
+        return 0;
+
+    gettimeofday (&tv1, NULL);
+    rc = compress2 (dest + 5, &dest_size,
+                    (Bytef *)(msg->data + 5), msg->data_size - 5,
+                    level);
+    gettimeofday (&tv2, NULL);
+    if ((rc != Z_OK) || ((int)dest_size + 5 >= msg->data_size))
+    {
+        free (dest);
+        return 0;
+    }
+
+    /* set size and compression flag */
+    size32 = htonl ((uint32_t)(dest_size + 5));
+    memcpy (dest, &size32, 4);
+    dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB;
+
+    msg->compressed_data = (char *)dest;
+    msg->compressed_size = (int)dest_size + 5;
+    msg->compressed_level = level;
+    msg->compressed_time = weechat_util_timeval_diff (&tv1, &tv2);
+
+    return 1;
+}
+
 /*
  * Sends a message.
  */
@@ -1020,51 +1083,34 @@ relay_weechat_msg_send (struct t_relay_client *client,
 {
     uint32_t size32;
     char compression, raw_message[1024];
-    int rc;
-    Bytef *dest;
-    uLongf dest_size;
-    struct timeval tv1, tv2;
-    long time_diff;
+    int level;
+    enum t_relay_client_msg_type msg_type;
+
+    /* lines added in buffers can be dropped if client is too slow */
+    msg_type = (msg->id && (strcmp (msg->id, "_buffer_line_added") == 0)) ?
+        RELAY_CLIENT_MSG_LINE : RELAY_CLIENT_MSG_STANDARD;
 
-    if (weechat_config_integer (relay_config_network_compression_level) > 0)
+    level = weechat_config_integer (relay_config_network_compression_level);
+    if (level > 0)
     {
         switch (RELAY_WEECHAT_DATA(client, compression))
         {
             case RELAY_WEECHAT_COMPRESSION_ZLIB:
-                dest_size = compressBound (msg->data_size - 5);
-                dest = malloc (dest_size + 5);
-                if (dest)
+                if (relay_weechat_msg_compress (msg, level))
                 {
-                    gettimeofday (&tv1, NULL);
-                    rc = compress2 (dest + 5, &dest_size,
-                                    (Bytef *)(msg->data + 5), msg->data_size - 5,
-                                    weechat_config_integer (relay_config_network_compression_level));
-                    gettimeofday (&tv2, NULL);
-                    time_diff = weechat_util_timeval_diff (&tv1, &tv2);
-                    if ((rc == Z_OK) && ((int)dest_size + 5 < msg->data_size))
-                    {
-                        /* set size and compression flag */
-                        size32 = htonl ((uint32_t)(dest_size + 5));
-                        memcpy (dest, &size32, 4);
-                        dest[4] = RELAY_WEECHAT_COMPRESSION_ZLIB;
-
-                        /* display message in raw buffer */
-                        snprintf (raw_message, sizeof (raw_message),
-                                  "obj: %d/%d bytes (%d%%, %ldms), id: %s",
-                                  (int)dest_size + 5,
-                                  msg->data_size,
-                                  100 - ((((int)dest_size + 5) * 100) / msg->data_size),
-                                  time_diff,
-                                  msg->id);
-
-                        /* send compressed data */
-                        relay_client_send (client, (const char *)dest, dest_size + 5,
-                                           raw_message);
-
-                        free (dest);
-                        return;
-                    }
-                    free (dest);
+                    /* display message in raw buffer */
+                    snprintf (raw_message, sizeof (raw_message),
+                              "obj: %d/%d bytes (%d%%, %ldms), id: %s",
+                              msg->compressed_size,
+                              msg->data_size,
+                              100 - ((msg->compressed_size * 100) / msg->data_size),
+                              msg->compressed_time,
+                              msg->id);
+
+                    /* send compressed data */
+                    relay_client_send (client, msg_type, msg->compressed_data,
+                                       msg->compressed_size, raw_message);
+                    return;
                 }
                 break;
             default:
@@ -1083,7 +1129,8 @@ relay_weechat_msg_send (struct t_relay_client *client,
     /* send uncompressed data */
     snprintf (raw_message, sizeof (raw_message),
               "obj: %d bytes, id: %s", msg->data_size, msg->id);
-    relay_client_send (client, msg->data, msg->data_size, raw_message);
+    relay_client_send (client, msg_type, msg->data, msg->data_size,
+                       raw_message);
 }
 
 /*
@@ -1097,6 +1144,8 @@ relay_weechat_msg_free (struct t_relay_weechat_msg *msg)
         free (msg->id);
     if (msg->data)
         free (msg->data);
+    if (msg->compressed_data)
+        free (msg->compressed_data);
 
     free (msg);
 }
@@ -44,6 +44,11 @@ struct t_relay_weechat_msg
     char *data;                        /* binary buffer                     */
     int data_alloc;                    /* currently allocated size          */
     int data_size;                     /* current size of buffer            */
+    char *compressed_data;             /* compressed message (kept when     */
+                                       /* message is sent to many clients)  */
+    int compressed_size;               /* size of compressed message        */
+    int compressed_level;              /* compression level used            */
+    long compressed_time;              /* time spent to compress (in ms)    */
 };
 
 extern struct t_relay_weechat_msg *relay_weechat_msg_new (const char *id);
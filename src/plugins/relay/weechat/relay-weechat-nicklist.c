@@ -26,8 +26,27 @@
 #include "../relay.h"
 #include "relay-weechat.h"
 #include "relay-weechat-nicklist.h"
+#include "relay-weechat-protocol.h"
+#include "../relay-client.h"
+#include "../relay-config.h"
 
 
+/*
+ * nicklist diffs waiting to be sent to clients (shared by all clients),
+ * key is a buffer pointer, value is a pointer to a nicklist structure
+ */
+struct t_hashtable *relay_weechat_nicklist_pending = NULL;
+
+/*
+ * version of nicklist for each buffer (incremented each time nicklist diffs
+ * are sent to clients), key is a buffer pointer, value is an integer
+ */
+struct t_hashtable *relay_weechat_nicklist_versions = NULL;
+
+struct t_hook *relay_weechat_nicklist_hook_timer = NULL;
+struct t_hook *relay_weechat_nicklist_hook_hsignal = NULL;
+struct t_hook *relay_weechat_nicklist_hook_signal = NULL;
+
 /*
  * Builds a new nicklist structure (to store nicklist diffs).
  *
@@ -153,3 +172,282 @@ relay_weechat_nicklist_free (struct t_relay_weechat_nicklist *nicklist)
 
     free (nicklist);
 }
+
+/*
+ * Gets current version of nicklist for a buffer.
+ *
+ * Returns 0 if the nicklist of buffer has never changed.
+ */
+
+int
+relay_weechat_nicklist_get_version (struct t_gui_buffer *buffer)
+{
+    int *ptr_version;
+
+    if (!relay_weechat_nicklist_versions)
+        return 0;
+
+    ptr_version = weechat_hashtable_get (relay_weechat_nicklist_versions,
+                                         buffer);
+
+    return (ptr_version) ? *ptr_version : 0;
+}
+
+/*
+ * Increments version of nicklist for a buffer.
+ *
+ * Returns the new version.
+ */
+
+int
+relay_weechat_nicklist_incr_version (struct t_gui_buffer *buffer)
+{
+    int version;
+
+    version = relay_weechat_nicklist_get_version (buffer) + 1;
+    if (relay_weechat_nicklist_versions)
+    {
+        weechat_hashtable_set (relay_weechat_nicklist_versions,
+                               buffer, &version);
+    }
+
+    return version;
+}
+
+/*
+ * Sets version of nicklist known by a client for a buffer (or all buffers if
+ * buffer is NULL), after full nicklist has been sent to the client.
+ *
+ * If some changes are waiting to be sent for the buffer, the version is set
+ * to -1 so that the client will receive full nicklist again when the changes
+ * are sent (diffs would be applied twice on its side).
+ *
+ * The version is kept only if the client is synchronized with flag
+ * "nicklist" for the buffer (versions of nicklist are not incremented when no
+ * client is synchronized with the nicklist of buffer).
+ */
+
+void
+relay_weechat_nicklist_set_client_version (struct t_relay_client *client,
+                                           struct t_gui_buffer *buffer)
+{
+    struct t_hdata *ptr_hdata;
+    struct t_gui_buffer *ptr_buffer;
+    int version;
+
+    if (!buffer)
+    {
+        ptr_hdata = weechat_hdata_get ("buffer");
+        ptr_buffer = weechat_hdata_get_list (ptr_hdata, "gui_buffers");
+        while (ptr_buffer)
+        {
+            relay_weechat_nicklist_set_client_version (client, ptr_buffer);
+            ptr_buffer = weechat_hdata_move (ptr_hdata, ptr_buffer, 1);
+        }
+        return;
+    }
+
+    if (!relay_weechat_protocol_is_sync (client, buffer,
+                                         RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST))
+    {
+        weechat_hashtable_remove (RELAY_WEECHAT_DATA(client, buffers_nicklist),
+                                  buffer);
+        return;
+    }
+
+    if (relay_weechat_nicklist_pending
+        && weechat_hashtable_has_key (relay_weechat_nicklist_pending, buffer))
+    {
+        version = -1;
+    }
+    else
+        version = relay_weechat_nicklist_get_version (buffer);
+
+    weechat_hashtable_set (RELAY_WEECHAT_DATA(client, buffers_nicklist),
+                           buffer, &version);
+}
+
+/*
+ * Removes version of nicklist known by a client for a buffer if the client
+ * is not synchronized any more with flag "nicklist" for this buffer (callback
+ * called for each buffer in hashtable "buffers_nicklist" of client).
+ */
+
+void
+relay_weechat_nicklist_purge_client_map_cb (void *data,
+                                            struct t_hashtable *hashtable,
+                                            const void *key,
+                                            const void *value)
+{
+    /* make C compiler happy */
+    (void) value;
+
+    if (!relay_weechat_protocol_is_sync ((struct t_relay_client *)data,
+                                         (struct t_gui_buffer *)key,
+                                         RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST))
+    {
+        weechat_hashtable_remove (hashtable, key);
+    }
+}
+
+/*
+ * Removes versions of nicklist known by a client for buffers which are not
+ * synchronized any more with flag "nicklist" (called after commands "sync"
+ * and "desync"), so that the client receives the full nicklist on next
+ * change if it synchronizes the buffer again.
+ */
+
+void
+relay_weechat_nicklist_purge_client (struct t_relay_client *client)
+{
+    weechat_hashtable_map (RELAY_WEECHAT_DATA(client, buffers_nicklist),
+                           &relay_weechat_nicklist_purge_client_map_cb,
+                           client);
+}
+
+/*
+ * Hooks timer to send nicklist diffs to clients (if not already hooked).
+ *
+ * The timer is not delayed by new changes, so that changes are never kept
+ * more than the delay defined in option relay.weechat.nicklist_delay.
+ */
+
+void
+relay_weechat_nicklist_hook_timer_send ()
+{
+    if (relay_weechat_nicklist_hook_timer)
+        return;
+
+    relay_weechat_nicklist_hook_timer = weechat_hook_timer (
+        weechat_config_integer (relay_config_weechat_nicklist_delay), 0, 1,
+        &relay_weechat_protocol_timer_nicklist_cb, NULL);
+}
+
+/*
+ * Removes all nicklist data for a buffer (called when the buffer is closing).
+ */
+
+void
+relay_weechat_nicklist_remove_buffer (struct t_gui_buffer *buffer)
+{
+    struct t_relay_client *ptr_client;
+
+    if (relay_weechat_nicklist_pending)
+        weechat_hashtable_remove (relay_weechat_nicklist_pending, buffer);
+    if (relay_weechat_nicklist_versions)
+        weechat_hashtable_remove (relay_weechat_nicklist_versions, buffer);
+
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
+    {
+        if ((ptr_client->protocol == RELAY_PROTOCOL_WEECHAT)
+            && ptr_client->protocol_data)
+        {
+            weechat_hashtable_remove (RELAY_WEECHAT_DATA(ptr_client,
+                                                         buffers_nicklist),
+                                      buffer);
+        }
+    }
+}
+
+/*
+ * Callback for signal "buffer_closing".
+ */
+
+int
+relay_weechat_nicklist_signal_buffer_closing_cb (void *data,
+                                                 const char *signal,
+                                                 const char *type_data,
+                                                 void *signal_data)
+{
+    /* make C compiler happy */
+    (void) data;
+    (void) signal;
+    (void) type_data;
+
+    if (signal_data)
+        relay_weechat_nicklist_remove_buffer ((struct t_gui_buffer *)signal_data);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Frees a value of hashtable "relay_weechat_nicklist_pending".
+ */
+
+void
+relay_weechat_nicklist_free_pending (struct t_hashtable *hashtable,
+                                     const void *key, void *value)
+{
+    /* make C compiler happy */
+    (void) hashtable;
+    (void) key;
+
+    relay_weechat_nicklist_free ((struct t_relay_weechat_nicklist *)value);
+}
+
+/*
+ * Initializes nicklist diffs (shared by all clients).
+ */
+
+void
+relay_weechat_nicklist_init ()
+{
+    relay_weechat_nicklist_pending = weechat_hashtable_new (32,
+                                                            WEECHAT_HASHTABLE_POINTER,
+                                                            WEECHAT_HASHTABLE_POINTER,
+                                                            NULL,
+                                                            NULL);
+    if (relay_weechat_nicklist_pending)
+    {
+        weechat_hashtable_set_pointer (relay_weechat_nicklist_pending,
+                                       "callback_free_value",
+                                       &relay_weechat_nicklist_free_pending);
+    }
+    relay_weechat_nicklist_versions = weechat_hashtable_new (32,
+                                                             WEECHAT_HASHTABLE_POINTER,
+                                                             WEECHAT_HASHTABLE_INTEGER,
+                                                             NULL,
+                                                             NULL);
+
+    relay_weechat_nicklist_hook_hsignal = weechat_hook_hsignal (
+        "nicklist_*",
+        &relay_weechat_protocol_hsignal_nicklist_cb, NULL);
+    relay_weechat_nicklist_hook_signal = weechat_hook_signal (
+        "buffer_closing",
+        &relay_weechat_nicklist_signal_buffer_closing_cb, NULL);
+}
+
+/*
+ * Ends nicklist diffs (frees all data).
+ */
+
+void
+relay_weechat_nicklist_end ()
+{
+    if (relay_weechat_nicklist_hook_hsignal)
+    {
+        weechat_unhook (relay_weechat_nicklist_hook_hsignal);
+        relay_weechat_nicklist_hook_hsignal = NULL;
+    }
+    if (relay_weechat_nicklist_hook_signal)
+    {
+        weechat_unhook (relay_weechat_nicklist_hook_signal);
+        relay_weechat_nicklist_hook_signal = NULL;
+    }
+    if (relay_weechat_nicklist_hook_timer)
+    {
+        weechat_unhook (relay_weechat_nicklist_hook_timer);
+        relay_weechat_nicklist_hook_timer = NULL;
+    }
+    if (relay_weechat_nicklist_pending)
+    {
+        weechat_hashtable_free (relay_weechat_nicklist_pending);
+        relay_weechat_nicklist_pending = NULL;
+    }
+    if (relay_weechat_nicklist_versions)
+    {
+        weechat_hashtable_free (relay_weechat_nicklist_versions);
+        relay_weechat_nicklist_versions = NULL;
+    }
+}
@@ -20,6 +20,8 @@
 #ifndef WEECHAT_RELAY_WEECHAT_NICKLIST_H
 #define WEECHAT_RELAY_WEECHAT_NICKLIST_H 1
 
+struct t_relay_client;
+
 #define RELAY_WEECHAT_NICKLIST_DIFF_UNKNOWN ' '
 #define RELAY_WEECHAT_NICKLIST_DIFF_PARENT  '^'
 #define RELAY_WEECHAT_NICKLIST_DIFF_ADDED   '+'
@@ -47,11 +49,24 @@ struct t_relay_weechat_nicklist
     struct t_relay_weechat_nicklist_item *items; /* nicklist items          */
 };
 
+extern struct t_hashtable *relay_weechat_nicklist_pending;
+extern struct t_hashtable *relay_weechat_nicklist_versions;
+extern struct t_hook *relay_weechat_nicklist_hook_timer;
+
 extern struct t_relay_weechat_nicklist *relay_weechat_nicklist_new ();
 extern void relay_weechat_nicklist_add_item (struct t_relay_weechat_nicklist *nicklist,
                                              char diff,
                                              struct t_gui_nick_group *group,
                                              struct t_gui_nick *nick);
 extern void relay_weechat_nicklist_free (struct t_relay_weechat_nicklist *nicklist);
+extern int relay_weechat_nicklist_get_version (struct t_gui_buffer *buffer);
+extern int relay_weechat_nicklist_incr_version (struct t_gui_buffer *buffer);
+extern void relay_weechat_nicklist_set_client_version (struct t_relay_client *client,
+                                                       struct t_gui_buffer *buffer);
+extern void relay_weechat_nicklist_purge_client (struct t_relay_client *client);
+extern void relay_weechat_nicklist_hook_timer_send ();
+extern void relay_weechat_nicklist_remove_buffer (struct t_gui_buffer *buffer);
+extern void relay_weechat_nicklist_init ();
+extern void relay_weechat_nicklist_end ();
 
 #endif /* WEECHAT_RELAY_WEECHAT_NICKLIST_H */
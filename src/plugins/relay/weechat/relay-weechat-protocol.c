@@ -349,6 +349,7 @@ RELAY_WEECHAT_PROTOCOL_CALLBACK(nicklist)
         relay_weechat_msg_add_nicklist (msg, ptr_buffer, NULL);
         relay_weechat_msg_send (client, msg);
         relay_weechat_msg_free (msg);
+        relay_weechat_nicklist_set_client_version (client, ptr_buffer);
     }
 
     return WEECHAT_RC_OK;
@@ -490,7 +491,8 @@ relay_weechat_protocol_signal_buffer_cb (void *data, const char *signal,
                 relay_weechat_msg_add_hdata (msg, cmd_hdata,
                                              "number,full_name,short_name,"
                                              "nicklist,title,local_variables,"
-                                             "prev_buffer,next_buffer");
+                                             "prev_buffer,next_buffer,"
+                                             "line_id_epoch");
                 relay_weechat_msg_send (ptr_client, msg);
                 relay_weechat_msg_free (msg);
             }
@@ -717,7 +719,7 @@ relay_weechat_protocol_signal_buffer_cb (void *data, const char *signal,
                           "line_data:0x%lx",
                           (long unsigned int)ptr_line_data);
                 relay_weechat_msg_add_hdata (msg, cmd_hdata,
-                                             "buffer,date,date_printed,"
+                                             "buffer,id,date,date_printed,"
                                              "displayed,highlight,tags_array,"
                                              "prefix,message");
                 relay_weechat_msg_send (ptr_client, msg);
@@ -741,8 +743,6 @@ relay_weechat_protocol_signal_buffer_cb (void *data, const char *signal,
             {
                 snprintf (cmd_hdata, sizeof (cmd_hdata),
                           "buffer:0x%lx", (long unsigned int)ptr_buffer);
-                weechat_hashtable_remove (RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist),
-                                          ptr_buffer);
                 relay_weechat_msg_add_hdata (msg, cmd_hdata,
                                              "number,full_name");
                 relay_weechat_msg_send (ptr_client, msg);
@@ -755,57 +755,156 @@ relay_weechat_protocol_signal_buffer_cb (void *data, const char *signal,
 }
 
 /*
- * Callback for entries in hashtable "buffers_nicklist" of client (sends
- * nicklist for each buffer in this hashtable).
+ * Checks if at least one client is synchronized with flag "nicklist" for a
+ * buffer.
+ *
+ * Returns:
+ *   1: at least one client is synchronized with nicklist of buffer
+ *   0: no client is synchronized with nicklist of buffer
+ */
+
+int
+relay_weechat_protocol_nicklist_is_sync (struct t_gui_buffer *buffer)
+{
+    struct t_relay_client *ptr_client;
+
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
+    {
+        if ((ptr_client->protocol == RELAY_PROTOCOL_WEECHAT)
+            && ptr_client->protocol_data
+            && !RELAY_CLIENT_HAS_ENDED(ptr_client)
+            && relay_weechat_protocol_is_sync (ptr_client, buffer,
+                                               RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Sends nicklist diffs of a buffer to all clients synchronized with flag
+ * "nicklist" for this buffer.
+ *
+ * Messages are built only once and shared by all clients: the diffs are sent
+ * to clients which have received the previous version of nicklist, other
+ * clients (which are late or never received the nicklist) receive the full
+ * nicklist.
  */
 
 void
-relay_weechat_protocol_nicklist_map_cb (void *data,
-                                        struct t_hashtable *hashtable,
-                                        const void *key,
-                                        const void *value)
+relay_weechat_protocol_nicklist_send (struct t_gui_buffer *buffer,
+                                      struct t_relay_weechat_nicklist *nicklist)
 {
     struct t_relay_client *ptr_client;
-    struct t_gui_buffer *ptr_buffer;
-    struct t_relay_weechat_nicklist *ptr_nicklist;
     struct t_hdata *ptr_hdata;
-    struct t_relay_weechat_msg *msg;
+    struct t_relay_weechat_msg *msg_diff, *msg_full;
+    int old_version, new_version, *ptr_client_version;
 
-    /* make C compiler happy */
-    (void) hashtable;
+    ptr_hdata = weechat_hdata_get ("buffer");
+    if (!ptr_hdata
+        || !weechat_hdata_check_pointer (ptr_hdata,
+                                         weechat_hdata_get_list (ptr_hdata,
+                                                                 "gui_buffers"),
+                                         buffer))
+    {
+        return;
+    }
 
-    ptr_client = (struct t_relay_client *)data;
-    ptr_buffer = (struct t_gui_buffer *)key;
-    ptr_nicklist = (struct t_relay_weechat_nicklist *)value;
+    /*
+     * if no client is synchronized with nicklist of buffer, nothing is sent
+     * and the version is not changed (clients which synchronize the buffer
+     * later have no version for the buffer and receive the full nicklist)
+     */
+    if (!relay_weechat_protocol_nicklist_is_sync (buffer))
+        return;
 
-    ptr_hdata = weechat_hdata_get ("buffer");
-    if (ptr_hdata)
+    /*
+     * if no diff at all, if nicklist was empty before first diff, or if the
+     * diff is bigger than the nicklist: send whole nicklist
+     */
+    if (nicklist
+        && ((nicklist->items_count == 0)
+            || (nicklist->nicklist_count <= 1)
+            || (nicklist->items_count >= nicklist->nicklist_count + 1)))
     {
-        if (weechat_hdata_check_pointer (ptr_hdata,
-                                         weechat_hdata_get_list (ptr_hdata, "gui_buffers"),
-                                         ptr_buffer))
+        nicklist = NULL;
+    }
+
+    old_version = relay_weechat_nicklist_get_version (buffer);
+    new_version = relay_weechat_nicklist_incr_version (buffer);
+
+    msg_diff = NULL;
+    msg_full = NULL;
+
+    for (ptr_client = relay_clients; ptr_client;
+         ptr_client = ptr_client->next_client)
+    {
+        if ((ptr_client->protocol != RELAY_PROTOCOL_WEECHAT)
+            || !ptr_client->protocol_data
+            || RELAY_CLIENT_HAS_ENDED(ptr_client)
+            || !relay_weechat_protocol_is_sync (ptr_client, buffer,
+                                                RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST))
         {
-            /*
-             * if no diff at all, or if diffs are bigger than nicklist:
-             * send whole nicklist
-             */
-            if (ptr_nicklist
-                && ((ptr_nicklist->items_count == 0)
-                    || (ptr_nicklist->items_count >= weechat_buffer_get_integer (ptr_buffer, "nicklist_count") + 1)))
+            continue;
+        }
+
+        ptr_client_version = weechat_hashtable_get (RELAY_WEECHAT_DATA(ptr_client,
+                                                                       buffers_nicklist),
+                                                    buffer);
+        if (nicklist && ptr_client_version
+            && (*ptr_client_version == old_version))
+        {
+            if (!msg_diff)
             {
-                ptr_nicklist = NULL;
+                msg_diff = relay_weechat_msg_new ("_nicklist_diff");
+                if (msg_diff)
+                    relay_weechat_msg_add_nicklist (msg_diff, buffer, nicklist);
             }
-
-            /* send nicklist diffs or full nicklist */
-            msg = relay_weechat_msg_new ((ptr_nicklist) ? "_nicklist_diff" : "_nicklist");
-            if (msg)
+            if (msg_diff)
+                relay_weechat_msg_send (ptr_client, msg_diff);
+        }
+        else
+        {
+            if (!msg_full)
             {
-                relay_weechat_msg_add_nicklist (msg, ptr_buffer, ptr_nicklist);
-                relay_weechat_msg_send (ptr_client, msg);
-                relay_weechat_msg_free (msg);
+                msg_full = relay_weechat_msg_new ("_nicklist");
+                if (msg_full)
+                    relay_weechat_msg_add_nicklist (msg_full, buffer, NULL);
             }
+            if (msg_full)
+                relay_weechat_msg_send (ptr_client, msg_full);
         }
+
+        weechat_hashtable_set (RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist),
+                               buffer, &new_version);
     }
+
+    if (msg_diff)
+        relay_weechat_msg_free (msg_diff);
+    if (msg_full)
+        relay_weechat_msg_free (msg_full);
+}
+
+/*
+ * Callback for entries in hashtable "relay_weechat_nicklist_pending" (sends
+ * nicklist for each buffer in this hashtable).
+ */
+
+void
+relay_weechat_protocol_nicklist_map_cb (void *data,
+                                        struct t_hashtable *hashtable,
+                                        const void *key,
+                                        const void *value)
+{
+    /* make C compiler happy */
+    (void) data;
+    (void) hashtable;
+
+    relay_weechat_protocol_nicklist_send ((struct t_gui_buffer *)key,
+                                          (struct t_relay_weechat_nicklist *)value);
 }
 
 /*
@@ -815,51 +914,48 @@ relay_weechat_protocol_nicklist_map_cb (void *data,
 int
 relay_weechat_protocol_timer_nicklist_cb (void *data, int remaining_calls)
 {
-    struct t_relay_client *ptr_client;
-
     /* make C compiler happy */
+    (void) data;
     (void) remaining_calls;
 
-    ptr_client = (struct t_relay_client *)data;
-    if (!ptr_client || !relay_client_valid (ptr_client))
+    relay_weechat_nicklist_hook_timer = NULL;
+
+    if (!relay_weechat_nicklist_pending)
         return WEECHAT_RC_OK;
 
-    weechat_hashtable_map (RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist),
+    weechat_hashtable_map (relay_weechat_nicklist_pending,
                            &relay_weechat_protocol_nicklist_map_cb,
-                           ptr_client);
-
-    weechat_hashtable_remove_all (RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist));
+                           NULL);
 
-    RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist) = NULL;
+    weechat_hashtable_remove_all (relay_weechat_nicklist_pending);
 
     return WEECHAT_RC_OK;
 }
 
 /*
  * Callback for hsignals "nicklist_*".
+ *
+ * The nicklist diffs are stored once for all clients, and sent by a timer
+ * (or immediately if there are too many diffs for the buffer).
  */
 
 int
 relay_weechat_protocol_hsignal_nicklist_cb (void *data, const char *signal,
                                             struct t_hashtable *hashtable)
 {
-    struct t_relay_client *ptr_client;
     struct t_gui_nick_group *parent_group, *group;
     struct t_gui_nick *nick;
     struct t_gui_buffer *ptr_buffer;
     struct t_relay_weechat_nicklist *ptr_nicklist;
     char diff;
 
-    ptr_client = (struct t_relay_client *)data;
-    if (!ptr_client || !relay_client_valid (ptr_client))
-        return WEECHAT_RC_OK;
+    /* make C compiler happy */
+    (void) data;
 
-    /* check if buffer is synchronized with flag "nicklist" */
-    ptr_buffer = weechat_hashtable_get (hashtable, "buffer");
-    if (!relay_weechat_protocol_is_sync (ptr_client, ptr_buffer,
-                                         RELAY_WEECHAT_PROTOCOL_SYNC_NICKLIST))
+    if (!relay_weechat_nicklist_pending)
         return WEECHAT_RC_OK;
 
+    ptr_buffer = weechat_hashtable_get (hashtable, "buffer");
     parent_group = weechat_hashtable_get (hashtable, "parent_group");
     group = weechat_hashtable_get (hashtable, "group");
     nick = weechat_hashtable_get (hashtable, "nick");
@@ -868,8 +964,18 @@ relay_weechat_protocol_hsignal_nicklist_cb (void *data, const char *signal,
     if (!parent_group)
         return WEECHAT_RC_OK;
 
-    ptr_nicklist = weechat_hashtable_get (RELAY_WEECHAT_DATA(ptr_client,
-                                                             buffers_nicklist),
+    /*
+     * if no client is synchronized with flag "nicklist" for this buffer,
+     * ignore the change (clients have no version for this buffer, so they
+     * will receive the full nicklist on next change after sync)
+     */
+    if (!relay_weechat_protocol_nicklist_is_sync (ptr_buffer))
+    {
+        weechat_hashtable_remove (relay_weechat_nicklist_pending, ptr_buffer);
+        return WEECHAT_RC_OK;
+    }
+
+    ptr_nicklist = weechat_hashtable_get (relay_weechat_nicklist_pending,
                                           ptr_buffer);
     if (!ptr_nicklist)
     {
@@ -878,7 +984,7 @@ relay_weechat_protocol_hsignal_nicklist_cb (void *data, const char *signal,
             return WEECHAT_RC_OK;
         ptr_nicklist->nicklist_count = weechat_buffer_get_integer (ptr_buffer,
                                                                    "nicklist_count");
-        weechat_hashtable_set (RELAY_WEECHAT_DATA(ptr_client, buffers_nicklist),
+        weechat_hashtable_set (relay_weechat_nicklist_pending,
                                ptr_buffer,
                                ptr_nicklist);
     }
@@ -916,13 +1022,18 @@ relay_weechat_protocol_hsignal_nicklist_cb (void *data, const char *signal,
             relay_weechat_nicklist_add_item (ptr_nicklist, diff, group, nick);
         }
 
-        /* add timer to send nicklist */
-        if (RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist))
+        if (ptr_nicklist->items_count >= weechat_config_integer (relay_config_weechat_nicklist_diff_max))
+        {
+            /* too many diffs: send them now (the window is bounded) */
+            relay_weechat_protocol_nicklist_send (ptr_buffer, ptr_nicklist);
+            weechat_hashtable_remove (relay_weechat_nicklist_pending,
+                                      ptr_buffer);
+        }
+        else
         {
-            weechat_unhook (RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist));
-            RELAY_WEECHAT_DATA(ptr_client, hook_timer_nicklist) = NULL;
+            /* add timer to send nicklist */
+            relay_weechat_nicklist_hook_timer_send ();
         }
-        relay_weechat_hook_timer_nicklist (ptr_client);
     }
 
     return WEECHAT_RC_OK;
@@ -1047,6 +1158,8 @@ RELAY_WEECHAT_PROTOCOL_CALLBACK(sync)
         weechat_string_free_split (buffers);
     }
 
+    relay_weechat_nicklist_purge_client (client);
+
     return WEECHAT_RC_OK;
 }
 
@@ -1132,6 +1245,158 @@ RELAY_WEECHAT_PROTOCOL_CALLBACK(desync)
         weechat_string_free_split (buffers);
     }
 
+    relay_weechat_nicklist_purge_client (client);
+
+    return WEECHAT_RC_OK;
+}
+
+/*
+ * Searches first line of a buffer with an id greater than "line_id".
+ *
+ * If "epoch" is NULL or different from epoch of line ids in buffer (buffer
+ * created again or restart of WeeChat: ids started again at 0), or if
+ * "line_id" is greater or equal to id of next line in buffer, all lines are
+ * returned.
+ *
+ * Returns pointer to first line found, NULL if there is no line newer than
+ * "line_id"; argument "count" is set with number of lines found.
+ */
+
+struct t_gui_line *
+relay_weechat_protocol_search_line_after_id (struct t_gui_buffer *buffer,
+                                             const char *epoch,
+                                             int line_id, int *count)
+{
+    struct t_hdata *ptr_hdata_lines, *ptr_hdata_line, *ptr_hdata_line_data;
+    struct t_gui_line *ptr_line, *ptr_first_line;
+    struct t_gui_line_data *ptr_line_data;
+    const char *ptr_epoch;
+
+    *count = 0;
+
+    ptr_hdata_lines = weechat_hdata_get ("lines");
+    ptr_hdata_line = weechat_hdata_get ("line");
+    ptr_hdata_line_data = weechat_hdata_get ("line_data");
+    if (!ptr_hdata_lines || !ptr_hdata_line || !ptr_hdata_line_data)
+        return NULL;
+
+    ptr_epoch = weechat_buffer_get_string (buffer, "line_id_epoch");
+    if (!epoch || !ptr_epoch || (strcmp (epoch, ptr_epoch) != 0)
+        || (line_id >= weechat_buffer_get_integer (buffer, "next_line_id")))
+    {
+        line_id = -1;
+    }
+
+    ptr_first_line = NULL;
+    ptr_line = weechat_hdata_pointer (
+        ptr_hdata_lines,
+        weechat_hdata_pointer (weechat_hdata_get ("buffer"), buffer,
+                               "own_lines"),
+        "last_line");
+    while (ptr_line)
+    {
+        ptr_line_data = weechat_hdata_pointer (ptr_hdata_line, ptr_line,
+                                               "data");
+        if (!ptr_line_data
+            || (weechat_hdata_integer (ptr_hdata_line_data, ptr_line_data,
+                                       "id") <= line_id))
+        {
+            break;
+        }
+        ptr_first_line = ptr_line;
+        (*count)++;
+        ptr_line = weechat_hdata_move (ptr_hdata_line, ptr_line, -1);
+    }
+
+    return ptr_first_line;
+}
+
+/*
+ * Callback for command "resume" (from client).
+ *
+ * Message looks like:
+ *   resume irc.freenode.#weechat:1413673200.123456:1234
+ *   resume irc.freenode.#weechat:1413673200.123456:1234,0x12345678:1413673201.654321:42
+ *   resume core.weechat:1413673200.000001:10 date,prefix,message
+ *   resume core.weechat::10
+ *
+ * The epoch can be empty (then all lines are sent), but the two separators
+ * are mandatory: the buffer name can contain ':', so the line id and epoch
+ * are always the last two fields.
+ */
+
+RELAY_WEECHAT_PROTOCOL_CALLBACK(resume)
+{
+    struct t_relay_weechat_msg *msg;
+    struct t_gui_buffer *ptr_buffer;
+    struct t_gui_line *ptr_line;
+    char **buffers, *pos, *pos_epoch, *error, cmd_hdata[128];
+    const char *keys;
+    int num_buffers, i, count;
+    long line_id;
+
+    RELAY_WEECHAT_PROTOCOL_MIN_ARGS(1);
+
+    keys = (argc > 1) ?
+        argv[1] :
+        "buffer,id,date,date_printed,displayed,highlight,tags_array,"
+        "prefix,message";
+
+    buffers = weechat_string_split (argv[0], ",", 0, 0, &num_buffers);
+    if (!buffers)
+        return WEECHAT_RC_OK;
+
+    msg = relay_weechat_msg_new (id);
+    if (msg)
+    {
+        for (i = 0; i < num_buffers; i++)
+        {
+            ptr_buffer = NULL;
+            pos_epoch = NULL;
+            error = NULL;
+            line_id = 0;
+            pos = strrchr (buffers[i], ':');
+            if (pos)
+            {
+                pos[0] = '\0';
+                line_id = strtol (pos + 1, &error, 10);
+                pos_epoch = strrchr (buffers[i], ':');
+            }
+            if (pos_epoch)
+            {
+                pos_epoch[0] = '\0';
+                pos_epoch++;
+                ptr_buffer = relay_weechat_protocol_get_buffer (buffers[i]);
+            }
+            if (!ptr_buffer || !error || error[0])
+            {
+                if (weechat_relay_plugin->debug >= 1)
+                {
+                    weechat_printf (NULL,
+                                    _("%s: invalid buffer or line id in "
+                                      "message: \"%s %s\""),
+                                    RELAY_PLUGIN_NAME,
+                                    command,
+                                    argv_eol[0]);
+                }
+                continue;
+            }
+            ptr_line = relay_weechat_protocol_search_line_after_id (
+                ptr_buffer, pos_epoch, (int)line_id, &count);
+            if (ptr_line && (count > 0))
+            {
+                snprintf (cmd_hdata, sizeof (cmd_hdata),
+                          "line:0x%lx(%d)/data",
+                          (long unsigned int)ptr_line, count);
+                relay_weechat_msg_add_hdata (msg, cmd_hdata, keys);
+            }
+        }
+        relay_weechat_msg_send (client, msg);
+        relay_weechat_msg_free (msg);
+    }
+
+    weechat_string_free_split (buffers);
+
     return WEECHAT_RC_OK;
 }
 
@@ -1288,6 +1553,7 @@ relay_weechat_protocol_recv (struct t_relay_client *client, const char *data)
           { "input", &relay_weechat_protocol_cb_input },
           { "sync", &relay_weechat_protocol_cb_sync },
           { "desync", &relay_weechat_protocol_cb_desync },
+          { "resume", &relay_weechat_protocol_cb_resume },
           { "test", &relay_weechat_protocol_cb_test },
           { "ping", &relay_weechat_protocol_cb_ping },
           { "quit", &relay_weechat_protocol_cb_quit },
@@ -81,6 +81,9 @@ struct t_relay_weechat_protocol_cb
     t_relay_weechat_cmd_func *cmd_function; /* callback                     */
 };
 
+extern int relay_weechat_protocol_is_sync (struct t_relay_client *ptr_client,
+                                           struct t_gui_buffer *buffer,
+                                           int flags);
 extern int relay_weechat_protocol_signal_buffer_cb (void *data,
                                                     const char *signal,
                                                     const char *type_data,
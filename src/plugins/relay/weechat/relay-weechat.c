@@ -33,6 +33,7 @@
 #include "../../weechat-plugin.h"
 #include "../relay.h"
 #include "relay-weechat.h"
+#include "relay-weechat-msg.h"
 #include "relay-weechat-nicklist.h"
 #include "relay-weechat-protocol.h"
 #include "../relay-client.h"
@@ -77,10 +78,6 @@ relay_weechat_hook_signals (struct t_relay_client *client)
         weechat_hook_signal ("buffer_*",
                              &relay_weechat_protocol_signal_buffer_cb,
                              client);
-    RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) =
-        weechat_hook_hsignal ("nicklist_*",
-                              &relay_weechat_protocol_hsignal_nicklist_cb,
-                              client);
     RELAY_WEECHAT_DATA(client, hook_signal_upgrade) =
         weechat_hook_signal ("upgrade*",
                              &relay_weechat_protocol_signal_upgrade_cb,
@@ -99,11 +96,6 @@ relay_weechat_unhook_signals (struct t_relay_client *client)
         weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_buffer));
         RELAY_WEECHAT_DATA(client, hook_signal_buffer) = NULL;
     }
-    if (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist))
-    {
-        weechat_unhook (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist));
-        RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) = NULL;
-    }
     if (RELAY_WEECHAT_DATA(client, hook_signal_upgrade))
     {
         weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_upgrade));
@@ -111,19 +103,6 @@ relay_weechat_unhook_signals (struct t_relay_client *client)
     }
 }
 
-/*
- * Hooks timer to update nicklist.
- */
-
-void
-relay_weechat_hook_timer_nicklist (struct t_relay_client *client)
-{
-    RELAY_WEECHAT_DATA(client, hook_timer_nicklist) =
-        weechat_hook_timer (100, 0, 1,
-                            &relay_weechat_protocol_timer_nicklist_cb,
-                            client);
-}
-
 /*
  * Reads data from a client.
  */
@@ -135,28 +114,34 @@ relay_weechat_recv (struct t_relay_client *client, const char *data)
 }
 
 /*
- * Closes connection with a client.
+ * Asks client to resync (some lines were dropped because client was too slow
+ * to read data).
+ *
+ * Message "_resync" is sent to client, without any object: the client should
+ * then use command "resume" to get missing lines.
  */
 
 void
-relay_weechat_close_connection (struct t_relay_client *client)
+relay_weechat_resync (struct t_relay_client *client)
 {
-    relay_weechat_unhook_signals (client);
+    struct t_relay_weechat_msg *msg;
+
+    msg = relay_weechat_msg_new ("_resync");
+    if (msg)
+    {
+        relay_weechat_msg_send (client, msg);
+        relay_weechat_msg_free (msg);
+    }
 }
 
 /*
- * Frees a value of hashtable "buffers_nicklist".
+ * Closes connection with a client.
  */
 
 void
-relay_weechat_free_buffers_nicklist (struct t_hashtable *hashtable,
-                                     const void *key, void *value)
+relay_weechat_close_connection (struct t_relay_client *client)
 {
-    /* make C compiler happy */
-    (void) hashtable;
-    (void) key;
-
-    relay_weechat_nicklist_free ((struct t_relay_weechat_nicklist *)value);
+    relay_weechat_unhook_signals (client);
 }
 
 /*
@@ -184,18 +169,13 @@ relay_weechat_alloc (struct t_relay_client *client)
                                    NULL,
                                    NULL);
         RELAY_WEECHAT_DATA(client, hook_signal_buffer) = NULL;
-        RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) = NULL;
         RELAY_WEECHAT_DATA(client, hook_signal_upgrade) = NULL;
         RELAY_WEECHAT_DATA(client, buffers_nicklist) =
             weechat_hashtable_new (32,
                                    WEECHAT_HASHTABLE_POINTER,
-                                   WEECHAT_HASHTABLE_POINTER,
+                                   WEECHAT_HASHTABLE_INTEGER,
                                    NULL,
                                    NULL);
-        weechat_hashtable_set_pointer (RELAY_WEECHAT_DATA(client, buffers_nicklist),
-                                       "callback_free_value",
-                                       &relay_weechat_free_buffers_nicklist);
-        RELAY_WEECHAT_DATA(client, hook_timer_nicklist) = NULL;
 
         relay_weechat_hook_signals (client);
     }
@@ -247,23 +227,17 @@ relay_weechat_alloc_with_infolist (struct t_relay_client *client,
             index++;
         }
         RELAY_WEECHAT_DATA(client, hook_signal_buffer) = NULL;
-        RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) = NULL;
         RELAY_WEECHAT_DATA(client, hook_signal_upgrade) = NULL;
         RELAY_WEECHAT_DATA(client, buffers_nicklist) =
             weechat_hashtable_new (32,
                                    WEECHAT_HASHTABLE_POINTER,
-                                   WEECHAT_HASHTABLE_POINTER,
+                                   WEECHAT_HASHTABLE_INTEGER,
                                    NULL,
                                    NULL);
-        weechat_hashtable_set_pointer (RELAY_WEECHAT_DATA(client, buffers_nicklist),
-                                       "callback_free_value",
-                                       &relay_weechat_free_buffers_nicklist);
-        RELAY_WEECHAT_DATA(client, hook_timer_nicklist) = NULL;
 
         if (RELAY_CLIENT_HAS_ENDED(client))
         {
             RELAY_WEECHAT_DATA(client, hook_signal_buffer) = NULL;
-            RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist) = NULL;
             RELAY_WEECHAT_DATA(client, hook_signal_upgrade) = NULL;
         }
         else
@@ -284,8 +258,6 @@ relay_weechat_free (struct t_relay_client *client)
             weechat_hashtable_free (RELAY_WEECHAT_DATA(client, buffers_sync));
         if (RELAY_WEECHAT_DATA(client, hook_signal_buffer))
             weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_buffer));
-        if (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist))
-            weechat_unhook (RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist));
         if (RELAY_WEECHAT_DATA(client, hook_signal_upgrade))
             weechat_unhook (RELAY_WEECHAT_DATA(client, hook_signal_upgrade));
         if (RELAY_WEECHAT_DATA(client, buffers_nicklist))
@@ -338,12 +310,30 @@ relay_weechat_print_log (struct t_relay_client *client)
                             weechat_hashtable_get_string (RELAY_WEECHAT_DATA(client, buffers_sync),
                                                           "keys_values"));
         weechat_log_printf ("    hook_signal_buffer . . : 0x%lx", RELAY_WEECHAT_DATA(client, hook_signal_buffer));
-        weechat_log_printf ("    hook_hsignal_nicklist. : 0x%lx", RELAY_WEECHAT_DATA(client, hook_hsignal_nicklist));
         weechat_log_printf ("    hook_signal_upgrade. . : 0x%lx", RELAY_WEECHAT_DATA(client, hook_signal_upgrade));
         weechat_log_printf ("    buffers_nicklist . . . : 0x%lx (hashtable: '%s')",
                             RELAY_WEECHAT_DATA(client, buffers_nicklist),
                             weechat_hashtable_get_string (RELAY_WEECHAT_DATA(client, buffers_nicklist),
                                                           "keys_values"));
-        weechat_log_printf ("    hook_timer_nicklist. . : 0x%lx", RELAY_WEECHAT_DATA(client, hook_timer_nicklist));
     }
 }
+
+/*
+ * Initializes WeeChat protocol (data shared by all clients).
+ */
+
+void
+relay_weechat_init ()
+{
+    relay_weechat_nicklist_init ();
+}
+
+/*
+ * Ends WeeChat protocol (frees data shared by all clients).
+ */
+
+void
+relay_weechat_end ()
+{
+    relay_weechat_nicklist_end ();
+}
@@ -42,18 +42,17 @@ struct t_relay_weechat_data
     struct t_hashtable *buffers_sync;  /* buffers synchronized (events      */
                                        /* received for these buffers)       */
     struct t_hook *hook_signal_buffer;    /* hook for signals "buffer_*"    */
-    struct t_hook *hook_hsignal_nicklist; /* hook for hsignals "nicklist_*" */
     struct t_hook *hook_signal_upgrade;   /* hook for signals "upgrade*"    */
-    struct t_hashtable *buffers_nicklist; /* send nicklist for these buffers*/
-    struct t_hook *hook_timer_nicklist;   /* timer for sending nicklist     */
+    struct t_hashtable *buffers_nicklist; /* version of nicklist received   */
+                                          /* by client for each buffer      */
 };
 
 extern int relay_weechat_compression_search (const char *compression);
 extern void relay_weechat_hook_signals (struct t_relay_client *client);
 extern void relay_weechat_unhook_signals (struct t_relay_client *client);
-extern void relay_weechat_hook_timer_nicklist (struct t_relay_client *client);
 extern void relay_weechat_recv (struct t_relay_client *client,
                                 const char *data);
+extern void relay_weechat_resync (struct t_relay_client *client);
 extern void relay_weechat_close_connection (struct t_relay_client *client);
 extern void relay_weechat_alloc (struct t_relay_client *client);
 extern void relay_weechat_alloc_with_infolist (struct t_relay_client *client,
@@ -62,5 +61,7 @@ extern void relay_weechat_free (struct t_relay_client *client);
 extern int relay_weechat_add_to_infolist (struct t_infolist_item *item,
                                           struct t_relay_client *client);
 extern void relay_weechat_print_log (struct t_relay_client *client);
+extern void relay_weechat_init ();
+extern void relay_weechat_end ();
 
 #endif /* WEECHAT_RELAY_WEECHAT_H */
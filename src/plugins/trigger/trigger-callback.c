@@ -33,6 +33,133 @@
 /* one hashtable by hook, used in callback to evaluate "conditions" */
 struct t_hashtable *trigger_callback_hashtable_options = NULL;
 
+/* hashtables "pointers" and "extra_vars" reused by callbacks */
+struct t_trigger_callback_pool trigger_callback_pool_pointers[TRIGGER_CALLBACK_POOL_SIZE];
+struct t_trigger_callback_pool trigger_callback_pool_extra_vars[TRIGGER_CALLBACK_POOL_SIZE];
+
+
+/*
+ * Gets a free hashtable in a pool (the hashtable is created if there is no
+ * free hashtable in pool).
+ *
+ * If the pool is full (too many callbacks running at same time), a new
+ * hashtable is created, and it will be freed by trigger_callback_pool_release.
+ *
+ * Returns pointer to hashtable, NULL if error.
+ */
+
+struct t_hashtable *
+trigger_callback_pool_get (struct t_trigger_callback_pool *pool,
+                           const char *type_values)
+{
+    int i, index_free;
+
+    index_free = -1;
+    for (i = 0; i < TRIGGER_CALLBACK_POOL_SIZE; i++)
+    {
+        if (pool[i].hashtable)
+        {
+            if (!pool[i].used)
+            {
+                pool[i].used = 1;
+                return pool[i].hashtable;
+            }
+        }
+        else if (index_free < 0)
+        {
+            index_free = i;
+        }
+    }
+
+    if (index_free >= 0)
+    {
+        pool[index_free].hashtable = weechat_hashtable_new (
+            32,
+            WEECHAT_HASHTABLE_STRING,
+            type_values,
+            NULL,
+            NULL);
+        if (!pool[index_free].hashtable)
+            return NULL;
+        pool[index_free].used = 1;
+        return pool[index_free].hashtable;
+    }
+
+    return weechat_hashtable_new (32,
+                                  WEECHAT_HASHTABLE_STRING,
+                                  type_values,
+                                  NULL,
+                                  NULL);
+}
+
+/*
+ * Releases a hashtable used by a callback: if the hashtable is in a pool, it
+ * is emptied and can be reused, otherwise it is freed.
+ */
+
+void
+trigger_callback_pool_release (struct t_hashtable *hashtable)
+{
+    int i;
+
+    for (i = 0; i < TRIGGER_CALLBACK_POOL_SIZE; i++)
+    {
+        if (trigger_callback_pool_pointers[i].hashtable == hashtable)
+        {
+            weechat_hashtable_remove_all (hashtable);
+            trigger_callback_pool_pointers[i].used = 0;
+            return;
+        }
+        if (trigger_callback_pool_extra_vars[i].hashtable == hashtable)
+        {
+            weechat_hashtable_remove_all (hashtable);
+            trigger_callback_pool_extra_vars[i].used = 0;
+            return;
+        }
+    }
+
+    weechat_hashtable_free (hashtable);
+}
+
+/*
+ * Checks if full name of buffer matches the buffer masks of a print trigger
+ * (masks are split when the trigger is hooked), where exclusion is possible
+ * with char '!'.
+ *
+ * Returns:
+ *   1: buffer matches masks
+ *   0: buffer does not match masks
+ */
+
+int
+trigger_callback_buffer_match (struct t_trigger *trigger,
+                               struct t_gui_buffer *buffer)
+{
+    const char *full_name, *ptr_mask;
+    int i, match;
+
+    full_name = weechat_buffer_get_string (buffer, "full_name");
+    if (!full_name)
+        return 0;
+
+    match = 0;
+
+    for (i = 0; i < trigger->hook_print_buffers_count; i++)
+    {
+        ptr_mask = trigger->hook_print_buffers[i];
+        if (ptr_mask[0] == '!')
+            ptr_mask++;
+        if (weechat_string_match (full_name, ptr_mask, 0))
+        {
+            if (trigger->hook_print_buffers[i][0] == '!')
+                return 0;
+            match = 1;
+        }
+    }
+
+    return match;
+}
+
 
 /*
  * Parses an IRC message.
@@ -66,9 +193,60 @@ trigger_callback_irc_message_parse (const char *irc_message,
 
     return hashtable_out;
 }
+
+/*
+ * Returns the variables used in conditions of a trigger, if conditions can be
+ * checked before the other variables are set (variables used only in regex
+ * or command are then set only if conditions are true).
+ *
+ * Returns NULL if all variables must be set before checking conditions
+ * (variables used are unknown or trigger is displayed on monitor buffer).
+ */
+
+struct t_hashtable *
+trigger_callback_vars_conditions (struct t_trigger *trigger)
+{
+    if (!trigger->vars_conditions || !trigger->vars_used)
+        return NULL;
+
+    /* all variables are displayed on monitor buffer */
+    if (trigger_buffer || (weechat_trigger_plugin->debug >= 1))
+        return NULL;
+
+    return trigger->vars_conditions;
+}
+
+/*
+ * Checks if a variable must be set in hashtable "extra_vars".
+ *
+ * The variable is set if it is in hashtable "vars" (or if "vars" is NULL),
+ * and not in hashtable "vars_skip" (variables already set).
+ *
+ * Returns:
+ *   1: variable must be set
+ *   0: variable is not used (or already set)
+ */
+
+int
+trigger_callback_var_needed (struct t_hashtable *vars,
+                             struct t_hashtable *vars_skip,
+                             const char *name)
+{
+    if (vars && !weechat_hashtable_has_key (vars, name))
+        return 0;
+
+    if (vars_skip && weechat_hashtable_has_key (vars_skip, name))
+        return 0;
+
+    return 1;
+}
+
 /*
  * Sets variables in "extra_vars" hashtable using tags from message.
  *
+ * Only variables in hashtable "vars" and not in "vars_skip" are set (see
+ * function trigger_callback_var_needed).
+ *
  * Returns:
  *   0: tag "no_trigger" was in tags, callback must NOT be executed
  *   1: no tag "no_trigger", callback can be executed
@@ -77,16 +255,20 @@ trigger_callback_irc_message_parse (const char *irc_message,
 int
 trigger_callback_set_tags (struct t_gui_buffer *buffer,
                            const char **tags, int tags_count,
+                           struct t_hashtable *vars,
+                           struct t_hashtable *vars_skip,
                            struct t_hashtable *extra_vars)
 {
     const char *localvar_type;
     char str_temp[128];
     int i;
 
-    snprintf (str_temp, sizeof (str_temp), "%d", tags_count);
-    weechat_hashtable_set (extra_vars, "tg_tags_count", str_temp);
-    localvar_type = (buffer) ?
-        weechat_buffer_get_string (buffer, "localvar_type") : NULL;
+    if (trigger_callback_var_needed (vars, vars_skip, "tg_tags_count"))
+    {
+        snprintf (str_temp, sizeof (str_temp), "%d", tags_count);
+        weechat_hashtable_set (extra_vars, "tg_tags_count", str_temp);
+    }
+    localvar_type = NULL;
 
     for (i = 0; i < tags_count; i++)
     {
@@ -96,12 +278,29 @@ trigger_callback_set_tags (struct t_gui_buffer *buffer,
         }
         else if (strncmp (tags[i], "notify_", 7) == 0)
         {
-            weechat_hashtable_set (extra_vars, "tg_tag_notify", tags[i] + 7);
+            if (trigger_callback_var_needed (vars, vars_skip,
+                                             "tg_tag_notify"))
+            {
+                weechat_hashtable_set (extra_vars, "tg_tag_notify",
+                                       tags[i] + 7);
+            }
             if (strcmp (tags[i] + 7, "none") != 0)
             {
-                weechat_hashtable_set (extra_vars, "tg_notify", tags[i] + 7);
-                if (strcmp (tags[i] + 7, "private") == 0)
+                if (trigger_callback_var_needed (vars, vars_skip,
+                                                 "tg_notify"))
                 {
+                    weechat_hashtable_set (extra_vars, "tg_notify",
+                                           tags[i] + 7);
+                }
+                if ((strcmp (tags[i] + 7, "private") == 0)
+                    && trigger_callback_var_needed (vars, vars_skip,
+                                                    "tg_msg_pv"))
+                {
+                    if (!localvar_type && buffer)
+                    {
+                        localvar_type = weechat_buffer_get_string (
+                            buffer, "localvar_type");
+                    }
                     snprintf (str_temp, sizeof (str_temp), "%d",
                               (localvar_type
                                && (strcmp (localvar_type, "private") == 0)) ? 1 : 0);
@@ -111,16 +310,28 @@ trigger_callback_set_tags (struct t_gui_buffer *buffer,
         }
         else if (strncmp (tags[i], "nick_", 5) == 0)
         {
-            weechat_hashtable_set (extra_vars, "tg_tag_nick", tags[i] + 5);
+            if (trigger_callback_var_needed (vars, vars_skip, "tg_tag_nick"))
+            {
+                weechat_hashtable_set (extra_vars, "tg_tag_nick",
+                                       tags[i] + 5);
+            }
         }
         else if (strncmp (tags[i], "prefix_nick_", 12) == 0)
         {
-            weechat_hashtable_set (extra_vars, "tg_tag_prefix_nick",
-                                   tags[i] + 12);
+            if (trigger_callback_var_needed (vars, vars_skip,
+                                             "tg_tag_prefix_nick"))
+            {
+                weechat_hashtable_set (extra_vars, "tg_tag_prefix_nick",
+                                       tags[i] + 12);
+            }
         }
         else if (strncmp (tags[i], "host_", 5) == 0)
         {
-            weechat_hashtable_set (extra_vars, "tg_tag_host", tags[i] + 5);
+            if (trigger_callback_var_needed (vars, vars_skip, "tg_tag_host"))
+            {
+                weechat_hashtable_set (extra_vars, "tg_tag_host",
+                                       tags[i] + 5);
+            }
         }
     }
 
@@ -148,10 +359,15 @@ trigger_callback_check_conditions (struct t_trigger *trigger,
     if (!conditions || !conditions[0])
         return 1;
 
-    value = weechat_string_eval_expression (conditions,
-                                            pointers,
-                                            extra_vars,
-                                            trigger_callback_hashtable_options);
+    if (!trigger->conditions_eval)
+    {
+        trigger_compile_conditions (conditions, &trigger->conditions_eval);
+        if (!trigger->conditions_eval)
+            return 0;
+    }
+
+    value = weechat_string_eval_exec (trigger->conditions_eval,
+                                      pointers, extra_vars);
     rc = (value && (strcmp (value, "1") == 0));
     if (value)
         free (value);
@@ -341,6 +557,33 @@ trigger_callback_execute (struct t_trigger *trigger,
     }
 }
 
+/*
+ * Checks if the IRC message received in a signal must be parsed: it is
+ * parsed if some variables other than "tg_signal" and "tg_signal_data" are
+ * used (or if "vars" is NULL: variables used are unknown).
+ *
+ * Returns:
+ *   1: IRC message must be parsed
+ *   0: IRC message does not need to be parsed
+ */
+
+int
+trigger_callback_signal_irc_vars_needed (struct t_hashtable *vars)
+{
+    int count;
+
+    if (!vars)
+        return 1;
+
+    count = weechat_hashtable_get_integer (vars, "items_count");
+    if (weechat_hashtable_has_key (vars, "tg_signal"))
+        count--;
+    if (weechat_hashtable_has_key (vars, "tg_signal_data"))
+        count--;
+
+    return (count > 0) ? 1 : 0;
+}
+
 /*
  * Callback for a signal hooked.
  */
@@ -349,12 +592,15 @@ int
 trigger_callback_signal_cb (void *data, const char *signal,
                             const char *type_data, void *signal_data)
 {
+    struct t_hashtable *vars_conditions, *irc_vars;
     const char *ptr_signal_data;
     char str_data[128], *irc_server;
     const char *pos, *ptr_irc_message;
 
     TRIGGER_CALLBACK_CB_INIT(WEECHAT_RC_OK);
 
+    vars_conditions = trigger_callback_vars_conditions (trigger);
+
     /* split IRC message (if signal_data is an IRC message) */
     irc_server = NULL;
     ptr_irc_message = NULL;
@@ -386,15 +632,15 @@ trigger_callback_signal_cb (void *data, const char *signal,
             }
         }
     }
-    if (irc_server && ptr_irc_message)
+    if (irc_server && ptr_irc_message
+        && trigger_callback_signal_irc_vars_needed (vars_conditions))
     {
         extra_vars = trigger_callback_irc_message_parse (ptr_irc_message,
                                                          irc_server);
         if (extra_vars)
             weechat_hashtable_set (extra_vars, "server", irc_server);
+        ptr_irc_message = NULL;
     }
-    if (irc_server)
-        free (irc_server);
 
     /* create hashtable (if not already created) */
     if (!extra_vars)
@@ -431,10 +677,39 @@ trigger_callback_signal_cb (void *data, const char *signal,
     }
     weechat_hashtable_set (extra_vars, "tg_signal_data", ptr_signal_data);
 
-    /* execute the trigger (conditions, regex, command) */
-    trigger_callback_execute (trigger, NULL, pointers, extra_vars);
+    if (vars_conditions)
+    {
+        if (!trigger_callback_check_conditions (trigger, pointers, extra_vars))
+            goto end;
+        /* IRC message is parsed only if conditions are true */
+        if (irc_server && ptr_irc_message
+            && trigger_callback_signal_irc_vars_needed (trigger->vars_used))
+        {
+            irc_vars = trigger_callback_irc_message_parse (ptr_irc_message,
+                                                           irc_server);
+            if (irc_vars)
+            {
+                weechat_hashtable_set (irc_vars, "server", irc_server);
+                weechat_hashtable_set (irc_vars, "tg_signal", signal);
+                weechat_hashtable_set (irc_vars, "tg_signal_data",
+                                       ptr_signal_data);
+                trigger_callback_pool_release (extra_vars);
+                extra_vars = irc_vars;
+            }
+        }
+        trigger_callback_replace_regex (trigger, pointers, extra_vars, 0);
+        trigger_callback_run_command (trigger, NULL, pointers, extra_vars, 0);
+    }
+    else
+    {
+        /* execute the trigger (conditions, regex, command) */
+        trigger_callback_execute (trigger, NULL, pointers, extra_vars);
+    }
 
 end:
+    if (irc_server)
+        free (irc_server);
+
     TRIGGER_CALLBACK_CB_END(trigger_rc);
 }
 
@@ -644,7 +919,7 @@ trigger_callback_modifier_cb (void *data, const char *modifier,
     if (tags)
     {
         if (!trigger_callback_set_tags (buffer, (const char **)tags, num_tags,
-                                        extra_vars))
+                                        NULL, NULL, extra_vars))
         {
             goto end;
         }
@@ -666,6 +941,96 @@ end:
     TRIGGER_CALLBACK_CB_END(string_modified);
 }
 
+/*
+ * Sets variables in "extra_vars" hashtable for a print hooked.
+ *
+ * Only variables in hashtable "vars" and not in "vars_skip" are set (see
+ * function trigger_callback_var_needed).
+ *
+ * Returns:
+ *   0: tag "no_trigger" was in tags, callback must NOT be executed
+ *   1: no tag "no_trigger", callback can be executed
+ */
+
+int
+trigger_callback_print_set_vars (struct t_hashtable *vars,
+                                 struct t_hashtable *vars_skip,
+                                 struct t_hashtable *extra_vars,
+                                 struct t_gui_buffer *buffer, time_t date,
+                                 int tags_count, const char **tags,
+                                 int displayed, int highlight,
+                                 const char *prefix, const char *message)
+{
+    char *str_tags, *str_tags2, str_temp[128], *str_no_color;
+    int length;
+    struct tm *date_tmp;
+
+    if (trigger_callback_var_needed (vars, vars_skip, "tg_date"))
+    {
+        date_tmp = localtime (&date);
+        if (date_tmp)
+        {
+            strftime (str_temp, sizeof (str_temp),
+                      "%Y-%m-%d %H:%M:%S", date_tmp);
+            weechat_hashtable_set (extra_vars, "tg_date", str_temp);
+        }
+    }
+    if (trigger_callback_var_needed (vars, vars_skip, "tg_displayed"))
+    {
+        snprintf (str_temp, sizeof (str_temp), "%d", displayed);
+        weechat_hashtable_set (extra_vars, "tg_displayed", str_temp);
+    }
+    if (trigger_callback_var_needed (vars, vars_skip, "tg_highlight"))
+    {
+        snprintf (str_temp, sizeof (str_temp), "%d", highlight);
+        weechat_hashtable_set (extra_vars, "tg_highlight", str_temp);
+    }
+    if (trigger_callback_var_needed (vars, vars_skip, "tg_prefix"))
+        weechat_hashtable_set (extra_vars, "tg_prefix", prefix);
+    if (trigger_callback_var_needed (vars, vars_skip, "tg_prefix_nocolor"))
+    {
+        str_no_color = weechat_string_remove_color (prefix, NULL);
+        if (str_no_color)
+        {
+            weechat_hashtable_set (extra_vars, "tg_prefix_nocolor",
+                                   str_no_color);
+            free (str_no_color);
+        }
+    }
+    if (trigger_callback_var_needed (vars, vars_skip, "tg_message"))
+        weechat_hashtable_set (extra_vars, "tg_message", message);
+    if (trigger_callback_var_needed (vars, vars_skip, "tg_message_nocolor"))
+    {
+        str_no_color = weechat_string_remove_color (message, NULL);
+        if (str_no_color)
+        {
+            weechat_hashtable_set (extra_vars, "tg_message_nocolor",
+                                   str_no_color);
+            free (str_no_color);
+        }
+    }
+    if (trigger_callback_var_needed (vars, vars_skip, "tg_tags"))
+    {
+        str_tags = weechat_string_build_with_split_string (tags, ",");
+        if (str_tags)
+        {
+            /* build string with tags and commas around: ",tag1,tag2,tag3," */
+            length = 1 + strlen (str_tags) + 1 + 1;
+            str_tags2 = malloc (length);
+            if (str_tags2)
+            {
+                snprintf (str_tags2, length, ",%s,", str_tags);
+                weechat_hashtable_set (extra_vars, "tg_tags", str_tags2);
+                free (str_tags2);
+            }
+            free (str_tags);
+        }
+    }
+
+    return trigger_callback_set_tags (buffer, tags, tags_count,
+                                      vars, vars_skip, extra_vars);
+}
+
 /*
  * Callback for a print hooked.
  */
@@ -676,66 +1041,50 @@ trigger_callback_print_cb  (void *data, struct t_gui_buffer *buffer,
                             int displayed, int highlight, const char *prefix,
                             const char *message)
 {
-    char *str_tags, *str_tags2, str_temp[128], *str_no_color;
-    int length;
-    struct tm *date_tmp;
+    struct t_hashtable *vars_conditions;
 
     TRIGGER_CALLBACK_CB_INIT(WEECHAT_RC_OK);
 
     /* do nothing if the buffer does not match buffers defined in the trigger */
     if (trigger->hook_print_buffers
-        && !weechat_buffer_match_list (buffer, trigger->hook_print_buffers))
+        && !trigger_callback_buffer_match (trigger, buffer))
         goto end;
 
     TRIGGER_CALLBACK_CB_NEW_POINTERS;
     TRIGGER_CALLBACK_CB_NEW_EXTRA_VARS;
 
-    /* add data in hashtables used for conditions/replace/command */
+    /*
+     * add data in hashtables used for conditions/replace/command
+     * (only variables used in conditions if they are known: the other
+     * variables are set only if conditions are true)
+     */
+    vars_conditions = trigger_callback_vars_conditions (trigger);
     weechat_hashtable_set (pointers, "buffer", buffer);
-    date_tmp = localtime (&date);
-    if (date_tmp)
+    if (!trigger_callback_print_set_vars (vars_conditions, NULL, extra_vars,
+                                          buffer, date, tags_count, tags,
+                                          displayed, highlight,
+                                          prefix, message))
     {
-        strftime (str_temp, sizeof (str_temp), "%Y-%m-%d %H:%M:%S", date_tmp);
-        weechat_hashtable_set (extra_vars, "tg_date", str_temp);
-    }
-    snprintf (str_temp, sizeof (str_temp), "%d", displayed);
-    weechat_hashtable_set (extra_vars, "tg_displayed", str_temp);
-    snprintf (str_temp, sizeof (str_temp), "%d", highlight);
-    weechat_hashtable_set (extra_vars, "tg_highlight", str_temp);
-    weechat_hashtable_set (extra_vars, "tg_prefix", prefix);
-    str_no_color = weechat_string_remove_color (prefix, NULL);
-    if (str_no_color)
-    {
-        weechat_hashtable_set (extra_vars, "tg_prefix_nocolor", str_no_color);
-        free (str_no_color);
+        goto end;
     }
-    weechat_hashtable_set (extra_vars, "tg_message", message);
-    str_no_color = weechat_string_remove_color (message, NULL);
-    if (str_no_color)
+
+    if (vars_conditions)
     {
-        weechat_hashtable_set (extra_vars, "tg_message_nocolor", str_no_color);
-        free (str_no_color);
+        if (!trigger_callback_check_conditions (trigger, pointers, extra_vars))
+            goto end;
+        trigger_callback_print_set_vars (trigger->vars_used, vars_conditions,
+                                         extra_vars, buffer, date,
+                                         tags_count, tags, displayed,
+                                         highlight, prefix, message);
+        trigger_callback_replace_regex (trigger, pointers, extra_vars, 0);
+        trigger_callback_run_command (trigger, buffer, pointers, extra_vars,
+                                      0);
     }
-
-    str_tags = weechat_string_build_with_split_string (tags, ",");
-    if (str_tags)
+    else
     {
-        /* build string with tags and commas around: ",tag1,tag2,tag3," */
-        length = 1 + strlen (str_tags) + 1 + 1;
-        str_tags2 = malloc (length);
-        if (str_tags2)
-        {
-            snprintf (str_tags2, length, ",%s,", str_tags);
-            weechat_hashtable_set (extra_vars, "tg_tags", str_tags2);
-            free (str_tags2);
-        }
-        free (str_tags);
+        /* execute the trigger (conditions, regex, command) */
+        trigger_callback_execute (trigger, buffer, pointers, extra_vars);
     }
-    if (!trigger_callback_set_tags (buffer, tags, tags_count, extra_vars))
-        goto end;
-
-    /* execute the trigger (conditions, regex, command) */
-    trigger_callback_execute (trigger, buffer, pointers, extra_vars);
 
 end:
     TRIGGER_CALLBACK_CB_END(trigger_rc);
@@ -931,6 +1280,24 @@ trigger_callback_init ()
 void
 trigger_callback_end ()
 {
+    int i;
+
     if (trigger_callback_hashtable_options)
         weechat_hashtable_free (trigger_callback_hashtable_options);
+
+    for (i = 0; i < TRIGGER_CALLBACK_POOL_SIZE; i++)
+    {
+        if (trigger_callback_pool_pointers[i].hashtable)
+        {
+            weechat_hashtable_free (trigger_callback_pool_pointers[i].hashtable);
+            trigger_callback_pool_pointers[i].hashtable = NULL;
+        }
+        trigger_callback_pool_pointers[i].used = 0;
+        if (trigger_callback_pool_extra_vars[i].hashtable)
+        {
+            weechat_hashtable_free (trigger_callback_pool_extra_vars[i].hashtable);
+            trigger_callback_pool_extra_vars[i].hashtable = NULL;
+        }
+        trigger_callback_pool_extra_vars[i].used = 0;
+    }
 }
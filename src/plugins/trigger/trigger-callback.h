@@ -38,34 +38,49 @@
         weechat_config_integer (                                \
             trigger->options[TRIGGER_OPTION_RETURN_CODE])];
 
+#define TRIGGER_CALLBACK_POOL_SIZE 16
+
 #define TRIGGER_CALLBACK_CB_NEW_POINTERS                        \
-    pointers = weechat_hashtable_new (                          \
-        32,                                                     \
-        WEECHAT_HASHTABLE_STRING,                               \
-        WEECHAT_HASHTABLE_POINTER,                              \
-        NULL,                                                   \
-        NULL);                                                  \
+    pointers = trigger_callback_pool_get (                      \
+        trigger_callback_pool_pointers,                         \
+        WEECHAT_HASHTABLE_POINTER);                             \
     if (!pointers)                                              \
         goto end;
 
 #define TRIGGER_CALLBACK_CB_NEW_EXTRA_VARS                      \
-    extra_vars = weechat_hashtable_new (                        \
-        32,                                                     \
-        WEECHAT_HASHTABLE_STRING,                               \
-        WEECHAT_HASHTABLE_STRING,                               \
-        NULL,                                                   \
-        NULL);                                                  \
+    extra_vars = trigger_callback_pool_get (                    \
+        trigger_callback_pool_extra_vars,                       \
+        WEECHAT_HASHTABLE_STRING);                              \
     if (!extra_vars)                                            \
         goto end;
 
 #define TRIGGER_CALLBACK_CB_END(__rc)                           \
     if (pointers)                                               \
-        weechat_hashtable_free (pointers);                      \
+        trigger_callback_pool_release (pointers);               \
     if (extra_vars)                                             \
-        weechat_hashtable_free (extra_vars);                    \
+        trigger_callback_pool_release (extra_vars);             \
     trigger->hook_running = 0;                                  \
     return __rc;
 
+/*
+ * hashtable in a pool, shared by all triggers: hashtables are reused by hook
+ * callbacks (emptied after use) instead of being created for each call
+ */
+
+struct t_trigger_callback_pool
+{
+    struct t_hashtable *hashtable;     /* hashtable (NULL if not created)   */
+    int used;                          /* 1 if used by a callback running   */
+};
+
+extern struct t_hashtable *trigger_callback_hashtable_options;
+extern struct t_trigger_callback_pool trigger_callback_pool_pointers[];
+extern struct t_trigger_callback_pool trigger_callback_pool_extra_vars[];
+
+extern struct t_hashtable *trigger_callback_pool_get (struct t_trigger_callback_pool *pool,
+                                                      const char *type_values);
+extern void trigger_callback_pool_release (struct t_hashtable *hashtable);
+
 extern int trigger_callback_signal_cb (void *data, const char *signal,
                                        const char *type_data, void *signal_data);
 extern int trigger_callback_hsignal_cb (void *data, const char *signal,
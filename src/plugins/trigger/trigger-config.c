@@ -145,6 +145,8 @@ trigger_config_change_trigger_hook (void *data, struct t_config_option *option)
     if (!ptr_trigger)
         return;
 
+    trigger_set_vars_used (ptr_trigger);
+
     if (ptr_trigger->options[TRIGGER_OPTION_ARGUMENTS])
         trigger_hook (ptr_trigger);
 }
@@ -170,6 +172,28 @@ trigger_config_change_trigger_arguments (void *data,
         trigger_hook (ptr_trigger);
 }
 
+/*
+ * Callback for changes on option "trigger.trigger.xxx.conditions".
+ */
+
+void
+trigger_config_change_trigger_conditions (void *data,
+                                          struct t_config_option *option)
+{
+    struct t_trigger *ptr_trigger;
+
+    /* make C compiler happy */
+    (void) data;
+
+    ptr_trigger = trigger_search_with_option (option);
+    if (!ptr_trigger)
+        return;
+
+    trigger_compile_conditions (weechat_config_string (option),
+                                &ptr_trigger->conditions_eval);
+    trigger_set_vars_used (ptr_trigger);
+}
+
 /*
  * Callback for changes on option "trigger.trigger.xxx.regex".
  */
@@ -212,6 +236,8 @@ trigger_config_change_trigger_regex (void *data, struct t_config_option *option)
                             weechat_prefix ("error"), TRIGGER_PLUGIN_NAME);
             break;
     }
+
+    trigger_set_vars_used (ptr_trigger);
 }
 
 /*
@@ -234,6 +260,7 @@ trigger_config_change_trigger_command (void *data,
     trigger_split_command (weechat_config_string (option),
                            &ptr_trigger->commands_count,
                            &ptr_trigger->commands);
+    trigger_set_vars_used (ptr_trigger);
 }
 
 /*
@@ -297,8 +324,8 @@ trigger_config_create_trigger_option (const char *trigger_name, int index_option
                 N_("condition(s) for running the command (it is checked in "
                    "hook callback) (note: content is evaluated when trigger is "
                    "run, see /help eval)"),
-                NULL, 0, 0, value, NULL, 0,
-                NULL, NULL, NULL, NULL, NULL, NULL);
+                NULL, 0, 0, value, NULL, 0, NULL, NULL,
+                &trigger_config_change_trigger_conditions, NULL, NULL, NULL);
             break;
         case TRIGGER_OPTION_REGEX:
             ptr_option = weechat_config_new_option (
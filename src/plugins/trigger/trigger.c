@@ -225,9 +225,10 @@ trigger_unhook (struct t_trigger *trigger)
     trigger->hook_count_cmd = 0;
     if (trigger->hook_print_buffers)
     {
-        free (trigger->hook_print_buffers);
+        weechat_string_free_split (trigger->hook_print_buffers);
         trigger->hook_print_buffers = NULL;
     }
+    trigger->hook_print_buffers_count = 0;
 }
 
 /*
@@ -308,7 +309,15 @@ trigger_hook (struct t_trigger *trigger)
             if (argv && (argc >= 1))
             {
                 if (strcmp (argv[0], "*") != 0)
-                    trigger->hook_print_buffers = strdup (argv[0]);
+                {
+                    /*
+                     * split buffer masks once here, so that the callback
+                     * does not have to split them for each line printed
+                     */
+                    trigger->hook_print_buffers = weechat_string_split (
+                        argv[0], ",", 0, 0,
+                        &trigger->hook_print_buffers_count);
+                }
                 if ((argc >= 2) && (strcmp (argv[1], "*") != 0))
                     tags = argv[1];
                 if ((argc >= 3) && (strcmp (argv[2], "*") != 0))
@@ -688,6 +697,162 @@ trigger_split_command (const char *command,
     }
 }
 
+/*
+ * Compiles conditions of a trigger (they are evaluated in each call to hook
+ * callback).
+ */
+
+void
+trigger_compile_conditions (const char *conditions,
+                            struct t_eval_compiled **conditions_eval)
+{
+    if (!conditions_eval)
+        return;
+
+    if (*conditions_eval)
+    {
+        weechat_string_eval_free (*conditions_eval);
+        *conditions_eval = NULL;
+    }
+
+    if (conditions && conditions[0])
+    {
+        *conditions_eval = weechat_string_eval_compile (
+            conditions, trigger_callback_hashtable_options);
+    }
+}
+
+/*
+ * Adds variables used in an expression in hashtable "vars".
+ *
+ * Returns:
+ *   1: all variables have been added
+ *   0: variables are unknown (or error)
+ */
+
+int
+trigger_add_vars (const char *expression, struct t_hashtable *vars)
+{
+    struct t_eval_compiled *compiled;
+    int rc;
+
+    if (!expression || !expression[0])
+        return 1;
+
+    compiled = weechat_string_eval_compile (expression, NULL);
+    if (!compiled)
+        return 0;
+
+    rc = weechat_string_eval_get_vars (compiled, vars);
+
+    weechat_string_eval_free (compiled);
+
+    return rc;
+}
+
+/*
+ * Builds the list of variables used in conditions, regex and commands of a
+ * trigger: hook callbacks use it to set only these variables in hashtable
+ * "extra_vars".
+ *
+ * The hashtables are set to NULL if variables used are unknown (then all
+ * variables are set by callbacks).
+ */
+
+void
+trigger_set_vars_used (struct t_trigger *trigger)
+{
+    const char *ptr_var;
+    int i;
+
+    if (!trigger)
+        return;
+
+    if (trigger->vars_conditions)
+    {
+        weechat_hashtable_free (trigger->vars_conditions);
+        trigger->vars_conditions = NULL;
+    }
+    if (trigger->vars_used)
+    {
+        weechat_hashtable_free (trigger->vars_used);
+        trigger->vars_used = NULL;
+    }
+
+    if (!trigger->options[TRIGGER_OPTION_HOOK]
+        || !trigger->options[TRIGGER_OPTION_CONDITIONS])
+        return;
+
+    trigger->vars_conditions = weechat_hashtable_new (32,
+                                                      WEECHAT_HASHTABLE_STRING,
+                                                      WEECHAT_HASHTABLE_STRING,
+                                                      NULL,
+                                                      NULL);
+    trigger->vars_used = weechat_hashtable_new (32,
+                                                WEECHAT_HASHTABLE_STRING,
+                                                WEECHAT_HASHTABLE_STRING,
+                                                NULL,
+                                                NULL);
+    if (!trigger->vars_conditions || !trigger->vars_used)
+        goto unknown;
+
+    /* variables used in conditions */
+    if (trigger->conditions_eval)
+    {
+        if (!weechat_string_eval_get_vars (trigger->conditions_eval,
+                                           trigger->vars_conditions)
+            || !weechat_string_eval_get_vars (trigger->conditions_eval,
+                                              trigger->vars_used))
+        {
+            goto unknown;
+        }
+    }
+    else if (weechat_config_string (trigger->options[TRIGGER_OPTION_CONDITIONS])[0])
+    {
+        /* invalid conditions (not compiled) */
+        goto unknown;
+    }
+
+    /* variables used in regex (variable updated and replacement text) */
+    for (i = 0; i < trigger->regex_count; i++)
+    {
+        ptr_var = (trigger->regex[i].variable) ?
+            trigger->regex[i].variable :
+            trigger_hook_regex_default_var[weechat_config_integer (trigger->options[TRIGGER_OPTION_HOOK])];
+        if (ptr_var && ptr_var[0])
+            weechat_hashtable_set (trigger->vars_used, ptr_var, NULL);
+        if (!trigger_add_vars (trigger->regex[i].replace_escaped,
+                               trigger->vars_used))
+        {
+            goto unknown;
+        }
+    }
+
+    /* variables used in commands */
+    if (trigger->commands)
+    {
+        for (i = 0; trigger->commands[i]; i++)
+        {
+            if (!trigger_add_vars (trigger->commands[i], trigger->vars_used))
+                goto unknown;
+        }
+    }
+
+    return;
+
+unknown:
+    if (trigger->vars_conditions)
+    {
+        weechat_hashtable_free (trigger->vars_conditions);
+        trigger->vars_conditions = NULL;
+    }
+    if (trigger->vars_used)
+    {
+        weechat_hashtable_free (trigger->vars_used);
+        trigger->vars_used = NULL;
+    }
+}
+
 /*
  * Checks if a trigger name is valid: it must not start with "-" and not have
  * any spaces.
@@ -747,7 +912,11 @@ trigger_alloc (const char *name)
     new_trigger->hook_count_cb = 0;
     new_trigger->hook_count_cmd = 0;
     new_trigger->hook_running = 0;
+    new_trigger->hook_print_buffers_count = 0;
     new_trigger->hook_print_buffers = NULL;
+    new_trigger->conditions_eval = NULL;
+    new_trigger->vars_conditions = NULL;
+    new_trigger->vars_used = NULL;
     new_trigger->regex_count = 0;
     new_trigger->regex = NULL;
     new_trigger->commands_count = 0;
@@ -837,6 +1006,8 @@ trigger_new_with_options (const char *name, struct t_config_option **options)
     trigger_add (new_trigger, &triggers, &last_trigger);
     triggers_count++;
 
+    trigger_compile_conditions (weechat_config_string (new_trigger->options[TRIGGER_OPTION_CONDITIONS]),
+                                &new_trigger->conditions_eval);
     if (trigger_regex_split (weechat_config_string (new_trigger->options[TRIGGER_OPTION_REGEX]),
                              &new_trigger->regex_count,
                              &new_trigger->regex) < 0)
@@ -851,6 +1022,8 @@ trigger_new_with_options (const char *name, struct t_config_option **options)
                            &new_trigger->commands_count,
                            &new_trigger->commands);
 
+    trigger_set_vars_used (new_trigger);
+
     if (weechat_config_boolean (new_trigger->options[TRIGGER_OPTION_ENABLED]))
         trigger_hook (new_trigger);
 
@@ -1038,6 +1211,12 @@ trigger_free (struct t_trigger *trigger)
 
     /* free data */
     trigger_unhook (trigger);
+    if (trigger->conditions_eval)
+        weechat_string_eval_free (trigger->conditions_eval);
+    if (trigger->vars_conditions)
+        weechat_hashtable_free (trigger->vars_conditions);
+    if (trigger->vars_used)
+        weechat_hashtable_free (trigger->vars_used);
     trigger_regex_free (&trigger->regex_count, &trigger->regex);
     if (trigger->name)
         free (trigger->name);
@@ -1109,7 +1288,22 @@ trigger_print_log ()
         weechat_log_printf ("  hook_count_cb . . . . . : %lu",   ptr_trigger->hook_count_cb);
         weechat_log_printf ("  hook_count_cmd. . . . . : %lu",   ptr_trigger->hook_count_cmd);
         weechat_log_printf ("  hook_running. . . . . . : %d",    ptr_trigger->hook_running);
-        weechat_log_printf ("  hook_print_buffers. . . : '%s'",  ptr_trigger->hook_print_buffers);
+        weechat_log_printf ("  hook_print_buffers_count: %d",    ptr_trigger->hook_print_buffers_count);
+        weechat_log_printf ("  hook_print_buffers. . . : 0x%lx", ptr_trigger->hook_print_buffers);
+        for (i = 0; i < ptr_trigger->hook_print_buffers_count; i++)
+        {
+            weechat_log_printf ("    hook_print_buffers[%03d]: '%s'",
+                                i, ptr_trigger->hook_print_buffers[i]);
+        }
+        weechat_log_printf ("  conditions_eval . . . . : 0x%lx", ptr_trigger->conditions_eval);
+        weechat_log_printf ("  vars_conditions . . . . : 0x%lx (%s)",
+                            ptr_trigger->vars_conditions,
+                            weechat_hashtable_get_string (ptr_trigger->vars_conditions,
+                                                          "keys"));
+        weechat_log_printf ("  vars_used . . . . . . . : 0x%lx (%s)",
+                            ptr_trigger->vars_used,
+                            weechat_hashtable_get_string (ptr_trigger->vars_used,
+                                                          "keys"));
         weechat_log_printf ("  regex_count . . . . . . : %d",    ptr_trigger->regex_count);
         weechat_log_printf ("  regex . . . . . . . . . : 0x%lx", ptr_trigger->regex);
         for (i = 0; i < ptr_trigger->regex_count; i++)
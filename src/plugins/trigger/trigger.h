@@ -89,7 +89,18 @@ struct t_trigger
     unsigned long hook_count_cb;       /* number of calls made to callback  */
     unsigned long hook_count_cmd;      /* number of commands run in callback*/
     int hook_running;                  /* 1 if one hook callback is running */
-    char *hook_print_buffers;          /* buffers (for hook_print only)     */
+    int hook_print_buffers_count;      /* number of buffer masks            */
+    char **hook_print_buffers;         /* buffer masks, split when trigger  */
+                                       /* is hooked (for hook_print only)   */
+
+    /* conditions */
+    struct t_eval_compiled *conditions_eval; /* compiled conditions (NULL   */
+                                       /* if there is no condition)         */
+
+    /* variables used in conditions/regex/commands (NULL if unknown) */
+    struct t_hashtable *vars_conditions; /* variables used in conditions    */
+    struct t_hashtable *vars_used;     /* variables used in conditions,     */
+                                       /* regex and commands                */
 
     /* regular expressions with their replacement text */
     int regex_count;                   /* number of regex                   */
@@ -133,6 +144,9 @@ extern int trigger_regex_split (const char *str_regex,
                                 struct t_trigger_regex **regex);
 extern void trigger_split_command (const char *command,
                                    int *commands_count, char ***commands);
+extern void trigger_compile_conditions (const char *conditions,
+                                        struct t_eval_compiled **conditions_eval);
+extern void trigger_set_vars_used (struct t_trigger *trigger);
 extern void trigger_unhook (struct t_trigger *trigger);
 extern void trigger_hook (struct t_trigger *trigger);
 extern int trigger_name_valid (const char *name);
@@ -45,6 +45,7 @@ struct t_infolist_item;
 struct t_weelist;
 struct t_hashtable;
 struct t_hdata;
+struct t_eval_compiled;
 struct timeval;
 
 /*
@@ -57,7 +58,7 @@ struct timeval;
  * please change the date with current one; for a second change at same
  * date, increment the 01, otherwise please keep 01.
  */
-#define WEECHAT_PLUGIN_API_VERSION "20140610-01"
+#define WEECHAT_PLUGIN_API_VERSION "20140610-04"
 
 /* macros for defining plugin infos */
 #define WEECHAT_PLUGIN_NAME(__name)                                     \
@@ -274,6 +275,14 @@ struct t_weechat_plugin
                                      struct t_hashtable *pointers,
                                      struct t_hashtable *extra_vars,
                                      struct t_hashtable *options);
+    struct t_eval_compiled *(*string_eval_compile) (const char *expr,
+                                                    struct t_hashtable *options);
+    char *(*string_eval_exec) (struct t_eval_compiled *compiled,
+                               struct t_hashtable *pointers,
+                               struct t_hashtable *extra_vars);
+    int (*string_eval_get_vars) (struct t_eval_compiled *compiled,
+                                 struct t_hashtable *vars);
+    void (*string_eval_free) (struct t_eval_compiled *compiled);
 
     /* UTF-8 strings */
     int (*utf8_has_8bits) (const char *string);
@@ -307,6 +316,8 @@ struct t_weechat_plugin
     long (*util_timeval_diff) (struct timeval *tv1, struct timeval *tv2);
     void (*util_timeval_add) (struct timeval *tv, long interval);
     char *(*util_get_time_string) (const time_t *date);
+    int (*util_strftime) (char *string, int max, const char *format,
+                          time_t date);
     int (*util_version_number) (const char *version);
 
     /* sorted lists */
@@ -1059,6 +1070,15 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
                                        __extra_vars, __options)         \
     weechat_plugin->string_eval_expression(__expr, __pointers,          \
                                            __extra_vars, __options)
+#define weechat_string_eval_compile(__expr, __options)                  \
+    weechat_plugin->string_eval_compile(__expr, __options)
+#define weechat_string_eval_exec(__compiled, __pointers, __extra_vars)  \
+    weechat_plugin->string_eval_exec(__compiled, __pointers,            \
+                                     __extra_vars)
+#define weechat_string_eval_get_vars(__compiled, __vars)                \
+    weechat_plugin->string_eval_get_vars(__compiled, __vars)
+#define weechat_string_eval_free(__compiled)                            \
+    weechat_plugin->string_eval_free(__compiled)
 
 /* UTF-8 strings */
 #define weechat_utf8_has_8bits(__string)                                \
@@ -1119,6 +1139,8 @@ extern int weechat_plugin_end (struct t_weechat_plugin *plugin);
     weechat_plugin->util_timeval_add(__time, __interval)
 #define weechat_util_get_time_string(__date)                            \
     weechat_plugin->util_get_time_string(__date)
+#define weechat_util_strftime(__string, __max, __format, __date)        \
+    weechat_plugin->util_strftime(__string, __max, __format, __date)
 #define weechat_util_version_number(__version)                          \
     weechat_plugin->util_version_number(__version)
 
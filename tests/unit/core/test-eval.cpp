@@ -201,3 +201,158 @@ TEST(Eval, EvalExpression)
 
     hashtable_free (extra_vars);
 }
+
+/*
+ * Tests functions:
+ *   eval_compile
+ *   eval_exec
+ *   eval_compiled_free
+ */
+
+TEST(Eval, EvalCompiled)
+{
+    struct t_hashtable *extra_vars, *options;
+    struct t_eval_compiled *compiled;
+    char *value;
+
+    extra_vars = hashtable_new (32,
+                                WEECHAT_HASHTABLE_STRING,
+                                WEECHAT_HASHTABLE_STRING,
+                                NULL, NULL);
+    CHECK(extra_vars);
+
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    CHECK(options);
+
+    POINTERS_EQUAL(NULL, eval_compile (NULL, NULL));
+    POINTERS_EQUAL(NULL, eval_exec (NULL, NULL, NULL));
+    eval_compiled_free (NULL);
+
+    /* expression evaluated many times, with different extra vars */
+    compiled = eval_compile ("a${test}b ${buffer.number}", NULL);
+    CHECK(compiled);
+    value = eval_exec (compiled, NULL, extra_vars);
+    STRCMP_EQUAL("ab 1", value);
+    free (value);
+    hashtable_set (extra_vars, "test", "value");
+    value = eval_exec (compiled, NULL, extra_vars);
+    STRCMP_EQUAL("avalueb 1", value);
+    free (value);
+    eval_compiled_free (compiled);
+
+    /* condition evaluated many times, with different extra vars */
+    hashtable_set (options, "type", "condition");
+    compiled = eval_compile ("${test} =~ ^val && (${test2} == 2 || ${test2} > 5)",
+                             options);
+    CHECK(compiled);
+    value = eval_exec (compiled, NULL, extra_vars);
+    STRCMP_EQUAL("0", value);
+    free (value);
+    hashtable_set (extra_vars, "test2", "2");
+    value = eval_exec (compiled, NULL, extra_vars);
+    STRCMP_EQUAL("1", value);
+    free (value);
+    hashtable_set (extra_vars, "test2", "3");
+    value = eval_exec (compiled, NULL, extra_vars);
+    STRCMP_EQUAL("0", value);
+    free (value);
+    hashtable_set (extra_vars, "test2", "18");
+    value = eval_exec (compiled, NULL, extra_vars);
+    STRCMP_EQUAL("1", value);
+    free (value);
+    hashtable_set (extra_vars, "test", "other");
+    value = eval_exec (compiled, NULL, extra_vars);
+    STRCMP_EQUAL("0", value);
+    free (value);
+    eval_compiled_free (compiled);
+
+    /* nested variables and custom prefix/suffix */
+    hashtable_set (extra_vars, "name", "test");
+    compiled = eval_compile ("${${name}} == other", options);
+    CHECK(compiled);
+    value = eval_exec (compiled, NULL, extra_vars);
+    STRCMP_EQUAL("1", value);
+    free (value);
+    eval_compiled_free (compiled);
+    hashtable_remove_all (options);
+    hashtable_set (options, "prefix", "%(");
+    hashtable_set (options, "suffix", ")");
+    compiled = eval_compile ("%(test) ${test} %(test2", options);
+    CHECK(compiled);
+    value = eval_exec (compiled, NULL, extra_vars);
+    STRCMP_EQUAL("other ${test} ", value);
+    free (value);
+    eval_compiled_free (compiled);
+
+    hashtable_free (extra_vars);
+    hashtable_free (options);
+}
+
+/*
+ * Tests functions:
+ *   eval_compiled_get_vars
+ */
+
+TEST(Eval, EvalCompiledGetVars)
+{
+    struct t_hashtable *options, *vars;
+    struct t_eval_compiled *compiled;
+
+    options = hashtable_new (32,
+                             WEECHAT_HASHTABLE_STRING,
+                             WEECHAT_HASHTABLE_STRING,
+                             NULL, NULL);
+    CHECK(options);
+    vars = hashtable_new (32,
+                          WEECHAT_HASHTABLE_STRING,
+                          WEECHAT_HASHTABLE_STRING,
+                          NULL, NULL);
+    CHECK(vars);
+
+    LONGS_EQUAL(0, eval_compiled_get_vars (NULL, vars));
+
+    /* simple expression */
+    compiled = eval_compile ("a${test}b ${buffer.number} ${test}", NULL);
+    CHECK(compiled);
+    LONGS_EQUAL(0, eval_compiled_get_vars (compiled, NULL));
+    LONGS_EQUAL(1, eval_compiled_get_vars (compiled, vars));
+    LONGS_EQUAL(2, vars->items_count);
+    CHECK(hashtable_has_key (vars, "test"));
+    CHECK(hashtable_has_key (vars, "buffer.number"));
+    eval_compiled_free (compiled);
+
+    /* condition */
+    hashtable_remove_all (vars);
+    hashtable_set (options, "type", "condition");
+    compiled = eval_compile ("${test} =~ ^val && (${test2} == 2 || ${test3})",
+                             options);
+    CHECK(compiled);
+    LONGS_EQUAL(1, eval_compiled_get_vars (compiled, vars));
+    LONGS_EQUAL(3, vars->items_count);
+    CHECK(hashtable_has_key (vars, "test"));
+    CHECK(hashtable_has_key (vars, "test2"));
+    CHECK(hashtable_has_key (vars, "test3"));
+    eval_compiled_free (compiled);
+
+    /* no variables */
+    hashtable_remove_all (vars);
+    compiled = eval_compile ("abc == abc", options);
+    CHECK(compiled);
+    LONGS_EQUAL(1, eval_compiled_get_vars (compiled, vars));
+    LONGS_EQUAL(0, vars->items_count);
+    eval_compiled_free (compiled);
+
+    /* name of variable known only at runtime */
+    hashtable_remove_all (vars);
+    compiled = eval_compile ("${${name}} == other", options);
+    CHECK(compiled);
+    LONGS_EQUAL(0, eval_compiled_get_vars (compiled, vars));
+    CHECK(hashtable_has_key (vars, "name"));
+    eval_compiled_free (compiled);
+
+    hashtable_free (vars);
+    hashtable_free (options);
+}
@@ -90,6 +90,47 @@ TEST(Util, GetTimeString)
     STRCMP_EQUAL("Sat, 01 Jan 2000 00:00:00", str_date);
 }
 
+/*
+ * Tests functions:
+ *   util_strftime
+ */
+
+TEST(Util, Strftime)
+{
+    const char *formats[] = { "%H:%M:%S", "%H:%M", "%Y-%m-%d", "%H %Z",
+                              "%s", "", NULL };
+    char str_date[128], str_date2[128];
+    struct tm *local_time;
+    time_t date;
+    int i, j, length;
+
+    /* invalid arguments */
+    LONGS_EQUAL(0, util_strftime (NULL, 0, "%H", 0));
+    LONGS_EQUAL(0, util_strftime (str_date, 0, "%H", 0));
+    LONGS_EQUAL(0, util_strftime (str_date, sizeof (str_date), NULL, 0));
+    STRCMP_EQUAL("", str_date);
+
+    /* buffer too small */
+    date = 946684800;  /* 2000-01-01 00:00 */
+    LONGS_EQUAL(0, util_strftime (str_date, 4, "%Y-%m-%d", date));
+    STRCMP_EQUAL("", str_date);
+
+    /* same result as strftime (cached or not) */
+    for (i = 0; i < 3 * 86400; i += 7)
+    {
+        date = 946684800 + i;
+        local_time = localtime (&date);
+        for (j = 0; formats[j]; j++)
+        {
+            length = strftime (str_date2, sizeof (str_date2), formats[j],
+                               local_time);
+            LONGS_EQUAL(length, util_strftime (str_date, sizeof (str_date),
+                                               formats[j], date));
+            STRCMP_EQUAL(str_date2, str_date);
+        }
+    }
+}
+
 /*
  * Tests functions:
  *   util_signal_search